@@ -0,0 +1,210 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_CompressedTable_hpp
+#define cf3_common_CompressedTable_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "common/Component.hpp"
+#include "common/Foreach.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// View on one row of a CompressedTable. Use CompressedTableRow<const T> for read-only access.
+/// The view is only valid as long as the table is not modified.
+template<typename T>
+class CompressedTableRow
+{
+public:
+  typedef T value_type;
+  typedef T& reference;
+  typedef T& const_reference;
+  typedef T* iterator;
+  typedef T* const_iterator;
+  typedef Uint size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  CompressedTableRow(T* begin, T* end) : m_begin(begin), m_end(end) {}
+
+  /// Conversion from a mutable to a read-only row
+  template<typename OtherT>
+  CompressedTableRow(const CompressedTableRow<OtherT>& other) : m_begin(other.begin()), m_end(other.end()) {}
+
+  Uint size() const { return m_end - m_begin; }
+  bool empty() const { return m_begin == m_end; }
+
+  T& operator[](const Uint i) const { cf3_assert(i < size()); return m_begin[i]; }
+
+  iterator begin() const { return m_begin; }
+  iterator end() const { return m_end; }
+
+private:
+  T* m_begin;
+  T* m_end;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Component holding a table with variable row-size per row, stored in compressed row format:
+/// all values are in one contiguous array, and the start of each row is kept in an offsets array.
+/// Compared to DynTable, this avoids a heap allocation per row, at the cost of only allowing rows
+/// to be added at the end. Tables are built either by allocating all rows at once from their sizes
+/// and filling them afterwards, or by appending rows one by one.
+template<typename T>
+class CompressedTable : public common::Component {
+
+public:
+
+  typedef CompressedTableRow<T> Row;
+  typedef CompressedTableRow<const T> ConstRow;
+
+  /// Contructor
+  /// @param name of the component
+  CompressedTable ( const std::string& name ) : Component(name), m_offsets(1, 0) { }
+
+  ~CompressedTable () {}
+
+  /// Get the class name
+  static std::string type_name () { return "CompressedTable<"+common::class_name<T>()+">"; }
+
+  /// Number of rows
+  Uint size() const { return m_offsets.size() - 1; }
+
+  /// Total number of values, summed over all rows
+  Uint nb_values() const { return m_values.size(); }
+
+  Uint row_size(const Uint i) const { cf3_assert(i < size()); return m_offsets[i+1] - m_offsets[i]; }
+
+  Row operator[] (const Uint idx)
+  {
+    cf3_assert(idx < size());
+    T* values = m_values.empty() ? 0 : &m_values[0];
+    return Row(values + m_offsets[idx], values + m_offsets[idx+1]);
+  }
+
+  ConstRow operator[] (const Uint idx) const
+  {
+    cf3_assert(idx < size());
+    const T* values = m_values.empty() ? 0 : &m_values[0];
+    return ConstRow(values + m_offsets[idx], values + m_offsets[idx+1]);
+  }
+
+  /// Remove all rows
+  void clear()
+  {
+    m_offsets.assign(1, 0);
+    m_values.clear();
+  }
+
+  /// Replace the contents with rows of the given sizes, holding default-constructed values
+  /// @param row_sizes Any container of row sizes, supporting size() and operator[]
+  template<typename VectorT>
+  void allocate(const VectorT& row_sizes)
+  {
+    const Uint nb_rows = row_sizes.size();
+    m_offsets.resize(nb_rows + 1);
+    m_offsets[0] = 0;
+    for(Uint i = 0; i != nb_rows; ++i)
+      m_offsets[i+1] = m_offsets[i] + row_sizes[i];
+    m_values.assign(m_offsets.back(), T());
+  }
+
+  /// Reserve memory for the given number of rows and values, when appending rows
+  void reserve(const Uint nb_rows, const Uint nb_values)
+  {
+    m_offsets.reserve(nb_rows + 1);
+    m_values.reserve(nb_values);
+  }
+
+  /// Append a copy of the given row at the end of the table
+  /// @return the index of the new row
+  template<typename VectorT>
+  Uint add_row(const VectorT& row)
+  {
+    boost_foreach(const typename VectorT::value_type& v, row)
+      m_values.push_back(v);
+    m_offsets.push_back(m_values.size());
+    return size() - 1;
+  }
+
+  /// Append an empty row at the end of the table, to be filled using push_back()
+  /// @return the index of the new row
+  Uint add_row()
+  {
+    m_offsets.push_back(m_values.size());
+    return size() - 1;
+  }
+
+  /// Append a value to the last row
+  void push_back(const T& value)
+  {
+    cf3_assert(size() != 0);
+    m_values.push_back(value);
+    ++m_offsets.back();
+  }
+
+  /// Replace the contents with a copy of the given rows, e.g. DynTable::array()
+  template<typename ArrayT>
+  void assign(const ArrayT& rows)
+  {
+    std::vector<Uint> row_sizes;
+    row_sizes.reserve(rows.size());
+    boost_foreach(const typename ArrayT::value_type& row, rows)
+      row_sizes.push_back(row.size());
+    allocate(row_sizes);
+
+    Uint i = 0;
+    boost_foreach(const typename ArrayT::value_type& row, rows)
+    {
+      std::copy(row.begin(), row.end(), m_values.begin() + m_offsets[i]);
+      ++i;
+    }
+  }
+
+  /// Release memory that was reserved but is not used
+  void compact()
+  {
+    std::vector<Uint>(m_offsets).swap(m_offsets);
+    std::vector<T>(m_values).swap(m_values);
+  }
+
+  /// @return The start of each row in values(), with size()+1 entries
+  const std::vector<Uint>& offsets() const { return m_offsets; }
+
+  /// @return All values, stored row after row
+  const std::vector<T>& values() const { return m_values; }
+
+private: // data
+
+  std::vector<Uint> m_offsets;
+  std::vector<T> m_values;
+
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::ostream& operator<<(std::ostream& os, const CompressedTable<Uint>& table);
+std::ostream& operator<<(std::ostream& os, const CompressedTable<int>& table);
+std::ostream& operator<<(std::ostream& os, const CompressedTable<Real>& table);
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_CompressedTable_hpp
@@ -0,0 +1,322 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_HashMap_hpp
+#define cf3_common_HashMap_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+
+#include "common/Component.hpp"
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// This component class is a drop-in alternative for Map, using a flat open-addressing
+/// hash table (linear probing) instead of a sorted vector.
+/// The pairs are stored contiguously in insertion order, as in Map, and a separate
+/// table of slots holds the index of the pair for each hash bucket. Lookups are
+/// O(1) and never need a sort, so find() can be used right after push_back(),
+/// also in the const version.
+/// Use this instead of Map when lookups are interleaved with insertions, or when the map
+/// is large. Iteration is in insertion order rather than key order, so keep using Map
+/// when the keys must be traversed sorted.
+/// @pre KEY must be supported by boost::hash and operator==
+template <typename KEY, typename DATA>
+class HashMap : public Component {
+
+public: // typedefs
+
+  /// @brief Associative Container -- The map's key type, Key.
+  typedef KEY key_type;
+  /// @brief Pair Associative Container -- The type of object associated with the keys.
+  typedef DATA data_type;
+  /// @brief The type of object, pair<const key_type, data_type>, stored in the map.
+  typedef std::pair<key_type, data_type> value_type;
+
+  /// @brief iterator definition for use in stl algorithms
+  typedef typename std::vector<value_type>::iterator         iterator;
+  /// @brief const_iterator definition for use in stl algorithms
+  typedef typename std::vector<value_type>::const_iterator   const_iterator;
+
+public: // functions
+
+  /// Contructor
+  /// @param[in] name of the component
+  HashMap ( const std::string& name ) : Component(name), m_mask(0)
+  {
+    regist_typeinfo(this);
+  }
+
+  /// Virtual destructor
+  virtual ~HashMap() {}
+
+  /// Get the class name
+  static std::string type_name () { return "HashMap<"+common::class_name<KEY>()+","+common::class_name<DATA>()+">"; }
+
+  /// @brief Reserve memory
+  /// @param[in] max_size of the map to be set before starting inserting pairs in the  map
+  /// @post no rehashing will happen until more than max_size pairs are inserted
+  void reserve (size_t max_size)
+  {
+    m_entries.reserve(max_size);
+    if (2*max_size > m_slots.size())
+      rehash(max_size);
+  }
+
+  /// @brief Copy a std::map into the HashMap
+  /// @param[in] map The map to copy
+  void copy_std_map (std::map<key_type,data_type>& map)
+  {
+    clear();
+    reserve(map.size());
+
+    typename std::map<key_type,data_type>::iterator itr = map.begin();
+    typename std::map<key_type,data_type>::iterator map_end = map.end();
+    for(; itr != map_end; ++itr)
+      push_back(itr->first,itr->second);
+  }
+
+  /// @brief Insert pair without checking if it is already present
+  /// @param[in] key   new key to be inserted, must not be in the map yet
+  /// @param[in] data  new data to be inserted, corresponding to the given key
+  /// @return the position of the new pair
+  Uint push_back(const key_type& key, const data_type& data)
+  {
+    cf3_assert_desc ("Duplicated key inserted in map "+uri().string(), !exists(key));
+    grow_if_needed();
+    m_entries.push_back(std::make_pair(key,data));
+    m_slots[find_slot(key)] = m_entries.size()-1;
+    return m_entries.size()-1;
+  }
+
+  /// @brief Insert pair the same way a std::map would.
+  /// @param[in] v   std::pair<KEY,DATA> type to insert
+  /// @returns a pair, with its member pair::first set to an
+  ///          iterator pointing to either the newly inserted element or to the element
+  ///          that already had its same value in the map. The pair::second element in
+  ///          the pair is set to true if a new element was inserted or false if an element
+  ///          with the same value existed.
+  std::pair<iterator,bool> insert(const value_type& v)
+  {
+    iterator itr = find(v.first);
+    if (itr != end())
+      return std::make_pair(itr,false);
+    return std::make_pair(begin() + push_back(v.first,v.second),true);
+  }
+
+  /// @brief Find the iterator matching with the given KEY
+  /// @param[in] key  key to be looked-up
+  /// @return the iterator with key and value, the end() iterator is returned
+  ///         if no match is found
+  iterator find(const key_type& key)
+  {
+    if (m_entries.empty())
+      return end();
+    const Uint entry = m_slots[find_slot(key)];
+    return entry == empty_slot() ? end() : begin() + entry;
+  }
+
+  /// @brief Find the iterator matching with the given KEY
+  /// @param[in] key  key to be looked-up
+  /// @return the iterator with key and value, the end() iterator is returned
+  ///         if no match is found
+  const_iterator find(const key_type& key) const
+  {
+    if (m_entries.empty())
+      return end();
+    const Uint entry = m_slots[find_slot(key)];
+    return entry == empty_slot() ? end() : begin() + entry;
+  }
+
+  /// @brief Erase the given iterator from the map
+  /// @note The last pair is moved in the place of the erased one
+  /// @param[in] itr The iterator to delete
+  void erase (iterator itr)
+  {
+    const Uint entry = itr - begin();
+    remove_slot(find_slot(itr->first));
+
+    const Uint last = m_entries.size()-1;
+    if (entry != last)
+    {
+      m_slots[find_slot(m_entries[last].first)] = entry;
+      m_entries[entry] = m_entries[last];
+    }
+    m_entries.pop_back();
+  }
+
+  /// @brief Erase the entry with given key from the map
+  /// @param[in] key The key to delete
+  /// @returns true if element is erased, false if no element was erased
+  bool erase (const key_type& key)
+  {
+    iterator itr = find(key);
+    if (itr == end())
+      return false;
+    erase(itr);
+    return true;
+  }
+
+  /// @brief Check if the given KEY is existing in the HashMap
+  /// @param[in] key  key to be looked-up
+  /// @return flag to know if key exists
+  bool exists(const key_type& key) const
+  {
+    return (find(key) != end());
+  }
+
+  /// @brief Clear the content of the map, releasing its memory
+  void clear()
+  {
+    std::vector<value_type>().swap(m_entries);
+    std::vector<Uint>().swap(m_slots);
+    m_mask = 0;
+  }
+
+  /// @brief Get the number of pairs already inserted
+  size_t size() const { return m_entries.size(); }
+
+  /// @brief Get the capacity of the map (memory allocated)
+  size_t capacity() const { return m_entries.capacity(); }
+
+  /// @brief Overloading of the operator"[]" for assignment AND insertion
+  /// @param[in] key The key to look for. If the key is not found,
+  ///               it is inserted using push_back().
+  /// @return modifiable data. In case the key did not exist, this will assign the newly created data.
+  data_type& operator[] (const key_type& key)
+  {
+    iterator itr = find(key);
+    if (itr != end())
+      return itr->second;
+    return m_entries[push_back(key,data_type())].second;
+  }
+
+  /// @brief Overloading of the operator"[]" for access only
+  /// @param[in] key The key to look for, which must exist
+  /// @return non-modifiable data for the given key
+  const data_type& operator[] (const key_type& key) const
+  {
+    const_iterator itr = find(key);
+    cf3_assert_desc( "The key is not found in the HashMap, and can not be inserted in const version." , itr != end())
+    return itr->second;
+  }
+
+  /// @brief Does nothing, lookups don't need sorting. Provided for interface compatibility with Map.
+  void sort_keys() {}
+
+  /// @return the iterator pointing at the first element
+  iterator begin() { return m_entries.begin(); }
+
+  /// @return the const_iterator pointing at the first element
+  const_iterator begin() const { return m_entries.begin(); }
+
+  /// @return the end iterator
+  iterator end() { return m_entries.end(); }
+
+  /// @return the end const_iterator
+  const_iterator end() const { return m_entries.end(); }
+
+private: // helper functions
+
+  /// Marker for a slot that points to no entry
+  static Uint empty_slot() { return std::numeric_limits<Uint>::max(); }
+
+  /// Hash of a key. boost::hash is the identity for integers, so the bits are mixed
+  /// to spread consecutive global indices over the table.
+  static Uint hash(const key_type& key)
+  {
+    boost::uint64_t h = boost::hash<key_type>()(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<Uint>(h);
+  }
+
+  /// Slot containing the given key, or the empty slot where it would be inserted
+  /// @pre the slot table is not empty
+  Uint find_slot(const key_type& key) const
+  {
+    Uint slot = hash(key) & m_mask;
+    while (m_slots[slot] != empty_slot() && !(m_entries[m_slots[slot]].first == key))
+      slot = (slot+1) & m_mask;
+    return slot;
+  }
+
+  /// Empty the given slot, shifting back entries in the same probe sequence so no gap is left
+  void remove_slot(Uint hole)
+  {
+    Uint slot = hole;
+    while (true)
+    {
+      slot = (slot+1) & m_mask;
+      if (m_slots[slot] == empty_slot())
+        break;
+
+      // The entry can fill the hole if its home slot is not cyclically in (hole, slot]
+      const Uint home = hash(m_entries[m_slots[slot]].first) & m_mask;
+      const bool in_range = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+      if (!in_range)
+      {
+        m_slots[hole] = m_slots[slot];
+        hole = slot;
+      }
+    }
+    m_slots[hole] = empty_slot();
+  }
+
+  /// Keep the load factor below one half
+  void grow_if_needed()
+  {
+    if (2*(m_entries.size()+1) > m_slots.size())
+      rehash(std::max<size_t>(2*m_entries.size(), 8));
+  }
+
+  /// Rebuild the slot table for at least nb_entries entries
+  void rehash(const size_t nb_entries)
+  {
+    size_t nb_slots = 16;
+    while (nb_slots < 2*nb_entries)
+      nb_slots *= 2;
+
+    m_slots.assign(nb_slots, empty_slot());
+    m_mask = nb_slots-1;
+    for (Uint entry=0; entry<m_entries.size(); ++entry)
+      m_slots[find_slot(m_entries[entry].first)] = entry;
+  }
+
+private: //data
+
+  /// storage of the inserted data
+  std::vector<value_type> m_entries;
+
+  /// index in m_entries for each slot of the hash table, or empty_slot()
+  std::vector<Uint> m_slots;
+
+  /// number of slots minus one, the number of slots being a power of two
+  Uint m_mask;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_HashMap_hpp
@@ -6,12 +6,16 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring>
+
 #include "boost/lexical_cast.hpp"
 
 #include "common/BoostAssertions.hpp"
 #include "common/LibCommon.hpp"
 #include "common/FindComponents.hpp"
 #include "common/Builder.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
 #include "common/Log.hpp"
 
 #include "common/PE/Comm.hpp"
@@ -38,6 +42,11 @@ namespace PE {
 
 common::ComponentBuilder < CommPattern, Component, LibCommon > CommPattern_Provider;
 
+////////////////////////////////////////////////////////////////////////////////
+
+/// tag of the point-to-point messages of the neighbour exchange
+static const int neighbour_exchange_tag = 7401;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor & destructor
 ////////////////////////////////////////////////////////////////////////////////
@@ -51,17 +60,28 @@ CommPattern::CommPattern(const std::string& name): Component(name), m_gid(alloca
   m_sendCount(PE::Comm::instance().size(),0),
   m_sendMap(0),
   m_recvCount(PE::Comm::instance().size(),0),
-  m_recvMap(0)
+  m_recvMap(0),
+  m_self_recv_start(0)
 {
   //self->regist_signal ( "update" , "Executes communication patterns on all the registered data.", "" ).connect ( boost::bind ( &CommPattern2::update, self, _1 ) );
   m_isUpToDate=false;
   m_isFreeze=false;
+  m_neighbour_exchange=true;
+
+  options().add("neighbour_exchange", m_neighbour_exchange)
+      .link_to(&m_neighbour_exchange)
+      .description("Synchronize with non-blocking point-to-point messages to the neighbouring ranks only. If false, all_to_all over all the ranks is used.");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 CommPattern::~CommPattern()
 {
+  if (!m_pending.empty())
+  {
+    try { finish_synchronize(); }
+    catch (...) {}
+  }
   if (m_gid.get()!=nullptr) m_gid->remove_tag("gid_of_"+this->name());
 }
 
@@ -449,6 +469,7 @@ void CommPattern::setup()
   for(int i=0; i<(const int)local.size(); i+=2){
     m_sendMap[sendstarts[local[i+1].rank]++]=local[i].lid;
   }
+  setup_neighbours();
 
 //PEProcessSortedExecute(-1, PEDebugVector(m_sendCount,m_sendCount.size()); );
 //PECheckPoint(100,"");
@@ -562,6 +583,13 @@ void CommPattern::setup()
 
 void CommPattern::synchronize_all()
 {
+  if ( m_neighbour_exchange )
+  {
+    start_synchronize_all();
+    finish_synchronize();
+    return;
+  }
+
   std::vector<unsigned char> sndbuf(1);
   std::vector<unsigned char> rcvbuf(1);
   BOOST_FOREACH( CommWrapper& pobj, find_components_recursively<CommWrapper>(*this) )
@@ -591,12 +619,25 @@ void CommPattern::synchronize( const CommWrapper& pobj )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void CommPattern::synchronize( const std::vector<std::string>& names )
+{
+  start_synchronize(names);
+  finish_synchronize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // having the vectors for the intermediate buf coming from outside allows keeping them and reuse for all synchronize
 void CommPattern::synchronize_this( const CommWrapper& pobj, std::vector<unsigned char>& sndbuf, std::vector<unsigned char>& rcvbuf )
 {
 //  std::cout << PERank << pobj.name() << "\n" << std::flush;
 //  std::cout << PERank << pobj.needs_update() << "\n" << std::flush;
-  if ( pobj.needs_update() )
+  if ( m_neighbour_exchange )
+  {
+    start_synchronize(pobj);
+    finish_synchronize();
+  }
+  else if ( pobj.needs_update() )
   {
     pobj.pack(sndbuf,m_sendMap);
     rcvbuf.resize(m_recvMap.size()*pobj.size_of()*pobj.stride());
@@ -607,6 +648,191 @@ void CommPattern::synchronize_this( const CommWrapper& pobj, std::vector<unsigne
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void CommPattern::start_synchronize( const std::string& name )
+{
+  start_synchronize(std::vector<std::string>(1,name));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_synchronize( const CommWrapper& pobj )
+{
+  std::vector<const CommWrapper*> group(1,&pobj);
+  start_synchronize_group(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_synchronize( const std::vector<std::string>& names )
+{
+  std::vector<const CommWrapper*> group;
+  group.reserve(names.size());
+  BOOST_FOREACH( const std::string& name, names )
+  {
+    Handle<CommWrapper> pobj(get_child(name));
+    if (is_null(pobj)) throw ValueNotFound(FromHere(), type_name() + " at " + uri().path() + ": no registered data named " + name);
+    group.push_back(pobj.get());
+  }
+  start_synchronize_group(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_synchronize_all()
+{
+  std::vector<const CommWrapper*> group;
+  BOOST_FOREACH( CommWrapper& pobj, find_components_recursively<CommWrapper>(*this) )
+    group.push_back(&pobj);
+  start_synchronize_group(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_synchronize_group( const std::vector<const CommWrapper*>& group )
+{
+  if (!m_pending.empty())
+    throw ShouldNotBeHere(FromHere(), type_name() + " at " + uri().path() + ": start_synchronize called while " + m_pending.front()->name() + " is still being synchronized.");
+
+  // only the data needing update takes part in the exchange
+  m_pending.clear();
+  m_pending_offsets.assign(1,0);
+  BOOST_FOREACH( const CommWrapper* pobj, group )
+  {
+    if ( !pobj->needs_update() ) continue;
+    m_pending.push_back(pobj);
+    m_pending_offsets.push_back(m_pending_offsets.back()+pobj->size_of()*pobj->stride());
+  }
+  if (m_pending.empty()) return;
+
+  // fallback to the blocking all_to_all, one round per data, nothing left for finish_synchronize
+  if ( !m_neighbour_exchange )
+  {
+    BOOST_FOREACH( const CommWrapper* pobj, m_pending )
+    {
+      pobj->pack(m_send_buffer,m_sendMap);
+      m_recv_buffer.resize(m_recvMap.size()*pobj->size_of()*pobj->stride());
+      PE::Comm::instance().all_to_all(m_send_buffer,m_sendCount,m_recv_buffer,m_recvCount,pobj->size_of()*pobj->stride());
+      pobj->unpack(m_recv_buffer,m_recvMap);
+    }
+    m_pending.clear();
+    return;
+  }
+
+  // all data of one neighbour is laid out contiguously, data after data: { n0:(d0,d1,...), n1:(d0,d1,...), ... }
+  // so the message to a neighbour starts at start*item_size, and data d inside of it at size*m_pending_offsets[d]
+  const int item_size=m_pending_offsets.back();
+  Communicator comm=PE::Comm::instance().communicator();
+
+  // +1 for avoiding taking the address of an empty buffer
+  m_send_buffer.resize(m_sendMap.size()*item_size+1);
+  m_recv_buffer.resize(m_recvMap.size()*item_size+1);
+  m_requests.resize(m_recv_neighbours.size()+m_send_neighbours.size());
+
+  // post receives first, so that the messages can land directly in the receive buffer
+  MPI_Request* request=m_requests.empty() ? nullptr : &m_requests[0];
+  for (int n=0; n<(const int)m_recv_neighbours.size(); n++, request++)
+    MPI_CHECK_RESULT(MPI_Irecv,(&m_recv_buffer[m_recv_starts[n]*item_size], m_recv_sizes[n]*item_size, MPI_BYTE, m_recv_neighbours[n], neighbour_exchange_tag, comm, request));
+
+  for (int n=0; n<(const int)m_send_neighbours.size(); n++, request++)
+  {
+    unsigned char* buf=&m_send_buffer[m_send_starts[n]*item_size];
+    for (int d=0; d<(const int)m_pending.size(); d++)
+      m_pending[d]->pack(m_send_maps[n],buf+m_send_sizes[n]*m_pending_offsets[d]);
+    MPI_CHECK_RESULT(MPI_Isend,(buf, m_send_sizes[n]*item_size, MPI_BYTE, m_send_neighbours[n], neighbour_exchange_tag, comm, request));
+  }
+
+  // items sent to itself do not go through mpi, they are packed straight to the receive buffer
+  if (!m_self_send_map.empty())
+  {
+    unsigned char* buf=&m_recv_buffer[m_self_recv_start*item_size];
+    for (int d=0; d<(const int)m_pending.size(); d++)
+      m_pending[d]->pack(m_self_send_map,buf+m_self_send_map.size()*m_pending_offsets[d]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::finish_synchronize()
+{
+  if (m_pending.empty()) return;
+
+  if (!m_requests.empty())
+    MPI_CHECK_RESULT(MPI_Waitall,((int)m_requests.size(), &m_requests[0], MPI_STATUSES_IGNORE));
+  m_requests.clear();
+
+  const int item_size=m_pending_offsets.back();
+  for (int n=0; n<(const int)m_recv_neighbours.size(); n++)
+  {
+    unsigned char* buf=&m_recv_buffer[m_recv_starts[n]*item_size];
+    for (int d=0; d<(const int)m_pending.size(); d++)
+      m_pending[d]->unpack(buf+m_recv_sizes[n]*m_pending_offsets[d],m_recv_maps[n]);
+  }
+  if (!m_self_recv_map.empty())
+  {
+    unsigned char* buf=&m_recv_buffer[m_self_recv_start*item_size];
+    for (int d=0; d<(const int)m_pending.size(); d++)
+      m_pending[d]->unpack(buf+m_self_recv_map.size()*m_pending_offsets[d],m_self_recv_map);
+  }
+  m_pending.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::setup_neighbours()
+{
+  const CPint irank=(CPint)PE::Comm::instance().rank();
+  const CPint nproc=(CPint)PE::Comm::instance().size();
+
+  m_send_neighbours.clear();
+  m_send_starts.clear();
+  m_send_sizes.clear();
+  m_send_maps.clear();
+  m_recv_neighbours.clear();
+  m_recv_starts.clear();
+  m_recv_sizes.clear();
+  m_recv_maps.clear();
+  m_self_send_map.clear();
+  m_self_recv_map.clear();
+  m_self_recv_start=0;
+
+  // m_sendMap and m_recvMap are ordered by rank, so the starts are running sums of the counts
+  // the maps are cut per neighbour here once, so that packing to a neighbour does not need to look at other ranks
+  CPint send_start=0;
+  CPint recv_start=0;
+  for (CPint i=0; i<nproc; i++)
+  {
+    if (i==irank)
+    {
+      cf3_assert(m_sendCount[i]==m_recvCount[i]);
+      m_self_send_map.assign(m_sendMap.begin()+send_start,m_sendMap.begin()+send_start+m_sendCount[i]);
+      m_self_recv_map.assign(m_recvMap.begin()+recv_start,m_recvMap.begin()+recv_start+m_recvCount[i]);
+      m_self_recv_start=recv_start;
+    }
+    else
+    {
+      if (m_sendCount[i]!=0)
+      {
+        m_send_neighbours.push_back(i);
+        m_send_starts.push_back(send_start);
+        m_send_sizes.push_back(m_sendCount[i]);
+        m_send_maps.push_back(std::vector<int>(m_sendMap.begin()+send_start,m_sendMap.begin()+send_start+m_sendCount[i]));
+      }
+      if (m_recvCount[i]!=0)
+      {
+        m_recv_neighbours.push_back(i);
+        m_recv_starts.push_back(recv_start);
+        m_recv_sizes.push_back(m_recvCount[i]);
+        m_recv_maps.push_back(std::vector<int>(m_recvMap.begin()+recv_start,m_recvMap.begin()+recv_start+m_recvCount[i]));
+      }
+    }
+    send_start+=m_sendCount[i];
+    recv_start+=m_recvCount[i];
+  }
+  m_requests.reserve(m_send_neighbours.size()+m_recv_neighbours.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void CommPattern::add_global(Uint gid, Uint rank)
 {
   // later a mechanism could be implemented when commpattern can give gids by calling a "reserve(int num)" beforehand, to optimize performance
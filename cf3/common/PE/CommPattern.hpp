@@ -229,6 +229,32 @@ public:
   /// @param name the name of the parallel object
   void synchronize( const CommWrapper& pobj );
 
+  /// start a non-blocking synchronization of the parallel object designated by its name
+  /// data is packed and the messages to the neighbours are posted, the ghost values are only valid after finish_synchronize
+  /// @param name the name of the parallel object
+  void start_synchronize( const std::string& name );
+
+  /// start a non-blocking synchronization of the parallel object designated by its commwrapper reference
+  /// the wrapped data must stay alive and must not be resized until finish_synchronize returns
+  /// @param pobj the parallel object
+  void start_synchronize( const CommWrapper& pobj );
+
+  /// synchronize several parallel objects at once
+  /// all objects needing update are packed together, so there is one message per neighbour instead of one per object
+  /// @param names the names of the parallel objects
+  void synchronize( const std::vector<std::string>& names );
+
+  /// start a non-blocking synchronization of several parallel objects, batched in one message per neighbour
+  /// @param names the names of the parallel objects
+  void start_synchronize( const std::vector<std::string>& names );
+
+  /// start a non-blocking synchronization of all the registered parallel objects, batched in one message per neighbour
+  void start_synchronize_all();
+
+  /// wait for the exchange posted by start_synchronize and unpack the received ghost values
+  /// does nothing if no exchange is pending
+  void finish_synchronize();
+
   /// add element to the commpattern
   /// when all changes done, all needs to be committed by calling setup
   /// if global id is not on current rank, then a ghost is automatically created on current rank
@@ -281,6 +307,16 @@ public:
   /// @return vector of bools
   std::vector<bool>& isUpdatable() { return m_isUpdatable; }
 
+  /// accessor to check if a non-blocking synchronization is in flight
+  /// @return true if start_synchronize was called without matching finish_synchronize
+  bool is_synchronizing() const { return !m_pending.empty(); }
+
+  /// accessor to the ranks this process sends ghost updates to (excluding itself)
+  const std::vector<CPint>& send_neighbours() const { return m_send_neighbours; }
+
+  /// accessor to the ranks this process receives ghost updates from (excluding itself)
+  const std::vector<CPint>& recv_neighbours() const { return m_recv_neighbours; }
+
   //@} END ACCESSORS
 
 protected: // helper function
@@ -292,6 +328,14 @@ protected: // helper function
   /// @param rcvbuf vector for intermediate buffer for recieve
   void synchronize_this( const CommWrapper& pobj, std::vector<unsigned char>& sndbuf, std::vector<unsigned char>& rcvbuf );
 
+  /// derive the neighbour lists and the per-neighbour offsets from m_sendCount and m_recvCount
+  /// called at the end of setup, so the exchange itself does not need to look at all the ranks
+  void setup_neighbours();
+
+  /// pack the group of parallel objects and post the messages to the neighbours
+  /// @param group the parallel objects to synchronize, the ones not needing update are skipped
+  void start_synchronize_group( const std::vector<const CommWrapper*>& group );
+
 private:
 
   /// @name PROPERTIES
@@ -303,6 +347,9 @@ private:
   /// flag telling if pattern are set not to be allowed to change
   bool m_isFreeze;
 
+  /// flag telling if synchronization goes through point-to-point messages to the neighbours only, instead of all_to_all over all the ranks
+  bool m_neighbour_exchange;
+
   //@} END PROPERTIES
 
   /// @name BUFFERS HOLDING TEMPORARY DATA, TILL SETUP IS CALLED
@@ -343,6 +390,57 @@ private:
   /// this is the map of receiveing communication pattern
   std::vector< CPint > m_recvMap;
 
+  /// @name NEIGHBOUR EXCHANGE, BUILT AT SETUP
+  //@{
+
+  /// ranks having nonzero m_sendCount, excluding current rank
+  std::vector< CPint > m_send_neighbours;
+
+  /// start of the items of each send neighbour in m_sendMap
+  std::vector< CPint > m_send_starts;
+
+  /// number of items sent to each send neighbour
+  std::vector< CPint > m_send_sizes;
+
+  /// part of m_sendMap belonging to each send neighbour
+  std::vector< std::vector<int> > m_send_maps;
+
+  /// ranks having nonzero m_recvCount, excluding current rank
+  std::vector< CPint > m_recv_neighbours;
+
+  /// start of the items of each receive neighbour in m_recvMap
+  std::vector< CPint > m_recv_starts;
+
+  /// number of items received from each receive neighbour
+  std::vector< CPint > m_recv_sizes;
+
+  /// part of m_recvMap belonging to each receive neighbour
+  std::vector< std::vector<int> > m_recv_maps;
+
+  /// part of m_sendMap and m_recvMap the current rank sends to itself
+  std::vector<int> m_self_send_map;
+  std::vector<int> m_self_recv_map;
+
+  /// start of the items the current rank sends to itself in m_recvMap
+  CPint m_self_recv_start;
+
+  /// send buffer, kept alive between synchronizations to avoid reallocation
+  std::vector<unsigned char> m_send_buffer;
+
+  /// receive buffer, kept alive between synchronizations to avoid reallocation
+  std::vector<unsigned char> m_recv_buffer;
+
+  /// requests of the messages posted by start_synchronize
+  std::vector<MPI_Request> m_requests;
+
+  /// commwrappers waiting to be unpacked by finish_synchronize
+  std::vector<const CommWrapper*> m_pending;
+
+  /// byte offset of each pending commwrapper inside one packed item, the last entry is the size of the packed item
+  std::vector<int> m_pending_offsets;
+
+  //@} END NEIGHBOUR EXCHANGE
+
 }; // CommPattern
 
 ////////////////////////////////////////////////////////////////////////////////////////////
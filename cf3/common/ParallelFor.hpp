@@ -0,0 +1,55 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_ParallelFor_hpp
+#define cf3_common_ParallelFor_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common/CF.hpp"
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Split the range [0,size) in contiguous chunks and call range_function(begin,end) for each chunk,
+/// every chunk in its own thread. At most nb_threads threads are used, and each gets at least
+/// min_size_per_thread items, since starting a thread for less work costs more than the work itself.
+/// The calling thread handles the first chunk. When less than 2 threads would be used, the whole range
+/// is handled by the calling thread.
+/// @pre range_function must be safe to call concurrently on disjoint ranges
+template <typename RangeFunctionT>
+void parallel_for(const Uint size, const Uint nb_threads, const Uint min_size_per_thread, const RangeFunctionT& range_function)
+{
+  const Uint nb_used_threads = std::min(nb_threads, size / std::max(min_size_per_thread, Uint(1)));
+  if(nb_used_threads < 2)
+  {
+    range_function(Uint(0), size);
+    return;
+  }
+
+  boost::thread_group threads;
+  const Uint chunk_size = (size + nb_used_threads - 1) / nb_used_threads;
+  for(Uint begin = chunk_size; begin < size; begin += chunk_size)
+    threads.create_thread(boost::bind<void>(range_function, begin, std::min(begin + chunk_size, size)));
+  range_function(Uint(0), chunk_size);
+  threads.join_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_ParallelFor_hpp
@@ -0,0 +1,602 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <fstream>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/bind.hpp>
+
+#include "common/Assertions.hpp"
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/ParallelFor.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+#include "math/LSS/BlockCrs/BlockCrsMatrix.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file BlockCrsMatrix.cpp implementation of LSS::BlockCrsMatrix
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < LSS::BlockCrsMatrix, LSS::Matrix, LSS::LibLSS > BlockCrsMatrix_Builder;
+
+static const Uint min_rows_per_thread=512;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+BlockCrsMatrix::BlockCrsMatrix(const std::string& name) :
+  LSS::Matrix(name),
+  m_is_created(false),
+  m_neq(0),
+  m_blockrow_size(0),
+  m_blockcol_size(0),
+  m_nb_threads(1)
+{
+  properties().add("vector_type", std::string("cf3.math.LSS.BlockCrsVector"));
+
+  options().add("nb_threads", m_nb_threads)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used for the matrix-vector product")
+    .link_to(&m_nb_threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+BlockCrsMatrix::~BlockCrsMatrix()
+{
+  destroy();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs)
+{
+  // if already created
+  if (m_is_created) destroy();
+
+  m_neq=neq;
+  m_is_updatable=cp.isUpdatable();
+  m_blockcol_size=m_is_updatable.size();
+  m_blockrow_size=std::count(m_is_updatable.begin(),m_is_updatable.end(),true);
+  cf3_assert(starting_indices.size()==m_blockcol_size+1);
+
+  // sorted columns per row, making sure the diagonal block of the updatable rows exists
+  m_row_starts.assign(m_blockcol_size+1,0);
+  m_diagonal.assign(m_blockcol_size,-1);
+  m_cols.clear();
+  m_cols.reserve(node_connectivity.size()+m_blockrow_size);
+  m_interior_rows.clear();
+  m_boundary_rows.clear();
+  for (Uint i=0; i<m_blockcol_size; i++)
+  {
+    const Uint row_begin=m_cols.size();
+    m_cols.insert(m_cols.end(),node_connectivity.begin()+starting_indices[i],node_connectivity.begin()+starting_indices[i+1]);
+    if (m_is_updatable[i]) m_cols.push_back(i);
+    std::sort(m_cols.begin()+row_begin,m_cols.end());
+    m_cols.erase(std::unique(m_cols.begin()+row_begin,m_cols.end()),m_cols.end());
+    m_row_starts[i+1]=m_cols.size();
+
+    if (!m_is_updatable[i]) continue;
+    m_diagonal[i]=find_block(i,i);
+    bool interior=true;
+    for (Uint j=row_begin; j<m_cols.size(); j++)
+      if (!m_is_updatable[m_cols[j]]) { interior=false; break; }
+    if (interior) m_interior_rows.push_back(i);
+    else m_boundary_rows.push_back(i);
+  }
+  m_values.assign(m_cols.size()*m_neq*m_neq,0.);
+
+  // register the buffer for the ghost exchange
+  m_halo.assign(m_blockcol_size*m_neq,0.);
+  m_comm_pattern=cp.handle<common::PE::CommPattern>();
+  m_halo_name="halo"+boost::algorithm::replace_all_copy(uri().path(),"/","_");
+  if (is_not_null(cp.get_child(m_halo_name))) cp.clear(m_halo_name);
+  cp.insert(m_halo_name,m_halo,m_neq,true);
+
+  m_is_created=true;
+  CFdebug << "Created a " << m_blockrow_size*m_neq << " x " << m_blockcol_size*m_neq << " block-CRS matrix with " << m_cols.size() << " blocks of size " << m_neq << "x" << m_neq << "." << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::create_blocked(cf3::common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs)
+{
+  create(cp,vars.size(),node_connectivity,starting_indices,solution,rhs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::destroy()
+{
+  if (is_not_null(m_comm_pattern) && is_not_null(m_comm_pattern->get_child(m_halo_name)))
+    m_comm_pattern->clear(m_halo_name);
+  m_comm_pattern=Handle<common::PE::CommPattern>();
+  std::vector<bool>().swap(m_is_updatable);
+  std::vector<Uint>().swap(m_row_starts);
+  std::vector<Uint>().swap(m_cols);
+  std::vector<int>().swap(m_diagonal);
+  std::vector<Real>().swap(m_values);
+  std::vector<Uint>().swap(m_interior_rows);
+  std::vector<Uint>().swap(m_boundary_rows);
+  std::vector<Real>().swap(m_halo);
+  m_neq=0;
+  m_blockrow_size=0;
+  m_blockcol_size=0;
+  m_is_created=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+int BlockCrsMatrix::find_block(const Uint row, const Uint col) const
+{
+  const std::vector<Uint>::const_iterator begin=m_cols.begin()+m_row_starts[row];
+  const std::vector<Uint>::const_iterator end=m_cols.begin()+m_row_starts[row+1];
+  const std::vector<Uint>::const_iterator it=std::lower_bound(begin,end,col);
+  return (it!=end && *it==col) ? (int)(it-m_cols.begin()) : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::set_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  const Uint rowblock=irow/m_neq;
+  const int pos=m_is_updatable[rowblock] ? find_block(rowblock,icol/m_neq) : -1;
+  if (pos<0) throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  m_values[(pos*m_neq+irow%m_neq)*m_neq+icol%m_neq]=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::add_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  const Uint rowblock=irow/m_neq;
+  const int pos=m_is_updatable[rowblock] ? find_block(rowblock,icol/m_neq) : -1;
+  if (pos<0) throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  m_values[(pos*m_neq+irow%m_neq)*m_neq+icol%m_neq]+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::get_value(const Uint icol, const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  const Uint rowblock=irow/m_neq;
+  const int pos=m_is_updatable[rowblock] ? find_block(rowblock,icol/m_neq) : -1;
+  if (pos<0) throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  value=m_values[(pos*m_neq+irow%m_neq)*m_neq+icol%m_neq];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::set_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  const Uint neqneq=m_neq*m_neq;
+  for (Uint irow=0; irow<numblocks; irow++)
+  {
+    const Uint row=values.indices[irow];
+    if (!m_is_updatable[row]) continue;
+    for (Uint icol=0; icol<numblocks; icol++)
+    {
+      const int pos=find_block(row,values.indices[icol]);
+      if (pos<0) continue;
+      Real* block=&m_values[pos*neqneq];
+      for (Uint i=0; i<m_neq; i++)
+        for (Uint j=0; j<m_neq; j++)
+          *block++=values.mat(irow*m_neq+i,icol*m_neq+j);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  const Uint neqneq=m_neq*m_neq;
+  for (Uint irow=0; irow<numblocks; irow++)
+  {
+    const Uint row=values.indices[irow];
+    if (!m_is_updatable[row]) continue;
+    for (Uint icol=0; icol<numblocks; icol++)
+    {
+      const int pos=find_block(row,values.indices[icol]);
+      if (pos<0) continue;
+      Real* block=&m_values[pos*neqneq];
+      for (Uint i=0; i<m_neq; i++)
+        for (Uint j=0; j<m_neq; j++)
+          *block++ += values.mat(irow*m_neq+i,icol*m_neq+j);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::get_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  const Uint neqneq=m_neq*m_neq;
+  values.mat.setConstant(0.);
+  for (Uint irow=0; irow<numblocks; irow++)
+  {
+    const Uint row=values.indices[irow];
+    if (!m_is_updatable[row]) continue;
+    for (Uint icol=0; icol<numblocks; icol++)
+    {
+      const int pos=find_block(row,values.indices[icol]);
+      if (pos<0) continue;
+      const Real* block=&m_values[pos*neqneq];
+      for (Uint i=0; i<m_neq; i++)
+        for (Uint j=0; j<m_neq; j++)
+          values.mat(irow*m_neq+i,icol*m_neq+j)=*block++;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval)
+{
+  cf3_assert(m_is_created);
+  if (!m_is_updatable[iblockrow]) return;
+  const Uint neqneq=m_neq*m_neq;
+  for (Uint i=m_row_starts[iblockrow]; i<m_row_starts[iblockrow+1]; i++)
+  {
+    Real* row=&m_values[i*neqneq+ieq*m_neq];
+    for (Uint j=0; j<m_neq; j++)
+      row[j]=offdiagval;
+  }
+  m_values[m_diagonal[iblockrow]*neqneq+ieq*m_neq+ieq]=diagval;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values)
+{
+  cf3_assert(m_is_created);
+  values.assign(m_blockcol_size*m_neq,0.);
+  const Uint neqneq=m_neq*m_neq;
+  for (Uint k=0; k<m_blockcol_size; k++)
+  {
+    if (!m_is_updatable[k]) continue;
+    const int pos=find_block(k,iblockcol);
+    if (pos<0) continue;
+    Real* block=&m_values[pos*neqneq];
+    for (Uint j=0; j<m_neq; j++)
+    {
+      values[k*m_neq+j]=block[j*m_neq+ieq];
+      block[j*m_neq+ieq]=0.;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs)
+{
+  cf3_assert(m_is_created);
+  const Uint neqneq=m_neq*m_neq;
+  for (Uint i=m_row_starts[blockrow]; i<m_row_starts[blockrow+1]; i++)
+  {
+    const Uint other_row=m_cols[i];
+    if (!m_is_updatable[other_row]) continue;
+    const int pos=find_block(other_row,blockrow);
+    if (pos<0) continue;
+
+    Real* block=&m_values[pos*neqneq];
+    for (Uint j=0; j<m_neq; j++)
+    {
+      rhs.add_value(other_row,j,-block[j*m_neq+ieq]*value);
+      block[j*m_neq+ieq]=0.;
+    }
+
+    if (other_row==blockrow)
+    {
+      for (Uint k=m_row_starts[blockrow]; k<m_row_starts[blockrow+1]; k++)
+        for (Uint j=0; j<m_neq; j++)
+          m_values[k*neqneq+ieq*m_neq+j]=0.;
+      m_values[m_diagonal[blockrow]*neqneq+ieq*m_neq+ieq]=1.;
+    }
+  }
+
+  rhs.set_value(blockrow,ieq,value);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(m_is_updatable[iblockrow_to]==m_is_updatable[iblockrow_from]);
+  if (!m_is_updatable[iblockrow_to] || !m_is_updatable[iblockrow_from]) return;
+
+  const Uint to_begin=m_row_starts[iblockrow_to];
+  const Uint from_begin=m_row_starts[iblockrow_from];
+  const Uint nb_blocks=m_row_starts[iblockrow_to+1]-to_begin;
+  if (nb_blocks!=m_row_starts[iblockrow_from+1]-from_begin) throw common::BadValue(FromHere(),"Number of blocks do not match for the two block rows to be tied together.");
+  if (!std::equal(m_cols.begin()+to_begin,m_cols.begin()+to_begin+nb_blocks,m_cols.begin()+from_begin)) throw common::BadValue(FromHere(),"Indices of the blocks do not match for the two block rows to be tied together.");
+  const int from_pair_pos=find_block(iblockrow_from,iblockrow_to);
+  const int to_pair_pos=find_block(iblockrow_to,iblockrow_from);
+  if (from_pair_pos<0 || to_pair_pos<0) throw common::BadValue(FromHere(),"The two block rows to be tied together are not connected to each other.");
+
+  const Uint neqneq=m_neq*m_neq;
+  Real* to_vals=&m_values[to_begin*neqneq];
+  Real* from_vals=&m_values[from_begin*neqneq];
+  for (Uint i=0; i<nb_blocks*neqneq; i++)
+  {
+    to_vals[i]+=from_vals[i];
+    from_vals[i]=0.;
+  }
+
+  Real* from_diag=&m_values[m_diagonal[iblockrow_from]*neqneq];
+  Real* from_pair=&m_values[from_pair_pos*neqneq];
+  Real* to_diag=&m_values[m_diagonal[iblockrow_to]*neqneq];
+  Real* to_pair=&m_values[to_pair_pos*neqneq];
+  for (Uint i=0; i<m_neq; i++)
+  {
+    from_diag[i*m_neq+i]=1.;
+    from_pair[i*m_neq+i]=-1.;
+  }
+  for (Uint i=0; i<neqneq; i++)
+  {
+    to_diag[i]+=to_pair[i];
+    to_pair[i]=0.;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::set_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size()==m_blockcol_size*m_neq);
+  for (Uint i=0; i<m_blockcol_size; i++)
+    if (m_is_updatable[i])
+    {
+      Real* block=&m_values[m_diagonal[i]*m_neq*m_neq];
+      for (Uint j=0; j<m_neq; j++)
+        block[j*m_neq+j]=diag[i*m_neq+j];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::add_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size()==m_blockcol_size*m_neq);
+  for (Uint i=0; i<m_blockcol_size; i++)
+    if (m_is_updatable[i])
+    {
+      Real* block=&m_values[m_diagonal[i]*m_neq*m_neq];
+      for (Uint j=0; j<m_neq; j++)
+        block[j*m_neq+j]+=diag[i*m_neq+j];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::get_diagonal(std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  diag.assign(m_blockcol_size*m_neq,0.);
+  for (Uint i=0; i<m_blockcol_size; i++)
+    if (m_is_updatable[i])
+    {
+      const Real* block=&m_values[m_diagonal[i]*m_neq*m_neq];
+      for (Uint j=0; j<m_neq; j++)
+        diag[i*m_neq+j]=block[j*m_neq+j];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+  std::fill(m_values.begin(),m_values.end(),reset_to);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::print(common::LogStream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i<m_blockcol_size; i++)
+      if (m_is_updatable[i])
+        for (Uint j=0; j<m_neq; j++)
+          for (Uint k=m_row_starts[i]; k<m_row_starts[i+1]; k++)
+            for (Uint l=0; l<m_neq; l++)
+              stream << m_cols[k]*m_neq+l << " " << -(int)(i*m_neq+j) << " " << m_values[(k*m_neq+j)*m_neq+l] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of cols:       " << m_blockcol_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n";
+    stream << "# number of block cols: " << m_blockcol_size << "\n";
+    stream << "# number of entries:    " << m_values.size() << "\n";
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::print(std::ostream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i<m_blockcol_size; i++)
+      if (m_is_updatable[i])
+        for (Uint j=0; j<m_neq; j++)
+          for (Uint k=m_row_starts[i]; k<m_row_starts[i+1]; k++)
+            for (Uint l=0; l<m_neq; l++)
+              stream << m_cols[k]*m_neq+l << " " << -(int)(i*m_neq+j) << " " << m_values[(k*m_neq+j)*m_neq+l] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of cols:       " << m_blockcol_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n";
+    stream << "# number of block cols: " << m_blockcol_size << "\n";
+    stream << "# number of entries:    " << m_values.size() << "\n" << std::flush;
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::print(const std::string& filename, std::ios_base::openmode mode)
+{
+  std::ofstream stream(filename.c_str(),mode);
+  stream << "VARIABLES=COL,ROW,VAL\n" << std::flush;
+  stream << "ZONE T=\"" << type_name() << "::" << name() <<  "\"\n" << std::flush;
+  print(stream);
+  stream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::print_native(std::ostream& stream)
+{
+  print(stream);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values)
+{
+  cf3_assert(m_is_created);
+  row_indices.clear();
+  col_indices.clear();
+  values.clear();
+  for (Uint i=0; i<m_blockcol_size; i++)
+    if (m_is_updatable[i])
+      for (Uint j=0; j<m_neq; j++)
+        for (Uint k=m_row_starts[i]; k<m_row_starts[i+1]; k++)
+          for (Uint l=0; l<m_neq; l++)
+          {
+            row_indices.push_back(i*m_neq+j);
+            col_indices.push_back(m_cols[k]*m_neq+l);
+            values.push_back(m_values[(k*m_neq+j)*m_neq+l]);
+          }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::apply(const std::vector<Real>& x, std::vector<Real>& y)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(x.size()==m_blockcol_size*m_neq);
+  cf3_assert(&x!=&y);
+  y.resize(m_blockcol_size*m_neq);
+  for (Uint i=0; i<m_blockcol_size; i++)
+    if (!m_is_updatable[i])
+      std::fill(y.begin()+i*m_neq,y.begin()+(i+1)*m_neq,0.);
+
+  const bool exchange=common::PE::Comm::instance().is_active() && common::PE::Comm::instance().size()>1;
+  if (!exchange)
+  {
+    multiply_rows(m_interior_rows,x,y);
+    multiply_rows(m_boundary_rows,x,y);
+    return;
+  }
+
+  // the interior rows don't need the ghosts, so they are computed while the exchange is in flight
+  std::copy(x.begin(),x.end(),m_halo.begin());
+  m_comm_pattern->start_synchronize(m_halo_name);
+  multiply_rows(m_interior_rows,x,y);
+  m_comm_pattern->finish_synchronize();
+  multiply_rows(m_boundary_rows,m_halo,y);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::synchronize(std::vector<Real>& x)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(x.size()==m_blockcol_size*m_neq);
+  if (!common::PE::Comm::instance().is_active() || common::PE::Comm::instance().size()<2) return;
+  std::copy(x.begin(),x.end(),m_halo.begin());
+  m_comm_pattern->synchronize(m_halo_name);
+  std::copy(m_halo.begin(),m_halo.end(),x.begin());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real BlockCrsMatrix::dot(const std::vector<Real>& a, const std::vector<Real>& b)
+{
+  cf3_assert(m_is_created);
+  Real local_result=0.;
+  for (Uint i=0; i<m_blockcol_size; i++)
+    if (m_is_updatable[i])
+      for (Uint j=i*m_neq; j<(i+1)*m_neq; j++)
+        local_result+=a[j]*b[j];
+
+  if (!common::PE::Comm::instance().is_active() || common::PE::Comm::instance().size()<2)
+    return local_result;
+
+  Real result=0.;
+  common::PE::Comm::instance().all_reduce(common::PE::plus(),&local_result,1,&result);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::multiply_rows(const std::vector<Uint>& rows, const std::vector<Real>& x, std::vector<Real>& y)
+{
+  common::parallel_for(rows.size(),m_nb_threads,min_rows_per_thread,
+                       boost::bind(&BlockCrsMatrix::multiply_range,this,boost::cref(rows),_1,_2,boost::cref(x),boost::ref(y)));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsMatrix::multiply_range(const std::vector<Uint>& rows, const Uint begin, const Uint end, const std::vector<Real>& x, std::vector<Real>& y) const
+{
+  const Uint neqneq=m_neq*m_neq;
+  for (Uint r=begin; r!=end; ++r)
+  {
+    const Uint row=rows[r];
+    Real* y_row=&y[row*m_neq];
+    std::fill(y_row,y_row+m_neq,0.);
+    for (Uint k=m_row_starts[row]; k!=m_row_starts[row+1]; ++k)
+    {
+      const Real* block=&m_values[k*neqneq];
+      const Real* x_col=&x[m_cols[k]*m_neq];
+      for (Uint i=0; i<m_neq; i++)
+        for (Uint j=0; j<m_neq; j++)
+          y_row[i]+=*block++*x_col[j];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,259 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_BlockCrsMatrix_hpp
+#define cf3_Math_LSS_BlockCrsMatrix_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "math/LSS/LibLSS.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/Vector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file BlockCrsMatrix.hpp definition of LSS::BlockCrsMatrix
+
+  Matrix of the native block-CRS linear solver backend, usable without Trilinos.
+  Each block row holds the sorted block column indices of the node connectivity, in process-local numbering,
+  and the neq x neq blocks are stored contiguously in row-major order.
+  Only the rows of updatable nodes are assembled, ghost rows keep their structure but remain zero.
+  The matrix-vector product is split over threads, and the ghost values are exchanged through the
+  CommPattern while the rows that only reference local nodes are computed.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API BlockCrsMatrix : public LSS::Matrix {
+public:
+
+  /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
+  //@{
+
+  /// name of the type
+  static std::string type_name () { return "BlockCrsMatrix"; }
+
+  /// Accessor to solver type
+  const std::string solvertype() { return "BlockCrs"; }
+
+  /// Accessor to the flag if matrix, solution and rhs are tied together or not
+  const bool is_swappable(const LSS::Vector& solution, const LSS::Vector& rhs) { return true; }
+
+  /// Default constructor
+  BlockCrsMatrix(const std::string& name);
+
+  /// Destructor, unregisters the ghost exchange buffer from the CommPattern
+  ~BlockCrsMatrix();
+
+  /// Setup sparsity structure
+  void create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs);
+
+  /// The blocks are always stored per node, so this only takes the total number of variables
+  void create_blocked(cf3::common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs);
+
+  /// Deallocate underlying data
+  void destroy();
+
+  //@} END CREATION, DESTRUCTION AND COMPONENT SYSTEM
+
+  /// @name INDIVIDUAL ACCESS
+  //@{
+
+  /// Set value at given location in the matrix
+  void set_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Add value at given location in the matrix
+  void add_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Get value at given location in the matrix
+  void get_value(const Uint icol, const Uint irow, Real& value);
+
+  //@} END INDIVIDUAL ACCESS
+
+  /// @name EFFICCIENT ACCESS
+  //@{
+
+  /// Set a list of values
+  void set_values(const BlockAccumulator& values);
+
+  /// Add a list of values
+  void add_values(const BlockAccumulator& values);
+
+  /// Add a list of values
+  void get_values(BlockAccumulator& values);
+
+  /// Set a row, diagonal and off-diagonals values separately (dirichlet-type boundaries)
+  void set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval);
+
+  /// Get a column and replace it to zero (dirichlet-type boundaries, when trying to preserve symmetry)
+  /// Note that sparsity info is lost, values will contain zeros where no matrix entry is present
+  void get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values);
+
+  /// Apply a dirichlet boundary condition, preserving symmetry by moving entries to the RHS
+  void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs);
+
+  /// Add one line to another and tie to it via dirichlet-style (applying periodicity)
+  void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from);
+
+  /// Set the diagonal
+  void set_diagonal(const std::vector<Real>& diag);
+
+  /// Add to the diagonal
+  void add_diagonal(const std::vector<Real>& diag);
+
+  /// Get the diagonal
+  void get_diagonal(std::vector<Real>& diag);
+
+  /// Reset Matrix
+  void reset(Real reset_to=0.);
+
+  //@} END EFFICCIENT ACCESS
+
+  /// @name MISCELLANEOUS
+  //@{
+
+  /// Print to wherever
+  void print(common::LogStream& stream);
+
+  /// Print to wherever
+  void print(std::ostream& stream);
+
+  /// Print to file given by filename
+  void print(const std::string& filename, std::ios_base::openmode mode = std::ios_base::out );
+
+  /// The native representation is the same as print
+  void print_native(std::ostream& stream);
+
+  /// Accessor to the state of create
+  const bool is_created() { return m_is_created; }
+
+  /// Accessor to the number of equations
+  const Uint neq() { cf3_assert(m_is_created); return m_neq; }
+
+  /// Accessor to the number of block rows
+  const Uint blockrow_size() { cf3_assert(m_is_created); return m_blockrow_size; }
+
+  /// Accessor to the number of block columns
+  const Uint blockcol_size() { cf3_assert(m_is_created); return m_blockcol_size; }
+
+  //@} END MISCELLANEOUS
+
+  /// @name TEST ONLY
+  //@{
+
+  /// exports the matrix into big linear arrays
+  /// @attention only for debug and utest purposes
+  void debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values);
+
+  //@} END TEST ONLY
+
+  /// @name NATIVE SOLVER ACCESS
+  //@{
+
+  /// Compute y = A x for the updatable rows, the ghost rows of y are set to zero.
+  /// The ghost values of x do not need to be up to date, they are exchanged internally.
+  virtual void apply(const std::vector<Real>& x, std::vector<Real>& y);
+
+  /// Called by the solution strategy before solving, to complete any deferred modification of the RHS
+  virtual void prepare_solve() {}
+
+  /// Update the ghost values of a vector stored in process-local numbering
+  void synchronize(std::vector<Real>& x);
+
+  /// Dot product over the updatable rows of all processes
+  Real dot(const std::vector<Real>& a, const std::vector<Real>& b);
+
+  /// For each block row, the start of its blocks in cols(), with blockcol_size()+1 entries
+  const std::vector<Uint>& row_starts() const { return m_row_starts; }
+
+  /// Sorted block column index of each block
+  const std::vector<Uint>& cols() const { return m_cols; }
+
+  /// Position of the diagonal block of each row, or -1 for ghost rows
+  const std::vector<int>& diagonal_positions() const { return m_diagonal; }
+
+  /// Values of the blocks, neq*neq row-major values per block
+  const std::vector<Real>& values() const { return m_values; }
+
+  /// True if the given block row is owned by this process
+  bool is_updatable(const Uint iblockrow) const { return m_is_updatable[iblockrow]; }
+
+  //@} END NATIVE SOLVER ACCESS
+
+private:
+
+  /// position of block column col in the blocks of block row row, or -1 if there is no such block
+  int find_block(const Uint row, const Uint col) const;
+
+  /// Multiply the given rows, splitting them over the threads
+  void multiply_rows(const std::vector<Uint>& rows, const std::vector<Real>& x, std::vector<Real>& y);
+
+  /// Multiply the rows in [begin,end) of the given list
+  void multiply_range(const std::vector<Uint>& rows, const Uint begin, const Uint end, const std::vector<Real>& x, std::vector<Real>& y) const;
+
+  /// state of creation
+  bool m_is_created;
+
+  /// number of equations
+  Uint m_neq;
+
+  /// number of updatable block rows
+  Uint m_blockrow_size;
+
+  /// number of block columns, equal to the number of nodes of the CommPattern
+  Uint m_blockcol_size;
+
+  /// number of threads used for the matrix-vector product
+  Uint m_nb_threads;
+
+  /// flags the owned nodes
+  std::vector<bool> m_is_updatable;
+
+  /// block row starts in m_cols
+  std::vector<Uint> m_row_starts;
+
+  /// block column indices, sorted per row
+  std::vector<Uint> m_cols;
+
+  /// position of the diagonal block in each row
+  std::vector<int> m_diagonal;
+
+  /// block values
+  std::vector<Real> m_values;
+
+  /// updatable rows referencing only updatable nodes, computed while the ghosts are exchanged
+  std::vector<Uint> m_interior_rows;
+
+  /// updatable rows referencing at least one ghost node
+  std::vector<Uint> m_boundary_rows;
+
+  /// copy of the vector to multiply, including the exchanged ghost values
+  std::vector<Real> m_halo;
+
+  /// CommPattern used to exchange m_halo
+  Handle<common::PE::CommPattern> m_comm_pattern;
+
+  /// name under which m_halo is registered in the CommPattern
+  std::string m_halo_name;
+
+}; // end of class BlockCrsMatrix
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_BlockCrsMatrix_hpp
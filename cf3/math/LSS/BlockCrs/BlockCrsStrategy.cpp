@@ -0,0 +1,653 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include <boost/assign/std/vector.hpp>
+#include <boost/bind.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Timer.hpp"
+
+#include "math/MatrixTypes.hpp"
+
+#include "math/LSS/BlockCrs/BlockCrsMatrix.hpp"
+#include "math/LSS/BlockCrs/BlockCrsStrategy.hpp"
+#include "math/LSS/BlockCrs/BlockCrsVector.hpp"
+#include "math/LSS/PreconditionerReuse.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+using namespace boost::assign;
+
+common::ComponentBuilder<BlockCrsStrategy, SolutionStrategy, LibLSS> BlockCrsStrategy_builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+typedef Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BlockT;
+
+/// Store the inverse of the row-major neq x neq block
+inline void invert_block(const Real* block, const Uint neq, Real* inverse)
+{
+  Eigen::Map<BlockT>(inverse, neq, neq) = Eigen::Map<const BlockT>(block, neq, neq).fullPivLu().inverse();
+}
+
+/// y = block * x
+inline void block_product(const Real* block, const Real* x, const Uint neq, Real* y)
+{
+  for(Uint i = 0; i != neq; ++i)
+  {
+    y[i] = 0.;
+    for(Uint j = 0; j != neq; ++j)
+      y[i] += block[i*neq+j] * x[j];
+  }
+}
+
+/// y -= block * x
+inline void subtract_block_product(const Real* block, const Real* x, const Uint neq, Real* y)
+{
+  for(Uint i = 0; i != neq; ++i)
+    for(Uint j = 0; j != neq; ++j)
+      y[i] -= block[i*neq+j] * x[j];
+}
+
+/// Approximate inverse of the system matrix, applied at each iteration
+class Preconditioner
+{
+public:
+  virtual ~Preconditioner() {}
+
+  /// Compute the preconditioner from the current values of the matrix
+  virtual void setup(BlockCrsMatrix& matrix) = 0;
+
+  /// z = M^-1 r. The ghost entries of r are not used, those of z are set to zero.
+  virtual void apply(const std::vector<Real>& r, std::vector<Real>& z) const = 0;
+};
+
+class IdentityPreconditioner : public Preconditioner
+{
+public:
+  void setup(BlockCrsMatrix& matrix)
+  {
+  }
+
+  void apply(const std::vector<Real>& r, std::vector<Real>& z) const
+  {
+    z = r;
+  }
+};
+
+/// Divide by the diagonal of the matrix
+class JacobiPreconditioner : public Preconditioner
+{
+public:
+  void setup(BlockCrsMatrix& matrix)
+  {
+    std::vector<Real> diagonal;
+    matrix.get_diagonal(diagonal);
+    m_inverse_diagonal.resize(diagonal.size());
+    for(Uint i = 0; i != diagonal.size(); ++i)
+      m_inverse_diagonal[i] = diagonal[i] == 0. ? 1. : 1. / diagonal[i];
+  }
+
+  void apply(const std::vector<Real>& r, std::vector<Real>& z) const
+  {
+    const Uint size = r.size();
+    z.resize(size);
+    for(Uint i = 0; i != size; ++i)
+      z[i] = m_inverse_diagonal[i] * r[i];
+  }
+
+private:
+  std::vector<Real> m_inverse_diagonal;
+};
+
+/// Multiply with the inverse of the diagonal blocks, coupling the equations of each node
+class BlockJacobiPreconditioner : public Preconditioner
+{
+public:
+  void setup(BlockCrsMatrix& matrix)
+  {
+    m_neq = matrix.neq();
+    const Uint nb_nodes = matrix.blockcol_size();
+    const Uint neqneq = m_neq*m_neq;
+    m_inverse_blocks.assign(nb_nodes*neqneq, 0.);
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      if(matrix.is_updatable(i))
+        invert_block(&matrix.values()[matrix.diagonal_positions()[i]*neqneq], m_neq, &m_inverse_blocks[i*neqneq]);
+    }
+  }
+
+  void apply(const std::vector<Real>& r, std::vector<Real>& z) const
+  {
+    const Uint nb_nodes = r.size() / m_neq;
+    z.resize(r.size());
+    for(Uint i = 0; i != nb_nodes; ++i)
+      block_product(&m_inverse_blocks[i*m_neq*m_neq], &r[i*m_neq], m_neq, &z[i*m_neq]);
+  }
+
+private:
+  Uint m_neq;
+  std::vector<Real> m_inverse_blocks;
+};
+
+/// Block incomplete LU factorization without fill-in, restricted to the updatable nodes of this process
+class ILU0Preconditioner : public Preconditioner
+{
+public:
+  void setup(BlockCrsMatrix& matrix)
+  {
+    m_matrix = &matrix;
+    m_neq = matrix.neq();
+    const Uint nb_nodes = matrix.blockcol_size();
+    const Uint neqneq = m_neq*m_neq;
+    const std::vector<Uint>& row_starts = matrix.row_starts();
+    const std::vector<Uint>& cols = matrix.cols();
+
+    m_lu = matrix.values();
+    m_inverse_diagonal.assign(nb_nodes*neqneq, 0.);
+
+    // position of each column in the current row, or -1
+    std::vector<int> position(nb_nodes, -1);
+    std::vector<Real> l_block(neqneq);
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      if(!matrix.is_updatable(i))
+        continue;
+
+      for(Uint k = row_starts[i]; k != row_starts[i+1]; ++k)
+        position[cols[k]] = k;
+
+      // The columns are sorted, so each lower block is final when it is reached
+      for(Uint k = row_starts[i]; k != row_starts[i+1] && cols[k] < i; ++k)
+      {
+        const Uint c = cols[k];
+        if(!matrix.is_updatable(c))
+          continue;
+
+        // L_ic = A_ic U_cc^-1
+        Eigen::Map<BlockT> l(&m_lu[k*neqneq], m_neq, m_neq);
+        Eigen::Map<BlockT>(&l_block[0], m_neq, m_neq) = l * Eigen::Map<const BlockT>(&m_inverse_diagonal[c*neqneq], m_neq, m_neq);
+        l = Eigen::Map<const BlockT>(&l_block[0], m_neq, m_neq);
+
+        // A_ij -= L_ic U_cj for the upper blocks of row c that are also in row i
+        for(Uint q = row_starts[c]; q != row_starts[c+1]; ++q)
+        {
+          const Uint j = cols[q];
+          if(j <= c || position[j] < 0 || !matrix.is_updatable(j))
+            continue;
+          Eigen::Map<BlockT>(&m_lu[position[j]*neqneq], m_neq, m_neq) -= l * Eigen::Map<const BlockT>(&m_lu[q*neqneq], m_neq, m_neq);
+        }
+      }
+
+      invert_block(&m_lu[matrix.diagonal_positions()[i]*neqneq], m_neq, &m_inverse_diagonal[i*neqneq]);
+
+      for(Uint k = row_starts[i]; k != row_starts[i+1]; ++k)
+        position[cols[k]] = -1;
+    }
+  }
+
+  void apply(const std::vector<Real>& r, std::vector<Real>& z) const
+  {
+    const BlockCrsMatrix& matrix = *m_matrix;
+    const Uint nb_nodes = r.size() / m_neq;
+    const Uint neqneq = m_neq*m_neq;
+    const std::vector<Uint>& row_starts = matrix.row_starts();
+    const std::vector<Uint>& cols = matrix.cols();
+    z.assign(r.size(), 0.);
+
+    // Forward substitution with the unit lower factor
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      if(!matrix.is_updatable(i))
+        continue;
+      Real* z_i = &z[i*m_neq];
+      std::copy(&r[i*m_neq], &r[i*m_neq] + m_neq, z_i);
+      for(Uint k = row_starts[i]; k != row_starts[i+1] && cols[k] < i; ++k)
+      {
+        if(matrix.is_updatable(cols[k]))
+          subtract_block_product(&m_lu[k*neqneq], &z[cols[k]*m_neq], m_neq, z_i);
+      }
+    }
+
+    // Backward substitution with the upper factor
+    std::vector<Real> rhs_i(m_neq);
+    for(Uint i = nb_nodes; i-- != 0;)
+    {
+      if(!matrix.is_updatable(i))
+        continue;
+      Real* z_i = &z[i*m_neq];
+      std::copy(z_i, z_i + m_neq, rhs_i.begin());
+      for(Uint k = row_starts[i]; k != row_starts[i+1]; ++k)
+      {
+        if(cols[k] > i && matrix.is_updatable(cols[k]))
+          subtract_block_product(&m_lu[k*neqneq], &z[cols[k]*m_neq], m_neq, &rhs_i[0]);
+      }
+      block_product(&m_inverse_diagonal[i*neqneq], &rhs_i[0], m_neq, z_i);
+    }
+  }
+
+private:
+  const BlockCrsMatrix* m_matrix;
+  Uint m_neq;
+  /// L and U factors, stored in the sparsity of the matrix. The diagonal of L is the identity.
+  std::vector<Real> m_lu;
+  /// Inverse of the diagonal blocks of U
+  std::vector<Real> m_inverse_diagonal;
+};
+
+/// y += a*x
+inline void axpy(const Real a, const std::vector<Real>& x, std::vector<Real>& y)
+{
+  const Uint size = x.size();
+  for(Uint i = 0; i != size; ++i)
+    y[i] += a*x[i];
+}
+
+} // detail
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+struct BlockCrsStrategy::Implementation
+{
+  Implementation(common::Component& self) :
+    m_self(self),
+    m_reuse(self, "Never")
+  {
+    m_self.options().add("solver", std::string("GMRES"))
+      .pretty_name("Solver")
+      .description("Krylov method. CG requires a symmetric positive definite system and preconditioner.")
+      .mark_basic()
+      .restricted_list() += std::string("CG"), std::string("BiCGStab");
+
+    m_self.options().add("preconditioner", std::string("ILU0"))
+      .pretty_name("Preconditioner")
+      .description("Preconditioner applied at each iteration")
+      .attach_trigger(boost::bind(&Implementation::reset_preconditioner, this))
+      .mark_basic()
+      .restricted_list() += std::string("None"), std::string("Jacobi"), std::string("BlockJacobi");
+
+    m_self.options().add("max_iterations", 1000u)
+      .pretty_name("Maximum Iterations")
+      .description("Maximum number of iterations")
+      .mark_basic();
+
+    m_self.options().add("tolerance", 1e-8)
+      .pretty_name("Tolerance")
+      .description("Convergence criterion on the residual norm, relative to the norm of the right hand side")
+      .mark_basic();
+
+    m_self.options().add("restart", 30u)
+      .pretty_name("Restart")
+      .description("Number of GMRES iterations before restarting");
+
+    m_self.options().add("verbosity_level", 1)
+      .pretty_name("Verbosity Level")
+      .description("Verbosity level for the solver")
+      .mark_basic();
+
+    m_self.options().add("compute_residual", false)
+      .pretty_name("Compute Residual")
+      .description("Indicate if the residual should be computed. This incurs an extra matrix application after each solve")
+      .mark_basic();
+
+    m_self.properties().add("iterations", 0u);
+    m_self.properties().add("relative_residual", 0.);
+  }
+
+  void solve()
+  {
+    if(is_null(m_matrix))
+      throw common::SetupError(FromHere(), "Null matrix for " + m_self.uri().path());
+
+    if(is_null(m_rhs))
+      throw common::SetupError(FromHere(), "Null RHS for " + m_self.uri().path());
+
+    if(is_null(m_solution))
+      throw common::SetupError(FromHere(), "Null solution vector for " + m_self.uri().path());
+
+    m_matrix->prepare_solve();
+
+    common::Timer timer;
+    const bool setup = is_null(m_preconditioner.get()) || m_reuse.needs_setup();
+    if(setup)
+      setup_preconditioner();
+    const Real setup_time = timer.elapsed();
+    timer.restart();
+
+    const std::vector<Real>& b = m_rhs->data();
+    std::vector<Real>& x = m_solution->data();
+    m_b_norm = norm(b);
+    m_iterations = 0;
+    m_relative_residual = 0.;
+    if(m_b_norm == 0.)
+    {
+      std::fill(x.begin(), x.end(), 0.);
+    }
+    else
+    {
+      const std::string solver = m_self.options().value<std::string>("solver");
+      if(solver == "CG")
+        cg(b, x);
+      else if(solver == "BiCGStab")
+        bicgstab(b, x);
+      else if(solver == "GMRES")
+        gmres(b, x);
+      else
+        throw common::BadValue(FromHere(), "Unknown solver " + solver + " for " + m_self.uri().path());
+
+      m_matrix->synchronize(x);
+    }
+
+    m_reuse.solve_done(setup, m_iterations, setup_time, timer.elapsed());
+    m_self.properties().set("iterations", m_iterations);
+    m_self.properties().set("relative_residual", m_relative_residual);
+
+    const Real tolerance = m_self.options().value<Real>("tolerance");
+    if(m_relative_residual > tolerance)
+      CFwarn << m_self.uri().path() << " did not converge after " << m_iterations << " iterations, relative residual is " << m_relative_residual << CFendl;
+    else if(m_self.options().value<int>("verbosity_level") > 0)
+      CFinfo << m_self.options().value<std::string>("solver") << " converged after " << m_iterations << " iterations, relative residual is " << m_relative_residual << CFendl;
+
+    if(m_self.options().value<bool>("compute_residual"))
+      CFinfo << "Solver residual: " << compute_residual() << CFendl;
+  }
+
+  void setup_preconditioner()
+  {
+    if(is_null(m_preconditioner.get()))
+    {
+      const std::string preconditioner = m_self.options().value<std::string>("preconditioner");
+      if(preconditioner == "None")
+        m_preconditioner.reset(new detail::IdentityPreconditioner());
+      else if(preconditioner == "Jacobi")
+        m_preconditioner.reset(new detail::JacobiPreconditioner());
+      else if(preconditioner == "BlockJacobi")
+        m_preconditioner.reset(new detail::BlockJacobiPreconditioner());
+      else if(preconditioner == "ILU0")
+        m_preconditioner.reset(new detail::ILU0Preconditioner());
+      else
+        throw common::BadValue(FromHere(), "Unknown preconditioner " + preconditioner + " for " + m_self.uri().path());
+    }
+    m_preconditioner->setup(*m_matrix);
+  }
+
+  /// Drop the preconditioner, so it is rebuilt at the next solve
+  void reset_preconditioner()
+  {
+    m_preconditioner.reset();
+  }
+
+  Real compute_residual()
+  {
+    const std::vector<Real>& b = m_rhs->data();
+    std::vector<Real> r(b.size());
+    m_matrix->apply(m_solution->data(), r);
+    for(Uint i = 0; i != r.size(); ++i)
+      r[i] = b[i] - r[i];
+    return norm(r);
+  }
+
+  Real norm(const std::vector<Real>& v)
+  {
+    return std::sqrt(m_matrix->dot(v, v));
+  }
+
+  /// r = b - A x, returns the relative norm of r
+  Real residual(const std::vector<Real>& b, const std::vector<Real>& x, std::vector<Real>& r)
+  {
+    m_matrix->apply(x, r);
+    for(Uint i = 0; i != r.size(); ++i)
+      r[i] = b[i] - r[i];
+    return norm(r) / m_b_norm;
+  }
+
+  void cg(const std::vector<Real>& b, std::vector<Real>& x)
+  {
+    const Uint size = b.size();
+    const Uint max_iterations = m_self.options().value<Uint>("max_iterations");
+    const Real tolerance = m_self.options().value<Real>("tolerance");
+    std::vector<Real> r(size), z(size), p(size), q(size);
+
+    m_relative_residual = residual(b, x, r);
+    if(m_relative_residual <= tolerance)
+      return;
+
+    m_preconditioner->apply(r, z);
+    p = z;
+    Real rz = m_matrix->dot(r, z);
+    while(m_iterations < max_iterations)
+    {
+      m_matrix->apply(p, q);
+      const Real alpha = rz / m_matrix->dot(p, q);
+      detail::axpy(alpha, p, x);
+      detail::axpy(-alpha, q, r);
+      ++m_iterations;
+
+      m_relative_residual = norm(r) / m_b_norm;
+      if(m_relative_residual <= tolerance)
+        break;
+
+      m_preconditioner->apply(r, z);
+      const Real new_rz = m_matrix->dot(r, z);
+      const Real beta = new_rz / rz;
+      rz = new_rz;
+      for(Uint i = 0; i != size; ++i)
+        p[i] = z[i] + beta*p[i];
+    }
+  }
+
+  /// Right-preconditioned BiCGStab
+  void bicgstab(const std::vector<Real>& b, std::vector<Real>& x)
+  {
+    const Uint size = b.size();
+    const Uint max_iterations = m_self.options().value<Uint>("max_iterations");
+    const Real tolerance = m_self.options().value<Real>("tolerance");
+    std::vector<Real> r(size), r0(size), p(size, 0.), v(size, 0.), p_hat(size), s_hat(size), t(size);
+
+    m_relative_residual = residual(b, x, r);
+    if(m_relative_residual <= tolerance)
+      return;
+
+    r0 = r;
+    Real rho = 1., alpha = 1., omega = 1.;
+    while(m_iterations < max_iterations)
+    {
+      const Real new_rho = m_matrix->dot(r0, r);
+      if(new_rho == 0.)
+        break;
+      const Real beta = (new_rho / rho) * (alpha / omega);
+      rho = new_rho;
+      for(Uint i = 0; i != size; ++i)
+        p[i] = r[i] + beta*(p[i] - omega*v[i]);
+
+      m_preconditioner->apply(p, p_hat);
+      m_matrix->apply(p_hat, v);
+      alpha = rho / m_matrix->dot(r0, v);
+      detail::axpy(alpha, p_hat, x);
+      detail::axpy(-alpha, v, r);
+      ++m_iterations;
+
+      m_relative_residual = norm(r) / m_b_norm;
+      if(m_relative_residual <= tolerance)
+        break;
+
+      m_preconditioner->apply(r, s_hat);
+      m_matrix->apply(s_hat, t);
+      omega = m_matrix->dot(t, r) / m_matrix->dot(t, t);
+      detail::axpy(omega, s_hat, x);
+      detail::axpy(-omega, t, r);
+
+      m_relative_residual = norm(r) / m_b_norm;
+      if(m_relative_residual <= tolerance || omega == 0.)
+        break;
+    }
+  }
+
+  /// Right-preconditioned restarted GMRES, with modified Gram-Schmidt and Givens rotations
+  void gmres(const std::vector<Real>& b, std::vector<Real>& x)
+  {
+    const Uint size = b.size();
+    const Uint max_iterations = m_self.options().value<Uint>("max_iterations");
+    const Real tolerance = m_self.options().value<Real>("tolerance");
+    const Uint restart = std::max(m_self.options().value<Uint>("restart"), 1u);
+
+    std::vector< std::vector<Real> > v(restart+1, std::vector<Real>(size));
+    std::vector< std::vector<Real> > z(restart, std::vector<Real>(size));
+    std::vector<Real> w(size);
+    // Hessenberg matrix, (restart+1) x restart, row-major
+    std::vector<Real> h((restart+1)*restart);
+    std::vector<Real> cs(restart), sn(restart), g(restart+1), y(restart);
+
+    while(m_iterations < max_iterations)
+    {
+      m_relative_residual = residual(b, x, v[0]);
+      if(m_relative_residual <= tolerance)
+        break;
+
+      const Real beta = m_relative_residual * m_b_norm;
+      for(Uint i = 0; i != size; ++i)
+        v[0][i] /= beta;
+      g.assign(restart+1, 0.);
+      g[0] = beta;
+
+      Uint k = 0;
+      bool breakdown = false;
+      while(k != restart && m_iterations < max_iterations)
+      {
+        m_preconditioner->apply(v[k], z[k]);
+        m_matrix->apply(z[k], w);
+        for(Uint j = 0; j <= k; ++j)
+        {
+          h[j*restart+k] = m_matrix->dot(w, v[j]);
+          detail::axpy(-h[j*restart+k], v[j], w);
+        }
+        const Real w_norm = norm(w);
+        h[(k+1)*restart+k] = w_norm;
+        breakdown = w_norm == 0.;
+        if(!breakdown)
+        {
+          for(Uint i = 0; i != size; ++i)
+            v[k+1][i] = w[i] / w_norm;
+        }
+
+        // Apply the previous rotations to the new column, and eliminate its subdiagonal entry
+        for(Uint j = 0; j != k; ++j)
+        {
+          const Real h_jk = h[j*restart+k];
+          h[j*restart+k] = cs[j]*h_jk + sn[j]*h[(j+1)*restart+k];
+          h[(j+1)*restart+k] = -sn[j]*h_jk + cs[j]*h[(j+1)*restart+k];
+        }
+        const Real h_kk = h[k*restart+k];
+        const Real h_k1k = h[(k+1)*restart+k];
+        const Real denominator = std::sqrt(h_kk*h_kk + h_k1k*h_k1k);
+        cs[k] = denominator == 0. ? 1. : h_kk / denominator;
+        sn[k] = denominator == 0. ? 0. : h_k1k / denominator;
+        h[k*restart+k] = cs[k]*h_kk + sn[k]*h_k1k;
+        h[(k+1)*restart+k] = 0.;
+        g[k+1] = -sn[k]*g[k];
+        g[k] = cs[k]*g[k];
+
+        ++k;
+        ++m_iterations;
+        m_relative_residual = std::abs(g[k]) / m_b_norm;
+        if(m_relative_residual <= tolerance || breakdown)
+          break;
+      }
+
+      // Solve the upper triangular system and update the solution
+      for(Uint i = k; i-- != 0;)
+      {
+        y[i] = g[i];
+        for(Uint j = i+1; j != k; ++j)
+          y[i] -= h[i*restart+j]*y[j];
+        y[i] /= h[i*restart+i];
+      }
+      for(Uint j = 0; j != k; ++j)
+        detail::axpy(y[j], z[j], x);
+
+      if(m_relative_residual <= tolerance || breakdown)
+        break;
+    }
+  }
+
+  common::Component& m_self;
+  Handle<BlockCrsMatrix> m_matrix;
+  Handle<BlockCrsVector> m_rhs;
+  Handle<BlockCrsVector> m_solution;
+  boost::scoped_ptr<detail::Preconditioner> m_preconditioner;
+  PreconditionerReuse m_reuse;
+
+  /// Norm of the RHS, residuals are relative to it
+  Real m_b_norm;
+  /// Iterations used by the last solve
+  Uint m_iterations;
+  /// Relative residual at the end of the last solve
+  Real m_relative_residual;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+BlockCrsStrategy::BlockCrsStrategy(const std::string& name) :
+  SolutionStrategy(name),
+  m_implementation(new Implementation(*this))
+{
+}
+
+BlockCrsStrategy::~BlockCrsStrategy()
+{
+}
+
+void BlockCrsStrategy::set_matrix(const Handle< Matrix >& matrix)
+{
+  m_implementation->m_matrix = Handle<BlockCrsMatrix>(matrix);
+  m_implementation->reset_preconditioner();
+  if(is_null(m_implementation->m_matrix))
+    throw common::SetupError(FromHere(), "BlockCrsStrategy requires a BlockCrsMatrix, got " + matrix->derived_type_name());
+}
+
+void BlockCrsStrategy::set_rhs(const Handle< Vector >& rhs)
+{
+  m_implementation->m_rhs = Handle<BlockCrsVector>(rhs);
+  if(is_null(m_implementation->m_rhs))
+    throw common::SetupError(FromHere(), "BlockCrsStrategy requires a BlockCrsVector, got " + rhs->derived_type_name());
+}
+
+void BlockCrsStrategy::set_solution(const Handle< Vector >& solution)
+{
+  m_implementation->m_solution = Handle<BlockCrsVector>(solution);
+  if(is_null(m_implementation->m_solution))
+    throw common::SetupError(FromHere(), "BlockCrsStrategy requires a BlockCrsVector, got " + solution->derived_type_name());
+}
+
+void BlockCrsStrategy::solve()
+{
+  m_implementation->solve();
+}
+
+Real BlockCrsStrategy::compute_residual()
+{
+  return m_implementation->compute_residual();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
@@ -0,0 +1,69 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_BlockCrsStrategy_hpp
+#define cf3_Math_LSS_BlockCrsStrategy_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/scoped_ptr.hpp>
+
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/LibLSS.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ *  @file BlockCrsStrategy.hpp Krylov solvers for the native block-CRS backend
+ *
+ *  Solves systems built from BlockCrsMatrix and BlockCrsVector with CG, BiCGStab or restarted GMRES,
+ *  preconditioned with Jacobi, block-Jacobi or block ILU(0). The ILU(0) factorization is local to each
+ *  process, coupling across processes is only seen by the Krylov method.
+ **/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class BlockCrsMatrix;
+class BlockCrsVector;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API BlockCrsStrategy : public SolutionStrategy
+{
+public:
+
+  /// Default constructor
+  BlockCrsStrategy(const std::string& name);
+
+  ~BlockCrsStrategy();
+
+  /// name of the type
+  static std::string type_name () { return "BlockCrsStrategy"; }
+
+  void set_matrix(const Handle<LSS::Matrix>& matrix);
+  void set_rhs(const Handle<LSS::Vector>& rhs);
+  void set_solution(const Handle<LSS::Vector>& solution);
+  void solve();
+  Real compute_residual();
+
+private:
+  /// Keep the solvers and preconditioners out of the header
+  struct Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
+
+}; // end of class BlockCrsStrategy
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_BlockCrsStrategy_hpp
@@ -0,0 +1,284 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+
+#include "common/Assertions.hpp"
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+#include "math/LSS/BlockCrs/BlockCrsVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file BlockCrsVector.cpp implementation of LSS::BlockCrsVector
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+common::ComponentBuilder < LSS::BlockCrsVector, LSS::Vector, LSS::LibLSS > BlockCrsVector_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+BlockCrsVector::BlockCrsVector(const std::string& name) :
+  LSS::Vector(name),
+  m_is_created(false),
+  m_neq(0),
+  m_blockrow_size(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::create(common::PE::CommPattern& cp, Uint neq)
+{
+  if (m_is_created) destroy();
+  m_neq=neq;
+  m_blockrow_size=cp.isUpdatable().size();
+  m_data.assign(m_blockrow_size*m_neq,0.);
+  m_is_created=true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars)
+{
+  create(cp,vars.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::destroy()
+{
+  std::vector<Real>().swap(m_data);
+  m_neq=0;
+  m_blockrow_size=0;
+  m_is_created=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::set_value(const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  m_data[irow]=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::add_value(const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  m_data[irow]+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::get_value(const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  value=m_data[irow];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::set_value(const Uint iblockrow, const Uint ieq, const Real value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  m_data[iblockrow*m_neq+ieq]=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::add_value(const Uint iblockrow, const Uint ieq, const Real value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  m_data[iblockrow*m_neq+ieq]+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::get_value(const Uint iblockrow, const Uint ieq, Real& value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  value=m_data[iblockrow*m_neq+ieq];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::set_rhs_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  for (Uint i=0; i<numblocks; i++)
+    for (Uint j=0; j<m_neq; j++)
+      m_data[values.indices[i]*m_neq+j]=values.rhs[i*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::add_rhs_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  for (Uint i=0; i<numblocks; i++)
+    for (Uint j=0; j<m_neq; j++)
+      m_data[values.indices[i]*m_neq+j]+=values.rhs[i*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::get_rhs_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  for (Uint i=0; i<numblocks; i++)
+    for (Uint j=0; j<m_neq; j++)
+      values.rhs[i*m_neq+j]=m_data[values.indices[i]*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::set_sol_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  for (Uint i=0; i<numblocks; i++)
+    for (Uint j=0; j<m_neq; j++)
+      m_data[values.indices[i]*m_neq+j]=values.sol[i*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::add_sol_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  for (Uint i=0; i<numblocks; i++)
+    for (Uint j=0; j<m_neq; j++)
+      m_data[values.indices[i]*m_neq+j]+=values.sol[i*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::get_sol_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  for (Uint i=0; i<numblocks; i++)
+    for (Uint j=0; j<m_neq; j++)
+      values.sol[i*m_neq+j]=m_data[values.indices[i]*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+  std::fill(m_data.begin(),m_data.end(),reset_to);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::get( boost::multi_array<Real, 2>& data)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(data.shape()[0]==m_blockrow_size);
+  cf3_assert(data.shape()[1]==m_neq);
+  for (Uint i=0; i<m_blockrow_size; i++)
+    for (Uint j=0; j<m_neq; j++)
+      data[i][j]=m_data[i*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::set( boost::multi_array<Real, 2>& data)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(data.shape()[0]==m_blockrow_size);
+  cf3_assert(data.shape()[1]==m_neq);
+  for (Uint i=0; i<m_blockrow_size; i++)
+    for (Uint j=0; j<m_neq; j++)
+      m_data[i*m_neq+j]=data[i][j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::print(common::LogStream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i<m_blockrow_size*m_neq; i++)
+      stream << 0 << " " << -(int)i << " " << m_data[i] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n";
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::print(std::ostream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i<m_blockrow_size*m_neq; i++)
+      stream << 0 << " " << -(int)i << " " << m_data[i] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n" << std::flush;
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::print(const std::string& filename, std::ios_base::openmode mode)
+{
+  std::ofstream stream(filename.c_str(),mode);
+  stream << "VARIABLES=COL,ROW,VAL\n" << std::flush;
+  stream << "ZONE T=\"" << type_name() << "::" << name() <<  "\"\n" << std::flush;
+  print(stream);
+  stream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::print_native(std::ostream& stream)
+{
+  print(stream);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void BlockCrsVector::debug_data(std::vector<Real>& values)
+{
+  cf3_assert(m_is_created);
+  values.assign(m_data.begin(),m_data.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,180 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_BlockCrsVector_hpp
+#define cf3_Math_LSS_BlockCrsVector_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "math/LSS/LibLSS.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Vector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file BlockCrsVector.hpp definition of LSS::BlockCrsVector
+
+  Vector of the native block-CRS linear solver backend. The values are stored in one contiguous array
+  in process-local numbering, node after node, including the ghost nodes of the CommPattern.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API BlockCrsVector : public LSS::Vector {
+public:
+
+  /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
+  //@{
+
+  /// name of the type
+  static std::string type_name () { return "BlockCrsVector"; }
+
+  /// Accessor to solver type
+  const std::string solvertype() { return "BlockCrs"; }
+
+  /// Default constructor
+  BlockCrsVector(const std::string& name);
+
+  /// Setup sparsity structure
+  void create(common::PE::CommPattern& cp, Uint neq);
+
+  /// The storage is always per node, so a blocked vector only takes the total number of variables
+  void create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars);
+
+  /// Deallocate underlying data
+  void destroy();
+
+  //@} END CREATION, DESTRUCTION AND COMPONENT SYSTEM
+
+  /// @name INDIVIDUAL ACCESS
+  //@{
+
+  /// Set value at given location in the matrix
+  void set_value(const Uint irow, const Real value);
+
+  /// Add value at given location in the matrix
+  void add_value(const Uint irow, const Real value);
+
+  /// Get value at given location in the matrix
+  void get_value(const Uint irow, Real& value);
+
+  /// Set value at given location in the matrix
+  void set_value(const Uint iblockrow, const Uint ieq, const Real value);
+
+  /// Add value at given location in the matrix
+  void add_value(const Uint iblockrow, const Uint ieq, const Real value);
+
+  /// Get value at given location in the matrix
+  void get_value(const Uint iblockrow, const Uint ieq, Real& value);
+
+  //@} END INDIVIDUAL ACCESS
+
+  /// @name EFFICCIENT ACCESS
+  //@{
+
+  /// Set a list of values to rhs
+  void set_rhs_values(const BlockAccumulator& values);
+
+  /// Add a list of values to rhs
+  void add_rhs_values(const BlockAccumulator& values);
+
+  /// Get a list of values from rhs
+  void get_rhs_values(BlockAccumulator& values);
+
+  /// Set a list of values to sol
+  void set_sol_values(const BlockAccumulator& values);
+
+  /// Add a list of values to sol
+  void add_sol_values(const BlockAccumulator& values);
+
+  /// Get a list of values from sol
+  void get_sol_values(BlockAccumulator& values);
+
+  /// Reset Vector
+  void reset(Real reset_to=0.);
+
+  /// Copies the contents out of the LSS::Vector to table.
+  void get( boost::multi_array<Real, 2>& data);
+
+  /// Copies the contents of the table into the LSS::Vector.
+  void set( boost::multi_array<Real, 2>& data);
+
+  //@} END EFFICCIENT ACCESS
+
+  /// @name MISCELLANEOUS
+  //@{
+
+  /// Print to wherever
+  void print(common::LogStream& stream);
+
+  /// Print to wherever
+  void print(std::ostream& stream);
+
+  /// Print to file given by filename
+  void print(const std::string& filename, std::ios_base::openmode mode = std::ios_base::out );
+
+  /// The native representation is the same as print
+  void print_native(std::ostream& stream);
+
+  /// Accessor to the state of create
+  const bool is_created() { return m_is_created; }
+
+  /// Accessor to the number of equations
+  const Uint neq() { cf3_assert(m_is_created); return m_neq; }
+
+  /// Accessor to the number of block rows
+  const Uint blockrow_size() { cf3_assert(m_is_created); return m_blockrow_size; }
+
+  //@} END MISCELLANEOUS
+
+  /// @name TEST ONLY
+  //@{
+
+  /// exports the vector into big linear array
+  /// @attention only for debug and utest purposes
+  void debug_data(std::vector<Real>& values);
+
+  //@} END TEST ONLY
+
+  /// @name NATIVE SOLVER ACCESS
+  //@{
+
+  /// Raw storage, node after node in process-local numbering, used directly by BlockCrsStrategy
+  std::vector<Real>& data() { return m_data; }
+
+  //@} END NATIVE SOLVER ACCESS
+
+private:
+
+  /// state of creation
+  bool m_is_created;
+
+  /// number of equations
+  Uint m_neq;
+
+  /// number of block rows, ghosts included
+  Uint m_blockrow_size;
+
+  /// the values
+  std::vector<Real> m_data;
+
+}; // end of class BlockCrsVector
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_BlockCrsVector_hpp
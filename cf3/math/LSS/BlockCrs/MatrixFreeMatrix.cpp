@@ -0,0 +1,249 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Assertions.hpp"
+#include "common/Builder.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/LSS/BlockCrs/BlockCrsVector.hpp"
+#include "math/LSS/BlockCrs/MatrixFreeMatrix.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file MatrixFreeMatrix.cpp implementation of LSS::MatrixFreeMatrix
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < LSS::MatrixFreeMatrix, LSS::Matrix, LSS::LibLSS > MatrixFreeMatrix_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+MatrixFreeMatrix::MatrixFreeMatrix(const std::string& name) :
+  BlockCrsMatrix(name),
+  m_y(nullptr),
+  m_has_pending_dirichlet(false)
+{
+  options().add("operator", m_operator)
+    .pretty_name("Operator")
+    .description("Assembly action that is executed to compute each matrix-vector product")
+    .link_to(&m_operator)
+    .mark_basic();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs)
+{
+  // only the diagonal blocks are stored, which the base class adds by itself
+  const Uint nb_nodes=cp.isUpdatable().size();
+  BlockCrsMatrix::create(cp,neq,std::vector<Uint>(),std::vector<Uint>(nb_nodes+1,0),solution,rhs);
+
+  m_x.assign(nb_nodes*neq,0.);
+  m_is_dirichlet.assign(nb_nodes*neq,false);
+  m_pending_dirichlet.assign(nb_nodes*neq,0.);
+
+  // processes without conditions of their own still correct their RHS in prepare_solve
+  m_rhs=rhs.handle<BlockCrsVector>();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::destroy()
+{
+  BlockCrsMatrix::destroy();
+  std::vector<Real>().swap(m_x);
+  std::vector<bool>().swap(m_is_dirichlet);
+  std::vector<Uint>().swap(m_identity_rows);
+  std::vector<Real>().swap(m_identity_values);
+  std::vector<Real>().swap(m_pending_dirichlet);
+  m_has_pending_dirichlet=false;
+  m_rhs=Handle<BlockCrsVector>();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::set_values(const BlockAccumulator& values)
+{
+  if (!is_applying())
+    throw common::NotSupported(FromHere(),"Setting values in " + uri().path() + " is only supported during a matrix-vector product");
+  add_values(values);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(is_created());
+  if (!is_applying())
+  {
+    BlockCrsMatrix::add_values(values);
+    return;
+  }
+
+  const Uint numblocks=values.indices.size();
+  const Uint nb_eq=neq();
+  std::vector<Real>& y=*m_y;
+  for (Uint irow=0; irow<numblocks; irow++)
+  {
+    const Uint row=values.indices[irow];
+    if (!is_updatable(row)) continue;
+    for (Uint i=0; i<nb_eq; i++)
+    {
+      Real sum=0.;
+      for (Uint icol=0; icol<numblocks; icol++)
+      {
+        const Real* x=&m_x[values.indices[icol]*nb_eq];
+        for (Uint j=0; j<nb_eq; j++)
+          sum+=values.mat(irow*nb_eq+i,icol*nb_eq+j)*x[j];
+      }
+      y[row*nb_eq+i]+=sum;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval)
+{
+  cf3_assert(is_created());
+  if (offdiagval!=0.)
+    throw common::NotSupported(FromHere(),"Non-zero off-diagonal values are not supported by " + uri().path());
+  if (!is_updatable(iblockrow)) return;
+  BlockCrsMatrix::set_row(iblockrow,ieq,diagval,offdiagval);
+  m_identity_rows.push_back(iblockrow*neq()+ieq);
+  m_identity_values.push_back(diagval);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values)
+{
+  throw common::NotSupported(FromHere(),"The columns of " + uri().path() + " are not stored");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs)
+{
+  cf3_assert(is_created());
+  m_rhs=rhs.handle<BlockCrsVector>();
+  if (is_null(m_rhs))
+    throw common::SetupError(FromHere(),"MatrixFreeMatrix requires a BlockCrsVector as RHS, got " + rhs.derived_type_name());
+
+  // the diagonal block only holds the diagonal entry of the column
+  if (is_updatable(blockrow))
+    BlockCrsMatrix::set_row(blockrow,ieq,1.,0.);
+
+  const Uint idx=blockrow*neq()+ieq;
+  m_is_dirichlet[idx]=true;
+  m_pending_dirichlet[idx]=value;
+  m_has_pending_dirichlet=true;
+  rhs.set_value(blockrow,ieq,value);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from)
+{
+  throw common::NotSupported(FromHere(),"Periodicity is not supported by " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::reset(Real reset_to)
+{
+  BlockCrsMatrix::reset(reset_to);
+  std::fill(m_is_dirichlet.begin(),m_is_dirichlet.end(),false);
+  std::fill(m_pending_dirichlet.begin(),m_pending_dirichlet.end(),0.);
+  m_has_pending_dirichlet=false;
+  m_identity_rows.clear();
+  m_identity_values.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::apply(const std::vector<Real>& x, std::vector<Real>& y)
+{
+  cf3_assert(is_created());
+  cf3_assert(x.size()==m_x.size());
+
+  // the dirichlet columns are zero
+  m_x=x;
+  const Uint size=m_x.size();
+  for (Uint i=0; i<size; i++)
+    if (m_is_dirichlet[i]) m_x[i]=0.;
+
+  apply_operator(m_x,y);
+
+  // ... and so are the dirichlet rows, except for the diagonal
+  const Uint nb_eq=neq();
+  for (Uint i=0; i<size; i++)
+    if (m_is_dirichlet[i] && is_updatable(i/nb_eq)) y[i]=x[i];
+  const Uint nb_identity_rows=m_identity_rows.size();
+  for (Uint i=0; i<nb_identity_rows; i++)
+    y[m_identity_rows[i]]=m_identity_values[i]*x[m_identity_rows[i]];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::prepare_solve()
+{
+  // the product is collective, so it runs as soon as any process has pending conditions
+  int has_pending_dirichlet=m_has_pending_dirichlet;
+  if (common::PE::Comm::instance().is_active() && common::PE::Comm::instance().size()>1)
+    common::PE::Comm::instance().all_reduce(common::PE::logical_or(),&has_pending_dirichlet,1,&has_pending_dirichlet);
+  if (!has_pending_dirichlet) return;
+  if (is_null(m_rhs))
+    throw common::SetupError(FromHere(),"MatrixFreeMatrix requires a BlockCrsVector as RHS");
+
+  std::vector<Real> columns(m_pending_dirichlet.size());
+  apply_operator(m_pending_dirichlet,columns);
+
+  std::vector<Real>& rhs=m_rhs->data();
+  const Uint size=rhs.size();
+  for (Uint i=0; i<size; i++)
+    if (!m_is_dirichlet[i]) rhs[i]-=columns[i];
+
+  std::fill(m_pending_dirichlet.begin(),m_pending_dirichlet.end(),0.);
+  m_has_pending_dirichlet=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void MatrixFreeMatrix::apply_operator(const std::vector<Real>& x, std::vector<Real>& y)
+{
+  if (is_null(m_operator))
+    throw common::SetupError(FromHere(),"No operator set for " + uri().path());
+
+  if (&x!=&m_x) m_x=x;
+  synchronize(m_x);
+
+  y.assign(m_x.size(),0.);
+  m_y=&y;
+  try
+  {
+    m_operator->execute();
+  }
+  catch(...)
+  {
+    m_y=nullptr;
+    throw;
+  }
+  m_y=nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
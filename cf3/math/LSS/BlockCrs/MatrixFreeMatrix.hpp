@@ -0,0 +1,121 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_MatrixFreeMatrix_hpp
+#define cf3_Math_LSS_MatrixFreeMatrix_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Action.hpp"
+
+#include "math/LSS/BlockCrs/BlockCrsMatrix.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file MatrixFreeMatrix.hpp definition of LSS::MatrixFreeMatrix
+
+  Matrix that is never stored: each product y = A x executes the assembly action given in the "operator" option again,
+  and the element blocks it adds are multiplied with x on the fly instead of being accumulated.
+  Outside of a product, only the diagonal blocks of the added values are kept, so the Jacobi and block-Jacobi
+  preconditioners of BlockCrsStrategy remain available.
+  The assembly action must skip its RHS contributions while is_applying() is true, the Proto RHS terms do this automatically.
+  Dirichlet conditions are recorded and applied to each product, periodicity is not supported.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class BlockCrsVector;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API MatrixFreeMatrix : public BlockCrsMatrix {
+public:
+
+  /// name of the type
+  static std::string type_name () { return "MatrixFreeMatrix"; }
+
+  /// Default constructor
+  MatrixFreeMatrix(const std::string& name);
+
+  /// Setup the diagonal block storage, the connectivity is not needed
+  void create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs);
+
+  /// Deallocate underlying data
+  void destroy();
+
+  /// Only supported while applying, where it acts as add_values
+  void set_values(const BlockAccumulator& values);
+
+  /// While applying, multiply the block with the matching entries of x, otherwise store its diagonal blocks
+  void add_values(const BlockAccumulator& values);
+
+  /// Replace a row by a scaled identity row. Off-diagonal values other than zero are not supported.
+  void set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval);
+
+  /// Not supported, the columns are not stored
+  void get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values);
+
+  /// Record a symmetric dirichlet condition. The RHS correction needs a product with the operator,
+  /// so it is done for all recorded conditions at once, in prepare_solve.
+  void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs);
+
+  /// Not supported
+  void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from);
+
+  /// Reset the diagonal blocks and forget the boundary conditions
+  void reset(Real reset_to=0.);
+
+  /// Compute y = A x by executing the operator
+  void apply(const std::vector<Real>& x, std::vector<Real>& y);
+
+  /// Move the columns of the symmetric dirichlet conditions to the RHS
+  void prepare_solve();
+
+  /// True while the operator is executed for a product
+  bool is_applying() const { return is_not_null(m_y); }
+
+private:
+
+  /// Execute the operator to compute y = A x, without boundary conditions
+  void apply_operator(const std::vector<Real>& x, std::vector<Real>& y);
+
+  /// Assembly action that is executed for each product
+  Handle<common::Action> m_operator;
+
+  /// Vector being multiplied, with up to date ghost values
+  std::vector<Real> m_x;
+
+  /// Result of the product in progress, null outside of apply
+  std::vector<Real>* m_y;
+
+  /// Flags the equations that have a symmetric dirichlet condition
+  std::vector<bool> m_is_dirichlet;
+
+  /// Equations replaced by set_row, and the matching diagonal values
+  std::vector<Uint> m_identity_rows;
+  std::vector<Real> m_identity_values;
+
+  /// Symmetric dirichlet values whose columns still have to be moved to the RHS
+  std::vector<Real> m_pending_dirichlet;
+  bool m_has_pending_dirichlet;
+
+  /// RHS of the system, corrected for the symmetric dirichlet conditions in prepare_solve
+  Handle<BlockCrsVector> m_rhs;
+
+}; // end of class MatrixFreeMatrix
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_MatrixFreeMatrix_hpp
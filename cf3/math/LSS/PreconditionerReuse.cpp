@@ -0,0 +1,105 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/assign/std/vector.hpp>
+#include <boost/bind.hpp>
+
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+
+#include "math/LSS/PreconditionerReuse.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+using namespace boost::assign;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+PreconditionerReuse::PreconditionerReuse(common::Component& strategy, const std::string& default_policy) :
+  m_strategy(strategy),
+  m_invalid(true),
+  m_solves_since_setup(0),
+  m_reference_iterations(0),
+  m_last_iterations(0)
+{
+  m_strategy.options().add("preconditioner_reuse", default_policy)
+    .pretty_name("Preconditioner Reuse")
+    .description("When to keep the preconditioner across solves. Never recomputes it for each solve, Always keeps it until the matrix or solver settings change, "
+                 "Steps recomputes it every reuse_steps solves and IterationGrowth when the iteration count grew by more than reuse_iteration_growth percent")
+    .attach_trigger(boost::bind(&PreconditionerReuse::invalidate, this))
+    .mark_basic()
+    .restricted_list() += std::string("Never"), std::string("Always"), std::string("Steps"), std::string("IterationGrowth");
+
+  m_strategy.options().add("reuse_steps", 10u)
+    .pretty_name("Reuse Steps")
+    .description("Number of solves between preconditioner setups, for the Steps reuse policy");
+
+  m_strategy.options().add("reuse_iteration_growth", 50.)
+    .pretty_name("Reuse Iteration Growth")
+    .description("Allowed growth of the iteration count in percent, for the IterationGrowth reuse policy");
+
+  m_strategy.properties().add("preconditioner_setup_time", 0.);
+  m_strategy.properties().add("solve_time", 0.);
+  m_strategy.properties().add("preconditioner_setups", 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PreconditionerReuse::needs_setup() const
+{
+  if(m_invalid)
+    return true;
+
+  const std::string policy = m_strategy.options().value<std::string>("preconditioner_reuse");
+  if(policy == "Always")
+    return false;
+  if(policy == "Steps")
+    return m_solves_since_setup >= m_strategy.options().value<Uint>("reuse_steps");
+  if(policy == "IterationGrowth")
+    return static_cast<Real>(m_last_iterations) > static_cast<Real>(m_reference_iterations) * (1. + 0.01*m_strategy.options().value<Real>("reuse_iteration_growth"));
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void PreconditionerReuse::invalidate()
+{
+  m_invalid = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void PreconditionerReuse::solve_done(const bool was_setup, const Uint iterations, const Real setup_time, const Real solve_time)
+{
+  if(was_setup)
+  {
+    m_strategy.properties().set("preconditioner_setups", m_strategy.properties().value<Uint>("preconditioner_setups") + 1u);
+    m_invalid = false;
+    m_solves_since_setup = 0;
+    m_reference_iterations = iterations;
+  }
+  ++m_solves_since_setup;
+  m_last_iterations = iterations;
+
+  m_strategy.properties().set("preconditioner_setup_time", setup_time);
+  m_strategy.properties().set("solve_time", solve_time);
+
+  CFdebug << m_strategy.uri().path() << ": preconditioner " << (was_setup ? "computed" : "reused") << " in " << setup_time << " s, solved in " << solve_time << " s" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
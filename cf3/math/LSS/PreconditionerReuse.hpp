@@ -0,0 +1,77 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_PreconditionerReuse_hpp
+#define cf3_Math_LSS_PreconditionerReuse_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Component.hpp"
+
+#include "math/LSS/LibLSS.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file PreconditionerReuse.hpp Policy deciding when a solution strategy recomputes its preconditioner
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Adds the preconditioner reuse options to a solution strategy, and keeps track of the solves since the last setup.
+/// The policies are:
+/// - Never: recompute the preconditioner for each solve
+/// - Always: keep it until the strategy invalidates it, i.e. when the matrix or the solver settings change
+/// - Steps: recompute it every reuse_steps solves
+/// - IterationGrowth: recompute it when the iteration count grew by more than reuse_iteration_growth percent
+///   compared to the first solve after the last setup
+/// The setup and solve times of the last solve and the number of preconditioner setups are stored in the properties of the strategy.
+class LSS_API PreconditionerReuse
+{
+public:
+  /// Add the options to the given strategy, using the given default policy
+  PreconditionerReuse(common::Component& strategy, const std::string& default_policy);
+
+  /// True if the preconditioner needs to be computed before the next solve
+  bool needs_setup() const;
+
+  /// Force a setup at the next solve
+  void invalidate();
+
+  /// Record the results of a solve
+  /// @param was_setup True if the preconditioner was computed for this solve
+  /// @param iterations Number of iterations used by the solver, if known
+  void solve_done(const bool was_setup, const Uint iterations, const Real setup_time, const Real solve_time);
+
+private:
+  common::Component& m_strategy;
+
+  /// True if the preconditioner must be computed, regardless of the policy
+  bool m_invalid;
+
+  /// Number of solves since the preconditioner was last computed
+  Uint m_solves_since_setup;
+
+  /// Iterations used by the first solve after the last setup
+  Uint m_reference_iterations;
+
+  /// Iterations used by the last solve
+  Uint m_last_iterations;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_PreconditionerReuse_hpp
@@ -41,9 +41,12 @@
 #include "common/Builder.hpp"
 #include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
+#include "common/Timer.hpp"
 #include <common/Table.hpp>
 #include <common/List.hpp>
 
+#include "math/LSS/PreconditionerReuse.hpp"
+
 #include "ParameterList.hpp"
 #include "TrilinosVector.hpp"
 #include "TrilinosCrsMatrix.hpp"
@@ -65,7 +68,8 @@ struct ConstantPoissonStrategy::Implementation
     m_self(self),
     m_ml_parameter_list(Teuchos::createParameterList()),
     m_ifpack_parameter_list(Teuchos::createParameterList()),
-    m_solver_parameter_list(Teuchos::createParameterList())
+    m_solver_parameter_list(Teuchos::createParameterList()),
+    m_reuse(self, "Always")
   {
     // ML default parameters
     ML_Epetra::SetDefaults("SA", *m_ml_parameter_list);
@@ -187,17 +191,42 @@ struct ConstantPoissonStrategy::Implementation
     return 0;
   }
 
+  /// Recompute the preconditioner from the current matrix values, keeping its structure
+  int recompute_preconditioner()
+  {
+    if(m_self.options().value<bool>("use_ml_preconditioner"))
+    {
+      ML_CHK_ERR(m_ml_prec->ReComputePreconditioner());
+    }
+    else
+    {
+      IFPACK_CHK_ERR(m_ifpack_prec->Compute());
+    }
+    return 0;
+  }
+
   void solve()
   {
+    common::Timer timer;
+    bool setup = false;
     if(is_null(m_solver.get()))
     {
       setup_solver();
+      setup = true;
+    }
+    else if(m_reuse.needs_setup())
+    {
+      recompute_preconditioner();
+      setup = true;
     }
 
     if(!m_problem->setProblem())
       throw common::SetupError(FromHere(), "Error setting up Belos problem");
+    const Real setup_time = timer.elapsed();
+    timer.restart();
 
     m_solver->solve();
+    m_reuse.solve_done(setup, m_solver->getNumIters(), setup_time, timer.elapsed());
   }
 
   Real compute_residual()
@@ -254,6 +283,7 @@ struct ConstantPoissonStrategy::Implementation
   Handle<ParameterList> m_solver_parameters;
 
   std::vector<Real> m_coords[3];
+  PreconditionerReuse m_reuse;
 };
 
 ConstantPoissonStrategy::ConstantPoissonStrategy(const string& name) :
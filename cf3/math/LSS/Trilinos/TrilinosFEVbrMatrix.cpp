@@ -171,6 +171,31 @@ void TrilinosFEVbrMatrix::create(cf3::common::PE::CommPattern& cp, const Uint ne
   //TRILINOS_THROW(m_mat->OptimizeStorage()); // in theory fillcomplete calls optimizestorage from Trilinos 8.x+
   delete[] gid;
 
+  // sorted column lookup, so element contributions don't need a linear search over the block row
+  m_sorted_starts.assign(nmyglobalelements+1,0);
+  m_sorted_cols.clear();
+  m_sorted_pos.clear();
+  m_sorted_cols.reserve(m_mat->NumMyBlockEntries());
+  m_sorted_pos.reserve(m_mat->NumMyBlockEntries());
+  std::vector< std::pair<int,int> > row_entries;
+  for (int i=0; i<(const int)nmyglobalelements; i++)
+  {
+    Epetra_SerialDenseMatrix **val;
+    int* colindices;
+    int blockrowsize;
+    int dummyneq;
+    TRILINOS_THROW(m_mat->ExtractMyBlockRowView(i,dummyneq,blockrowsize,colindices,val));
+    row_entries.resize(blockrowsize);
+    for (int j=0; j<(const int)blockrowsize; j++) row_entries[j]=std::make_pair(colindices[j],j);
+    std::sort(row_entries.begin(),row_entries.end());
+    for (int j=0; j<(const int)blockrowsize; j++)
+    {
+      m_sorted_cols.push_back(row_entries[j].first);
+      m_sorted_pos.push_back(row_entries[j].second);
+    }
+    m_sorted_starts[i+1]=m_sorted_cols.size();
+  }
+
   // set class properties
   m_is_created=true;
   m_neq=neq;
@@ -192,6 +217,9 @@ void TrilinosFEVbrMatrix::destroy()
   if (m_is_created) m_mat.reset();
   m_p2m.resize(0);
   m_p2m.reserve(0);
+  std::vector<int>().swap(m_sorted_starts);
+  std::vector<int>().swap(m_sorted_cols);
+  std::vector<int>().swap(m_sorted_pos);
   m_neq=0;
   m_blockrow_size=0;
   m_blockcol_size=0;
@@ -211,14 +239,10 @@ void TrilinosFEVbrMatrix::set_value(const Uint icol, const Uint irow, const Real
   int* colindices;
   int blockrowsize;
   int dummyneq;
+  const int pos=find_block(rowblock,colblock);
+  if (pos<0) throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
   TRILINOS_ASSERT(m_mat->ExtractMyBlockRowView(rowblock,dummyneq,blockrowsize,colindices,val));
-  for (int i=0; i<(const int)blockrowsize; i++)
-    if (*colindices++==colblock)
-    {
-      val[i][0](rowsub,colsub)=value;
-      return;
-    }
-  throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  val[pos][0](rowsub,colsub)=value;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -234,14 +258,10 @@ void TrilinosFEVbrMatrix::add_value(const Uint icol, const Uint irow, const Real
   int* colindices;
   int blockrowsize;
   int dummyneq;
+  const int pos=find_block(rowblock,colblock);
+  if (pos<0) throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
   TRILINOS_ASSERT(m_mat->ExtractMyBlockRowView(rowblock,dummyneq,blockrowsize,colindices,val));
-  for (int i=0; i<(const int)blockrowsize; i++)
-    if (*colindices++==colblock)
-    {
-      val[i][0](rowsub,colsub)+=value;
-      return;
-    }
-  throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  val[pos][0](rowsub,colsub)+=value;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -257,14 +277,10 @@ void TrilinosFEVbrMatrix::get_value(const Uint icol, const Uint irow, Real& valu
   int* colindices;
   int blockrowsize;
   int dummyneq;
+  const int pos=find_block(rowblock,colblock);
+  if (pos<0) throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
   TRILINOS_ASSERT(m_mat->ExtractMyBlockRowView(rowblock,dummyneq,blockrowsize,colindices,val));
-  for (int i=0; i<(const int)blockrowsize; i++)
-    if (*colindices++==colblock)
-    {
-      value=val[i][0](rowsub,colsub);
-      return;
-    }
-  throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  value=val[pos][0](rowsub,colsub);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -276,7 +292,6 @@ void TrilinosFEVbrMatrix::set_values(const BlockAccumulator& values)
   int* colindices;
   int blockrowsize;
   int dummyneq;
-  int hits=0;
   const int numblocks=values.indices.size();
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
@@ -287,26 +302,19 @@ void TrilinosFEVbrMatrix::set_values(const BlockAccumulator& values)
   {
     if (idxs[irow]<m_blockrow_size)
     {
-      hits=0;
       TRILINOS_ASSERT(m_mat->ExtractMyBlockRowView(idxs[irow],dummyneq,blockrowsize,colindices,val));
-      for (int j=0; j<(const int)blockrowsize; j++)
+      for (int icol=0; icol<(const int)numblocks; icol++)
       {
-        for (int icol=0; icol<(const int)numblocks; icol++)
-          if (colindices[j]==idxs[icol])
-          {
-            double *emv=val[j][0].A();
-            int col_idx = icol*m_neq;
-            for (double* l=emv; emv<(const double*)(l+neqneq); ++col_idx)
-            {
-              int row_idx = irow*m_neq;
-              for (double* m=emv; emv<(const double*)(m+m_neq);)
-                *emv++ = values.mat(row_idx++, col_idx);
-            }
-
-            hits++;
-            //break; // this is arguable, can be that the blockaccumulator fills to the same id more than once (repetitive same id entries in values.indices)
-          }
-        if (hits==numblocks) break;
+        const int j=find_block(idxs[irow],idxs[icol]);
+        if (j<0) continue;
+        double *emv=val[j][0].A();
+        int col_idx = icol*m_neq;
+        for (double* l=emv; emv<(const double*)(l+neqneq); ++col_idx)
+        {
+          int row_idx = irow*m_neq;
+          for (double* m=emv; emv<(const double*)(m+m_neq);)
+            *emv++ = values.mat(row_idx++, col_idx);
+        }
       }
     }
   }
@@ -364,7 +372,6 @@ void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
   int* colindices;
   int blockrowsize;
   int dummyneq;
-  int hits=0;
   const int numblocks=values.indices.size();
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
@@ -375,26 +382,19 @@ void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
   {
     if (idxs[irow]<m_blockrow_size)
     {
-      hits=0;
       TRILINOS_ASSERT(m_mat->ExtractMyBlockRowView(idxs[irow],dummyneq,blockrowsize,colindices,val));
-      for (int j=0; j<(const int)blockrowsize; j++)
+      for (int icol=0; icol<(const int)numblocks; icol++)
       {
-        for (int icol=0; icol<(const int)numblocks; icol++)
-          if (colindices[j]==idxs[icol])
-          {
-            double *emv=val[j][0].A();
-            int col_idx = icol*m_neq;
-            for (double* l=emv; emv<(const double*)(l+neqneq); ++col_idx)
-            {
-              int row_idx = irow*m_neq;
-              for (double* m=emv; emv<(const double*)(m+m_neq);)
-                *emv++ += values.mat(row_idx++, col_idx);
-            }
-
-            hits++;
-            //break; // this is arguable, can be that the blockaccumulator fills to the same id more than once (repetitive same id entries in values.indices)
-          }
-        if (hits==numblocks) break;
+        const int j=find_block(idxs[irow],idxs[icol]);
+        if (j<0) continue;
+        double *emv=val[j][0].A();
+        int col_idx = icol*m_neq;
+        for (double* l=emv; emv<(const double*)(l+neqneq); ++col_idx)
+        {
+          int row_idx = irow*m_neq;
+          for (double* m=emv; emv<(const double*)(m+m_neq);)
+            *emv++ += values.mat(row_idx++, col_idx);
+        }
       }
     }
   }
@@ -409,7 +409,6 @@ void TrilinosFEVbrMatrix::get_values(BlockAccumulator& values)
   int* colindices;
   int blockrowsize;
   int dummyneq;
-  int hits=0;
   const int numblocks=values.indices.size();
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
@@ -421,26 +420,19 @@ void TrilinosFEVbrMatrix::get_values(BlockAccumulator& values)
   {
     if (idxs[irow]<m_blockrow_size)
     {
-      hits=0;
       TRILINOS_ASSERT(m_mat->ExtractMyBlockRowView(idxs[irow],dummyneq,blockrowsize,colindices,val));
-      for (int j=0; j<(const int)blockrowsize; j++)
+      for (int icol=0; icol<(const int)numblocks; icol++)
       {
-        for (int icol=0; icol<(const int)numblocks; icol++)
-          if (colindices[j]==idxs[icol])
-          {
-            double *emv=val[j][0].A();
-            int col_idx = icol*m_neq;
-            for (double* l=emv; emv<(const double*)(l+neqneq); ++col_idx)
-            {
-              int row_idx = irow*m_neq;
-              for (double* m=emv; emv<(const double*)(m+m_neq);)
-                values.mat(row_idx++, col_idx) = *emv++;
-            }
-
-            hits++;
-            //break; // this is arguable, can be that the blockaccumulator fills to the same id more than once (repetitive same id entries in values.indices)
-          }
-        if (hits==numblocks) break;
+        const int j=find_block(idxs[irow],idxs[icol]);
+        if (j<0) continue;
+        double *emv=val[j][0].A();
+        int col_idx = icol*m_neq;
+        for (double* l=emv; emv<(const double*)(l+neqneq); ++col_idx)
+        {
+          int row_idx = irow*m_neq;
+          for (double* m=emv; emv<(const double*)(m+m_neq);)
+            values.mat(row_idx++, col_idx) = *emv++;
+        }
       }
     }
   }
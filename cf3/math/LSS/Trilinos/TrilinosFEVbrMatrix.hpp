@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include <Epetra_MpiComm.h>
 #include <Epetra_FEVbrMatrix.h>
 #include <Teuchos_RCP.hpp>
@@ -161,6 +163,16 @@ public:
 
 private:
 
+  /// position of block column col in the ExtractMyBlockRowView of block row row, or -1 if there is no such block
+  int find_block(const int row, const int col) const
+  {
+    if (row>=(const int)m_blockrow_size) return -1;
+    const std::vector<int>::const_iterator begin=m_sorted_cols.begin()+m_sorted_starts[row];
+    const std::vector<int>::const_iterator end=m_sorted_cols.begin()+m_sorted_starts[row+1];
+    const std::vector<int>::const_iterator it=std::lower_bound(begin,end,col);
+    return (it!=end && *it==col) ? m_sorted_pos[it-m_sorted_cols.begin()] : -1;
+  }
+
   /// teuchos style smart pointer wrapping an epetra fevbrmatrix
   Teuchos::RCP<Epetra_FEVbrMatrix> m_mat;
 
@@ -190,6 +202,11 @@ private:
 
   /// For each element of m_node_connectivity, indicate if the entry is kept in the matrix (used to build symmetric matrices keeping only the upper-diagonal)
   std::vector<bool> m_keep_node;
+
+  /// block column indices of each block row in sorted order, starting at m_sorted_starts[row]
+  std::vector<int> m_sorted_starts, m_sorted_cols;
+  /// for each entry of m_sorted_cols, the position of the block in ExtractMyBlockRowView
+  std::vector<int> m_sorted_pos;
 }; // end of class Matrix
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -27,6 +27,9 @@
 #include "common/Builder.hpp"
 #include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
+#include "common/Timer.hpp"
+
+#include "math/LSS/PreconditionerReuse.hpp"
 
 #include "ParameterList.hpp"
 #include "ThyraMultiVector.hpp"
@@ -53,7 +56,8 @@ struct TrilinosStratimikosStrategy::Implementation
 {
   Implementation(common::Component& self) :
     m_self(self),
-    m_parameter_list(Teuchos::createParameterList())
+    m_parameter_list(Teuchos::createParameterList()),
+    m_reuse(self, "Never")
   {
     Teko::addTekoToStratimikosBuilder(m_linear_solver_builder);
     m_linear_solver_builder.setParameterList(m_parameter_list);
@@ -133,6 +137,8 @@ struct TrilinosStratimikosStrategy::Implementation
     if(is_null(m_solution))
       throw common::SetupError(FromHere(), "Null solution vector for " + m_self.uri().path());
 
+    common::Timer timer;
+    const bool setup = m_lows.is_null() || m_reuse.needs_setup();
     if(m_lows.is_null())
     {
       if(m_self.options().option("print_settings").value<bool>())
@@ -141,10 +147,21 @@ struct TrilinosStratimikosStrategy::Implementation
       m_lows = m_lows_factory->createOp();
     }
 
-    Thyra::initializeOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+    // Reusing keeps the preconditioner that was computed for an earlier matrix
+    if(setup)
+      Thyra::initializeOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+    else
+      Thyra::initializeAndReuseOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+    const Real setup_time = timer.elapsed();
+    timer.restart();
 
     Thyra::SolveStatus<double> status = Thyra::solve<double>(*m_lows, Thyra::NOTRANS, *m_rhs->thyra_vector(m_matrix->thyra_operator()->range()), m_solution->thyra_vector(m_matrix->thyra_operator()->domain()).ptr());
     CFinfo << "Thyra::solve finished with status " << status.message << CFendl;
+
+    Uint iterations = 0;
+    if(!status.extraParameters.is_null() && status.extraParameters->isParameter("Belos/Iteration Count"))
+      iterations = status.extraParameters->get<int>("Belos/Iteration Count");
+    m_reuse.solve_done(setup, iterations, setup_time, timer.elapsed());
     if(m_self.options().option("compute_residual").value<bool>())
       CFinfo << "Solver residual: " << compute_residual() << CFendl;
   }
@@ -197,6 +214,7 @@ struct TrilinosStratimikosStrategy::Implementation
   Handle<ThyraMultiVector> m_solution;
   Teuchos::RCP< Thyra::MultiVectorBase<Real> > m_residual_vec;
   Handle<ParameterList> m_parameters;
+  PreconditionerReuse m_reuse;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -16,7 +16,7 @@
 #include "common/EventHandler.hpp"
 #include "common/StringConversion.hpp"
 #include "common/Tags.hpp"
-#include "common/DynTable.hpp"
+#include "common/CompressedTable.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/PE/CommPattern.hpp"
 
@@ -308,9 +308,7 @@ void ContinuousDictionary::rebuild_spaces_from_geometry()
 
 void ContinuousDictionary::rebuild_node_to_element_connectivity()
 {
-  // Reserve memory in m_connectivity->array()
-  m_connectivity->array().resize(size());
-
+  // Count the elements connected to each node
   std::vector<Uint> connectivity_sizes(size());
   boost_foreach (const Handle<Space>& space, spaces() )
   {
@@ -323,11 +321,10 @@ void ContinuousDictionary::rebuild_node_to_element_connectivity()
       }
     }
   }
-  for (Uint i=0; i<size(); ++i)
-  {
-    m_connectivity->array()[i].clear();
-    m_connectivity->array()[i].reserve(connectivity_sizes[i]);
-  }
+  m_connectivity->allocate(connectivity_sizes);
+
+  // Fill the rows, reusing connectivity_sizes as fill position in each row
+  std::fill(connectivity_sizes.begin(), connectivity_sizes.end(), 0);
 
   boost_foreach (const Handle<Space>& space, spaces())
   {
@@ -335,7 +332,7 @@ void ContinuousDictionary::rebuild_node_to_element_connectivity()
     {
       boost_foreach (const Uint node_idx, space->connectivity()[elem_idx])
       {
-        m_connectivity->array()[node_idx].push_back(SpaceElem(*space,elem_idx));
+        (*m_connectivity)[node_idx][connectivity_sizes[node_idx]++] = SpaceElem(*space,elem_idx);
       }
     }
   }
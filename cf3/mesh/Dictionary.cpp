@@ -19,7 +19,7 @@
 #include "common/EventHandler.hpp"
 #include "common/StringConversion.hpp"
 #include "common/Tags.hpp"
-#include "common/DynTable.hpp"
+#include "common/CompressedTable.hpp"
 #include "common/List.hpp"
 
 #include "common/XML/SignalOptions.hpp"
@@ -65,10 +65,10 @@ Dictionary::Dictionary ( const std::string& name  ) :
   m_glb_idx = create_static_component< common::List<Uint> >(mesh::Tags::global_indices());
   m_glb_idx->add_tag(mesh::Tags::global_indices());
 
-  m_glb_to_loc = create_static_component< common::Map<boost::uint64_t,Uint> >(mesh::Tags::map_global_to_local());
+  m_glb_to_loc = create_static_component< common::HashMap<boost::uint64_t,Uint> >(mesh::Tags::map_global_to_local());
   m_glb_to_loc->add_tag(mesh::Tags::map_global_to_local());
 
-  m_connectivity = create_static_component< common::DynTable<SpaceElem> >("element_connectivity");
+  m_connectivity = create_static_component< common::CompressedTable<SpaceElem> >("element_connectivity");
 
   // Signals
   regist_signal ( "create_field" )
@@ -365,7 +365,6 @@ void Dictionary::rebuild_map_glb_to_loc()
   m_glb_to_loc->reserve(size());
   for (Uint n=0; n<size(); ++n)
     m_glb_to_loc->push_back(glb_idx()[n],n);
-  m_glb_to_loc->sort_keys();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -456,13 +455,13 @@ Field& Dictionary::create_coordinates()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-DynTable<Uint>& Dictionary::glb_elem_connectivity()
+CompressedTable<Uint>& Dictionary::glb_elem_connectivity()
 {
   if (is_null(m_glb_elem_connectivity))
   {
-    m_glb_elem_connectivity = create_static_component< DynTable<Uint> >("glb_elem_connectivity");
+    m_glb_elem_connectivity = create_static_component< CompressedTable<Uint> >("glb_elem_connectivity");
     m_glb_elem_connectivity->add_tag("glb_elem_connectivity");
-    m_glb_elem_connectivity->resize(size());
+    m_glb_elem_connectivity->allocate(std::vector<Uint>(size(), 0));
   }
   return *m_glb_elem_connectivity;
 }
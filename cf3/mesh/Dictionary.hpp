@@ -9,7 +9,7 @@
 
 #include <boost/cstdint.hpp>
 
-#include "common/Map.hpp"
+#include "common/HashMap.hpp"
 
 #include "mesh/LibMesh.hpp"
 
@@ -17,7 +17,7 @@ namespace cf3 {
 namespace common {
   class Link;
   template <typename T> class List;
-  template <typename T> class DynTable;
+  template <typename T> class CompressedTable;
   namespace PE { class CommPattern; }
 }
 namespace math { class VariablesDescriptor; }
@@ -84,13 +84,13 @@ public: // functions
   const common::List<Uint>& rank() const { return *m_rank; }
 
   /// Return a mapping between global and local indices
-//  common::Map<boost::uint64_t,Uint>& glb_to_loc() { return *m_glb_to_loc; }
+//  common::HashMap<boost::uint64_t,Uint>& glb_to_loc() { return *m_glb_to_loc; }
 
   /// Return a mapping between global and local indices
-  const common::Map<boost::uint64_t,Uint>& glb_to_loc() const { return *m_glb_to_loc; }
+  const common::HashMap<boost::uint64_t,Uint>& glb_to_loc() const { return *m_glb_to_loc; }
 
   /// Node to space-element connectivity
-  const common::DynTable<SpaceElem>& connectivity() const { return *m_connectivity; }
+  const common::CompressedTable<SpaceElem>& connectivity() const { return *m_connectivity; }
 
   /// Return the comm pattern valid for this field group. Created based on the glb_idx and rank if it didn't exist already
   common::PE::CommPattern& comm_pattern();
@@ -114,7 +114,7 @@ public: // functions
 
   const std::vector< Handle<Field> >& fields() const { return m_fields; }
 
-  common::DynTable<Uint>& glb_elem_connectivity();
+  common::CompressedTable<Uint>& glb_elem_connectivity();
 
   void signal_create_field ( common::SignalArgs& node );
 
@@ -159,13 +159,13 @@ protected:
   Handle<common::List<Uint> > m_glb_idx;
   Handle<common::List<Uint> > m_rank;
   Handle<Field> m_coordinates;
-  Handle<common::DynTable<Uint> > m_glb_elem_connectivity;
+  Handle<common::CompressedTable<Uint> > m_glb_elem_connectivity;
   Handle<common::PE::CommPattern> m_comm_pattern;
-  Handle<common::Map<boost::uint64_t,Uint> > m_glb_to_loc;
+  Handle<common::HashMap<boost::uint64_t,Uint> > m_glb_to_loc;
   bool m_is_continuous;
 
   /// Connectivity with the element of the space
-  Handle<common::DynTable<SpaceElem> > m_connectivity;
+  Handle<common::CompressedTable<SpaceElem> > m_connectivity;
 
 
 private:
@@ -17,6 +17,7 @@
 #include "math/Functions.hpp"
 
 #include "mesh/Octtree.hpp"
+#include "mesh/ElementTree.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Elements.hpp"
 #include "mesh/Dictionary.hpp"
@@ -72,14 +73,31 @@ void ElementFinderOcttree::configure_octtree()
     m_octtree = mesh->create_component<Octtree>("octtree");
     m_octtree->options().set("mesh",mesh);
   }
+
+  if (Handle<Component> found = mesh->get_child("element_tree"))
+    m_tree = Handle<ElementTree>(found);
+  else
+  {
+    m_tree = mesh->create_component<ElementTree>("element_tree");
+    m_tree->options().set("mesh",mesh);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 bool ElementFinderOcttree::find_element(const RealVector& target_coord, SpaceElem& element)
 {
-  cf3_assert(m_octtree);
+  // Exact match through the element tree
+  cf3_assert(m_tree);
+  if (m_tree->find_element(target_coord,m_tmp))
+  {
+    element = SpaceElem(*const_cast<Space*>(&m_dict->space(*m_tmp.comp)),m_tmp.idx);
+    return true;
+  }
 
+  // The octtree rings only serve to find the closest element, or an element the tree missed,
+  // so the octtree is only built once the tree misses a coordinate
+  cf3_assert(m_octtree);
   if (m_octtree->is_created() == false)
       m_octtree->create_octtree();
 
@@ -18,6 +18,7 @@ namespace cf3 {
 namespace mesh {
 
   class Octtree;
+  class ElementTree;
   
 /// @brief Find elements using an octtree
 class Mesh_API ElementFinderOcttree : public ElementFinder
@@ -39,6 +40,7 @@ private:
 private:
 
   Handle<Octtree> m_octtree;
+  Handle<ElementTree> m_tree;
   Entity m_tmp;
   bool m_closest;
 
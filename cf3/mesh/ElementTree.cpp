@@ -0,0 +1,357 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/Builder.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/ParallelFor.hpp"
+#include "common/Table.hpp"
+
+#include "math/Consts.hpp"
+
+#include "mesh/ElementTree.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Connectivity.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+cf3::common::ComponentBuilder < ElementTree, Component, LibMesh > ElementTree_Builder;
+
+static const Uint min_coords_per_thread=256;
+
+/// Maximum depth of the tree, the median splits keep it below log2 of the number of elements
+static const Uint max_depth=64;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Compare element indices on the center of their bounding box along one axis
+struct CenterLess
+{
+  CenterLess(const std::vector<Real>& element_boxes, const Uint axis) : boxes(element_boxes), d(axis) {}
+  bool operator()(const Uint a, const Uint b) const
+  {
+    return boxes[6*a+d]+boxes[6*a+3+d] < boxes[6*b+d]+boxes[6*b+3+d];
+  }
+  const std::vector<Real>& boxes;
+  const Uint d;
+};
+
+/// Morton code of a coordinate quantized in the box [min,max], interleaving the bits of all dimensions
+boost::uint64_t morton_code(const Real* coord, const Real* min, const Real* max, const Uint dim)
+{
+  const Uint bits = 63/dim;
+  const boost::uint64_t max_key = (boost::uint64_t(1) << bits) - 1;
+  boost::uint64_t keys[3] = {0,0,0};
+  for (Uint d=0; d<dim; ++d)
+  {
+    const Real length = max[d]-min[d];
+    const Real x = length > 0. ? (coord[d]-min[d])/length : 0.;
+    keys[d] = static_cast<boost::uint64_t>(std::min(std::max(x,0.),1.)*static_cast<Real>(max_key));
+  }
+  boost::uint64_t code = 0;
+  for (int b=bits-1; b>=0; --b)
+    for (Uint d=0; d<dim; ++d)
+      code = (code << 1) | ((keys[d] >> b) & 1u);
+  return code;
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+ElementTree::ElementTree( const std::string& name )
+  : Component(name), m_dim(0), m_tolerance(0.), m_max_elems_per_leaf(8), m_nb_threads(1)
+{
+  options().add("mesh", m_mesh)
+      .description("Mesh to create the tree from")
+      .pretty_name("Mesh")
+      .mark_basic()
+      .link_to(&m_mesh);
+
+  options().add("max_elems_per_leaf", m_max_elems_per_leaf)
+      .description("Maximum number of elements in a leaf of the tree")
+      .pretty_name("Maximum Elements per Leaf")
+      .link_to(&m_max_elems_per_leaf);
+
+  options().add("nb_threads", m_nb_threads)
+      .description("Number of threads used to find the elements of a set of coordinates")
+      .pretty_name("Number of Threads")
+      .link_to(&m_nb_threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ElementTree::create_tree()
+{
+  if (is_null(m_mesh))
+    throw SetupError(FromHere(), "Option \"mesh\" has not been configured");
+
+  m_dim = m_mesh->dimension();
+  m_nodes.clear();
+  m_elements.clear();
+
+  // Bounding box of every volume element
+  std::vector<Entity> elements;
+  std::vector<Real> boxes;
+  boost_foreach (Elements& entities, find_components_recursively_with_filter<Elements>(*m_mesh,IsElementsVolume()))
+  {
+    const Connectivity& connectivity = entities.geometry_space().connectivity();
+    const Table<Real>& coordinates = entities.geometry_space().dict().coordinates();
+    for (Uint e=0; e<entities.size(); ++e)
+    {
+      elements.push_back(Entity(entities,e));
+      Real box[6] = {0.,0.,0.,0.,0.,0.};
+      for (Uint d=0; d<m_dim; ++d)
+      {
+        box[d]   = math::Consts::real_max();
+        box[3+d] = -math::Consts::real_max();
+      }
+      boost_foreach (const Uint node, connectivity[e])
+      {
+        for (Uint d=0; d<m_dim; ++d)
+        {
+          box[d]   = std::min(box[d],   coordinates[node][d]);
+          box[3+d] = std::max(box[3+d], coordinates[node][d]);
+        }
+      }
+      boxes.insert(boxes.end(), box, box+6);
+    }
+  }
+
+  if (elements.empty())
+    return;
+
+  std::vector<Uint> order(elements.size());
+  for (Uint i=0; i<order.size(); ++i)
+    order[i] = i;
+
+  m_max_elems_per_leaf = std::max(m_max_elems_per_leaf,1u);
+  m_nodes.resize(1);
+  build_node(0,0,order.size(),order,boxes);
+
+  m_elements.resize(elements.size());
+  m_element_boxes.resize(boxes.size());
+  for (Uint i=0; i<order.size(); ++i)
+  {
+    m_elements[i] = elements[order[i]];
+    std::copy(boxes.begin()+6*order[i], boxes.begin()+6*order[i]+6, m_element_boxes.begin()+6*i);
+  }
+
+  Real size = 0.;
+  for (Uint d=0; d<m_dim; ++d)
+    size = std::max(size, m_nodes[0].max[d]-m_nodes[0].min[d]);
+  m_tolerance = 100.*math::Consts::eps()*std::max(size,1.);
+
+  CFdebug << "ElementTree: " << m_elements.size() << " elements in " << m_nodes.size() << " nodes" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ElementTree::build_node(const Uint node, const Uint begin, const Uint end, std::vector<Uint>& order, const std::vector<Real>& boxes)
+{
+  // Bounding box of the node, and of the centers of its elements
+  Real center_min[3] = {0.,0.,0.};
+  Real center_max[3] = {0.,0.,0.};
+  Node& n = m_nodes[node];
+  for (Uint d=0; d<3; ++d)
+  {
+    n.min[d] = 0.;
+    n.max[d] = 0.;
+  }
+  for (Uint d=0; d<m_dim; ++d)
+  {
+    n.min[d] = center_min[d] = math::Consts::real_max();
+    n.max[d] = center_max[d] = -math::Consts::real_max();
+  }
+  for (Uint i=begin; i<end; ++i)
+  {
+    const Real* box = &boxes[6*order[i]];
+    for (Uint d=0; d<m_dim; ++d)
+    {
+      n.min[d] = std::min(n.min[d], box[d]);
+      n.max[d] = std::max(n.max[d], box[3+d]);
+      center_min[d] = std::min(center_min[d], 0.5*(box[d]+box[3+d]));
+      center_max[d] = std::max(center_max[d], 0.5*(box[d]+box[3+d]));
+    }
+  }
+  n.begin = begin;
+  n.end = end;
+  n.children = 0;
+
+  if (end-begin <= m_max_elems_per_leaf)
+    return;
+
+  // Split at the median along the longest extent of the centers
+  Uint axis = 0;
+  for (Uint d=1; d<m_dim; ++d)
+  {
+    if (center_max[d]-center_min[d] > center_max[axis]-center_min[axis])
+      axis = d;
+  }
+  const Uint mid = begin + (end-begin)/2;
+  std::nth_element(order.begin()+begin, order.begin()+mid, order.begin()+end, CenterLess(boxes,axis));
+
+  // n is invalidated when the node array grows
+  const Uint children = m_nodes.size();
+  m_nodes[node].children = children;
+  m_nodes.resize(children+2);
+  build_node(children,   begin, mid, order, boxes);
+  build_node(children+1, mid,   end, order, boxes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ElementTree::locate(const RealVector& coord, Entity& element, RealMatrix& element_coordinates) const
+{
+  Uint stack[2*max_depth];
+  Uint stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size)
+  {
+    const Node& node = m_nodes[stack[--stack_size]];
+    bool inside = true;
+    for (Uint d=0; d<m_dim && inside; ++d)
+      inside = coord[d] >= node.min[d]-m_tolerance && coord[d] <= node.max[d]+m_tolerance;
+    if (!inside)
+      continue;
+
+    if (node.children)
+    {
+      cf3_assert(stack_size+2 <= 2*max_depth);
+      stack[stack_size++] = node.children+1;
+      stack[stack_size++] = node.children;
+      continue;
+    }
+
+    for (Uint e=node.begin; e<node.end; ++e)
+    {
+      const Real* box = &m_element_boxes[6*e];
+      bool in_box = true;
+      for (Uint d=0; d<m_dim && in_box; ++d)
+        in_box = coord[d] >= box[d]-m_tolerance && coord[d] <= box[3+d]+m_tolerance;
+      if (!in_box)
+        continue;
+
+      const Entity& candidate = m_elements[e];
+      if (element_coordinates.rows() != candidate.element_type().nb_nodes())
+        candidate.allocate_coordinates(element_coordinates);
+      candidate.put_coordinates(element_coordinates);
+      if (candidate.element_type().is_coord_in_element(coord,element_coordinates))
+      {
+        element = candidate;
+        return true;
+      }
+    }
+  }
+  element = Entity();
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ElementTree::find_element(const RealVector& target_coord, Entity& element)
+{
+  if ( !is_created() )
+    create_tree();
+
+  if ( !is_created() )
+  {
+    element = Entity();
+    return false;
+  }
+
+  cf3_assert(target_coord.size() <= (long)m_dim);
+  RealVector t_coord(m_dim); t_coord.setZero();
+  for (Uint d=0; d<target_coord.size(); ++d)
+    t_coord[d] = target_coord[d];
+
+  return locate(t_coord,element,m_element_coordinates);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ElementTree::locate_range(const Table<Real>& coordinates, const std::vector<Uint>& order, const Uint begin, const Uint end, std::vector<Entity>& elements) const
+{
+  RealVector t_coord(m_dim); t_coord.setZero();
+  RealMatrix element_coordinates;
+  const Uint coord_dim = std::min(coordinates.row_size(),m_dim);
+  for (Uint i=begin; i<end; ++i)
+  {
+    const Uint c = order[i];
+    for (Uint d=0; d<coord_dim; ++d)
+      t_coord[d] = coordinates[c][d];
+    locate(t_coord,elements[c],element_coordinates);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint ElementTree::find_elements(const Table<Real>& coordinates, std::vector<Entity>& elements)
+{
+  if ( !is_created() )
+    create_tree();
+
+  const Uint nb_coords = coordinates.size();
+  elements.assign(nb_coords,Entity());
+  if ( !is_created() || nb_coords == 0 )
+    return 0;
+
+  // Sort the coordinates along the Morton curve in the bounding box of the mesh
+  const Node& root = m_nodes[0];
+  const Uint coord_dim = std::min(coordinates.row_size(),m_dim);
+  std::vector< std::pair<boost::uint64_t,Uint> > codes(nb_coords);
+  Real coord[3] = {0.,0.,0.};
+  for (Uint c=0; c<nb_coords; ++c)
+  {
+    for (Uint d=0; d<coord_dim; ++d)
+      coord[d] = coordinates[c][d];
+    codes[c] = std::make_pair(morton_code(coord,root.min,root.max,m_dim),c);
+  }
+  std::sort(codes.begin(),codes.end());
+  std::vector<Uint> order(nb_coords);
+  for (Uint i=0; i<nb_coords; ++i)
+    order[i] = codes[i].second;
+
+  common::parallel_for(nb_coords,m_nb_threads,min_coords_per_thread,
+                       boost::bind(&ElementTree::locate_range,this,boost::cref(coordinates),boost::cref(order),_1,_2,boost::ref(elements)));
+
+  Uint nb_found = 0;
+  boost_foreach (const Entity& element, elements)
+  {
+    if (is_not_null(element.comp))
+      ++nb_found;
+  }
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,124 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_ElementTree_hpp
+#define cf3_mesh_ElementTree_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Component.hpp"
+#include "common/Table_fwd.hpp"
+
+#include "math/MatrixTypes.hpp"
+
+#include "mesh/Entities.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  class Mesh;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Bounding volume hierarchy over the bounding boxes of the volume elements of a mesh
+///
+/// The tree is built top-down: the elements of a node are split at the median of their
+/// box centers along the longest extent, until a leaf holds at most "max_elems_per_leaf"
+/// elements. The depth adapts to the element sizes, so strongly graded meshes don't give
+/// the empty or overfull cells of the uniform grid in Octtree.
+/// Nodes are stored in a flat array, and the two children of a node are consecutive.
+///
+/// Locating points only reads the tree, so a batch of points can be located by several threads.
+class Mesh_API ElementTree : public common::Component
+{
+public: // functions
+
+  /// constructor
+  ElementTree( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "ElementTree"; }
+
+  /// Build the tree from the volume elements of the configured mesh
+  void create_tree();
+
+  bool is_created() const { return !m_nodes.empty(); }
+
+  Uint dimension() const { return m_dim; }
+
+  /// @brief Find which element contains a given coordinate
+  /// @param [in]  target_coord  the coordinate, missing components are taken as zero
+  /// @param [out] element       the element containing the coordinate, or a null Entity
+  /// @return if element was found
+  bool find_element(const RealVector& target_coord, Entity& element);
+
+  /// @brief Find which elements contain a set of coordinates
+  ///
+  /// The coordinates are located in the order of their Morton code, so that consecutive
+  /// searches visit the same nodes. The sorted coordinates are split over "nb_threads" threads.
+  /// @param [in]  coordinates  one coordinate per row, missing components are taken as zero
+  /// @param [out] elements     the element containing each coordinate, a null Entity if not found
+  /// @return the number of coordinates found
+  Uint find_elements(const common::Table<Real>& coordinates, std::vector<Entity>& elements);
+
+private: // functions
+
+  /// Node of the tree, a leaf if it has no children
+  struct Node
+  {
+    Real min[3];
+    Real max[3];
+    Uint begin;     ///< first element of the node in m_elements
+    Uint end;       ///< one past the last element of the node in m_elements
+    Uint children;  ///< index of the first child, 0 for a leaf
+  };
+
+  /// Split the elements [begin,end) of order into the node, recursively
+  void build_node(const Uint node, const Uint begin, const Uint end, std::vector<Uint>& order, const std::vector<Real>& boxes);
+
+  /// Locate the coordinate, using the given storage for the element coordinates
+  bool locate(const RealVector& coord, Entity& element, RealMatrix& element_coordinates) const;
+
+  /// Locate the coordinates order[begin] to order[end-1]
+  void locate_range(const common::Table<Real>& coordinates, const std::vector<Uint>& order, const Uint begin, const Uint end, std::vector<Entity>& elements) const;
+
+private: // data
+
+  Handle<Mesh> m_mesh;
+
+  Uint m_dim;
+
+  /// Tolerance on the bounding boxes, relative to the size of the mesh
+  Real m_tolerance;
+
+  /// Nodes of the tree, the root is the first one
+  std::vector<Node> m_nodes;
+
+  /// Elements, ordered such that every leaf holds a contiguous range
+  std::vector<Entity> m_elements;
+
+  /// Bounding box of every element in m_elements, as min[3] followed by max[3]
+  std::vector<Real> m_element_boxes;
+
+  Uint m_max_elems_per_leaf;
+
+  Uint m_nb_threads;
+
+  /// Storage for the element coordinates in find_element
+  RealMatrix m_element_coordinates;
+
+}; // end ElementTree
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_ElementTree_hpp
@@ -196,6 +196,50 @@ public: // functions
 
   //@}
 
+  /// @name Batched computation functions
+  /// These evaluate the computation functions for the elements [begin,end) of a connectivity
+  /// table, gathering the node coordinates from a coordinates table. There is one virtual call
+  /// per block of elements, and the concrete element types use their fixed-size matrices.
+  /// The output is resized to the number of elements in the block.
+  //  ---------------------------
+  //@{
+
+  /// compute the volume of a block of elements
+  /// @param [in]  connectivity  element to node connectivity
+  /// @param [in]  coordinates   node coordinates (nb_nodes x dimension)
+  /// @param [in]  begin         first element of the block
+  /// @param [in]  end           one past the last element of the block
+  /// @param [out] volumes       volume of every element in the block
+  virtual void compute_volumes(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                               const Uint begin, const Uint end, RealVector& volumes) const = 0;
+
+  /// compute the area of a block of elements
+  /// @see compute_volumes() for the arguments
+  virtual void compute_areas(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                             const Uint begin, const Uint end, RealVector& areas) const = 0;
+
+  /// compute the centroid of a block of elements
+  /// @param [out] centroids  one row per element in the block (nb_elements x dimension)
+  /// @see compute_volumes() for the other arguments
+  virtual void compute_centroids(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                                 const Uint begin, const Uint end, RealMatrix& centroids) const = 0;
+
+  /// compute the unit-normal of a block of face-elements
+  /// @param [out] normals  one row per element in the block (nb_elements x dimension)
+  /// @see compute_volumes() for the other arguments
+  virtual void compute_normals(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                               const Uint begin, const Uint end, RealMatrix& normals) const = 0;
+
+  /// compute the jacobian determinant at the same mapped coordinate of a block of elements
+  /// @param [in]  mapped_coord   coordinates in mapped space (dimensionality x 1)
+  /// @param [out] determinants   jacobian determinant of every element in the block
+  /// @see compute_volumes() for the other arguments
+  virtual void compute_jacobian_determinants(const RealVector& mapped_coord,
+                                             const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                                             const Uint begin, const Uint end, RealVector& determinants) const = 0;
+
+  //@}
+
 protected: // data
 
   /// the GeoShape::Type corresponding to the shape
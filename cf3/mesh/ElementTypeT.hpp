@@ -19,6 +19,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "common/Table.hpp"
+
 #include "mesh/ElementType.hpp"
 #include "mesh/ShapeFunctionT.hpp"
 
@@ -187,7 +189,91 @@ public: // functions
 
   //@}
 
+  /// @name Batched computation functions
+  //  ---------------------------
+  //@{
+
+  virtual void compute_volumes(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                               const Uint begin, const Uint end, RealVector& volumes) const
+  {
+    typename ETYPE::NodesT nodes;
+    volumes.resize(end-begin);
+    for (Uint e=begin; e<end; ++e)
+    {
+      gather_nodes(connectivity[e],coordinates,nodes);
+      volumes[e-begin] = ETYPE::volume(nodes);
+    }
+  }
+
+  virtual void compute_areas(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                             const Uint begin, const Uint end, RealVector& areas) const
+  {
+    typename ETYPE::NodesT nodes;
+    areas.resize(end-begin);
+    for (Uint e=begin; e<end; ++e)
+    {
+      gather_nodes(connectivity[e],coordinates,nodes);
+      areas[e-begin] = ETYPE::area(nodes);
+    }
+  }
+
+  virtual void compute_centroids(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                                 const Uint begin, const Uint end, RealMatrix& centroids) const
+  {
+    typename ETYPE::NodesT nodes;
+    typename ETYPE::CoordsT centroid;
+    centroids.resize(end-begin,ETYPE::dimension);
+    for (Uint e=begin; e<end; ++e)
+    {
+      gather_nodes(connectivity[e],coordinates,nodes);
+      ETYPE::compute_centroid(nodes,centroid);
+      centroids.row(e-begin) = centroid.transpose();
+    }
+  }
+
+  virtual void compute_normals(const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                               const Uint begin, const Uint end, RealMatrix& normals) const
+  {
+    typename ETYPE::NodesT nodes;
+    typename ETYPE::CoordsT normal;
+    normals.resize(end-begin,ETYPE::dimension);
+    for (Uint e=begin; e<end; ++e)
+    {
+      gather_nodes(connectivity[e],coordinates,nodes);
+      ETYPE::compute_normal(nodes,normal);
+      normals.row(e-begin) = normal.transpose();
+    }
+  }
+
+  virtual void compute_jacobian_determinants(const RealVector& mapped_coord,
+                                             const common::Table<Uint>& connectivity, const common::Table<Real>& coordinates,
+                                             const Uint begin, const Uint end, RealVector& determinants) const
+  {
+    const typename ETYPE::MappedCoordsT mapped_c(mapped_coord);
+    typename ETYPE::NodesT nodes;
+    determinants.resize(end-begin);
+    for (Uint e=begin; e<end; ++e)
+    {
+      gather_nodes(connectivity[e],coordinates,nodes);
+      determinants[e-begin] = ETYPE::jacobian_determinant(mapped_c,nodes);
+    }
+  }
+
+  //@}
+
 private:
+
+  /// Copy the coordinates of the nodes of one element in a fixed-size matrix
+  static void gather_nodes(const common::Table<Uint>::ConstRow& element_nodes, const common::Table<Real>& coordinates, typename ETYPE::NodesT& nodes)
+  {
+    for (Uint n=0; n<ETYPE::nb_nodes; ++n)
+    {
+      const common::Table<Real>::ConstRow node_coordinates = coordinates[element_nodes[n]];
+      for (Uint d=0; d<ETYPE::dimension; ++d)
+        nodes(n,d) = node_coordinates[d];
+    }
+  }
+
   Handle< ShapeFunction > m_sf;
 };
 
@@ -17,6 +17,7 @@
 #include "math/Consts.hpp"
 
 #include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/FaceHashTable.hpp"
 #include "mesh/NodeElementConnectivity.hpp"
 #include "mesh/Dictionary.hpp"
 #include "mesh/Mesh.hpp"
@@ -127,7 +128,6 @@ void FaceCellConnectivity::build_connectivity()
   common::List<bool>::Buffer is_bdry_face = m_is_bdry_face->create_buffer();
   Dictionary& geometry_fields = find_parent_component<Mesh>(*used()[0]).geometry_fields();
   Uint tot_nb_nodes = geometry_fields.size();
-  std::vector < std::vector<Uint> > mapNodeFace(tot_nb_nodes);
   std::vector<Uint> face_nodes;  face_nodes.reserve(100);
   std::vector<Entity> dummy_element_row(2);
   std::vector<Uint> dummy_idx_row(2);
@@ -165,18 +165,13 @@ void FaceCellConnectivity::build_connectivity()
     }
   }
 
+  // Faces found so far, identified by their nodes
+  FaceHashTable face_table;
+  face_table.reserve(max_nb_faces);
+
   // Declarations to save frequent allocations in the loop algorithm
   Uint nb_inner_faces = 0;
-  Uint nb_matched_nodes = 1;
-  Uint face_node_idx;
-  Uint face_node;
-  Uint face;
-  Uint connected_face;
-  Uint node;
   Uint nb_nodes;
-  bool found_face = false;
-  Handle< Component > elem_location_comp;
-  Uint elem_location_idx;
 
   // loop over the element types
   m_nb_faces=0;
@@ -208,81 +203,29 @@ void FaceCellConnectivity::build_connectivity()
         face_nodes.resize(nb_nodes);
         Uint i(0);
         boost_foreach(const Uint face_node_idx, elements.element_type().faces().nodes_range(face_idx))
-            face_nodes[i++] = elem_nodes[face_node_idx];
-
-
-        // consider the first node belonging to the current face
-        // check if you find a face ID shared between all the other
-        // nodes building a face
-        node = face_nodes[0];
-        cf3_assert(node<tot_nb_nodes);
+        {
+          cf3_assert(elem_nodes[face_node_idx]<tot_nb_nodes);
+          face_nodes[i++] = elem_nodes[face_node_idx];
+        }
 
-        found_face = false;
-        // search for matching face if they are registered to the node yet
-        boost_foreach( face, mapNodeFace[node] )
+        const Uint face = face_table.insert(face_nodes);
+        if (face != m_nb_faces)
         {
-          nb_matched_nodes = 1;
-          if (nb_nodes > 1)
-          {
-            for (face_node_idx=1; face_node_idx!=nb_nodes; ++face_node_idx)
-            {
-              boost_foreach (connected_face, mapNodeFace[face_nodes[face_node_idx]])
-              {
-                if (connected_face == face)
-                {
-                  ++nb_matched_nodes;
-                  break;
-                }
-              }
-
-
-              if (nb_matched_nodes == nb_nodes) // face matches the nodes
-              {
-                // the corresponding face already exists, meaning
-                // that the face is an internal one, shared by two elements
-                // here you set the second element (==state) neighbor of the face
-                found_face = true;
-                //(*m_connectivity)[elemID][iFace] = currFaceID;
-                f2c.get_row(face)[1]=element;
-                face_number.get_row(face)[1]=face_idx;
-                is_bdry_face.get_row(face)=false;
-                // since it has two neighbor cells,
-                // this face is surely NOT a boundary face
-                // m_isBFace[currFaceID] = false;
-
-                // increment number of inner faces (they always have 2 states)
-                ++nb_inner_faces;
-                break;
-              }
-            }
-          }
-          else // this only applies to the 1D case
-          {
-            // the corresponding faceID already exists, meaning
-            // that the face is an internal one, shared by two elements
-            // here you set the second element (==state) neighbor of the face
-            found_face = true;
-            //(*elem_to_face)[elemID][iFace] = currFaceID;
-            f2c.get_row(face)[1]=element;
-            face_number.get_row(face)[1]=face_idx;
-            is_bdry_face.get_row(face)=false;
-
-            // increment number of inner faces (they always have 2 states)
-            ++nb_inner_faces;
-            break;
-          }
+          // the corresponding face already exists, meaning
+          // that the face is an internal one, shared by two elements
+          // here you set the second element (==state) neighbor of the face
+          f2c.get_row(face)[1]=element;
+          face_number.get_row(face)[1]=face_idx;
+          // since it has two neighbor cells,
+          // this face is surely NOT a boundary face
+          is_bdry_face.get_row(face)=false;
+
+          // increment number of inner faces (they always have 2 states)
+          ++nb_inner_faces;
         }
-        if (found_face == false)
+        else
         {
-          // a new face has been found
-          // add the ID of the new face in the corresponding nodes
-          // referencing it
-          boost_foreach (face_node, face_nodes)
-          {
-            mapNodeFace[face_node].push_back(m_nb_faces);
-          }
-
-          // increment the number of faces
+          // a new face has been found, increment the number of faces
           dummy_element_row[0]=element;
           f2c.add_row(dummy_element_row);
 
@@ -0,0 +1,105 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/functional/hash.hpp>
+
+#include "math/Consts.hpp"
+
+#include "mesh/FaceHashTable.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+const Uint FaceHashTable::not_found = math::Consts::uint_max();
+
+////////////////////////////////////////////////////////////////////////////////
+
+FaceHashTable::FaceHashTable() :
+  m_offsets(1, 0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void FaceHashTable::reserve(const Uint nb_faces)
+{
+  m_offsets.reserve(nb_faces+1);
+  m_hashes.reserve(nb_faces);
+  if(2*nb_faces > m_slots.size())
+    rehash(nb_faces);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void FaceHashTable::clear()
+{
+  std::vector<Uint>().swap(m_nodes);
+  std::vector<Uint>(1, 0).swap(m_offsets);
+  std::vector<std::size_t>().swap(m_hashes);
+  std::vector<Uint>().swap(m_slots);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t FaceHashTable::hash_nodes(const Uint* sorted, const Uint nb_nodes)
+{
+  std::size_t seed = boost::hash_range(sorted, sorted + nb_nodes);
+  // mix the bits, since only the lowest bits select the slot
+  seed ^= seed >> 16;
+  seed *= 0x85ebca6bu;
+  seed ^= seed >> 13;
+  seed *= 0xc2b2ae35u;
+  seed ^= seed >> 16;
+  return seed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint FaceHashTable::find_slot(const Uint* sorted, const Uint nb_nodes, const std::size_t hash) const
+{
+  const Uint mask = m_slots.size()-1;
+  Uint slot = hash & mask;
+  while(true)
+  {
+    const Uint face = m_slots[slot];
+    if(face == not_found)
+      return slot;
+    if(m_hashes[face] == hash
+       && m_offsets[face+1]-m_offsets[face] == nb_nodes
+       && std::equal(sorted, sorted + nb_nodes, m_nodes.begin() + m_offsets[face]))
+      return slot;
+    slot = (slot+1) & mask;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void FaceHashTable::rehash(const Uint nb_faces)
+{
+  Uint nb_slots = 16;
+  while(nb_slots < 2*nb_faces)
+    nb_slots *= 2;
+
+  m_slots.assign(nb_slots, not_found);
+  const Uint mask = nb_slots-1;
+  for(Uint face = 0; face != size(); ++face)
+  {
+    // all faces are distinct, so only an empty slot needs to be found
+    Uint slot = m_hashes[face] & mask;
+    while(m_slots[slot] != not_found)
+      slot = (slot+1) & mask;
+    m_slots[slot] = face;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,131 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_FaceHashTable_hpp
+#define cf3_mesh_FaceHashTable_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <vector>
+
+#include "common/Assertions.hpp"
+#include "mesh/LibMesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Hash table of faces, where a face is identified by its set of nodes,
+/// independent of the order of the nodes.
+/// Faces are numbered in order of insertion. Each face is stored as its sorted
+/// node indices with a precomputed hash, and looked up in an open-addressing table,
+/// so matching faces costs O(1) per face and needs no node-to-face connectivity.
+/// find() does not modify the table, and can be called concurrently from several threads.
+class Mesh_API FaceHashTable
+{
+public:
+
+  /// Maximum number of nodes in a face
+  enum { MAX_FACE_NODES = 32 };
+
+  /// Returned by find() if the face is not in the table
+  static const Uint not_found;
+
+  FaceHashTable();
+
+  /// Reserve memory for the given number of faces
+  void reserve(const Uint nb_faces);
+
+  /// Remove all faces
+  void clear();
+
+  /// Number of faces in the table
+  Uint size() const { return m_hashes.size(); }
+
+  /// Insert a face, unless a face with the same nodes is already present
+  /// @param nodes Nodes of the face, in any order
+  /// @return The index of the existing face with the same nodes, or size()-1 if the face was inserted
+  template<typename RowT>
+  Uint insert(const RowT& nodes)
+  {
+    Uint sorted[MAX_FACE_NODES];
+    const Uint nb_nodes = sort_nodes(nodes, sorted);
+    const std::size_t hash = hash_nodes(sorted, nb_nodes);
+
+    if(2*(size()+1) > m_slots.size())
+      rehash(2*size());
+
+    const Uint slot = find_slot(sorted, nb_nodes, hash);
+    if(m_slots[slot] != not_found)
+      return m_slots[slot];
+
+    m_nodes.insert(m_nodes.end(), sorted, sorted + nb_nodes);
+    m_offsets.push_back(m_nodes.size());
+    m_hashes.push_back(hash);
+    m_slots[slot] = size()-1;
+    return size()-1;
+  }
+
+  /// Find the face with the same nodes
+  /// @param nodes Nodes of the face, in any order
+  /// @return The index of the face, or not_found
+  template<typename RowT>
+  Uint find(const RowT& nodes) const
+  {
+    if(m_slots.empty())
+      return not_found;
+
+    Uint sorted[MAX_FACE_NODES];
+    const Uint nb_nodes = sort_nodes(nodes, sorted);
+    return m_slots[find_slot(sorted, nb_nodes, hash_nodes(sorted, nb_nodes))];
+  }
+
+private: // functions
+
+  /// Copy the nodes into sorted, and sort them
+  /// @return the number of nodes
+  template<typename RowT>
+  static Uint sort_nodes(const RowT& nodes, Uint* sorted)
+  {
+    const Uint nb_nodes = nodes.size();
+    cf3_assert(nb_nodes <= MAX_FACE_NODES);
+    std::copy(nodes.begin(), nodes.end(), sorted);
+    std::sort(sorted, sorted + nb_nodes);
+    return nb_nodes;
+  }
+
+  static std::size_t hash_nodes(const Uint* sorted, const Uint nb_nodes);
+
+  /// Slot holding the face with the given sorted nodes, or the empty slot where it would be inserted
+  Uint find_slot(const Uint* sorted, const Uint nb_nodes, const std::size_t hash) const;
+
+  /// Rebuild the slots for at least nb_faces faces
+  void rehash(const Uint nb_faces);
+
+private: // data
+
+  /// Sorted nodes of all faces, stored face after face
+  std::vector<Uint> m_nodes;
+  /// Start of each face in m_nodes, with size()+1 entries
+  std::vector<Uint> m_offsets;
+  /// Hash of each face
+  std::vector<std::size_t> m_hashes;
+  /// Face index for each slot, or not_found. The number of slots is a power of two.
+  std::vector<Uint> m_slots;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_FaceHashTable_hpp
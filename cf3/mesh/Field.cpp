@@ -180,6 +180,22 @@ void Field::synchronize()
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+void Field::start_synchronize()
+{
+  if ( is_not_null(m_comm_pattern) )
+    m_comm_pattern->start_synchronize( name() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Field::finish_synchronize()
+{
+  if ( is_not_null(m_comm_pattern) )
+    m_comm_pattern->finish_synchronize();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void Field::set_descriptor(math::VariablesDescriptor& descriptor)
@@ -201,5 +217,33 @@ void Field::create_descriptor(const std::string& description, const Uint dimensi
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+void synchronize_fields(const std::vector< Handle<Field> >& fields)
+{
+  // group the field names per comm pattern, keeping the order in which the fields are given,
+  // since packing and unpacking must happen in the same order on all ranks
+  std::vector< std::pair< Handle<CommPattern>, std::vector<std::string> > > groups;
+  boost_foreach(const Handle<Field>& field, fields)
+  {
+    if ( is_null(field) || is_null(field->comm_pattern()) )
+      continue;
+
+    Uint g=0;
+    for( ; g<groups.size(); ++g)
+      if (groups[g].first == field->comm_pattern())
+        break;
+    if (g==groups.size())
+      groups.push_back(std::make_pair(field->comm_pattern(),std::vector<std::string>()));
+    groups[g].second.push_back(field->name());
+  }
+
+  // post all exchanges before waiting for any of them
+  for(Uint g=0; g<groups.size(); ++g)
+    groups[g].first->start_synchronize(groups[g].second);
+  for(Uint g=0; g<groups.size(); ++g)
+    groups[g].first->finish_synchronize();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
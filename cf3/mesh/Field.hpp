@@ -26,6 +26,7 @@ namespace math { class VariablesDescriptor; }
 namespace mesh {
 
   class Region;
+  namespace field_expression { template <typename E> struct Expression; }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -118,6 +119,16 @@ public: // functions
 
   void synchronize();
 
+  /// Post the ghost exchange of this field without waiting for it, so interior work can overlap with communication
+  /// @pre no other exchange is pending on the comm pattern of the dictionary
+  void start_synchronize();
+
+  /// Wait for the exchange started by start_synchronize and update the ghost values
+  void finish_synchronize();
+
+  /// Comm pattern this field is synchronized with, null if the field is not parallelized
+  const Handle<common::PE::CommPattern>& comm_pattern() const { return m_comm_pattern; }
+
   math::VariablesDescriptor& descriptor() const { return *m_descriptor; }
 
   void set_descriptor(math::VariablesDescriptor& descriptor);
@@ -175,6 +186,11 @@ public: // functions
       return *this;
     }
 
+    /// U = expression, evaluated in a single pass
+    /// @note defined in mesh/FieldExpression.hpp, which provides the operators building expressions
+    template <typename E>
+    Field& operator =(const field_expression::Expression<E>& expr);
+
     /// U += c
     Field& operator +=(const Real& c)
     {
@@ -307,6 +323,13 @@ private:
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Synchronize a set of fields, batching the fields sharing a comm pattern
+/// into a single exchange with one message per neighbouring rank
+/// @param fields the fields to synchronize, null handles are skipped
+void Mesh_API synchronize_fields(const std::vector< Handle<Field> >& fields);
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
 
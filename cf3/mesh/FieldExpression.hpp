@@ -0,0 +1,295 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_FieldExpression_hpp
+#define cf3_mesh_FieldExpression_hpp
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/ParallelFor.hpp"
+#include "common/StringConversion.hpp"
+
+#include "mesh/Field.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Expression templates for fused, element-wise Field arithmetic
+///
+/// An expression such as
+/// @code U = U0 + H * ( 0.5*R0 + 0.5*R1 ); @endcode
+/// builds a tree of lightweight nodes, and is evaluated in a single pass over the rows of U,
+/// without temporary fields. Fields with a row size of 1 are scalar fields: they are broadcast
+/// over the variables of the other operand, as in Field::operator*=(const Field&). Other fields
+/// must have the row size of the assigned field.
+/// Sums with a number of terms only known at runtime use LinearCombination.
+///
+/// The evaluation can be split over threads with assign(). The right-hand side may contain
+/// the assigned field itself, as every entry only depends on the same entry of the operands.
+namespace field_expression {
+
+static const Uint min_rows_per_thread = 4096;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Base of all expression nodes, E is the node type itself
+template <typename E>
+struct Expression
+{
+  const E& derived() const { return static_cast<const E&>(*this); }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Leaf referring to the entries of a field
+struct Terminal : Expression<Terminal>
+{
+  Terminal(const Field& field) :
+    data(field.array().data()),
+    nb_rows(field.size()),
+    stride(field.row_size()),
+    col_stride(field.row_size() == 1 ? 0u : 1u)
+  {}
+
+  Real operator()(const Uint i, const Uint j) const { return data[i*stride + j*col_stride]; }
+
+  Uint rows() const { return nb_rows; }
+
+  /// Throw if the field can not be evaluated into a field of the given size
+  void check(const Uint rows, const Uint row_size) const
+  {
+    if (nb_rows != rows)
+      throw common::BadValue(FromHere(), "Field expression operand has " + common::to_str(nb_rows) + " rows, expected " + common::to_str(rows));
+    if (stride != 1 && stride != row_size)
+      throw common::BadValue(FromHere(), "Field expression operand has row size " + common::to_str(stride) + ", expected 1 or " + common::to_str(row_size));
+  }
+
+  const Real* data;
+  Uint nb_rows;
+  Uint stride;
+  Uint col_stride;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Sum of a runtime number of scaled fields, sum( c_k * F_k )
+struct LinearCombination : Expression<LinearCombination>
+{
+  /// @param rows number of rows of the fields, an empty combination evaluates to zero
+  explicit LinearCombination(const Uint rows) : nb_rows(rows) {}
+
+  /// Add the term coeff*field, terms with a zero coefficient are skipped
+  void add(const Real coeff, const Field& field)
+  {
+    cf3_assert(field.size() == nb_rows);
+    if (coeff == 0.)
+      return;
+    coeffs.push_back(coeff);
+    terms.push_back(Terminal(field));
+  }
+
+  Real operator()(const Uint i, const Uint j) const
+  {
+    Real result = 0.;
+    const Uint nb_terms = terms.size();
+    for (Uint k=0; k<nb_terms; ++k)
+      result += coeffs[k] * terms[k](i,j);
+    return result;
+  }
+
+  Uint rows() const { return nb_rows; }
+
+  void check(const Uint rows, const Uint row_size) const
+  {
+    if (nb_rows != rows)
+      throw common::BadValue(FromHere(), "Linear combination has " + common::to_str(nb_rows) + " rows, expected " + common::to_str(rows));
+    const Uint nb_terms = terms.size();
+    for (Uint k=0; k<nb_terms; ++k)
+      terms[k].check(rows, row_size);
+  }
+
+  std::vector<Real> coeffs;
+  std::vector<Terminal> terms;
+  Uint nb_rows;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Constant times an expression
+template <typename E>
+struct Scaled : Expression< Scaled<E> >
+{
+  Scaled(const Real c, const E& e) : coeff(c), expr(e) {}
+
+  Real operator()(const Uint i, const Uint j) const { return coeff * expr(i,j); }
+
+  Uint rows() const { return expr.rows(); }
+
+  void check(const Uint rows, const Uint row_size) const { expr.check(rows, row_size); }
+
+  Real coeff;
+  E expr;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+struct Plus       { static Real apply(const Real a, const Real b) { return a + b; } };
+struct Minus      { static Real apply(const Real a, const Real b) { return a - b; } };
+struct Multiplies { static Real apply(const Real a, const Real b) { return a * b; } };
+struct Divides    { static Real apply(const Real a, const Real b) { return a / b; } };
+
+/// Element-wise binary operation OP on two expressions
+template <typename L, typename R, typename OP>
+struct Binary : Expression< Binary<L,R,OP> >
+{
+  Binary(const L& l, const R& r) : lhs(l), rhs(r) {}
+
+  Real operator()(const Uint i, const Uint j) const { return OP::apply(lhs(i,j), rhs(i,j)); }
+
+  Uint rows() const { return lhs.rows(); }
+
+  void check(const Uint rows, const Uint row_size) const
+  {
+    lhs.check(rows, row_size);
+    rhs.check(rows, row_size);
+  }
+
+  L lhs;
+  R rhs;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Evaluate the rows [begin,end) of the expression into the field
+template <typename E>
+void assign_range(Field& result, const E& expr, const Uint begin, const Uint end)
+{
+  Real* data = result.array().data();
+  const Uint row_size = result.row_size();
+  for (Uint i=begin; i<end; ++i)
+  {
+    Real* row = data + i*row_size;
+    for (Uint j=0; j<row_size; ++j)
+      row[j] = expr(i,j);
+  }
+}
+
+/// Evaluate the expression into the field in a single pass, split over nb_threads threads
+/// @throw common::BadValue if an operand does not have the rows of the field, or a row size other than 1 or that of the field
+template <typename E>
+void assign(Field& result, const Expression<E>& expression, const Uint nb_threads = 1)
+{
+  const E& expr = expression.derived();
+  expr.check(result.size(), result.row_size());
+  common::parallel_for(result.size(), nb_threads, min_rows_per_thread,
+                       boost::bind(&assign_range<E>, boost::ref(result), boost::cref(expr), _1, _2));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @name Operators building Field expressions
+/// The operators taking an expression are found through argument dependent lookup.
+//@{
+
+#define CF3_FIELD_EXPRESSION_BINARY_OPERATOR(OPERATOR, OP)                                                   \
+template <typename R>                                                                                         \
+Binary<Terminal, R, OP> OPERATOR(const Field& lhs, const Expression<R>& rhs)                                  \
+{                                                                                                             \
+  return Binary<Terminal, R, OP>(lhs, rhs.derived());                                                         \
+}                                                                                                             \
+template <typename L>                                                                                         \
+Binary<L, Terminal, OP> OPERATOR(const Expression<L>& lhs, const Field& rhs)                                  \
+{                                                                                                             \
+  return Binary<L, Terminal, OP>(lhs.derived(), rhs);                                                         \
+}                                                                                                             \
+template <typename L, typename R>                                                                             \
+Binary<L, R, OP> OPERATOR(const Expression<L>& lhs, const Expression<R>& rhs)                                 \
+{                                                                                                             \
+  return Binary<L, R, OP>(lhs.derived(), rhs.derived());                                                      \
+}
+
+CF3_FIELD_EXPRESSION_BINARY_OPERATOR(operator +, Plus)
+CF3_FIELD_EXPRESSION_BINARY_OPERATOR(operator -, Minus)
+CF3_FIELD_EXPRESSION_BINARY_OPERATOR(operator *, Multiplies)
+CF3_FIELD_EXPRESSION_BINARY_OPERATOR(operator /, Divides)
+
+#undef CF3_FIELD_EXPRESSION_BINARY_OPERATOR
+
+/// c * expression
+template <typename E>
+Scaled<E> operator *(const Real c, const Expression<E>& expr)
+{
+  return Scaled<E>(c, expr.derived());
+}
+
+//@}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // field_expression
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename E>
+Field& Field::operator =(const field_expression::Expression<E>& expr)
+{
+  field_expression::assign(*this, expr);
+  return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @name Operators building Field expressions from fields only
+//@{
+
+/// U + U
+inline field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Plus>
+operator +(const Field& lhs, const Field& rhs)
+{
+  return field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Plus>(lhs, rhs);
+}
+
+/// U - U
+inline field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Minus>
+operator -(const Field& lhs, const Field& rhs)
+{
+  return field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Minus>(lhs, rhs);
+}
+
+/// U * U (row-wise)
+inline field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Multiplies>
+operator *(const Field& lhs, const Field& rhs)
+{
+  return field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Multiplies>(lhs, rhs);
+}
+
+/// U / U (row-wise)
+inline field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Divides>
+operator /(const Field& lhs, const Field& rhs)
+{
+  return field_expression::Binary<field_expression::Terminal, field_expression::Terminal, field_expression::Divides>(lhs, rhs);
+}
+
+/// c * U
+inline field_expression::Scaled<field_expression::Terminal> operator *(const Real c, const Field& U)
+{
+  return field_expression::Scaled<field_expression::Terminal>(c, U);
+}
+
+//@}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+#endif // cf3_mesh_FieldExpression_hpp
@@ -13,6 +13,7 @@
 #include "common/Builder.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
+#include "common/ParallelFor.hpp"
 #include "common/Signal.hpp"
 #include "common/XML/SignalOptions.hpp"
 #include "common/PE/debug.hpp"
@@ -35,12 +36,22 @@ common::ComponentBuilder<Interpolator,AInterpolator,LibMesh> Interpolator_builde
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Interpolator::Interpolator(const std::string &name) : AInterpolator(name)
+static const Uint min_rows_per_thread=1024;
+
+////////////////////////////////////////////////////////////////////////////////
+
+Interpolator::Interpolator(const std::string &name) : AInterpolator(name),
+  m_nb_threads(1)
 {
   options().add("store", false)
       .description("Flag to store weights and stencils used for faster interpolation in the future")
       .pretty_name("Store");
 
+  options().add("nb_threads", m_nb_threads)
+      .description("Number of threads used for stored interpolation")
+      .pretty_name("Number of Threads")
+      .link_to(&m_nb_threads);
+
   m_point_interpolator = Handle<APointInterpolator>(create_component<PointInterpolator>("point_interpolator"));
 }
 
@@ -88,16 +99,13 @@ void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coord
 
   m_proc.clear();
   m_expect_recv.clear();
-  m_stored_element.clear();
-  m_stored_stencil.clear();
-  m_stored_source_field_points.clear();
-  m_stored_source_field_weights.clear();
 
   m_expect_recv.resize(PE::Comm::instance().size());
-  m_stored_element.resize(PE::Comm::instance().size());
-  m_stored_stencil.resize(PE::Comm::instance().size());
-  m_stored_source_field_points.resize(PE::Comm::instance().size());
-  m_stored_source_field_weights.resize(PE::Comm::instance().size());
+
+  // Stencil sizes, source points and weights of the points interpolated for each processor
+  std::vector< std::vector<Uint> > stencil_sizes(PE::Comm::instance().size());
+  std::vector< std::vector<Uint> > stencil_points(PE::Comm::instance().size());
+  std::vector< std::vector<Real> > stencil_weights(PE::Comm::instance().size());
 
 
   // Now find missing on other procs.
@@ -129,15 +137,7 @@ void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coord
 
     // Find interpolated
 
-    m_stored_element[pid_recv_coords].clear();
-    m_stored_stencil[pid_recv_coords].clear();
-    m_stored_source_field_points[pid_recv_coords].clear();
-    m_stored_source_field_weights[pid_recv_coords].clear();
-
-    m_stored_element[pid_recv_coords].reserve(nb_received_coords);
-    m_stored_stencil[pid_recv_coords].reserve(nb_received_coords);
-    m_stored_source_field_points[pid_recv_coords].reserve(nb_received_coords);
-    m_stored_source_field_weights[pid_recv_coords].reserve(nb_received_coords);
+    stencil_sizes[pid_recv_coords].reserve(nb_received_coords);
 
     std::vector<Uint> send_found_coords;  send_found_coords.reserve(nb_received_coords);
 
@@ -160,10 +160,10 @@ void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coord
 
       if (interpolation_possible_on_this_proc)
       {
-        m_stored_element[pid_recv_coords].push_back(element);
-        m_stored_stencil[pid_recv_coords].push_back(stencil);
-        m_stored_source_field_points[pid_recv_coords].push_back(points);
-        m_stored_source_field_weights[pid_recv_coords].push_back(weights);
+        cf3_assert(points.size() == weights.size());
+        stencil_sizes[pid_recv_coords].push_back(points.size());
+        stencil_points[pid_recv_coords].insert(stencil_points[pid_recv_coords].end(), points.begin(), points.end());
+        stencil_weights[pid_recv_coords].insert(stencil_weights[pid_recv_coords].end(), weights.begin(), weights.end());
 
         // mark found
         send_found_coords.push_back(t);
@@ -197,63 +197,79 @@ void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coord
         not_found.push_back(t);
     }
   }
+
+  // Compile the stencils in the interpolation operator, rows ordered by requesting processor
+  m_row_offsets.assign(1,0u);
+  m_columns.clear();
+  m_weights.clear();
+  m_send_counts.resize(PE::Comm::instance().size());
+  m_recv_counts.resize(PE::Comm::instance().size());
+  for (Uint pid=0; pid<PE::Comm::instance().size(); ++pid)
+  {
+    boost_foreach(const Uint stencil_size, stencil_sizes[pid])
+      m_row_offsets.push_back(m_row_offsets.back()+stencil_size);
+    m_columns.insert(m_columns.end(), stencil_points[pid].begin(), stencil_points[pid].end());
+    m_weights.insert(m_weights.end(), stencil_weights[pid].begin(), stencil_weights[pid].end());
+    m_send_counts[pid] = stencil_sizes[pid].size();
+    m_recv_counts[pid] = m_expect_recv[pid].size();
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void Interpolator::stored_interpolation(const Field& source_field, Table<Real>& target)
 {
-  // Do interpolation on processors that can do the interpolation,
-  // and send back an array of interpolated values
-  for (Uint pid=0; pid<PE::Comm::instance().size(); pid++)
+  // number of variables for each point to be interpolated
+  const Uint nb_vars = m_source_vars.size();
+
+  // Interpolate all points requested from this processor
+  const Uint nb_rows = m_row_offsets.size()-1;
+  m_send_buffer.resize(std::max(nb_rows*nb_vars,1u));
+  common::parallel_for(nb_rows,m_nb_threads,min_rows_per_thread,
+                       boost::bind(&Interpolator::interpolate_rows,this,boost::cref(source_field),_1,_2));
+
+  // Send the interpolated values to the processors that requested them, in one exchange
+  const std::vector<Real>* received = &m_send_buffer;
+  if (PE::Comm::instance().size() > 1)
   {
-    // Trade my requests with processor send and recv
-    const Uint pid_send_interpolated = (PE::Comm::instance().size() + PE::Comm::instance().rank() - pid) %
-                                        PE::Comm::instance().size();
-    const Uint pid_recv_interpolated = (PE::Comm::instance().rank() + pid) %
-                                        PE::Comm::instance().size();
-
-    // number of points to be interpolated
-    const Uint nb_points = m_stored_element[pid_send_interpolated].size();
-
-    // number of variables for each point to be interpolated
-    const Uint nb_vars = m_source_vars.size();
-
-    // storage for interpolated variables, which will be sent to the pid that reqests it (pid_recv_interpolated)
-    std::vector<Real> interpolated; interpolated.reserve(nb_points*nb_vars);
-
-    // Interpolation points and weights
-    const std::vector< std::vector<Uint> >& s_points  = m_stored_source_field_points[pid_send_interpolated];
-    const std::vector< std::vector<Real> >& s_weights = m_stored_source_field_weights[pid_send_interpolated];
+    Uint nb_recv = 0;
+    boost_foreach(const int count, m_recv_counts)
+      nb_recv += count;
+    m_recv_buffer.resize(std::max(nb_recv*nb_vars,1u));
+    PE::Comm::instance().all_to_all(&m_send_buffer[0], &m_send_counts[0], &m_recv_buffer[0], &m_recv_counts[0], nb_vars);
+    received = &m_recv_buffer;
+  }
 
-    // Do interpolation
-    for (Uint t=0; t<nb_points; ++t)
+  // Fill the target with the received interpolated variables, ordered by processor
+  Uint it=0;
+  for (Uint pid=0; pid<PE::Comm::instance().size(); ++pid)
+  {
+    boost_foreach( const Uint t, m_expect_recv[pid] )
     {
+      cf3_assert(t<target.size());
       for (Uint v=0; v<nb_vars; ++v)
-      {
-        interpolated.push_back(0.);
-        for (Uint s=0; s<s_points[t].size(); ++s)
-        {
-          cf3_assert(s_points[t][s]<source_field.size());
-          interpolated.back() += source_field[ s_points[t][s] ][ m_source_vars[v] ] * s_weights[t][s];
-        }
-      }
+        target[t][ m_target_vars[v] ] = (*received)[it++];
     }
+  }
+}
 
-    // Send/Receive interpolated variables
-    std::vector<Real> recv_interpolated;
-    Interpolator_send_receive(pid_send_interpolated   , interpolated,
-                              pid_recv_interpolated   , recv_interpolated);
+////////////////////////////////////////////////////////////////////////////////
 
-    // Fill the target_field with received interpolated variables from requested processor
-    Uint it=0;
-    boost_foreach( const Uint t, m_expect_recv[pid_recv_interpolated] )
+void Interpolator::interpolate_rows(const Field& source_field, const Uint begin, const Uint end)
+{
+  const Uint nb_vars = m_source_vars.size();
+  for (Uint r=begin; r<end; ++r)
+  {
+    Real* interpolated = &m_send_buffer[r*nb_vars];
+    for (Uint v=0; v<nb_vars; ++v)
+      interpolated[v] = 0.;
+    for (Uint k=m_row_offsets[r]; k<m_row_offsets[r+1]; ++k)
     {
+      cf3_assert(m_columns[k]<source_field.size());
+      const Table<Real>::ConstRow source = source_field[ m_columns[k] ];
+      const Real weight = m_weights[k];
       for (Uint v=0; v<nb_vars; ++v)
-      {
-        cf3_assert(t<target.size());
-        target[t][ m_target_vars[v] ] = recv_interpolated[it++];
-      }
+        interpolated[v] += source[ m_source_vars[v] ] * weight;
     }
   }
 }
@@ -56,10 +56,17 @@ public: // functions
 
 private: // functions
 
+  /// Find the stencils and weights of all target coordinates, and compile them in the
+  /// interpolation operator and the communication plan
   void store(const Dictionary& dict, const common::Table<Real>& target_coords);
 
+  /// Apply the stored interpolation operator to all variables at once,
+  /// followed by a single exchange of the interpolated values
   void stored_interpolation(const Field& source_field, common::Table<Real>& target);
 
+  /// Interpolate the rows [begin,end) of the stored interpolation operator in the send buffer
+  void interpolate_rows(const Field& source_field, const Uint begin, const Uint end);
+
   void unstored_interpolation(const Field& source_field, const common::Table<Real>& target_coords, common::Table<Real>& target);
 
 protected: // data
@@ -79,10 +86,23 @@ private: // data
   // Values for each processor
   std::vector< int                                   > m_proc;
   std::vector< std::vector< Uint                   > > m_expect_recv;
-  std::vector< std::vector< SpaceElem              > > m_stored_element;
-  std::vector< std::vector< std::vector<SpaceElem> > > m_stored_stencil;
-  std::vector< std::vector< std::vector<Uint>      > > m_stored_source_field_points;
-  std::vector< std::vector< std::vector<Real>      > > m_stored_source_field_weights;
+
+  // Interpolation operator in compressed row storage. Every row interpolates one point
+  // requested by a processor, from the local source points m_columns[m_row_offsets[r]] to
+  // m_columns[m_row_offsets[r+1]-1] with the matching m_weights.
+  // Rows are ordered by requesting processor.
+  std::vector<Uint> m_row_offsets;
+  std::vector<Uint> m_columns;
+  std::vector<Real> m_weights;
+
+  // Communication plan, reused for every stored interpolation
+  std::vector<int> m_send_counts;   ///< number of rows interpolated for each processor
+  std::vector<int> m_recv_counts;   ///< number of points interpolated by each processor
+  std::vector<Real> m_send_buffer;  ///< interpolated values, one row of all variables per point
+  std::vector<Real> m_recv_buffer;  ///< received interpolated values
+
+  /// Number of threads used to apply the interpolation operator
+  Uint m_nb_threads;
 
   // store variable indices in table rows
   std::vector<Uint> m_source_vars;
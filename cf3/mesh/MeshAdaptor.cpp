@@ -11,6 +11,8 @@
 
 #include "common/Log.hpp"
 #include "common/FindComponents.hpp"
+#include "common/CompressedTable.hpp"
+#include "common/HashMap.hpp"
 #include "common/Map.hpp"
 #include "common/PropertyList.hpp"
 
@@ -33,6 +35,7 @@
 #include "mesh/Region.hpp"
 #include "mesh/MeshElements.hpp"
 #include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/Tags.hpp"
 
 namespace cf3 {
 namespace mesh {
@@ -210,6 +213,8 @@ void MeshAdaptor::finish()
   restore_element_node_connectivity();
   cf3_assert( ! is_node_connectivity_global );
 
+  clear_connectivity_caches();
+
   m_mesh->raise_mesh_changed();
 
   // Change following flags as "raise_mesh_changed" took care of this
@@ -219,6 +224,19 @@ void MeshAdaptor::finish()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void MeshAdaptor::clear_connectivity_caches()
+{
+  // Collect first, since removing invalidates the range
+  std::vector< Handle<Component> > caches;
+  boost_foreach(Component& cache, find_components_recursively_with_tag(*m_mesh, mesh::Tags::connectivity_cache()))
+    caches.push_back(cache.handle());
+
+  boost_foreach(const Handle<Component>& cache, caches)
+    cache->parent()->remove_component(*cache);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void MeshAdaptor::create_element_buffers()
 {
   clear_element_buffers();
@@ -351,7 +369,7 @@ void MeshAdaptor::restore_element_node_connectivity()
         //PECheckPoint(100,space->dict().uri());
         //PECheckPoint(100,"global connectivity = \n"<<space->connectivity());
         //PECheckPoint(100,"global nodes = \n"<<space->dict().glb_idx());
-        const common::Map<boost::uint64_t,Uint>& glb_to_loc = space->dict().glb_to_loc();
+        const common::HashMap<boost::uint64_t,Uint>& glb_to_loc = space->dict().glb_to_loc();
         boost_foreach ( Connectivity::Row nodes, space->connectivity().array() )
         {
           boost_foreach ( Uint& node, nodes )
@@ -780,7 +798,7 @@ void MeshAdaptor::send_nodes(const std::vector< std::vector< std::vector<Uint> >
       received_glb_nodes_pid[recv_pid][unpacked_node.dict_idx()].insert( unpacked_node.glb_idx() );
 
       // Component to check if a node is already existing. If so, the unpacked node doesn't need to be added anymore
-      const common::Map<boost::uint64_t,Uint>& glb_to_loc = m_mesh->dictionaries()[unpacked_node.dict_idx()]->glb_to_loc();
+      const common::HashMap<boost::uint64_t,Uint>& glb_to_loc = m_mesh->dictionaries()[unpacked_node.dict_idx()]->glb_to_loc();
       if (!glb_to_loc.exists(unpacked_node.glb_idx()))
       {
         add_node(unpacked_node);
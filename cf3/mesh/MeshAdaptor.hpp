@@ -144,6 +144,9 @@ public:
   /// @brief rebuild dictionary.connectivity() map with flushed nodes and elements included
   void rebuild_node_to_element_connectivity();
 
+  /// @brief Remove all components tagged as Tags::connectivity_cache(), since they were computed from the old connectivity
+  void clear_connectivity_caches();
+
   //@} End Fine Level functions
 
 
@@ -14,7 +14,7 @@
 #include "common/FindComponents.hpp"
 #include "common/Map.hpp"
 #include "common/Foreach.hpp"
-#include "common/DynTable.hpp"
+#include "common/CompressedTable.hpp"
 #include "common/Table.hpp"
 #include "common/List.hpp"
 
@@ -204,7 +204,7 @@ Uint MeshPartitioner::nb_connected_objects_in_part(const Uint part, VectorT& nb_
 
       if (Handle< Dictionary > nodes = Handle<Dictionary>(comp))
       {
-        const common::DynTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
+        const common::CompressedTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
         nb_connections_per_obj[idx] = node_to_glb_elm.row_size(loc_idx);
       }
       else if (Handle< Elements > elements = Handle<Elements>(comp))
@@ -237,7 +237,7 @@ void MeshPartitioner::list_of_connected_objects_in_part(const Uint part, VectorT
       boost::tie(comp,loc_idx) = m_lookup->location(loc_obj);
       if (Handle< Dictionary > nodes = Handle<Dictionary>(comp))
       {
-        const common::DynTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
+        const common::CompressedTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
         boost_foreach (const Uint glb_elm , node_to_glb_elm[loc_idx])
           connected_objects[idx++] = glb_elm;
       }
@@ -273,7 +273,7 @@ void MeshPartitioner::list_of_connected_procs_in_part(const Uint part, VectorT&
       boost::tie(comp,loc_idx) = m_lookup->location(loc_obj);
       if (Handle< Dictionary > nodes = Handle<Dictionary>(comp))
       {
-        const common::DynTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
+        const common::CompressedTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
         boost_foreach (const Uint glb_elm , node_to_glb_elm[loc_idx])
           connected_procs[idx++] = part_of_obj(glb_elm); /// @todo should be proc of obj, not part!!!
       }
@@ -14,6 +14,7 @@
 #include "common/Environment.hpp"
 #include "common/Core.hpp"
 #include "common/FindComponents.hpp"
+#include "common/PropertyList.hpp"
 
 #include "mesh/MeshWriter.hpp"
 #include "mesh/MeshMetadata.hpp"
@@ -33,7 +34,9 @@ using namespace common;
 ////////////////////////////////////////////////////////////////////////////////
 
 MeshWriter::MeshWriter ( const std::string& name  ) :
-  Action ( name )
+  Action ( name ),
+  m_time(0.),
+  m_iter(0)
 {
   mark_basic();
 
@@ -58,6 +61,12 @@ MeshWriter::MeshWriter ( const std::string& name  ) :
       .link_to(&m_file_path)
       .mark_basic();
 
+  // Coordinates to write, e.g. a copy taken at an earlier time. Default is the geometry of the mesh.
+  options().add("coordinates", m_coordinates)
+      .description("Node coordinates to write instead of those of the geometry dictionary, e.g. a copy taken at an earlier time")
+      .pretty_name("Coordinates")
+      .link_to(&m_coordinates);
+
   // Regions to write. Default is entire mesh.
   options().add("regions", std::vector<URI>(1,"./"+std::string(Tags::topology())))
       .pretty_name("Regions")
@@ -149,6 +158,16 @@ MeshWriter::~MeshWriter()
 //////////////////////////////////////////////////////////////////////////////
 
 void MeshWriter::execute()
+{
+  prepare();
+
+  // Call implementation
+  write();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MeshWriter::prepare()
 {
   // Check if the mesh was configured
   if (is_null(m_mesh))
@@ -156,23 +175,47 @@ void MeshWriter::execute()
 
   CFinfo << "Writing mesh " << m_file_path << CFendl;
 
+  // The data written is labelled with the time and iteration at which it was prepared
+  m_time = m_mesh->metadata().properties().value<Real>("time");
+  m_iter = m_mesh->metadata().properties().value<Uint>("iter");
+
   // Configure the fields to write
   config_fields();
 
   // Configure the regions to write
   config_regions();
 
+  if (is_not_null(m_coordinates) && m_coordinates->size() != m_mesh->geometry_fields().coordinates().size())
+    throw SetupError(FromHere(),"Coordinates "+m_coordinates->uri().string()+" configured in mesh-writer ["+uri().string()+"] don't match the mesh");
+
   m_filtered_entities.clear();
   boost_foreach(const Handle<Region const>& region, m_regions)
     boost_foreach(const Entities& entities, find_components_recursively_with_filter<Entities>(*region,m_entities_filter))
       m_filtered_entities.push_back(entities.handle<Entities>());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MeshWriter::write_prepared()
+{
+  if (is_null(m_mesh))
+    throw SetupError(FromHere(),"Mesh of mesh-writer ["+uri().string()+"] was removed before it was written");
 
-  // Call implementation
   write();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
+const Field& MeshWriter::coordinates() const
+{
+  cf3_assert(is_not_null(m_mesh));
+  if (is_not_null(m_coordinates))
+    return *m_coordinates;
+  return m_mesh->geometry_fields().coordinates();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 void MeshWriter::write_from_to(const Mesh& mesh, const URI& file_path)
 {
   options().set("mesh",mesh.handle<Mesh const>());
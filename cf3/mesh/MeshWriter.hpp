@@ -55,6 +55,20 @@ public: // functions
 
   virtual void write_from_to(const Mesh& mesh, const common::URI& file_path);
 
+  /// Configure the fields, regions and entities to write, without writing anything.
+  /// execute() is equivalent to prepare() followed by write_prepared().
+  void prepare();
+
+  /// Write the data selected by the last prepare().
+  /// This only reads the mesh, the configured fields and the coordinates, so it may run
+  /// in a background thread as long as the solver leaves those untouched.
+  void write_prepared();
+
+protected: // functions
+
+  /// Coordinates to write: the "coordinates" option if set, otherwise those of the geometry dictionary
+  const Field& coordinates() const;
+
 private: // functions
 
   virtual void write() {};
@@ -87,10 +101,13 @@ protected:
   RegionFilter                         m_region_filter;      ///< Filters regions
   EntitiesFilter                       m_entities_filter;    ///< Filters entities
   Handle<Mesh const>                   m_mesh;               ///< Handle to configured mesh
+  Handle<Field const>                  m_coordinates;        ///< Handle to configured coordinates, if not those of the mesh
   std::vector<Handle<Field const> >    m_fields;             ///< Handle to configured fields
   std::vector<Handle<Region const> >   m_regions;            ///< Handle to configured regions
   std::vector<Handle<Entities const> > m_filtered_entities;  ///< Handle to selected entities
   bool                                 m_enable_overlap;     ///< If true, writing of overlap will be enabled
+  Real                                 m_time;               ///< Time in the mesh metadata at prepare()
+  Uint                                 m_iter;               ///< Iteration in the mesh metadata at prepare()
 
 };
 
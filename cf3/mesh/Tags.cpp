@@ -37,6 +37,7 @@ const char * Tags::outer_faces ()  { return "outer_faces"; }
 const char * Tags::bdry_faces ()  { return "bdry_faces"; }
 
 const char * Tags::connectivity_table () { return "connectivity_table"; }
+const char * Tags::connectivity_cache () { return "connectivity_cache"; }
 
 const char * Tags::event_mesh_loaded() { return "mesh_loaded"; }
 const char * Tags::event_mesh_changed() { return "mesh_changed"; }
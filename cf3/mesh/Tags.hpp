@@ -50,6 +50,9 @@ public:
 
   static const char * connectivity_table ();
 
+  /// Tag for data computed from connectivity tables, removed when the mesh changes
+  static const char * connectivity_cache ();
+
   static const char * event_mesh_loaded();
   static const char * event_mesh_changed();
 
@@ -4,23 +4,29 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <cstring>
+#include <iomanip>
 #include <iostream>
 #include <set>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
 
 #include "rapidxml/rapidxml.hpp"
 
+#include "common/BasicExceptions.hpp"
 #include "common/BoostFilesystem.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
+#include "common/ParallelFor.hpp"
 #include "common/Builder.hpp"
 #include "common/FindComponents.hpp"
 #include "common/StringConversion.hpp"
@@ -49,130 +55,144 @@ namespace VTKXML {
 
 namespace detail
 {
-  struct CompressedStreamHeader
+  /// Appended data section of a VTU file, streamed directly to the output file.
+  /// Each array is collected uncompressed and then written either as-is ("raw"), or split in blocks that are
+  /// compressed independently by zlib, spreading the blocks over nb_threads threads.
+  struct AppendedDataStream
   {
-    CompressedStreamHeader() :
-      nb_blocks(1),
+    AppendedDataStream(std::ostream& out, const std::string& compression, const Uint nb_threads) :
       blocksize(32768), // Same as in ParaView
-      last_blocksize(0)
+      m_out(out),
+      m_compressed(compression != "raw"),
+      m_level(compression == "fast" ? boost::iostreams::zlib::best_speed : boost::iostreams::zlib::default_compression),
+      m_nb_threads(std::max(nb_threads, Uint(1))),
+      m_wordsize(0),
+      m_position(0),
+      m_offset(0)
     {
     }
 
-    boost::uint32_t nb_blocks;
-    const boost::uint32_t blocksize;
-    boost::uint32_t last_blocksize;
-    std::vector<boost::uint32_t> compressed_blocksizes;
-  };
-
-  struct CompressedStream
-  {
-    CompressedStream() :
-      data_stream(std::ios_base::in | std::ios_base::out | std::ios_base::binary),
-      m_current_block(std::ios_base::in | std::ios_base::out | std::ios_base::binary)
-    {
-      // VTK data starts with a _
-      data_stream.write("_", 1);
-    }
-
     /// Start writing a new array
     void start_array(const Uint nb_elems, const Uint wordsize)
     {
       m_wordsize = wordsize;
-
-      const Uint nb_bytes = nb_elems * wordsize;
-      m_header.last_blocksize = nb_bytes % m_header.blocksize;
-      if(m_header.last_blocksize)
-      {
-        m_header.nb_blocks = nb_bytes / m_header.blocksize + 1;
-      }
-      else
-      {
-        m_header.last_blocksize = m_header.blocksize;
-        m_header.nb_blocks = nb_bytes / m_header.blocksize;
-      }
-
-      m_header.compressed_blocksizes.clear();
-      m_header.compressed_blocksizes.reserve(m_header.nb_blocks);
-
-      // Write known header info
-      data_stream.write(reinterpret_cast<const char*>(&m_header.nb_blocks), 4);
-      data_stream.write(reinterpret_cast<const char*>(&m_header.blocksize), 4);
-      data_stream.write(reinterpret_cast<const char*>(&m_header.last_blocksize), 4);
-
-      // save filepointer
-      m_compressed_sizes_start = data_stream.tellp();
-
-      // Reserve space for compressed block sizes
-      for(Uint i = 0; i != m_header.nb_blocks; ++i)
-        data_stream.write(reinterpret_cast<const char*>(&m_header.nb_blocks), 4);
+      m_raw.resize(nb_elems * wordsize);
+      m_position = 0;
     }
 
-    /// Finish writing the current array
-    void finish_array()
+    /// Append a value to the current array
+    template<typename ValueT>
+    void push_back(const ValueT& value)
     {
-      // Write the last block
-      cf3_assert(static_cast<Uint>(m_current_block.tellp()) == static_cast<Uint>(m_header.last_blocksize));
-      compress_block();
-
-      // go back to the header
-      const Uint stream_end = data_stream.tellp();
-      data_stream.seekp(m_compressed_sizes_start);
-
-      // Write actual compressed block sizes
-      for(Uint i = 0; i != m_header.nb_blocks; ++i)
-        data_stream.write(reinterpret_cast<const char*>(&m_header.compressed_blocksizes[i]), 4);
-
-      // go back to the stream end
-      data_stream.seekp(stream_end);
+      cf3_assert(m_position + m_wordsize <= m_raw.size());
+      std::memcpy(&m_raw[m_position], &value, m_wordsize);
+      m_position += m_wordsize;
     }
 
-    /// Append a value to the stream
-    template<typename ValueT>
-    void push_back(const ValueT& value)
+    /// Finish writing the current array, compressing it if needed and writing it to the file
+    void finish_array()
     {
-      // Block is full, write it to the compressed stream
-      if(m_current_block.tellp() == static_cast<std::streampos>(m_header.blocksize))
-        compress_block();
+      cf3_assert(m_position == m_raw.size());
+      const Uint nb_bytes = m_raw.size();
 
-      m_current_block.write(reinterpret_cast<const char*>(&value), m_wordsize);
+      if(!m_compressed)
+      {
+        const boost::uint32_t nb_bytes_header = nb_bytes;
+        m_out.write(reinterpret_cast<const char*>(&nb_bytes_header), 4);
+        if(nb_bytes)
+          m_out.write(&m_raw[0], nb_bytes);
+        m_offset += 4 + nb_bytes;
+        return;
+      }
+
+      boost::uint32_t last_blocksize = nb_bytes % blocksize;
+      const boost::uint32_t nb_blocks = nb_bytes / blocksize + (last_blocksize ? 1 : 0);
+      if(!last_blocksize)
+        last_blocksize = blocksize;
+
+      // Compress the blocks
+      std::vector<std::string> blocks(nb_blocks);
+      common::parallel_for(nb_blocks, m_nb_threads, 1, boost::bind(&AppendedDataStream::compress_blocks, this, boost::ref(blocks), _1, _2));
+
+      // Header, followed by the compressed blocks
+      m_out.write(reinterpret_cast<const char*>(&nb_blocks), 4);
+      m_out.write(reinterpret_cast<const char*>(&blocksize), 4);
+      m_out.write(reinterpret_cast<const char*>(&last_blocksize), 4);
+      m_offset += 12;
+      boost_foreach(const std::string& block, blocks)
+      {
+        const boost::uint32_t compressed_size = block.size();
+        m_out.write(reinterpret_cast<const char*>(&compressed_size), 4);
+        m_offset += 4;
+      }
+      boost_foreach(const std::string& block, blocks)
+      {
+        m_out.write(block.data(), block.size());
+        m_offset += block.size();
+      }
     }
 
-    // Offset to put in the VTK XML (= offset after the _)
-    Uint offset()
+    /// Offset to put in the VTK XML (= offset after the _)
+    boost::uint64_t offset() const
     {
-      return static_cast<Uint>(data_stream.tellp()) - 1u;
+      return m_offset;
     }
 
-    // Compress the current block and append it to the data stream
-    void compress_block()
+    /// Compress the blocks in the range [begin, end) of the current array
+    void compress_blocks(std::vector<std::string>& blocks, const Uint begin, const Uint end) const
     {
-      // set up zlib compressor
-      boost::iostreams::filtering_stream<boost::iostreams::input> compressed_stream;
-      compressed_stream.push(boost::iostreams::zlib_compressor());
-      compressed_stream.push(m_current_block);
-
-      // write data and store compressed size
-      const Uint before = data_stream.tellp();
-      data_stream << compressed_stream.rdbuf();
-      m_header.compressed_blocksizes.push_back(static_cast<Uint>(data_stream.tellp()) - before);
-
-      // clear current block
-      m_current_block.str(std::string());
+      for(Uint i = begin; i != end; ++i)
+      {
+        const Uint block_begin = i * blocksize;
+        const Uint block_size = std::min(static_cast<Uint>(blocksize), static_cast<Uint>(m_raw.size()) - block_begin);
+        boost::iostreams::filtering_ostream compressed_stream;
+        compressed_stream.push(boost::iostreams::zlib_compressor(boost::iostreams::zlib_params(m_level)));
+        compressed_stream.push(boost::iostreams::back_inserter(blocks[i]));
+        compressed_stream.write(&m_raw[block_begin], block_size);
+        compressed_stream.reset();
+      }
     }
 
-    CompressedStreamHeader m_header;
+    const boost::uint32_t blocksize;
 
-    /// File pointer where the compressed sizes start
-    Uint m_compressed_sizes_start;
+  private:
+    std::ostream& m_out;
+    const bool m_compressed;
+    const int m_level;
+    const Uint m_nb_threads;
 
     Uint m_wordsize;
 
-    // Uncompressed data for the block that is being appended to
-    std::stringstream m_current_block;
+    /// Uncompressed data for the current array
+    std::vector<char> m_raw;
+    Uint m_position;
 
-    std::stringstream data_stream;
+    /// Number of bytes written so far
+    boost::uint64_t m_offset;
   };
 
+  /// Fixed-width offset attribute, so the XML header has the same size before and after the actual offsets are known
+  std::string offset_str(const boost::uint64_t offset)
+  {
+    std::ostringstream result;
+    result << std::setw(20) << std::setfill('0') << offset;
+    return result.str();
+  }
+
+  /// XML meta data, up to and including the start of the appended data
+  std::string xml_header(const XmlNode& doc)
+  {
+    std::string xml_string;
+    to_string(doc, xml_string);
+
+    // Remove the closing tag
+    boost::algorithm::erase_last(xml_string, "</VTKFile>");
+    boost::algorithm::trim_right(xml_string);
+
+    // VTK data starts with a _
+    return xml_string + "\n<AppendedData encoding=\"raw\">\n_";
+  }
+
   // Recursively transform nodes to their parallel counterparts
   void make_pvtu(XmlNode& node)
   {
@@ -201,11 +221,26 @@ common::ComponentBuilder < VTKXML::Writer, MeshWriter, LibVTKXML> aVTKXMLWriter_
 //////////////////////////////////////////////////////////////////////////////
 
 Writer::Writer( const std::string& name )
-: MeshWriter(name)
+: MeshWriter(name),
+  m_nb_threads(1)
 {
     options().add("distributed_files", false)
     .pretty_name("Distributed Files")
     .description("Indicate if the filesystem is local to each note. When true, the pvtu file is written on each node.");
+
+  std::vector<boost::any> compressions;
+  compressions.push_back(std::string("zlib"));
+  compressions.push_back(std::string("fast"));
+  compressions.push_back(std::string("raw"));
+  options().add("compression", std::string("zlib"))
+    .pretty_name("Compression")
+    .description("Encoding of the appended data: zlib (default compression level), fast (zlib at the fastest compression level) or raw (uncompressed)")
+    .restricted_list() = compressions;
+
+  options().add("nb_threads", m_nb_threads)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used to compress the data blocks")
+    .link_to(&m_nb_threads);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -228,6 +263,10 @@ void Writer::write()
   const std::string basename = my_path.base_name();
   my_path = my_dir / (basename + "_P" + to_str(PE::Comm::instance().rank()) + ".vtu");
 
+  const std::string compression = options().value<std::string>("compression");
+  if(compression != "zlib" && compression != "fast" && compression != "raw")
+    throw SetupError(FromHere(), "Unknown compression " + compression + " for " + uri().string() + ", use zlib, fast or raw");
+
   XmlDoc doc("1.0", "ISO-8859-1");
 
   // Root node
@@ -235,11 +274,12 @@ void Writer::write()
   vtkfile.set_attribute("type", "UnstructuredGrid");
   vtkfile.set_attribute("version", "0.1");
   vtkfile.set_attribute("byte_order", "LittleEndian");
-  vtkfile.set_attribute("compressor", "vtkZLibDataCompressor");
+  if(compression != "raw")
+    vtkfile.set_attribute("compressor", "vtkZLibDataCompressor");
 
   XmlNode unstructured_grid = vtkfile.add_node("UnstructuredGrid");
 
-  const Field& coords = m_mesh->geometry_fields().coordinates();
+  const Field& coords = coordinates();
   const Uint npoints = coords.size();
   const Uint dim = coords.row_size();
 
@@ -267,15 +307,77 @@ void Writer::write()
   piece.set_attribute("NumberOfPoints", to_str(npoints));
   piece.set_attribute("NumberOfCells", to_str(nb_elems));
 
-  // Points output
-  detail::CompressedStream appended_data;
-
+  // Build the complete XML structure first, so the appended data can be streamed to the file after it.
+  // Offsets are filled in once all data is written.
   XmlNode points_data = piece.add_node("Points").add_node("DataArray");
   points_data.set_attribute("type", sizeof(Real) == 4 ? "Float32" : "Float64");
   points_data.set_attribute("NumberOfComponents", "3");
   points_data.set_attribute("format", "appended");
-  points_data.set_attribute("offset", to_str(appended_data.offset()));
+  points_data.set_attribute("offset", detail::offset_str(0));
+
+  XmlNode cells = piece.add_node("Cells");
 
+  XmlNode connectivity = cells.add_node("DataArray");
+  connectivity.set_attribute("type", "UInt32");
+  connectivity.set_attribute("Name", "connectivity");
+  connectivity.set_attribute("format", "appended");
+  connectivity.set_attribute("offset", detail::offset_str(0));
+
+  XmlNode offsets = cells.add_node("DataArray");
+  offsets.set_attribute("type", "UInt32");
+  offsets.set_attribute("Name", "offsets");
+  offsets.set_attribute("format", "appended");
+  offsets.set_attribute("offset", detail::offset_str(0));
+
+  XmlNode types = cells.add_node("DataArray");
+  types.set_attribute("type", "UInt8");
+  types.set_attribute("Name", "types");
+  types.set_attribute("format", "appended");
+  types.set_attribute("offset", detail::offset_str(0));
+
+  XmlNode cell_data = piece.add_node("CellData");
+  XmlNode point_data = piece.add_node("PointData");
+
+  // Unique fields to write, with the DataArray node of each variable
+  std::vector< Handle<Field const> > written_fields;
+  std::vector<XmlNode> field_arrays;
+  std::set<std::string> added_fields;
+  boost_foreach(Handle<Field const> field_ptr, m_fields)
+  {
+    const Field& field = *field_ptr;
+
+    if(!added_fields.insert(field.uri().string()).second)
+      continue;
+
+    written_fields.push_back(field_ptr);
+
+    for(Uint var_idx = 0; var_idx != field.nb_vars(); ++var_idx)
+    {
+      const Uint var_size = field.var_length(var_idx);
+
+      XmlNode data_array = field.continuous()
+        ? point_data.add_node("DataArray")
+        : cell_data.add_node("DataArray");
+
+      data_array.set_attribute("type", sizeof(Real) == 4 ? "Float32" : "Float64");
+      data_array.set_attribute("NumberOfComponents", to_str(var_size == 2 && dim == 2 ? 3 : var_size));
+      data_array.set_attribute("Name", field.var_name(var_idx));
+      data_array.set_attribute("format", "appended");
+      data_array.set_attribute("offset", detail::offset_str(0));
+      field_arrays.push_back(data_array);
+    }
+  }
+
+  // Write to file, leaving room for the XML header
+  std::cout << "writing file " << my_path.path() << std::endl;
+  boost::filesystem::fstream fout(my_path.path(), std::ios_base::out | std::ios_base::binary);
+  const std::string placeholder_header = detail::xml_header(doc);
+  fout << placeholder_header;
+
+  detail::AppendedDataStream appended_data(fout, compression, m_nb_threads);
+
+  // Points output
+  points_data.set_attribute("offset", detail::offset_str(appended_data.offset()));
   appended_data.start_array(3*npoints, sizeof(Real));
   for(Uint i = 0; i != npoints; ++i)
   {
@@ -286,14 +388,8 @@ void Writer::write()
   }
   appended_data.finish_array();
 
-  XmlNode cells = piece.add_node("Cells");
-
   // Write connectivity
-  XmlNode connectivity = cells.add_node("DataArray");
-  connectivity.set_attribute("type", "UInt32");
-  connectivity.set_attribute("Name", "connectivity");
-  connectivity.set_attribute("format", "appended");
-  connectivity.set_attribute("offset", to_str(appended_data.offset()));
+  connectivity.set_attribute("offset", detail::offset_str(appended_data.offset()));
   appended_data.start_array(nb_conn_nodes, 4);
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
@@ -313,11 +409,7 @@ void Writer::write()
   appended_data.finish_array();
 
   // Write the offsets
-  XmlNode offsets = cells.add_node("DataArray");
-  offsets.set_attribute("type", "UInt32");
-  offsets.set_attribute("Name", "offsets");
-  offsets.set_attribute("format", "appended");
-  offsets.set_attribute("offset", to_str(appended_data.offset()));
+  offsets.set_attribute("offset", detail::offset_str(appended_data.offset()));
   boost::uint32_t offset = 0;
   appended_data.start_array(nb_elems, 4);
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
@@ -335,11 +427,7 @@ void Writer::write()
   }
   appended_data.finish_array();
 
-  XmlNode types = cells.add_node("DataArray");
-  types.set_attribute("type", "UInt8");
-  types.set_attribute("Name", "types");
-  types.set_attribute("format", "appended");
-  types.set_attribute("offset", to_str(appended_data.offset()));
+  types.set_attribute("offset", detail::offset_str(appended_data.offset()));
   appended_data.start_array(nb_elems, 1);
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
@@ -355,37 +443,19 @@ void Writer::write()
   }
   appended_data.finish_array();
 
-
-  XmlNode cell_data = piece.add_node("CellData");
-  XmlNode point_data = piece.add_node("PointData");
-
-  std::stringstream data_header( std::ios_base::in | std::ios_base::out | std::ios_base::binary );
-
-  std::set<std::string> added_fields;
-  boost_foreach(Handle<Field const> field_ptr, m_fields)
+  Uint array_idx = 0;
+  boost_foreach(Handle<Field const> field_ptr, written_fields)
   {
     const Field& field = *field_ptr;
 
-    if(!added_fields.insert(field.uri().string()).second)
-      continue;
-
     for(Uint var_idx = 0; var_idx != field.nb_vars(); ++var_idx)
     {
-      const std::string var_name = field.var_name(var_idx);
       const Uint var_begin = field.var_offset(var_idx);
       const Uint field_size = field.continuous() ? field.size() : nb_elems;
       const Uint var_size = field.var_length(var_idx);
       const Uint var_end = var_begin + var_size;
 
-      XmlNode data_array = field.continuous()
-        ? point_data.add_node("DataArray")
-        : cell_data.add_node("DataArray");
-
-      data_array.set_attribute("type", sizeof(Real) == 4 ? "Float32" : "Float64");
-      data_array.set_attribute("NumberOfComponents", to_str(var_size == 2 && dim == 2 ? 3 : var_size));
-      data_array.set_attribute("Name", var_name);
-      data_array.set_attribute("format", "appended");
-      data_array.set_attribute("offset", to_str(appended_data.offset()));
+      field_arrays[array_idx++].set_attribute("offset", detail::offset_str(appended_data.offset()));
 
       appended_data.start_array(field_size*(var_size == 2 && dim == 2 ? 3 : var_size), sizeof(Real));
 
@@ -399,7 +469,7 @@ void Writer::write()
             {
               appended_data.push_back(field[i][j]);
             }
-            appended_data.push_back(0.);
+            appended_data.push_back(Real(0.));
           }
         }
         else
@@ -426,7 +496,7 @@ void Writer::write()
                   /// @bug the field values of the space should be interpolated to the cell-centre, similar to the tecplot writer
                   appended_data.push_back(field[field_connectivity[i][0]][j]);
                 }
-                appended_data.push_back(0.);
+                appended_data.push_back(Real(0.));
               }
             }
             else
@@ -448,24 +518,14 @@ void Writer::write()
     }
   }
 
-  // Write to file, inserting the binary data at the end
-  std::cout << "writing file " << my_path.path() << std::endl;
-  boost::filesystem::fstream fout(my_path.path(), std::ios_base::out | std::ios_base::binary);
-
-  // Remove the closing tag
-  std::string xml_string;
-  to_string(doc, xml_string);
-  boost::algorithm::erase_last(xml_string, "</VTKFile>");
-  boost::algorithm::trim_right(xml_string);
+  fout << "\n</AppendedData>\n</VTKFile>\n";
 
-  // Write XML meta data
+  // Rewrite the XML meta data, now with the actual offsets
+  const std::string xml_string = detail::xml_header(doc);
+  cf3_always_assert(xml_string.size() == placeholder_header.size());
+  fout.seekp(0);
   fout << xml_string;
 
-  // Append  compressed data
-  fout << "\n<AppendedData encoding=\"raw\">\n";
-  fout << appended_data.data_stream.rdbuf();
-  fout << "\n</AppendedData>\n</VTKFile>\n";
-
   fout.close();
 
   // Write the parallel header, if needed
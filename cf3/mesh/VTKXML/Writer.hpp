@@ -24,6 +24,9 @@ namespace VTKXML {
 //////////////////////////////////////////////////////////////////////////////
 
 /// This class defines VTKXML mesh format writer
+/// Each rank writes a .vtu file, with its appended data streamed directly to disk.
+/// Data blocks are compressed in parallel using the "nb_threads" option, or written uncompressed
+/// when the "compression" option is "raw". Rank 0 writes the .pvtu index.
 /// @author Bart Janssens
 class VTKXML_API Writer : public MeshWriter
 {
@@ -45,6 +48,10 @@ public: // functions
   virtual std::string get_format() { return "VTKXML"; }
 
   virtual std::vector<std::string> get_extensions();
+
+private:
+  /// Number of threads used to compress the data blocks
+  Uint m_nb_threads;
 }; // end Writer
 
 
@@ -160,8 +160,22 @@ void WriteMesh::write_mesh( const Mesh& mesh, const URI& file )
 
 void WriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector<URI>& fields)
 {
-  update_list_of_available_writers();
+  const URI filepath = file_path(mesh, file);
+
+  // get the correct writer based on the extension
+
+  MeshWriter& writer = writer_for(filepath);
+  writer.options().set("fields",fields);
+  writer.options().set("mesh",mesh.handle<Mesh>());
+  writer.options().set("file", filepath);
+
+  writer.execute();
+}
 
+////////////////////////////////////////////////////////////////////////////////
+
+URI WriteMesh::file_path( const Mesh& mesh, const URI& file ) const
+{
   /// @todo this should be improved to allow http(s) which would then upload the mesh
   ///       to a remote location after writing to a temporary file
   ///       uploading can be achieved using the curl library (which we already search for in the build system)
@@ -171,22 +185,6 @@ void WriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector
   if( filepath.scheme() != URI::Scheme::FILE )
     filepath.scheme( URI::Scheme::FILE );
 
-
-  const std::string extension = filepath.extension();
-
-  if ( m_extensions_to_writers.count(extension) == 0 )
-    throw FileFormatError (FromHere(), "No meshwriter exists for files with extension " + extension);
-
-  if (m_extensions_to_writers[extension].size()>1)
-  {
-     std::string msg;
-     msg = filepath.string() + " has ambiguous extension " + extension + "\n"
-       +  "Possible writers for this extension are: \n";
-     boost_foreach(const Handle< MeshWriter > writer , m_extensions_to_writers[extension])
-       msg += " - " + writer->name() + "\n";
-     throw FileFormatError( FromHere(), msg);
-   }
-
   // substitute the regex wildcards in the file name
 
   const MeshMetadata& metadata = mesh.metadata();
@@ -229,15 +227,31 @@ void WriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector
   // change the path in the filepath
 
   filepath.path( file_str );
+  return filepath;
+}
 
-  // get the correct writer based on the extension
+////////////////////////////////////////////////////////////////////////////////
+
+MeshWriter& WriteMesh::writer_for( const URI& file )
+{
+  update_list_of_available_writers();
+
+  const std::string extension = file.extension();
+
+  if ( m_extensions_to_writers.count(extension) == 0 )
+    throw FileFormatError (FromHere(), "No meshwriter exists for files with extension " + extension);
 
-  Handle< MeshWriter > writer = m_extensions_to_writers[extension][0];
-  writer->options().set("fields",fields);
-  writer->options().set("mesh",mesh.handle<Mesh>());
-  writer->options().set("file", filepath);
+  if (m_extensions_to_writers[extension].size()>1)
+  {
+     std::string msg;
+     msg = file.string() + " has ambiguous extension " + extension + "\n"
+       +  "Possible writers for this extension are: \n";
+     boost_foreach(const Handle< MeshWriter > writer , m_extensions_to_writers[extension])
+       msg += " - " + writer->name() + "\n";
+     throw FileFormatError( FromHere(), msg);
+   }
 
-  writer->execute();
+  return *m_extensions_to_writers[extension][0];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,6 +60,13 @@ public: // functions
   /// writes all the fields on the mesh
   void write_mesh( const Mesh&, const common::URI& file);
 
+  /// Path of the file to write, with the wildcards such as ${iter} and ${time}
+  /// substituted from the current metadata of the mesh
+  common::URI file_path( const Mesh&, const common::URI& file ) const;
+
+  /// Writer that handles the extension of the given file
+  MeshWriter& writer_for( const common::URI& file );
+
   virtual void execute();
 
 protected: // helper functions
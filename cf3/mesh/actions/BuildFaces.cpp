@@ -6,8 +6,8 @@
 
 #include <set>
 
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
-#include <boost/functional/hash.hpp>
 
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
@@ -17,6 +17,7 @@
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
 #include "common/OptionT.hpp"
+#include "common/ParallelFor.hpp"
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
 
@@ -31,8 +32,8 @@
 #include "mesh/Region.hpp"
 #include "mesh/MeshElements.hpp"
 #include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/FaceHashTable.hpp"
 #include "mesh/NodeElementConnectivity.hpp"
-#include "mesh/Node2FaceCellConnectivity.hpp"
 #include "mesh/Cells.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Connectivity.hpp"
@@ -50,20 +51,36 @@ namespace actions {
   using namespace common;
   using namespace math::Functions;
 
-struct FaceCompare
+/// Nodes of a face stored in a FaceCellConnectivity
+inline std::vector<Uint> face_nodes(const FaceCellConnectivity& faces, const Uint idx)
 {
-  bool operator()(const Face2Cell& face1, const Face2Cell& face2) const
-  {
-    std::size_t seed1=0;
-    std::size_t seed2=0;
-
-    boost::hash_combine(seed1,face1.comp->uri().string());
-    boost::hash_combine(seed2,face2.comp->uri().string());
-    boost::hash_combine(seed1,face1.idx);
-    boost::hash_combine(seed2,face2.idx);
-    return seed1 < seed2;
-  }
-};
+  return faces.face_nodes(idx);
+}
+
+/// Nodes of a face stored as face elements
+inline Connectivity::ConstRow face_nodes(const Elements& faces, const Uint idx)
+{
+  return faces.geometry_space().connectivity()[idx];
+}
+
+/// Look up the faces in [begin,end) in the table, storing the index of the matching face
+template<typename FacesT>
+void find_faces_range(const FaceHashTable& table, const FacesT& faces, std::vector<Uint>& matches, const Uint begin, const Uint end)
+{
+  for (Uint idx=begin; idx!=end; ++idx)
+    matches[idx] = table.find(face_nodes(faces,idx));
+}
+
+/// Look up all faces in the table, splitting the lookups over nb_threads threads
+/// @return for each face the index of the matching face in the table, or FaceHashTable::not_found
+template<typename FacesT>
+std::vector<Uint> find_faces(const FaceHashTable& table, const FacesT& faces, const Uint nb_faces, const Uint nb_threads)
+{
+  std::vector<Uint> matches(nb_faces, FaceHashTable::not_found);
+  common::parallel_for(nb_faces, nb_threads, 1,
+                       boost::bind(&find_faces_range<FacesT>, boost::cref(table), boost::cref(faces), boost::ref(matches), _1, _2));
+  return matches;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -73,7 +90,8 @@ common::ComponentBuilder < BuildFaces, MeshTransformer, mesh::actions::LibAction
 
 BuildFaces::BuildFaces( const std::string& name )
 : MeshTransformer(name),
-  m_store_cell2face(false)
+  m_store_cell2face(false),
+  m_nb_threads(1)
 {
 
   properties()["brief"] = std::string("Print information of the mesh");
@@ -89,6 +107,11 @@ BuildFaces::BuildFaces( const std::string& name )
       .pretty_name("Store Cell to Face")
       .mark_basic()
       .link_to(&m_store_cell2face);
+
+  options().add("nb_threads", m_nb_threads)
+      .description("Number of threads used to look up matching faces between regions")
+      .pretty_name("Number of Threads")
+      .link_to(&m_nb_threads);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -429,7 +452,6 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
 
   CFdebug << "matching faces between regions " << region1.uri().path() << "  and  " << region2.uri().path() << CFendl;
 
-  Mesh& mesh = *m_mesh;
   // interface connectivity
   boost::shared_ptr<FaceCellConnectivity> interface = allocate_component<FaceCellConnectivity>("interface_connectivity");
   interface->options().set("face_building_algorithm",true);
@@ -443,91 +465,58 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::List<bool>::Buffer> >  buf_bdry;
   std::map<FaceCellConnectivity*,boost::shared_ptr<ElementConnectivity::Buffer> > buf_f2c;
 
-  // Build a node to face connectivity matching faces2
-  boost::shared_ptr<Node2FaceCellConnectivity> node2faces2_ptr = allocate_component<Node2FaceCellConnectivity>("node2faces");
-  Node2FaceCellConnectivity& node2faces2 = *node2faces2_ptr;
+  // Store the faces of region2 in a hash table, to match them with the faces of region1
+  FaceHashTable faces2_table;
+  std::vector<Face2Cell> faces2_list;
   boost_foreach(FaceCellConnectivity& faces2, find_components_recursively_with_tag<FaceCellConnectivity>(region2,mesh::Tags::inner_faces()))
   {
     buf_fnb [&faces2] = boost::shared_ptr<common::Table<Uint>::Buffer> ( new common::Table<Uint>::Buffer(faces2.face_number().create_buffer()));
     buf_bdry[&faces2] = boost::shared_ptr<common::List<bool>::Buffer> ( new common::List<bool>::Buffer(faces2.is_bdry_face().create_buffer()));
     buf_f2c [&faces2] = boost::shared_ptr<ElementConnectivity::Buffer> ( new ElementConnectivity::Buffer(faces2.connectivity().create_buffer()));
-    node2faces2.add_used(faces2); // it is assumed this is only face types
+    faces2_table.reserve(faces2_table.size()+faces2.size());
+    for (Uint idx=0; idx<faces2.size(); ++idx)
+    {
+      if (faces2_table.insert(faces2.face_nodes(idx)) == faces2_list.size())
+        faces2_list.push_back(Face2Cell(faces2,idx));
+    }
   }
-  node2faces2.set_nodes(mesh.geometry_fields());
-  node2faces2.build_connectivity();
 
-  Uint f1(0);
-  Uint faces1_idx(0);
   boost_foreach(FaceCellConnectivity& faces1, find_components_recursively_with_tag<FaceCellConnectivity>(region1,mesh::Tags::inner_faces()))
   {
     buf_fnb [&faces1] = boost::shared_ptr<common::Table<Uint>::Buffer> ( new common::Table<Uint>::Buffer(faces1.face_number().create_buffer()));
     buf_bdry[&faces1] = boost::shared_ptr<common::List<bool>::Buffer> ( new common::List<bool>::Buffer(faces1.is_bdry_face().create_buffer()));
     buf_f2c [&faces1] = boost::shared_ptr<ElementConnectivity::Buffer> ( new ElementConnectivity::Buffer(faces1.connectivity().create_buffer()));
 
-
-    std::vector<Uint> face_nodes;
     std::vector<Entity> elems(2);
     std::vector<Uint> face_nb(2);
     enum {LEFT=0,RIGHT=1};
-    Uint nb_matches(0);
 
+    const std::vector<Uint> matches = find_faces(faces2_table, faces1, faces1.size(), m_nb_threads);
 
     for (Uint idx=0; idx<faces1.size(); ++idx)
     {
-      Face2Cell face1(faces1,idx);
-      face_nodes = face1.nodes();
-      const Uint nb_nodes_per_face = face_nodes.size();
+      if (matches[idx] == FaceHashTable::not_found)
+        continue;
 
-      std::map<Face2Cell,Uint,FaceCompare> found_faces;
-      std::map<Face2Cell,Uint,FaceCompare>::iterator not_found = found_faces.end();
-
-      bool match_found = false;
-      boost_foreach(const Uint face_node, face_nodes)
-      {
-        boost_foreach(const Face2Cell face2, node2faces2.connectivity()[face_node])
-        {
-          std::map<Face2Cell,Uint,FaceCompare>::iterator it = found_faces.find(face2);
-          if ( it == not_found)
-          {
-            found_faces[face2]=1;
-          }
-          else
-          {
-            Uint& nb_faces = it->second;
-            ++nb_faces;
-            if (nb_faces == nb_nodes_per_face)
-            {
-              match_found = true;
-              elems[LEFT]  = face1.cells()[0];
-              elems[RIGHT] = face2.cells()[0];
-              face_nb[LEFT] = face1.face_nb_in_cells()[0];
-              face_nb[RIGHT] = face2.face_nb_in_cells()[0];
-//              CFdebug << PERank << "match found: " << elems[LEFT] << " <--> " << elems[RIGHT] << CFendl;
-
-              // Remove matches from the 2 connectivity tables and add to the interface
-              i2c.add_row(elems);
-              fnb.add_row(face_nb);
-//              fnb.add_row(buf_fnb[face1.comp]->get_row(face1.idx));
-              bdry.add_row(false);
-
-              buf_f2c [face1.comp]->rm_row(face1.idx);
-              buf_f2c [face2.comp]->rm_row(face2.idx);
-              buf_fnb [face1.comp]->rm_row(face1.idx);
-              buf_fnb [face2.comp]->rm_row(face2.idx);
-              buf_bdry[face1.comp]->rm_row(face1.idx);
-              buf_bdry[face2.comp]->rm_row(face2.idx);
-
-              ++nb_matches;
-              break;
-            }
-          }
-        }
-        if (match_found)
-          break;
-      }
-      ++f1;
+      Face2Cell face1(faces1,idx);
+      Face2Cell face2 = faces2_list[matches[idx]];
+      elems[LEFT]  = face1.cells()[0];
+      elems[RIGHT] = face2.cells()[0];
+      face_nb[LEFT] = face1.face_nb_in_cells()[0];
+      face_nb[RIGHT] = face2.face_nb_in_cells()[0];
+
+      // Remove matches from the 2 connectivity tables and add to the interface
+      i2c.add_row(elems);
+      fnb.add_row(face_nb);
+      bdry.add_row(false);
+
+      buf_f2c [face1.comp]->rm_row(face1.idx);
+      buf_f2c [face2.comp]->rm_row(face2.idx);
+      buf_fnb [face1.comp]->rm_row(face1.idx);
+      buf_fnb [face2.comp]->rm_row(face2.idx);
+      buf_bdry[face1.comp]->rm_row(face1.idx);
+      buf_bdry[face2.comp]->rm_row(face2.idx);
     }
-    ++faces1_idx;
   }
 
   return interface;
@@ -538,30 +527,29 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
 
 void BuildFaces::match_boundary(Region& bdry_region, Region& inner_region)
 {
-  Mesh& mesh = *m_mesh;
-
   // create buffers for each face_cell_connectivity of unified_inner_faces_to_cells
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::Table<Uint>::Buffer> >  buf_inner_face_nb;
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::List<bool>::Buffer> >   buf_inner_face_is_bdry;
   std::map<FaceCellConnectivity*,boost::shared_ptr<ElementConnectivity::Buffer> >  buf_inner_face_connectivity;
 
-  // Build a node to face connectivity matching faces2
-  boost::shared_ptr<Node2FaceCellConnectivity> nodes_to_inner_faces_ptr = allocate_component<Node2FaceCellConnectivity>("node2faces");
-  Node2FaceCellConnectivity& nodes_to_inner_faces = *nodes_to_inner_faces_ptr;
+  // Store the inner faces in a hash table, to match them with the boundary faces
+  FaceHashTable inner_faces_table;
+  std::vector<Face2Cell> inner_faces_list;
   boost_foreach(FaceCellConnectivity& f2c, find_components_recursively_with_tag<FaceCellConnectivity>(inner_region,mesh::Tags::inner_faces()))
   {
     buf_inner_face_nb          [&f2c] = boost::shared_ptr<common::Table<Uint>::Buffer> ( new common::Table<Uint>::Buffer(f2c.face_number().create_buffer()));
     buf_inner_face_is_bdry     [&f2c] = boost::shared_ptr<common::List<bool>::Buffer>  ( new common::List<bool>::Buffer(f2c.is_bdry_face().create_buffer()));
     buf_inner_face_connectivity[&f2c] = boost::shared_ptr<ElementConnectivity::Buffer> ( new ElementConnectivity::Buffer(f2c.connectivity().create_buffer()));
-    nodes_to_inner_faces.add_used(f2c);
+    inner_faces_table.reserve(inner_faces_table.size()+f2c.size());
+    for (Uint idx=0; idx<f2c.size(); ++idx)
+    {
+      if (inner_faces_table.insert(f2c.face_nodes(idx)) == inner_faces_list.size())
+        inner_faces_list.push_back(Face2Cell(f2c,idx));
+    }
   }
-  nodes_to_inner_faces.set_nodes(mesh.geometry_fields());
-  nodes_to_inner_faces.build_connectivity();
 
   boost_foreach(Elements& bdry_faces, find_components<Elements>(bdry_region))
   {
-//    PECheckPoint(100, "matching boundary " << bdry_faces.uri());
-//    bdry_faces.add_tag(mesh::Tags::outer_faces());
     Handle< FaceCellConnectivity > bdry_face_to_cell = find_component_ptr<FaceCellConnectivity>(bdry_faces);
     if (is_null(bdry_face_to_cell))
     {
@@ -584,134 +572,25 @@ void BuildFaces::match_boundary(Region& bdry_region, Region& inner_region)
     // the bdry_face_connectivity table
     std::vector<Entity> elems(1);
 
-    // initialize a counter for see if matches are found.
-    // A match is found if every node of a boundary face is also found in an inner_face
-    Uint nb_matches(0);
+    // A match is found if a boundary face has the same nodes as an inner_face
+    const std::vector<Uint> matches = find_faces(inner_faces_table, bdry_faces, bdry_faces.size(), m_nb_threads);
+
     for (Uint idx=0; idx<bdry_faces.size(); ++idx)
     {
-      Entity bdry_entity(bdry_faces,idx);
-      Connectivity::ConstRow bdry_face_nodes = bdry_entity.get_nodes();
-      const Uint nb_nodes_per_face = bdry_face_nodes.size();
-
-      std::map<Face2Cell,Uint,FaceCompare> found_faces;
-      std::map<Face2Cell,Uint,FaceCompare>::iterator not_found = found_faces.end();
-
-      //      CFdebug << "    searching for match for " << bdry_entity << "  ( ";
-      //      boost_foreach(const Uint bdry_face_node, bdry_face_nodes)
-      //          CFdebug << bdry_face_node << " " ;
-      //      CFdebug << ")"<< CFendl;
-      bool match_found = false;
-      boost_foreach(const Uint bdry_face_node, bdry_face_nodes)
-      {
-        //        CFdebug << "         node = " << bdry_face_node << CFendl;
-        boost_foreach( Face2Cell& inner_face, nodes_to_inner_faces.connectivity()[bdry_face_node])
-        {
-          //          CFdebug << "           check inner_face["<<inner_face.idx<<"]  ( ";
-          //          boost_foreach(const Uint face_node, inner_face.nodes())
-          //              CFdebug << face_node << " ";
-          //          CFdebug << " )"<<CFendl;
-          std::map<Face2Cell,Uint,FaceCompare>::iterator it = found_faces.find(inner_face);
-          if ( it == not_found)
-          {
-            found_faces[inner_face]=1;
-
-            it = found_faces.find(inner_face);
-            //            CFdebug << "               bump " << it->first.comp->uri().path() << "  " << it->first.idx << CFendl;
-
-            if (nb_nodes_per_face == 1)
-            {
-              match_found = true;
-              elems[0] = inner_face.cells()[0];
-
-              //              CFdebug << PERank << "match found: " << inner_face.comp->uri().string()<<"["<<inner_face.idx<<"]" << " <--> " << elems[0] << CFendl;
-
-              // Remove matches from the inner_faces_connectivity tables and add to the boundary
-              bdry_face_connectivity.set_row(bdry_entity.idx,elems);
-              bdry_face_nb[bdry_entity.idx][0] = inner_face.face_nb_in_cells()[0];
-              bdry_face_is_bdry[bdry_entity.idx] = true;
-
-              buf_inner_face_connectivity[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_nb[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_is_bdry[inner_face.comp]->rm_row(inner_face.idx);
-
-              ++nb_matches;
-              break;
-            }
-          }
-          else
-          {
-            Uint& nb_faces = it->second;
-            ++nb_faces;
-            //            CFdebug << "               bump " << it->first.comp->uri().path() << "  " << it->first.idx << CFendl;
-
-            if (nb_faces == nb_nodes_per_face)
-            {
-
-              match_found = true;
-              elems[0] = inner_face.cells()[0];
-
-//              CFdebug << PERank << "match found: " << inner_face.comp->uri().string()<<"["<<inner_face.idx<<"]" << " <--> " << elems[0] << CFendl;
-
-              // Remove matches from the inner_faces_connectivity tables and add to the boundary
-              bdry_face_connectivity.set_row(bdry_entity.idx,elems);
-              bdry_face_nb[bdry_entity.idx][0] = inner_face.face_nb_in_cells()[0];
-              bdry_face_is_bdry[bdry_entity.idx] = true;
-
-              buf_inner_face_connectivity[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_nb[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_is_bdry[inner_face.comp]->rm_row(inner_face.idx);
-
-              ++nb_matches;
-              break;
-
-
-
-
-//              match_found = true;
-//              Handle< FaceCellConnectivity > inner_faces_to_cells;
-//              Uint inner_face_idx;
-//              Uint inner_faces_comp_idx;
-//              boost::tie(inner_faces_comp_idx,inner_face_idx) = nodes_to_inner_faces.face_cell_connectivity().location_idx(unified_inner_face_idx);
-//              inner_faces_to_cells = Handle<FaceCellConnectivity>(unified_inner_faces_to_cells->components()[inner_faces_comp_idx]);
-//              elems[0] = inner_faces_to_cells->connectivity()[inner_face_idx][0];
-
-//              // ----------- debug -----------
-//              //Handle< Component > inner_cell_comp;
-//              //Uint inner_cell_idx;
-//              //boost::tie(inner_cell_comp,inner_cell_idx) = inner_faces_to_cells->lookup().location(inner_faces_to_cells->connectivity()[inner_face_idx][0]);
-//              //CFdebug << PERank << "match found: " << bdry_faces.parent().name() << "/" << bdry_faces.name() << "["<<local_bdry_face_idx<<"] <--> " << inner_cell_comp->parent().name()<<"/"<<inner_cell_comp->name()<<"["<<inner_cell_idx<<"]" << CFendl;
-//              // -----------------------------
-
-//               // RealMatrix cell_coordinates = inner_cell_comp->as_type<Elements>().get_coordinates(inner_cell_idx);
-//               // RealVector face_coordinates = bdry_faces.get_coordinates(local_bdry_face_idx).row(0);
-//               // bool match_found_double_check = false;
-//               // for (Uint i=0; i<cell_coordinates.rows(); ++i)
-//               // {
-//               //   if (cell_coordinates.row(i) == face_coordinates.transpose())
-//               //   {
-//               //     match_found_double_check = true;
-//               //     break;
-//               //   }
-//               // }
-//               // cf3_assert(match_found_double_check);
-
-//              // Remove matches from the 2 connectivity tables and add to the interface
-//              bdry_face_connectivity.set_row(local_bdry_face_idx,elems);
-//              bdry_face_nb[local_bdry_face_idx] = buf_vec_inner_face_nb[inner_faces_comp_idx]->get_row(inner_face_idx);
-//              bdry_face_is_bdry[local_bdry_face_idx] = true;
-
-//              buf_vec_inner_face_connectivity[inner_faces_comp_idx]->rm_row(inner_face_idx);
-//              buf_vec_inner_face_nb[inner_faces_comp_idx]->rm_row(inner_face_idx);
-//              buf_vec_inner_face_is_bdry[inner_faces_comp_idx]->rm_row(inner_face_idx);
-
-//              ++nb_matches;
-//              break;
-            }
-          }
-        }
-        if (match_found)
-          break;
-      }
+      if (matches[idx] == FaceHashTable::not_found)
+        continue;
+
+      Face2Cell inner_face = inner_faces_list[matches[idx]];
+      elems[0] = inner_face.cells()[0];
+
+      // Remove matches from the inner_faces_connectivity tables and add to the boundary
+      bdry_face_connectivity.set_row(idx,elems);
+      bdry_face_nb[idx][0] = inner_face.face_nb_in_cells()[0];
+      bdry_face_is_bdry[idx] = true;
+
+      buf_inner_face_connectivity[inner_face.comp]->rm_row(inner_face.idx);
+      buf_inner_face_nb[inner_face.comp]->rm_row(inner_face.idx);
+      buf_inner_face_is_bdry[inner_face.comp]->rm_row(inner_face.idx);
     }
   }
 
@@ -58,6 +58,8 @@ private: // data
 
   bool m_store_cell2face;
 
+  Uint m_nb_threads;
+
 }; // end BuildFaces
 
 
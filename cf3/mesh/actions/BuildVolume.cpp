@@ -19,6 +19,8 @@
 #include "mesh/Mesh.hpp"
 #include "mesh/Field.hpp"
 #include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -66,14 +68,13 @@ void BuildVolume::execute()
 
   boost_foreach( const Handle<Space>& space, volume.spaces() )
   {
-    RealMatrix coordinates;  space->support().geometry_space().allocate_coordinates(coordinates);
+    const Space& geometry_space = space->support().geometry_space();
+    RealVector volumes;
+    space->support().element_type().compute_volumes( geometry_space.connectivity(), geometry_space.dict().coordinates(), 0, space->size(), volumes );
 
     const Connectivity& space_connectivity = space->connectivity();
     for (Uint cell_idx = 0; cell_idx<space->size(); ++cell_idx)
-    {
-      space->support().geometry_space().put_coordinates( coordinates, cell_idx );
-      volume[space_connectivity[cell_idx][0]][0] = space->support().element_type().volume( coordinates );
-    }
+      volume[space_connectivity[cell_idx][0]][0] = volumes[cell_idx];
   }
 
 }
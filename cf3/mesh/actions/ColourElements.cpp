@@ -0,0 +1,93 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/Log.hpp"
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/PropertyList.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Tags.hpp"
+
+#include "mesh/actions/ColourElements.hpp"
+#include "mesh/actions/ElementColouring.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace actions {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < ColourElements, MeshTransformer, mesh::actions::LibActions> ColourElements_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+ColourElements::ColourElements( const std::string& name )
+: MeshTransformer(name)
+{
+  properties()["brief"] = std::string("Colour the elements of each space, so that elements of the same colour share no node");
+  std::string desc;
+  desc =
+      "  Usage: ColourElements \n\n"
+      "  Optional arguments:\n"
+      "    - balance the colour sizes\n"
+      "        balanced:bool=false\n";
+  properties()["description"] = desc;
+
+  options().add("balanced", false)
+      .description("Move elements between colours so all colours have about the same size")
+      .mark_basic();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ColourElements::execute()
+{
+  const bool balanced = options().value<bool>("balanced");
+
+  boost_foreach(const Handle<Dictionary>& dict, m_mesh->dictionaries())
+  {
+    boost_foreach(const Handle<Space>& space, dict->spaces())
+    {
+      const ElementColouring& space_colouring = colouring(*space, balanced);
+      CFdebug << "Coloured " << space_colouring.nb_elements() << " elements of " << space->uri().path()
+              << " using " << space_colouring.nb_colours() << " colours" << CFendl;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+const ElementColouring& ColourElements::colouring(Space& space, const bool balanced)
+{
+  Handle<ElementColouring> result(space.get_child("element_colouring"));
+  if(is_not_null(result) && result->nb_elements() == space.size() && result->balanced() == balanced)
+    return *result;
+
+  if(is_null(result))
+  {
+    result = space.create_component<ElementColouring>("element_colouring");
+    result->add_tag(mesh::Tags::connectivity_cache());
+  }
+
+  result->build(space.connectivity(), space.dict().size(), balanced);
+  return *result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // mesh
+} // cf3
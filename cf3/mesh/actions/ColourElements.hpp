@@ -0,0 +1,62 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_actions_ColourElements_hpp
+#define cf3_mesh_actions_ColourElements_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshTransformer.hpp"
+
+#include "mesh/actions/LibActions.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  class Space;
+
+namespace actions {
+
+  class ElementColouring;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Colour the elements of every space in the mesh
+///
+/// The colouring of each space is cached as an ElementColouring child of the space,
+/// tagged with Tags::connectivity_cache(). MeshAdaptor::finish() removes it when
+/// the mesh changes, and the next call to colouring() computes it again.
+class mesh_actions_API ColourElements : public MeshTransformer
+{
+public: // functions
+
+  /// constructor
+  ColourElements( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "ColourElements"; }
+
+  virtual void execute();
+
+  /// Get the colouring of the given space, computing it if it is not cached or out of date.
+  /// Not thread-safe: call this before starting any threads that use the colouring.
+  /// @param space The space to colour
+  /// @param balanced Balance the colour sizes
+  static const ElementColouring& colouring(Space& space, const bool balanced = false);
+
+}; // end ColourElements
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_actions_ColourElements_hpp
@@ -0,0 +1,156 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Table.hpp"
+
+#include "mesh/actions/ElementColouring.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace actions {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < ElementColouring, Component, mesh::actions::LibActions> ElementColouring_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+ElementColouring::ElementColouring( const std::string& name ) :
+  Component(name),
+  m_balanced(false)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ElementColouring::build(const Table<Uint>& connectivity, const Uint nb_nodes, const bool balanced)
+{
+  const Uint nb_elems = connectivity.size();
+  const Uint nb_elem_nodes = connectivity.row_size();
+
+  std::vector<Uint> colours(nb_elems, 0);
+  std::vector<Uint> colour_sizes;
+
+  // Greedy colouring. The colours used by each node are stored as a bitmask, so each sweep handles 64 colours.
+  // Elements that could not be coloured are tried again in the next sweep with 64 new colours.
+  std::vector<boost::uint64_t> node_masks(nb_nodes);
+  std::vector<Uint> todo(nb_elems);
+  for(Uint elem = 0; elem != nb_elems; ++elem)
+    todo[elem] = elem;
+
+  Uint first_colour = 0;
+  while(!todo.empty())
+  {
+    std::fill(node_masks.begin(), node_masks.end(), 0);
+    colour_sizes.resize(first_colour + 64, 0);
+    std::vector<Uint> deferred;
+    for(std::vector<Uint>::const_iterator elem_it = todo.begin(); elem_it != todo.end(); ++elem_it)
+    {
+      Table<Uint>::ConstRow row = connectivity[*elem_it];
+      boost::uint64_t used = 0;
+      for(Uint i = 0; i != nb_elem_nodes; ++i)
+        used |= node_masks[row[i]];
+
+      if(used == ~boost::uint64_t(0))
+      {
+        deferred.push_back(*elem_it);
+        continue;
+      }
+
+      // Pick the lowest free colour
+      Uint colour = 0;
+      while(used & (boost::uint64_t(1) << colour))
+        ++colour;
+
+      const boost::uint64_t colour_bit = boost::uint64_t(1) << colour;
+      for(Uint i = 0; i != nb_elem_nodes; ++i)
+        node_masks[row[i]] |= colour_bit;
+
+      colours[*elem_it] = first_colour + colour;
+      ++colour_sizes[first_colour + colour];
+    }
+    todo.swap(deferred);
+    first_colour += 64;
+  }
+
+  // Drop trailing empty colours
+  while(!colour_sizes.empty() && colour_sizes.back() == 0)
+    colour_sizes.pop_back();
+
+  const Uint nb_colours = colour_sizes.size();
+
+  // Balancing: move elements out of colours above the average size into the first colour below the average
+  // that is not used by any of their nodes
+  if(balanced && nb_colours > 1)
+  {
+    const Uint target_size = (nb_elems + nb_colours - 1) / nb_colours;
+    std::vector<bool> node_colours(nb_nodes * nb_colours, false);
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+    {
+      Table<Uint>::ConstRow row = connectivity[elem];
+      for(Uint i = 0; i != nb_elem_nodes; ++i)
+        node_colours[row[i]*nb_colours + colours[elem]] = true;
+    }
+
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+    {
+      const Uint old_colour = colours[elem];
+      if(colour_sizes[old_colour] <= target_size)
+        continue;
+
+      Table<Uint>::ConstRow row = connectivity[elem];
+      for(Uint new_colour = 0; new_colour != nb_colours; ++new_colour)
+      {
+        if(colour_sizes[new_colour] >= target_size)
+          continue;
+
+        bool is_free = true;
+        for(Uint i = 0; i != nb_elem_nodes && is_free; ++i)
+          is_free = !node_colours[row[i]*nb_colours + new_colour];
+
+        if(!is_free)
+          continue;
+
+        for(Uint i = 0; i != nb_elem_nodes; ++i)
+        {
+          node_colours[row[i]*nb_colours + old_colour] = false;
+          node_colours[row[i]*nb_colours + new_colour] = true;
+        }
+        colours[elem] = new_colour;
+        --colour_sizes[old_colour];
+        ++colour_sizes[new_colour];
+        break;
+      }
+    }
+  }
+
+  // Sort the elements by colour
+  m_colour_starts.assign(nb_colours + 1, 0);
+  for(Uint c = 0; c != nb_colours; ++c)
+    m_colour_starts[c+1] = m_colour_starts[c] + colour_sizes[c];
+
+  std::vector<Uint> fill_positions(m_colour_starts.begin(), m_colour_starts.end() - 1);
+  m_elements.resize(nb_elems);
+  for(Uint elem = 0; elem != nb_elems; ++elem)
+    m_elements[fill_positions[colours[elem]]++] = elem;
+
+  m_balanced = balanced;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // mesh
+} // cf3
@@ -0,0 +1,79 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_actions_ElementColouring_hpp
+#define cf3_mesh_actions_ElementColouring_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Component.hpp"
+#include "common/Table_fwd.hpp"
+
+#include "mesh/actions/LibActions.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace actions {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Elements of a connectivity table, grouped in colours
+///
+/// No two elements of the same colour share a node, so the elements of a colour
+/// can be processed concurrently, even when they scatter results to their nodes.
+/// The elements are stored sorted by colour, colour c occupying the range
+/// [colour_starts()[c], colour_starts()[c+1]) of elements().
+class mesh_actions_API ElementColouring : public common::Component
+{
+public: // functions
+
+  /// constructor
+  ElementColouring( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "ElementColouring"; }
+
+  /// Colour the rows of a connectivity table
+  /// @param connectivity Node indices for each element
+  /// @param nb_nodes Number of nodes the connectivity refers to
+  /// @param balanced If true, elements are moved from the largest to the smallest colours afterwards,
+  ///                 so the colours are of approximately equal size
+  void build(const common::Table<Uint>& connectivity, const Uint nb_nodes, const bool balanced = false);
+
+  /// Number of colours
+  Uint nb_colours() const { return m_colour_starts.empty() ? 0 : m_colour_starts.size() - 1; }
+
+  /// Number of coloured elements
+  Uint nb_elements() const { return m_elements.size(); }
+
+  /// True if the colouring was balanced
+  bool balanced() const { return m_balanced; }
+
+  /// Element indices, sorted by colour
+  const std::vector<Uint>& elements() const { return m_elements; }
+
+  /// Start of each colour in elements(), the last entry is the number of elements
+  const std::vector<Uint>& colour_starts() const { return m_colour_starts; }
+
+private: // data
+
+  std::vector<Uint> m_elements;
+  std::vector<Uint> m_colour_starts;
+  bool m_balanced;
+
+}; // end ElementColouring
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_actions_ElementColouring_hpp
@@ -18,6 +18,7 @@
 #include "common/PropertyList.hpp"
 #include "common/OptionT.hpp"
 #include "common/List.hpp"
+#include "common/HashMap.hpp"
 
 #include "common/PE/Comm.hpp"
 #include "common/PE/debug.hpp"
@@ -51,13 +52,133 @@ namespace actions {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Process responsible for resolving the given hash in the rendezvous algorithm
+inline Uint rendezvous_rank(boost::uint64_t hash, const Uint nb_procs)
+{
+  // Mix the bits, as neighbouring hilbert indices would otherwise end up on few processes
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash % nb_procs;
+}
+
+/// For every ghost entry, find the global index and rank of the owned entry with the same hash
+/// on another process.
+/// Every hash is sent to its rendezvous process with one all_to_all, where the owned and the ghost
+/// entries with that hash meet. The answers are sent back with a second all_to_all.
+/// Memory and communication volume scale with the number of local entries.
+/// @param [in]  hashes          hash of every local entry
+/// @param [in]  glb_idx         global index of every local entry, only used for owned entries
+/// @param [in]  is_ghost        true for entries owned by another process
+/// @param [out] owner_glb_idx   for every ghost entry, the global index given by its owner, uint_max() otherwise
+/// @param [out] owner_rank      for every ghost entry, the rank of its owner, uint_max() otherwise
+void rendezvous_ghost_numbering(const std::vector<boost::uint64_t>& hashes,
+                                const common::List<Uint>& glb_idx,
+                                const std::vector<bool>& is_ghost,
+                                std::vector<Uint>& owner_glb_idx,
+                                std::vector<Uint>& owner_rank)
+{
+  const Uint nb_procs = PE::Comm::instance().size();
+  const Uint nb_entries = hashes.size();
+
+  // Route owned entries as (hash, glb_idx) pairs, and ghost entries as queries for their hash
+  std::vector< std::vector<boost::uint64_t> > send_owned(nb_procs);
+  std::vector< std::vector<boost::uint64_t> > send_queries(nb_procs);
+  std::vector< std::vector<Uint> > query_entries(nb_procs);
+  for (Uint i=0; i<nb_entries; ++i)
+  {
+    const Uint rendezvous = rendezvous_rank(hashes[i],nb_procs);
+    if (is_ghost[i])
+    {
+      send_queries[rendezvous].push_back(hashes[i]);
+      query_entries[rendezvous].push_back(i);
+    }
+    else
+    {
+      send_owned[rendezvous].push_back(hashes[i]);
+      send_owned[rendezvous].push_back(glb_idx[i]);
+    }
+  }
+
+  std::vector< std::vector<boost::uint64_t> > recv_owned;
+  std::vector< std::vector<boost::uint64_t> > recv_queries;
+  PE::Comm::instance().all_to_all(send_owned,recv_owned);
+  PE::Comm::instance().all_to_all(send_queries,recv_queries);
+  std::vector< std::vector<boost::uint64_t> >().swap(send_owned);
+  std::vector< std::vector<boost::uint64_t> >().swap(send_queries);
+
+  // Resolve the queries on this rendezvous process. If several processes claim the same hash,
+  // the lowest rank wins, so all processes agree.
+  boost::shared_ptr< HashMap<boost::uint64_t,Uint> > owned_ptr = allocate_component< HashMap<boost::uint64_t,Uint> >("owned");
+  HashMap<boost::uint64_t,Uint>& owned = *owned_ptr;
+  std::vector<Uint> owned_glb_idx;
+  std::vector<Uint> owned_rank;
+  Uint nb_owned = 0;
+  for (Uint p=0; p<nb_procs; ++p)
+    nb_owned += recv_owned[p].size()/2;
+  owned.reserve(nb_owned);
+  owned_glb_idx.reserve(nb_owned);
+  owned_rank.reserve(nb_owned);
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    for (Uint i=0; i<recv_owned[p].size(); i+=2)
+    {
+      if (owned.insert(std::make_pair(recv_owned[p][i],static_cast<Uint>(owned_glb_idx.size()))).second)
+      {
+        owned_glb_idx.push_back(recv_owned[p][i+1]);
+        owned_rank.push_back(p);
+      }
+    }
+  }
+  std::vector< std::vector<boost::uint64_t> >().swap(recv_owned);
+
+  std::vector< std::vector<boost::uint64_t> > send_answers(nb_procs);
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    send_answers[p].reserve(2*recv_queries[p].size());
+    boost_foreach(const boost::uint64_t hash, recv_queries[p])
+    {
+      HashMap<boost::uint64_t,Uint>::const_iterator it = owned.find(hash);
+      if (it != owned.end())
+      {
+        send_answers[p].push_back(owned_glb_idx[it->second]);
+        send_answers[p].push_back(owned_rank[it->second]);
+      }
+      else
+      {
+        send_answers[p].push_back(uint_max());
+        send_answers[p].push_back(uint_max());
+      }
+    }
+  }
+
+  std::vector< std::vector<boost::uint64_t> > recv_answers;
+  PE::Comm::instance().all_to_all(send_answers,recv_answers);
+
+  // Answers come back in the order the queries were sent
+  owner_glb_idx.assign(nb_entries,uint_max());
+  owner_rank.assign(nb_entries,uint_max());
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    cf3_assert(recv_answers[p].size() == 2*query_entries[p].size());
+    for (Uint q=0; q<query_entries[p].size(); ++q)
+    {
+      owner_glb_idx[query_entries[p][q]] = recv_answers[p][2*q];
+      owner_rank[query_entries[p][q]]    = recv_answers[p][2*q+1];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 common::ComponentBuilder < GlobalNumbering, MeshTransformer, mesh::actions::LibActions> GlobalNumbering_Builder;
 
 //////////////////////////////////////////////////////////////////////////////
 
 GlobalNumbering::GlobalNumbering( const std::string& name )
 : MeshTransformer(name),
-  m_debug(false)
+  m_debug(false),
+  m_rendezvous(true)
 {
 
   properties()["brief"] = std::string("Construct global node and element numbering based on coordinates hash values");
@@ -71,6 +192,12 @@ GlobalNumbering::GlobalNumbering( const std::string& name )
       .pretty_name("Debug")
       .link_to(&m_debug);
 
+  options().add("rendezvous", m_rendezvous)
+      .description("Find the global indices of ghosts by sending every hash to a rendezvous process, "
+                   "instead of broadcasting the hashes of every process to all processes")
+      .pretty_name("Rendezvous")
+      .link_to(&m_rendezvous);
+
   options().add("combined", true)
       .description("Combine nodes and elements in one global numbering")
       .pretty_name("Combined");
@@ -287,50 +414,73 @@ void GlobalNumbering::execute()
   if (node_hilbert2loc.count(267565322921))
     std::cout << PERank << "++++++ hilbert 267565322921 found at local idx "<< node_hilbert2loc[267565322921] << ", owned by " << nodes.rank()[node_hilbert2loc[267565322921]] << std::endl;
 
-  for (Uint root=0; root<PE::Comm::instance().size(); ++root)
+  if (m_rendezvous)
   {
+    std::vector<bool> node_is_ghost(nodes.size());
+    for (Uint i=0; i<nodes.size(); ++i)
+      node_is_ghost[i] = nodes.is_ghost(i);
 
-    std::vector<boost::uint64_t> rcv_node_from(0);
-    PE::Comm::instance().broadcast(node_from,rcv_node_from,root);
-    std::vector<boost::uint64_t>        rcv_node_to(0);
-    PE::Comm::instance().broadcast(node_to,rcv_node_to,root);
-
-    if (m_debug)
+    std::vector<Uint> owner_glb_idx;
+    std::vector<Uint> owner_rank;
+    rendezvous_ghost_numbering(hilbert_indices.data(),nodes_glb_idx,node_is_ghost,owner_glb_idx,owner_rank);
+    for (Uint i=0; i<nodes.size(); ++i)
     {
-      std::cout << "["<<PE::Comm::instance().rank() << "]  received nodes from " << root << std::endl;
+      if (owner_glb_idx[i] != uint_max())
+      {
+        if (m_debug)
+          std::cout << "["<<PE::Comm::instance().rank() << "]  will change node "<< hilbert_indices.data()[i] << " (" << i << ") to " << owner_glb_idx[i] << std::endl;
+        nodes_glb_idx[i]=owner_glb_idx[i];
+        nodes_rank[i]=std::min(owner_rank[i],nodes_rank[i]);
+      }
     }
-
-    if (PE::Comm::instance().rank() != root)
+  }
+  else
+  {
+    for (Uint root=0; root<PE::Comm::instance().size(); ++root)
     {
-      for (Uint p=0; p<PE::Comm::instance().size(); ++p)
+
+      std::vector<boost::uint64_t> rcv_node_from(0);
+      PE::Comm::instance().broadcast(node_from,rcv_node_from,root);
+      std::vector<boost::uint64_t>        rcv_node_to(0);
+      PE::Comm::instance().broadcast(node_to,rcv_node_to,root);
+
+      if (m_debug)
+      {
+        std::cout << "["<<PE::Comm::instance().rank() << "]  received nodes from " << root << std::endl;
+      }
+
+      if (PE::Comm::instance().rank() != root)
       {
-        if (p == PE::Comm::instance().rank())
+        for (Uint p=0; p<PE::Comm::instance().size(); ++p)
         {
-          Uint rcv_idx(0);
-          boost_foreach(const boost::uint64_t hilbert_idx, rcv_node_from)
+          if (p == PE::Comm::instance().rank())
           {
-            if ( node_hilbert2loc.count(hilbert_idx) )
+            Uint rcv_idx(0);
+            boost_foreach(const boost::uint64_t hilbert_idx, rcv_node_from)
             {
-              const Uint loc_idx = node_hilbert2loc[hilbert_idx];
-              if (m_debug)
-                std::cout << "["<<PE::Comm::instance().rank() << "]  will change node "<< hilbert_idx << " (" << loc_idx<< ") to " << rcv_node_to[rcv_idx] << std::endl;
-              cf3_assert(rcv_idx < rcv_node_to.size());
-              nodes_glb_idx[loc_idx]=rcv_node_to[rcv_idx];
-              cf3_assert(loc_idx < nodes_rank.size());
-              cf3_assert_desc("node "+to_str(loc_idx)+ " with hilbert_idx " +to_str(hilbert_idx) +" must be a ghost, but is owned by "+to_str(nodes_rank[loc_idx]),nodes.is_ghost(loc_idx));
-              nodes_rank[loc_idx]=std::min(root,nodes_rank[loc_idx]);
+              if ( node_hilbert2loc.count(hilbert_idx) )
+              {
+                const Uint loc_idx = node_hilbert2loc[hilbert_idx];
+                if (m_debug)
+                  std::cout << "["<<PE::Comm::instance().rank() << "]  will change node "<< hilbert_idx << " (" << loc_idx<< ") to " << rcv_node_to[rcv_idx] << std::endl;
+                cf3_assert(rcv_idx < rcv_node_to.size());
+                nodes_glb_idx[loc_idx]=rcv_node_to[rcv_idx];
+                cf3_assert(loc_idx < nodes_rank.size());
+                cf3_assert_desc("node "+to_str(loc_idx)+ " with hilbert_idx " +to_str(hilbert_idx) +" must be a ghost, but is owned by "+to_str(nodes_rank[loc_idx]),nodes.is_ghost(loc_idx));
+                nodes_rank[loc_idx]=std::min(root,nodes_rank[loc_idx]);
+              }
+              ++rcv_idx;
             }
-            ++rcv_idx;
+            break;
           }
-          break;
         }
       }
-    }
-    if (m_debug)
-    {
-      std::cout << "["<<PE::Comm::instance().rank() << "]  changed nodes based on " << root << std::endl;
-    }
+      if (m_debug)
+      {
+        std::cout << "["<<PE::Comm::instance().rank() << "]  changed nodes based on " << root << std::endl;
+      }
 
+    }
   }
 
   if (m_debug)
@@ -401,37 +551,60 @@ void GlobalNumbering::execute()
     } // end foreach elem_idx
     cf3_assert(cnt == nb_owned_elems);
 
-    for (Uint root=0; root<PE::Comm::instance().size(); ++root)
+    if (m_rendezvous)
     {
-      std::vector<boost::uint64_t> recv_hash(0);
-      PE::Comm::instance().broadcast(send_hash,recv_hash,root);
-      std::vector<boost::uint64_t>        recv_id(0);
-      PE::Comm::instance().broadcast(send_id,recv_id,root);
-      if (PE::Comm::instance().rank() != root)
+      std::vector<bool> elem_is_ghost(elements.size());
+      for (Uint e=0; e<elements.size(); ++e)
+        elem_is_ghost[e] = elements.is_ghost(e);
+
+      std::vector<Uint> owner_glb_idx;
+      std::vector<Uint> owner_rank;
+      rendezvous_ghost_numbering(hilbert_indices,elements_glb_idx,elem_is_ghost,owner_glb_idx,owner_rank);
+      for (Uint e=0; e<elements.size(); ++e)
       {
-        for (Uint p=0; p<PE::Comm::instance().size(); ++p)
+        if (owner_glb_idx[e] != uint_max())
         {
-          if (p == PE::Comm::instance().rank())
+          if (m_debug)
+            std::cout << "["<<PE::Comm::instance().rank() << "]  will change ghost elem "<< hilbert_indices[e] << " (" << elements.uri() << "[" << e << "]) to " << owner_glb_idx[e] << std::endl;
+          elements_glb_idx[e]=owner_glb_idx[e];
+          elem_rank[e]=owner_rank[e];
+        }
+      }
+    }
+    else
+    {
+      for (Uint root=0; root<PE::Comm::instance().size(); ++root)
+      {
+        std::vector<boost::uint64_t> recv_hash(0);
+        PE::Comm::instance().broadcast(send_hash,recv_hash,root);
+        std::vector<boost::uint64_t>        recv_id(0);
+        PE::Comm::instance().broadcast(send_id,recv_id,root);
+        if (PE::Comm::instance().rank() != root)
+        {
+          for (Uint p=0; p<PE::Comm::instance().size(); ++p)
           {
-            Uint recv_idx(0);
-            boost_foreach(const boost::uint64_t hash, recv_hash)
+            if (p == PE::Comm::instance().rank())
             {
-              elem_glb2loc_it = elem_glb2loc.find(hash);
-              if ( elem_glb2loc_it != hash_not_found )
+              Uint recv_idx(0);
+              boost_foreach(const boost::uint64_t hash, recv_hash)
               {
-                if (m_debug)
-                  std::cout << "["<<PE::Comm::instance().rank() << "]  will change ghost elem "<< elem_glb2loc_it->first << " (" << elements.uri() << "[" << elem_glb2loc_it->second << "]) to " << recv_id[recv_idx] << std::endl;
-                elements_glb_idx[elem_glb2loc_it->second]=recv_id[recv_idx];
-                cf3_assert(elements.is_ghost(elem_glb2loc_it->second));
-                elem_rank[elem_glb2loc_it->second]=root;
+                elem_glb2loc_it = elem_glb2loc.find(hash);
+                if ( elem_glb2loc_it != hash_not_found )
+                {
+                  if (m_debug)
+                    std::cout << "["<<PE::Comm::instance().rank() << "]  will change ghost elem "<< elem_glb2loc_it->first << " (" << elements.uri() << "[" << elem_glb2loc_it->second << "]) to " << recv_id[recv_idx] << std::endl;
+                  elements_glb_idx[elem_glb2loc_it->second]=recv_id[recv_idx];
+                  cf3_assert(elements.is_ghost(elem_glb2loc_it->second));
+                  elem_rank[elem_glb2loc_it->second]=root;
+                }
+                ++recv_idx;
               }
-              ++recv_idx;
+              break;
             }
-            break;
           }
         }
-      }
-    } // end foreach broadcasting process
+      } // end foreach broadcasting process
+    }
 
 
 
@@ -50,6 +50,8 @@ public: // functions
 private: // data
 
   bool m_debug;
+
+  bool m_rendezvous;
 }; // end GlobalNumbering
 
 
@@ -20,7 +20,7 @@
 #include "mesh/Space.hpp"
 #include "mesh/Field.hpp"
 #include "mesh/ShapeFunction.hpp"
-#include "mesh/Octtree.hpp"
+#include "mesh/ElementTree.hpp"
 #include "mesh/Connectivity.hpp"
 
 #include "mesh/actions/Interpolate.hpp"
@@ -157,14 +157,14 @@ void Interpolate::interpolate(const Field& source, const common::Table<Real>& co
 
   Mesh& source_mesh = find_parent_component<Mesh>(source);
 
-  if ( is_null(m_octtree) )
+  if ( is_null(m_tree) )
   {
-    if (Handle<Component> found = source_mesh.get_child("octtree"))
-      m_octtree = Handle<Octtree>(found);
+    if (Handle<Component> found = source_mesh.get_child("element_tree"))
+      m_tree = Handle<ElementTree>(found);
     else
     {
-      m_octtree = source_mesh.create_component<Octtree>("octtree");
-      m_octtree->options().set("mesh",source_mesh.handle<Mesh>());
+      m_tree = source_mesh.create_component<ElementTree>("element_tree");
+      m_tree->options().set("mesh",source_mesh.handle<Mesh>());
     }
   }
 
@@ -178,11 +178,16 @@ void Interpolate::interpolate(const Field& source, const common::Table<Real>& co
   RealVector coord(dimension); coord.setZero();
   const Uint target_dim = coordinates.row_size();
 
+  // Locate all coordinates at once, in an order that keeps the tree traversals local
+  std::vector<Entity> elements;
+  m_tree->find_elements(coordinates,elements);
+
   for(Uint i=0; i<coordinates.size(); ++i)
   {
     for (Uint d=0; d<target_dim; ++d)
       coord[d] = coordinates[i][d];
-    if( m_octtree->find_element(coord,element) )
+    element = elements[i];
+    if( is_not_null(element.comp) )
     {
       interpolate_coordinate( coord, *element.comp, element.idx, target[i] );
 //      std::cout<< PERank << "interpolate for coord (" << coord.transpose() << ") in " << element_component->uri().path() << "["<<element_idx<<"] ... done" << std::endl;
@@ -250,7 +255,7 @@ void Interpolate::interpolate(const Field& source, const common::Table<Real>& co
         for (Uint d=0; d<target_dim; ++d)
           coord[d] = recv_coordinates[i][d];
 
-        if( m_octtree->find_element(coord,element) )
+        if( m_tree->find_element(coord,element) )
         {
 //          std::cout<< PERank << " send to " << root << ": interpolate for coord (" << coord.transpose() << ") in " << element_component->uri().path() << "["<<element_idx<<"]" << std::endl;
           boost::multi_array<Real,2> target_row(boost::extents[1][nb_vars]);
@@ -20,7 +20,7 @@
 namespace cf3 {
 namespace mesh {
 
-  class Octtree;
+  class ElementTree;
   class Field;
   class Elements;
 
@@ -64,8 +64,8 @@ private:
   /// target field
   Handle<Field> m_target;
 
-  /// source octtree
-  Handle<Octtree> m_octtree;
+  /// tree locating the target coordinates in the source mesh
+  Handle<ElementTree> m_tree;
 
   void interpolate_coordinate(const RealVector& target_coord, const Entities& element_component, const Uint element_idx, Field::Row target_row);
 
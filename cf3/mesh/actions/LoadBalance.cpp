@@ -9,6 +9,7 @@
 #include "common/Builder.hpp"
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
 #include "common/PropertyList.hpp"
 
 #include "common/PE/Comm.hpp"
@@ -38,11 +39,8 @@ LoadBalance::LoadBalance( const std::string& name ) :
   ,m_partitioner(create_component("partitioner", "cf3.mesh.ptscotch.Partitioner"))
 #elif (defined CF3_HAVE_ZOLTAN)
   ,m_partitioner(create_component("partitioner", "cf3.mesh.zoltan.Partitioner"))
-#endif
-
-#if ( !defined CF3_HAVE_PTSCOTCH ) && ( !defined CF3_HAVE_ZOLTAN )
-#warning "There is no partitioner available (Zoltan or PT-Scotch). Load-balancing will not be possible."
-#define CF3_MESH_LOADBALANCE_PARTITIONER_UNAVAILABLE
+#else
+  ,m_partitioner(create_component("partitioner", "cf3.mesh.hilbert.Partitioner"))
 #endif
 {
 
@@ -52,6 +50,10 @@ LoadBalance::LoadBalance( const std::string& name ) :
     "  Usage: LoadBalance Regions:array[uri]=region1,region2\n\n";
   properties()["description"] = desc;
 
+  options().add("hilbert_warm_start", false)
+      .description("Distribute the elements along the Hilbert space-filling curve before calling the graph partitioner")
+      .pretty_name("Hilbert Warm Start");
+
 #if (defined CF3_HAVE_PTSCOTCH)
   // no configuration necessary
 #elif (defined CF3_HAVE_ZOLTAN)
@@ -81,6 +83,17 @@ void LoadBalance::execute()
     CFinfo << "  + building joint node & element global numbering ... done" << CFendl;
     Comm::instance().barrier();
 
+    // A cheap first distribution, so the graph partitioner starts from compact parts.
+    // Migration leaves the global numbering non-contiguous, so it is rebuilt afterwards.
+    if( options().value<bool>("hilbert_warm_start") && m_partitioner->derived_type_name() != "cf3.mesh.hilbert.Partitioner" )
+    {
+      CFinfo << "  + hilbert warm start ..." << CFendl;
+      build_component_abstract_type<MeshTransformer>("cf3.mesh.hilbert.Partitioner","hilbert_partitioner")->transform(mesh);
+      build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering","glb_numbering")->transform(mesh);
+      CFinfo << "  + hilbert warm start ... done" << CFendl;
+      Comm::instance().barrier();
+    }
+
     CFinfo << "  + building global node-element connectivity ... " << CFendl;
 
     build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalConnectivity","glb_connectivity")->transform(mesh);
@@ -88,13 +101,9 @@ void LoadBalance::execute()
     CFinfo << "  + building global node-element connectivity ... done" << CFendl;
     Comm::instance().barrier();
 
-#ifdef CF3_MESH_LOADBALANCE_PARTITIONER_UNAVAILABLE
-    CFwarn << "  Skipping mesh partitioning. (No partitioner available)" << CFendl;
-#else
     CFinfo << "  + partitioning and migrating ..." << CFendl;
     m_partitioner->transform(mesh);
     CFinfo << "  + partitioning and migrating ... done" << CFendl;
-#endif
     Comm::instance().barrier();
     CFinfo << "  + growing overlap layer ..." << CFendl;
     build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GrowOverlap","grow_overlap")->transform(mesh);
@@ -0,0 +1,159 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/checkpoint/File.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+  using namespace common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Largest number of bytes passed to a single MPI-IO call, which counts in int
+const boost::uint64_t max_bytes_per_call = 1u << 30;
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+File::File(const boost::filesystem::path& path, const Mode mode) :
+  m_path(path),
+  m_parallel(PE::Comm::instance().is_active()),
+  m_open(false)
+{
+  if (m_parallel)
+  {
+    // Collective buffering aggregates the contiguous rank ranges into large file system requests
+    MPI_Info info;
+    MPI_CHECK_RESULT(MPI_Info_create, (&info));
+    MPI_CHECK_RESULT(MPI_Info_set, (info, const_cast<char*>("romio_cb_write"), const_cast<char*>("enable")));
+    MPI_CHECK_RESULT(MPI_Info_set, (info, const_cast<char*>("romio_cb_read"), const_cast<char*>("enable")));
+
+    const int amode = (mode == WRITE) ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+    const int result = MPI_File_open(PE::Comm::instance().communicator(), const_cast<char*>(path.string().c_str()), amode, info, &m_handle);
+    MPI_Info_free(&info);
+    if (result != MPI_SUCCESS)
+      throw FileSystemError(FromHere(), "Could not open checkpoint file " + path.string());
+
+    if (mode == WRITE)
+      MPI_CHECK_RESULT(MPI_File_set_size, (m_handle, 0));
+  }
+  else
+  {
+    const std::ios_base::openmode openmode = (mode == WRITE) ? (std::ios_base::out | std::ios_base::trunc | std::ios_base::binary) : (std::ios_base::in | std::ios_base::binary);
+    m_stream.open(path, openmode);
+    if (!m_stream)
+      throw FileSystemError(FromHere(), "Could not open checkpoint file " + path.string());
+  }
+  m_open = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+File::~File()
+{
+  // Closing is collective, so a file left open by an exception is only closed in serial
+  if (m_open && !m_parallel)
+    m_stream.close();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Uint File::nb_calls(const boost::uint64_t nb_bytes) const
+{
+  std::vector<Uint> local_calls(1, static_cast<Uint>(std::max<boost::uint64_t>(1u, (nb_bytes + max_bytes_per_call - 1) / max_bytes_per_call)));
+  std::vector<Uint> global_calls(1);
+  PE::Comm::instance().all_reduce(PE::max(), local_calls, global_calls);
+  return global_calls[0];
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void File::write_at_all(const boost::uint64_t offset, const void* data, const boost::uint64_t nb_bytes)
+{
+  cf3_assert(m_open);
+  if (!m_parallel)
+  {
+    m_stream.seekp(offset);
+    m_stream.write(static_cast<const char*>(data), nb_bytes);
+    if (!m_stream)
+      throw FileSystemError(FromHere(), "Could not write to checkpoint file " + m_path.string());
+    return;
+  }
+
+  const Uint calls = nb_calls(nb_bytes);
+  boost::uint64_t done = 0;
+  for (Uint call=0; call<calls; ++call)
+  {
+    const int count = static_cast<int>(std::min(max_bytes_per_call, nb_bytes - done));
+    MPI_CHECK_RESULT(MPI_File_write_at_all, (m_handle, static_cast<MPI_Offset>(offset + done), const_cast<char*>(static_cast<const char*>(data) + done), count, MPI_BYTE, MPI_STATUS_IGNORE));
+    done += count;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void File::read_at_all(const boost::uint64_t offset, void* data, const boost::uint64_t nb_bytes)
+{
+  cf3_assert(m_open);
+  if (!m_parallel)
+  {
+    m_stream.seekg(offset);
+    m_stream.read(static_cast<char*>(data), nb_bytes);
+    if (!m_stream)
+      throw FileSystemError(FromHere(), "Could not read " + to_str(static_cast<Uint>(nb_bytes)) + " bytes from checkpoint file " + m_path.string());
+    return;
+  }
+
+  const Uint calls = nb_calls(nb_bytes);
+  boost::uint64_t done = 0;
+  for (Uint call=0; call<calls; ++call)
+  {
+    const int count = static_cast<int>(std::min(max_bytes_per_call, nb_bytes - done));
+    MPI_Status status;
+    MPI_CHECK_RESULT(MPI_File_read_at_all, (m_handle, static_cast<MPI_Offset>(offset + done), static_cast<char*>(data) + done, count, MPI_BYTE, &status));
+    int nb_read;
+    MPI_Get_count(&status, MPI_BYTE, &nb_read);
+    if (nb_read != count)
+      throw FileSystemError(FromHere(), "Could not read " + to_str(count) + " bytes from checkpoint file " + m_path.string());
+    done += count;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void File::close()
+{
+  if (!m_open)
+    return;
+  if (m_parallel)
+  {
+    MPI_CHECK_RESULT(MPI_File_close, (&m_handle));
+  }
+  else
+  {
+    m_stream.close();
+  }
+  m_open = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
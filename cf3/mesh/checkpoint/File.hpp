@@ -0,0 +1,72 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_checkpoint_File_hpp
+#define cf3_mesh_checkpoint_File_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/PE/types.hpp"
+
+#include "mesh/checkpoint/LibCheckpoint.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// File shared by all ranks, accessed with collective MPI-IO.
+/// Every rank reads or writes one contiguous range of bytes per call, and all ranks
+/// must take part in each call, possibly with zero bytes.
+/// When the parallel environment is not active, a plain file stream is used instead.
+class checkpoint_API File : public boost::noncopyable
+{
+public:
+
+  enum Mode { READ, WRITE };
+
+  /// Open the file on all ranks. In WRITE mode, an existing file is truncated.
+  File(const boost::filesystem::path& path, const Mode mode);
+
+  ~File();
+
+  /// Write nb_bytes at the given byte offset (collective)
+  void write_at_all(const boost::uint64_t offset, const void* data, const boost::uint64_t nb_bytes);
+
+  /// Read nb_bytes from the given byte offset (collective)
+  void read_at_all(const boost::uint64_t offset, void* data, const boost::uint64_t nb_bytes);
+
+  /// Close the file (collective)
+  void close();
+
+private:
+
+  /// Number of MPI-IO calls needed by the largest request over all ranks
+  Uint nb_calls(const boost::uint64_t nb_bytes) const;
+
+  boost::filesystem::path m_path;
+  bool m_parallel;
+  bool m_open;
+  MPI_File m_handle;
+  boost::filesystem::fstream m_stream;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_checkpoint_File_hpp
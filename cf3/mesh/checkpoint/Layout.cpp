@@ -0,0 +1,225 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Foreach.hpp"
+#include "common/StringConversion.hpp"
+
+#include "mesh/checkpoint/Layout.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+  using namespace common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const char magic[8] = { 'C', 'F', '3', 'C', 'H', 'K', 'P', 'T' };
+
+/// Written in native byte order, to detect files from a machine with a different one
+const boost::uint64_t byte_order_mark = 0x0102030405060708ull;
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+const Uint Layout::header_size;
+const Uint Layout::version;
+const boost::uint64_t Layout::no_rank;
+
+//////////////////////////////////////////////////////////////////////////////
+
+Layout::Layout() :
+  dimension(0),
+  nb_nodes(0),
+  m_end(header_size)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Layout::Block& Layout::add_block(const std::string& name, const bool is_real, const boost::uint64_t nb_rows, const boost::uint64_t row_size)
+{
+  Block block;
+  block.name = name;
+  block.is_real = is_real;
+  block.offset = m_end;
+  block.nb_rows = nb_rows;
+  block.row_size = row_size;
+  m_blocks.push_back(block);
+  m_end += nb_rows * row_size * 8u;
+  return m_blocks.back();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+const Layout::Block& Layout::block(const std::string& name) const
+{
+  boost_foreach(const Block& block, m_blocks)
+  {
+    if (block.name == name)
+      return block;
+  }
+  throw FileFormatError(FromHere(), "Checkpoint file has no block " + name);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::string Layout::table_of_contents() const
+{
+  std::stringstream toc;
+  toc << "dimension " << dimension << "\n";
+  toc << "nodes " << nb_nodes << "\n";
+  boost_foreach(const FieldInfo& field, node_fields)
+    toc << "node_field " << field.name << " " << field.description << "\n";
+  boost_foreach(const EntitiesInfo& info, entities)
+    toc << "entities " << info.path << " " << info.entities_type << " " << info.element_type << "\n";
+  boost_foreach(const DictionaryInfo& dict, dictionaries)
+  {
+    toc << "dictionary " << dict.name << " " << (dict.continuous ? "continuous" : "discontinuous") << "\n";
+    boost_foreach(const SpaceInfo& space, dict.spaces)
+      toc << "space " << dict.name << " " << space.entities << " " << space.shape_function << "\n";
+    boost_foreach(const FieldInfo& field, dict.fields)
+      toc << "field " << dict.name << " " << field.name << " " << field.description << "\n";
+  }
+  boost_foreach(const Block& block, m_blocks)
+    toc << "block " << block.name << " " << (block.is_real ? "real" : "uint") << " " << block.offset << " " << block.nb_rows << " " << block.row_size << "\n";
+  return toc.str();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Layout::parse_table_of_contents(const std::string& text)
+{
+  node_fields.clear();
+  entities.clear();
+  dictionaries.clear();
+  m_blocks.clear();
+  m_end = header_size;
+
+  std::stringstream toc(text);
+  std::string line;
+  while (std::getline(toc, line))
+  {
+    std::stringstream words(line);
+    std::string keyword;
+    if (!(words >> keyword))
+      continue;
+
+    if (keyword == "dimension")
+    {
+      words >> dimension;
+    }
+    else if (keyword == "nodes")
+    {
+      words >> nb_nodes;
+    }
+    else if (keyword == "node_field")
+    {
+      FieldInfo field;
+      words >> field.name >> field.description;
+      node_fields.push_back(field);
+    }
+    else if (keyword == "entities")
+    {
+      EntitiesInfo info;
+      words >> info.path >> info.entities_type >> info.element_type;
+      entities.push_back(info);
+    }
+    else if (keyword == "dictionary")
+    {
+      DictionaryInfo dict;
+      std::string continuity;
+      words >> dict.name >> continuity;
+      dict.continuous = (continuity == "continuous");
+      dictionaries.push_back(dict);
+    }
+    else if (keyword == "space" || keyword == "field")
+    {
+      std::string dict_name;
+      words >> dict_name;
+      if (dictionaries.empty() || dictionaries.back().name != dict_name)
+        throw FileFormatError(FromHere(), "Checkpoint table of contents lists a " + keyword + " outside of dictionary " + dict_name);
+      if (keyword == "space")
+      {
+        SpaceInfo space;
+        words >> space.entities >> space.shape_function;
+        dictionaries.back().spaces.push_back(space);
+      }
+      else
+      {
+        FieldInfo field;
+        words >> field.name >> field.description;
+        dictionaries.back().fields.push_back(field);
+      }
+    }
+    else if (keyword == "block")
+    {
+      Block block;
+      std::string type;
+      words >> block.name >> type >> block.offset >> block.nb_rows >> block.row_size;
+      block.is_real = (type == "real");
+      m_blocks.push_back(block);
+      m_end = std::max(m_end, block.offset + block.nb_rows * block.row_size * 8u);
+    }
+    else
+    {
+      throw FileFormatError(FromHere(), "Unknown keyword \"" + keyword + "\" in checkpoint table of contents");
+    }
+
+    if (words.fail())
+      throw FileFormatError(FromHere(), "Malformed line in checkpoint table of contents: " + line);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Layout::write_header(char* header, const boost::uint64_t toc_size) const
+{
+  const boost::uint64_t values[4] = { version, byte_order_mark, m_end, toc_size };
+  std::memset(header, 0, header_size);
+  std::memcpy(header, magic, sizeof(magic));
+  std::memcpy(header + sizeof(magic), values, sizeof(values));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Layout::read_header(const char* header, boost::uint64_t& toc_offset, boost::uint64_t& toc_size)
+{
+  if (std::memcmp(header, magic, sizeof(magic)) != 0)
+    throw FileFormatError(FromHere(), "File is not a coolfluid checkpoint");
+
+  boost::uint64_t values[4];
+  std::memcpy(values, header + sizeof(magic), sizeof(values));
+  if (values[1] != byte_order_mark)
+    throw FileFormatError(FromHere(), "Checkpoint file was written with a different byte order");
+  if (values[0] != version)
+    throw NotSupported(FromHere(), "Checkpoint format version " + to_str(static_cast<Uint>(values[0])) + " is not supported, only version " + to_str(version) + " is");
+  toc_offset = values[2];
+  toc_size = values[3];
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Uint Layout::chunk_begin(const Uint nb_rows, const Uint part, const Uint nb_parts)
+{
+  return static_cast<Uint>(static_cast<boost::uint64_t>(nb_rows) * part / nb_parts);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
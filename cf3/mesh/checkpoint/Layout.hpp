@@ -0,0 +1,149 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_checkpoint_Layout_hpp
+#define cf3_mesh_checkpoint_Layout_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "mesh/checkpoint/LibCheckpoint.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Self-describing layout of a checkpoint file.
+///
+/// The file starts with a fixed-size binary header, holding a magic string,
+/// the format version, a byte order mark and the position of the table of contents.
+/// The header is followed by the data blocks, each a dense array of rows of
+/// 8-byte unsigned integers or doubles. The table of contents at the end of
+/// the file is plain text, and describes the mesh structure and every block:
+/// @verbatim
+/// dimension 2
+/// nodes 441
+/// node_field temperature T[scalar]
+/// entities interior/elements_cf3.mesh.LagrangeP1.Quad2D cf3.mesh.Cells cf3.mesh.LagrangeP1.Quad2D
+/// dictionary solution continuous
+/// space solution interior/elements_cf3.mesh.LagrangeP1.Quad2D cf3.mesh.LagrangeP2.Quad2D
+/// field solution state rho[scalar],U[vector]
+/// block nodes/coordinates real 64 441 2
+/// ...
+/// @endverbatim
+/// Node blocks are indexed by the global node index, so that any reader rank can
+/// locate a node without searching. Element blocks hold the elements of all writer ranks
+/// one after the other, and store the connectivity as global node indices.
+/// Fields of other dictionaries are stored per element, for every node of the element's space.
+class checkpoint_API Layout
+{
+public:
+
+  /// Size in bytes of the binary header
+  static const Uint header_size = 64;
+
+  /// Version of the format written by this implementation
+  static const Uint version = 1;
+
+  /// Value in the "nodes/rank" block for rows that do not correspond to a node
+  static const boost::uint64_t no_rank = 0xffffffffffffffffull;
+
+  /// Contiguous array of rows in the file
+  struct Block
+  {
+    std::string name;
+    bool is_real;                ///< true for doubles, false for unsigned 64-bit integers
+    boost::uint64_t offset;      ///< byte offset of the first row
+    boost::uint64_t nb_rows;
+    boost::uint64_t row_size;    ///< number of 8-byte values in a row
+  };
+
+  /// Entities component, with its path relative to the mesh topology
+  struct EntitiesInfo
+  {
+    std::string path;
+    std::string entities_type;   ///< builder name of the Entities component
+    std::string element_type;    ///< builder name of the element type
+  };
+
+  /// Field, identified by its name and variables description
+  struct FieldInfo
+  {
+    std::string name;
+    std::string description;
+  };
+
+  /// Space of a dictionary on one Entities component
+  struct SpaceInfo
+  {
+    std::string entities;        ///< path of the entities relative to the mesh topology
+    std::string shape_function;  ///< builder name of the shape function
+  };
+
+  /// Dictionary other than the geometry
+  struct DictionaryInfo
+  {
+    std::string name;
+    bool continuous;
+    std::vector<SpaceInfo> spaces;
+    std::vector<FieldInfo> fields;
+  };
+
+  Layout();
+
+  /// Append a block after the last one
+  Block& add_block(const std::string& name, const bool is_real, const boost::uint64_t nb_rows, const boost::uint64_t row_size);
+
+  /// Block with the given name, throws if it is not in the layout
+  const Block& block(const std::string& name) const;
+
+  /// Byte offset past the last block, where the table of contents is stored
+  boost::uint64_t end() const { return m_end; }
+
+  /// Text of the table of contents
+  std::string table_of_contents() const;
+
+  /// Set up the layout from the text of a table of contents
+  void parse_table_of_contents(const std::string& text);
+
+  /// Encode the header for a table of contents with the given size
+  void write_header(char* header, const boost::uint64_t toc_size) const;
+
+  /// Decode the header, and return the offset and size of the table of contents
+  static void read_header(const char* header, boost::uint64_t& toc_offset, boost::uint64_t& toc_size);
+
+  /// First row of a part, when nb_rows rows are evenly distributed over nb_parts parts
+  static Uint chunk_begin(const Uint nb_rows, const Uint part, const Uint nb_parts);
+
+  Uint dimension;
+  Uint nb_nodes;                                  ///< rows in the node blocks, one more than the largest global node index
+  std::vector<FieldInfo> node_fields;             ///< fields of the geometry dictionary, besides the coordinates
+  std::vector<EntitiesInfo> entities;
+  std::vector<DictionaryInfo> dictionaries;
+
+private:
+
+  std::vector<Block> m_blocks;
+  boost::uint64_t m_end;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_checkpoint_Layout_hpp
@@ -0,0 +1,385 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <map>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/ContinuousDictionary.hpp"
+#include "mesh/DiscontinuousDictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/ShapeFunction.hpp"
+#include "mesh/Space.hpp"
+
+#include "mesh/checkpoint/File.hpp"
+#include "mesh/checkpoint/Layout.hpp"
+#include "mesh/checkpoint/Reader.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < checkpoint::Reader, MeshReader, LibCheckpoint > aCheckpointReader_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Read nb_rows rows, starting at first_row of the block
+template <typename T>
+void read_rows(File& file, const Layout::Block& block, const Uint first_row, const Uint nb_rows, std::vector<T>& rows)
+{
+  rows.resize(static_cast<std::size_t>(nb_rows) * block.row_size);
+  file.read_at_all(block.offset + first_row * block.row_size * 8u, rows.empty() ? 0 : &rows[0], rows.size() * 8u);
+}
+
+/// Region at the given path relative to the topology, created if needed
+Region& get_region(Region& topology, const std::vector<std::string>& path)
+{
+  Handle<Region> region(topology.handle<Region>());
+  for (Uint i=0; i+1<path.size(); ++i)
+  {
+    Handle<Region> child(region->get_child(path[i]));
+    region = is_null(child) ? region->create_region(path[i]).handle<Region>() : child;
+  }
+  return *region;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Reader::Reader( const std::string& name )
+: MeshReader(name)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> Reader::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".cf3chk");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::do_read_mesh_into(const URI& path, Mesh& mesh)
+{
+  PE::Comm& comm = PE::Comm::instance();
+  const bool parallel = comm.is_active() && comm.size() > 1;
+  const Uint nb_parts = parallel ? comm.size() : 1u;
+  const Uint part = parallel ? comm.rank() : 0u;
+
+  boost::filesystem::path fp(path.path());
+  if (!boost::filesystem::exists(fp))
+    throw boost::filesystem::filesystem_error( fp.string() + " does not exist", boost::system::error_code() );
+
+  Timer timer;
+  CFinfo << "Reading checkpoint " << fp.string() << CFendl;
+
+  File file(fp, File::READ);
+
+  char header[Layout::header_size];
+  file.read_at_all(0u, header, Layout::header_size);
+  boost::uint64_t toc_offset, toc_size;
+  Layout::read_header(header, toc_offset, toc_size);
+
+  std::string toc(toc_size, ' ');
+  file.read_at_all(toc_offset, toc.empty() ? 0 : &toc[0], toc_size);
+  Layout layout;
+  layout.parse_table_of_contents(toc);
+
+  mesh.initialize_nodes(0, layout.dimension);
+  Dictionary& nodes = mesh.geometry_fields();
+
+  // -------------------------------------------------------------------------
+  // Entities: an even share of the elements of each component
+
+  std::map< std::string, Handle<Entities> > entities_by_path;
+  std::vector< Handle<Entities> > entities(layout.entities.size());
+  std::vector<Uint> first_elem(layout.entities.size());
+  std::vector< std::vector<Uint> > connectivities(layout.entities.size());
+  for (Uint i=0; i<layout.entities.size(); ++i)
+  {
+    const Layout::EntitiesInfo& info = layout.entities[i];
+    std::vector<std::string> entities_path;
+    boost::algorithm::split(entities_path, info.path, boost::algorithm::is_any_of("/"));
+
+    boost::shared_ptr< Entities > created = build_component_abstract_type<Entities>(info.entities_type, entities_path.back());
+    get_region(mesh.topology(), entities_path).add_component(created);
+    created->initialize(info.element_type, nodes);
+    entities[i] = created->handle<Entities>();
+    entities_by_path[info.path] = entities[i];
+
+    const Layout::Block& glb_idx_block = layout.block(info.path+"/glb_idx");
+    const Uint total_nb_elems = glb_idx_block.nb_rows;
+    first_elem[i] = Layout::chunk_begin(total_nb_elems, part, nb_parts);
+    const Uint nb_elems = Layout::chunk_begin(total_nb_elems, part+1, nb_parts) - first_elem[i];
+
+    std::vector<boost::uint64_t> glb_idx;
+    read_rows(file, glb_idx_block, first_elem[i], nb_elems, glb_idx);
+    entities[i]->resize(nb_elems);
+    for (Uint e=0; e<nb_elems; ++e)
+    {
+      entities[i]->glb_idx()[e] = glb_idx[e];
+      entities[i]->rank()[e] = part;
+    }
+
+    std::vector<boost::uint64_t> connectivity;
+    const Layout::Block& connectivity_block = layout.block(info.path+"/connectivity");
+    if (connectivity_block.row_size != entities[i]->element_type().nb_nodes())
+      throw FileFormatError(FromHere(), "Connectivity of " + info.path + " in checkpoint does not match element type " + info.element_type);
+    read_rows(file, connectivity_block, first_elem[i], nb_elems, connectivity);
+    connectivities[i].assign(connectivity.begin(), connectivity.end());
+  }
+
+  // -------------------------------------------------------------------------
+  // Nodes, and the connectivity in local node indices
+
+  std::vector<Uint> nodes_glb_idx;
+  read_nodes(file, layout, connectivities, mesh, nodes_glb_idx);
+
+  for (Uint i=0; i<entities.size(); ++i)
+  {
+    Connectivity& connectivity = entities[i]->geometry_space().connectivity();
+    const Uint nb_elem_nodes = connectivity.row_size();
+    for (Uint e=0; e<connectivity.size(); ++e)
+    {
+      for (Uint n=0; n<nb_elem_nodes; ++n)
+      {
+        const Uint glb_idx = connectivities[i][e*nb_elem_nodes+n];
+        connectivity[e][n] = std::lower_bound(nodes_glb_idx.begin(), nodes_glb_idx.end(), glb_idx) - nodes_glb_idx.begin();
+      }
+    }
+    std::vector<Uint>().swap(connectivities[i]);
+  }
+  mesh.update_structures();
+
+  // -------------------------------------------------------------------------
+  // Other dictionaries, rebuilt on the elements, and their fields set from the element rows
+
+  boost_foreach(const Layout::DictionaryInfo& info, layout.dictionaries)
+  {
+    Dictionary& dict = info.continuous ?
+          static_cast<Dictionary&>(*mesh.create_component<ContinuousDictionary>(info.name)) :
+          static_cast<Dictionary&>(*mesh.create_component<DiscontinuousDictionary>(info.name));
+    boost_foreach(const Layout::SpaceInfo& space, info.spaces)
+    {
+      if (!entities_by_path.count(space.entities))
+        throw FileFormatError(FromHere(), "Dictionary " + info.name + " in checkpoint has a space on unknown entities " + space.entities);
+      entities_by_path[space.entities]->create_space(space.shape_function, dict);
+    }
+    dict.build();
+    mesh.update_structures();
+
+    boost_foreach(const Layout::FieldInfo& field_info, info.fields)
+    {
+      // Fields created by the build of the dictionary, such as the coordinates, are overwritten
+      Handle<Field> existing(dict.get_child(field_info.name));
+      Field& field = is_not_null(existing) ? *existing : dict.create_field(field_info.name, field_info.description);
+      const Uint row_size = field.row_size();
+      boost_foreach(const Layout::SpaceInfo& space_info, info.spaces)
+      {
+        const Handle<Entities>& space_entities = entities_by_path[space_info.entities];
+        const Space& space = space_entities->space(dict);
+        const Layout::Block& block = layout.block(space_info.entities+"/"+info.name+"/"+field_info.name);
+        const Uint nb_space_nodes = space.shape_function().nb_nodes();
+        if (block.row_size != nb_space_nodes * row_size)
+          throw FileFormatError(FromHere(), "Field " + field_info.name + " on " + space_info.entities + " in checkpoint does not match its space");
+
+        const Uint index = std::find(entities.begin(), entities.end(), space_entities) - entities.begin();
+        std::vector<double> values;
+        read_rows(file, block, first_elem[index], space_entities->size(), values);
+        for (Uint e=0; e<space_entities->size(); ++e)
+        {
+          for (Uint n=0; n<nb_space_nodes; ++n)
+          {
+            Field::Row row = field[space.connectivity()[e][n]];
+            for (Uint v=0; v<row_size; ++v)
+              row[v] = values[(e*nb_space_nodes+n)*row_size+v];
+          }
+        }
+      }
+    }
+  }
+
+  file.close();
+
+  CFinfo << "Read checkpoint " << fp.string() << " in " << timer.elapsed() << " s" << CFendl;
+
+  mesh.raise_mesh_loaded();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_nodes(File& file, const Layout& layout, const std::vector< std::vector<Uint> >& connectivities, Mesh& mesh, std::vector<Uint>& nodes_glb_idx)
+{
+  PE::Comm& comm = PE::Comm::instance();
+  const bool parallel = comm.is_active() && comm.size() > 1;
+  const Uint nb_parts = parallel ? comm.size() : 1u;
+  const Uint part = parallel ? comm.rank() : 0u;
+
+  std::vector<Uint> node_begin(nb_parts+1);
+  for (Uint p=0; p<=nb_parts; ++p)
+    node_begin[p] = Layout::chunk_begin(layout.nb_nodes, p, nb_parts);
+  const Uint first_node = node_begin[part];
+  const Uint nb_chunk_nodes = node_begin[part+1] - first_node;
+
+  // The coordinates, followed by the other geometry fields
+  std::vector<std::string> field_blocks(1, "nodes/coordinates");
+  boost_foreach(const Layout::FieldInfo& field, layout.node_fields)
+    field_blocks.push_back("nodes/" + field.name);
+  std::vector<Uint> field_row_size(field_blocks.size());
+  Uint node_row_size = 0;
+  for (Uint f=0; f<field_blocks.size(); ++f)
+  {
+    field_row_size[f] = layout.block(field_blocks[f]).row_size;
+    node_row_size += field_row_size[f];
+  }
+
+  // Node rows of this rank
+  std::vector<boost::uint64_t> chunk_ranks;
+  read_rows(file, layout.block("nodes/rank"), first_node, nb_chunk_nodes, chunk_ranks);
+  std::vector< std::vector<double> > chunk_values(field_blocks.size());
+  for (Uint f=0; f<field_blocks.size(); ++f)
+    read_rows(file, layout.block(field_blocks[f]), first_node, nb_chunk_nodes, chunk_values[f]);
+
+  // Nodes of the elements that are stored in the rows of other ranks
+  std::vector<Uint> ghosts;
+  boost_foreach(const std::vector<Uint>& connectivity, connectivities)
+  {
+    boost_foreach(const Uint glb_idx, connectivity)
+    {
+      if (glb_idx >= layout.nb_nodes)
+        throw FileFormatError(FromHere(), "Checkpoint element uses node " + to_str(glb_idx) + ", but has only " + to_str(layout.nb_nodes) + " nodes");
+      if (glb_idx < first_node || glb_idx >= first_node+nb_chunk_nodes)
+        ghosts.push_back(glb_idx);
+      else if (chunk_ranks[glb_idx-first_node] == Layout::no_rank)
+        throw FileFormatError(FromHere(), "Checkpoint element uses node " + to_str(glb_idx) + ", which is not in the file");
+    }
+  }
+  std::sort(ghosts.begin(), ghosts.end());
+  ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+
+  // Ask the ranks holding the rows of the ghost nodes for their values
+  std::vector<Uint> ghost_parts(ghosts.size());
+  std::vector<Real> ghost_values(ghosts.size()*node_row_size);
+  if (parallel)
+  {
+    std::vector< std::vector<Uint> > send_queries(nb_parts);
+    std::vector< std::vector<Uint> > recv_queries;
+    for (Uint g=0; g<ghosts.size(); ++g)
+    {
+      ghost_parts[g] = std::upper_bound(node_begin.begin(), node_begin.end(), ghosts[g]) - node_begin.begin() - 1;
+      send_queries[ghost_parts[g]].push_back(ghosts[g]);
+    }
+    comm.all_to_all(send_queries, recv_queries);
+
+    std::vector< std::vector<Real> > send_answers(nb_parts);
+    std::vector< std::vector<Real> > recv_answers;
+    for (Uint p=0; p<nb_parts; ++p)
+    {
+      send_answers[p].reserve(recv_queries[p].size()*node_row_size);
+      boost_foreach(const Uint glb_idx, recv_queries[p])
+      {
+        const Uint row = glb_idx - first_node;
+        if (chunk_ranks[row] == Layout::no_rank)
+          throw FileFormatError(FromHere(), "Checkpoint element uses node " + to_str(glb_idx) + ", which is not in the file");
+        for (Uint f=0; f<field_blocks.size(); ++f)
+          send_answers[p].insert(send_answers[p].end(), chunk_values[f].begin()+row*field_row_size[f], chunk_values[f].begin()+(row+1)*field_row_size[f]);
+      }
+    }
+    comm.all_to_all(send_answers, recv_answers);
+
+    // The ghosts are sorted, so the answers of all ranks follow in the order of the ghosts
+    Uint g = 0;
+    for (Uint p=0; p<nb_parts; ++p)
+    {
+      std::copy(recv_answers[p].begin(), recv_answers[p].end(), ghost_values.begin()+g*node_row_size);
+      g += send_queries[p].size();
+    }
+  }
+  cf3_assert(parallel || ghosts.empty());
+
+  // Store all nodes in the order of their global index
+  Dictionary& nodes = mesh.geometry_fields();
+  std::vector<Uint> owned;
+  for (Uint row=0; row<nb_chunk_nodes; ++row)
+  {
+    if (chunk_ranks[row] != Layout::no_rank)
+      owned.push_back(first_node+row);
+  }
+  nodes_glb_idx.resize(owned.size()+ghosts.size());
+  std::merge(owned.begin(), owned.end(), ghosts.begin(), ghosts.end(), nodes_glb_idx.begin());
+
+  nodes.resize(nodes_glb_idx.size());
+  std::vector<Field*> fields(1, &nodes.coordinates());
+  boost_foreach(const Layout::FieldInfo& field, layout.node_fields)
+  {
+    Handle<Field> existing(nodes.get_child(field.name));
+    fields.push_back(is_not_null(existing) ? existing.get() : &nodes.create_field(field.name, field.description));
+  }
+
+  Uint owned_idx = 0;
+  Uint ghost_idx = 0;
+  for (Uint n=0; n<nodes_glb_idx.size(); ++n)
+  {
+    const Uint glb_idx = nodes_glb_idx[n];
+    nodes.glb_idx()[n] = glb_idx;
+    if (owned_idx < owned.size() && owned[owned_idx] == glb_idx)
+    {
+      nodes.rank()[n] = part;
+      const Uint row = glb_idx - first_node;
+      for (Uint f=0; f<fields.size(); ++f)
+      {
+        Field::Row values = (*fields[f])[n];
+        for (Uint v=0; v<field_row_size[f]; ++v)
+          values[v] = chunk_values[f][row*field_row_size[f]+v];
+      }
+      ++owned_idx;
+    }
+    else
+    {
+      nodes.rank()[n] = ghost_parts[ghost_idx];
+      const Real* ghost_row = &ghost_values[ghost_idx*node_row_size];
+      for (Uint f=0; f<fields.size(); ++f)
+      {
+        Field::Row values = (*fields[f])[n];
+        for (Uint v=0; v<field_row_size[f]; ++v)
+          values[v] = *ghost_row++;
+      }
+      ++ghost_idx;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
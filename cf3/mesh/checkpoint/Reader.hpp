@@ -0,0 +1,66 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_checkpoint_Reader_hpp
+#define cf3_mesh_checkpoint_Reader_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshReader.hpp"
+
+#include "mesh/checkpoint/LibCheckpoint.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+  class File;
+  class Layout;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Restarts a mesh from a file written by the checkpoint Writer, on any number of ranks.
+/// Each rank reads an even share of the elements of every Entities component and
+/// of the node rows, with collective MPI-IO, and fetches the nodes of its elements
+/// that are read by other ranks. The dictionaries and fields are rebuilt on these elements.
+/// The result is partitioned by file position, so the existing repartitioning path
+/// (the LoadBalance action) is applied afterwards to obtain a balanced partitioning.
+class checkpoint_API Reader : public MeshReader
+{
+public: // functions
+
+  /// constructor
+  Reader( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "Reader"; }
+
+  virtual std::string get_format() { return "checkpoint"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+private: // functions
+
+  virtual void do_read_mesh_into(const common::URI& path, Mesh& mesh);
+
+  /// Read the node rows of this rank, and the nodes used by the given element connectivities
+  /// @param [in]  connectivities  connectivity of the elements read by this rank, in global node indices
+  /// @param [out] nodes_glb_idx   sorted global indices of the nodes, in the order of the geometry dictionary
+  void read_nodes(File& file, const Layout& layout, const std::vector< std::vector<Uint> >& connectivities, Mesh& mesh, std::vector<Uint>& nodes_glb_idx);
+
+}; // end Reader
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_checkpoint_Reader_hpp
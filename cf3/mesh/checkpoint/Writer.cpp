@@ -0,0 +1,503 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <map>
+
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/ShapeFunction.hpp"
+#include "mesh/Space.hpp"
+
+#include "mesh/checkpoint/File.hpp"
+#include "mesh/checkpoint/Layout.hpp"
+#include "mesh/checkpoint/Writer.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < checkpoint::Writer, MeshWriter, LibCheckpoint > aCheckpointWriter_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Write the rows of this rank, starting at first_row of the block
+template <typename T>
+void write_rows(File& file, const Layout::Block& block, const Uint first_row, const std::vector<T>& rows)
+{
+  cf3_assert(rows.size() % block.row_size == 0);
+  file.write_at_all(block.offset + first_row * block.row_size * 8u, rows.empty() ? 0 : &rows[0], rows.size() * 8u);
+}
+
+/// First row of each rank, when every rank writes nb_local rows one after the other.
+/// The last entry holds the total number of rows.
+std::vector<Uint> rows_begin(const Uint nb_local)
+{
+  PE::Comm& comm = PE::Comm::instance();
+  std::vector<Uint> counts(1, nb_local);
+  if (comm.is_active() && comm.size() > 1)
+  {
+    std::vector<Uint> local_count(counts);
+    comm.all_gather(local_count, counts);
+  }
+  std::vector<Uint> begin(counts.size()+1, 0u);
+  for (Uint p=0; p<counts.size(); ++p)
+    begin[p+1] = begin[p] + counts[p];
+  return begin;
+}
+
+/// Maximum of value over all ranks
+Uint global_max(const Uint value)
+{
+  PE::Comm& comm = PE::Comm::instance();
+  std::vector<Uint> local_value(1, value);
+  if (!comm.is_active() || comm.size() == 1)
+    return value;
+  std::vector<Uint> result(1);
+  comm.all_reduce(PE::max(), local_value, result);
+  return result[0];
+}
+
+/// Compare two lists of fields by name and description
+bool same_fields(const std::vector<Layout::FieldInfo>& a, const std::vector<Layout::FieldInfo>& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (Uint i=0; i<a.size(); ++i)
+  {
+    if (a[i].name != b[i].name || a[i].description != b[i].description)
+      return false;
+  }
+  return true;
+}
+
+/// Replace the entities and dictionaries of the layout by the union of those in the tables of contents of all ranks.
+/// A rank may lack some entities, for instance when a region has no elements in its part of the mesh,
+/// but the geometry fields, and the fields of a dictionary, must be the same on all ranks.
+void merge_structures(Layout& layout, const std::vector<std::string>& tocs)
+{
+  std::vector<Layout::FieldInfo> node_fields;
+  std::map< std::string, Layout::EntitiesInfo > entities;
+  std::map< std::string, Layout::DictionaryInfo > dictionaries;
+  std::map< std::string, std::map< std::string, Layout::SpaceInfo > > spaces;
+  for (Uint p=0; p<tocs.size(); ++p)
+  {
+    Layout rank_layout;
+    rank_layout.parse_table_of_contents(tocs[p]);
+
+    if (p == 0)
+      node_fields = rank_layout.node_fields;
+    else if (!same_fields(node_fields, rank_layout.node_fields))
+      throw SetupError(FromHere(), "Geometry fields differ between rank 0 and rank " + to_str(p) + ", they can not be written to one checkpoint");
+
+    boost_foreach(const Layout::EntitiesInfo& info, rank_layout.entities)
+    {
+      std::map< std::string, Layout::EntitiesInfo >::iterator found = entities.find(info.path);
+      if (found == entities.end())
+        entities[info.path] = info;
+      else if (found->second.entities_type != info.entities_type || found->second.element_type != info.element_type)
+        throw SetupError(FromHere(), "Entities " + info.path + " have a different type on rank " + to_str(p));
+    }
+
+    boost_foreach(const Layout::DictionaryInfo& info, rank_layout.dictionaries)
+    {
+      std::map< std::string, Layout::DictionaryInfo >::iterator found = dictionaries.find(info.name);
+      if (found == dictionaries.end())
+        dictionaries[info.name] = info;
+      else if (found->second.continuous != info.continuous || !same_fields(found->second.fields, info.fields))
+        throw SetupError(FromHere(), "Dictionary " + info.name + " has different fields on rank " + to_str(p));
+
+      boost_foreach(const Layout::SpaceInfo& space, info.spaces)
+      {
+        std::map< std::string, Layout::SpaceInfo >::iterator found_space = spaces[info.name].find(space.entities);
+        if (found_space == spaces[info.name].end())
+          spaces[info.name][space.entities] = space;
+        else if (found_space->second.shape_function != space.shape_function)
+          throw SetupError(FromHere(), "Dictionary " + info.name + " has a different space on " + space.entities + " on rank " + to_str(p));
+      }
+    }
+  }
+
+  layout.entities.clear();
+  foreach_container( (const std::string& path)(const Layout::EntitiesInfo& info), entities )
+    layout.entities.push_back(info);
+
+  layout.dictionaries.clear();
+  foreach_container( (const std::string& name)(Layout::DictionaryInfo& info), dictionaries )
+  {
+    info.spaces.clear();
+    foreach_container( (const std::string& entities_path)(const Layout::SpaceInfo& space), spaces[name] )
+      info.spaces.push_back(space);
+    layout.dictionaries.push_back(info);
+  }
+}
+
+/// Make the entities and dictionaries of the layout the same on all ranks.
+/// The tables of contents are gathered on rank 0, which merges them and broadcasts the result,
+/// or the error if they can not be merged, so all ranks end up with the same layout, or all throw.
+void agree_on_structure(Layout& layout, const Uint nb_parts)
+{
+  if (nb_parts == 1)
+    return;
+
+  PE::Comm& comm = PE::Comm::instance();
+  const std::string toc = layout.table_of_contents();
+  const std::vector<char> send_toc(toc.begin(), toc.end());
+  std::vector<char> recv_tocs;
+  std::vector<int> toc_sizes(nb_parts, -1);
+  comm.gather(send_toc, send_toc.size(), recv_tocs, toc_sizes, 0);
+
+  // The first character tells if the merge succeeded, the rest is the merged table of contents or the error
+  std::vector<char> send_merged;
+  if (comm.rank() == 0)
+  {
+    std::vector<std::string> tocs(nb_parts);
+    std::vector<char>::const_iterator begin = recv_tocs.begin();
+    for (Uint p=0; p<nb_parts; ++p)
+    {
+      tocs[p].assign(begin, begin + toc_sizes[p]);
+      begin += toc_sizes[p];
+    }
+
+    std::string merged;
+    char success = 1;
+    try
+    {
+      Layout merged_layout = layout;
+      merge_structures(merged_layout, tocs);
+      merged = merged_layout.table_of_contents();
+    }
+    catch (SetupError& e)
+    {
+      success = 0;
+      merged = e.what();
+    }
+    send_merged.push_back(success);
+    send_merged.insert(send_merged.end(), merged.begin(), merged.end());
+  }
+
+  std::vector<char> recv_merged;
+  comm.broadcast(send_merged, recv_merged, 0);
+  const std::string merged(recv_merged.begin()+1, recv_merged.end());
+  if (!recv_merged[0])
+    throw SetupError(FromHere(), "Can not write one checkpoint for all ranks: " + merged);
+
+  Layout merged_layout;
+  merged_layout.parse_table_of_contents(merged);
+  layout.entities = merged_layout.entities;
+  layout.dictionaries = merged_layout.dictionaries;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Writer::Writer( const std::string& name )
+: MeshWriter(name)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> Writer::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".cf3chk");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write()
+{
+  const Mesh& mesh = *m_mesh;
+  PE::Comm& comm = PE::Comm::instance();
+  const bool parallel = comm.is_active() && comm.size() > 1;
+  const Uint nb_parts = parallel ? comm.size() : 1u;
+  const Uint part = parallel ? comm.rank() : 0u;
+
+  Timer timer;
+  const boost::filesystem::path path(m_file_path.path());
+  CFinfo << "Writing checkpoint " << path.string() << CFendl;
+
+  Layout layout;
+  layout.dimension = mesh.dimension();
+
+  File file(path, File::WRITE);
+
+  // -------------------------------------------------------------------------
+  // Nodes: sent to the rank that writes their range of global indices
+
+  const Dictionary& nodes = mesh.geometry_fields();
+
+  // The coordinates come first, followed by the other geometry fields in the order of their names
+  std::vector< Handle<Field const> > node_fields(1, nodes.coordinates().handle<Field const>());
+  {
+    std::map< std::string, Handle<Field const> > fields_by_name;
+    boost_foreach(const Handle<Field>& field, nodes.fields())
+    {
+      if (field.get() != &nodes.coordinates())
+        fields_by_name[field->name()] = field;
+    }
+    foreach_container( (const std::string& name)(const Handle<Field const>& field), fields_by_name )
+    {
+      Layout::FieldInfo info;
+      info.name = name;
+      info.description = field->descriptor().description();
+      layout.node_fields.push_back(info);
+      node_fields.push_back(field);
+    }
+  }
+  Uint node_row_size = 0;
+  boost_foreach(const Handle<Field const>& field, node_fields)
+    node_row_size += field->row_size();
+
+  // -------------------------------------------------------------------------
+  // Entities and dictionaries: the union over all ranks, so every rank takes part in the same collective writes
+
+  const std::string topology_path = mesh.topology().uri().path();
+  std::map< std::string, Handle<Entities const> > entities_by_path;
+  boost_foreach(const Handle<Entities>& entities, mesh.elements())
+    entities_by_path[entities->uri().path().substr(topology_path.size()+1)] = entities;
+
+  foreach_container( (const std::string& entities_path)(const Handle<Entities const>& entities), entities_by_path )
+  {
+    Layout::EntitiesInfo info;
+    info.path = entities_path;
+    info.entities_type = entities->derived_type_name();
+    info.element_type = entities->element_type().derived_type_name();
+    layout.entities.push_back(info);
+  }
+
+  // Dictionaries other than the geometry, in the order of their names
+  std::map< std::string, Handle<Dictionary const> > dictionaries_by_name;
+  boost_foreach(const Handle<Dictionary>& dict, mesh.dictionaries())
+  {
+    if (dict.get() != &nodes)
+      dictionaries_by_name[dict->name()] = dict;
+  }
+
+  foreach_container( (const std::string& name)(const Handle<Dictionary const>& dict), dictionaries_by_name )
+  {
+    Layout::DictionaryInfo info;
+    info.name = name;
+    info.continuous = dict->continuous();
+    for (Uint s=0; s<dict->spaces().size(); ++s)
+    {
+      Layout::SpaceInfo space;
+      space.entities = dict->entities_range()[s]->uri().path().substr(topology_path.size()+1);
+      space.shape_function = dict->spaces()[s]->shape_function().derived_type_name();
+      info.spaces.push_back(space);
+    }
+    boost_foreach(const Handle<Field>& field, dict->fields())
+    {
+      Layout::FieldInfo field_info;
+      field_info.name = field->name();
+      field_info.description = field->descriptor().description();
+      info.fields.push_back(field_info);
+    }
+    layout.dictionaries.push_back(info);
+  }
+
+  agree_on_structure(layout, nb_parts);
+
+  Uint local_nb_nodes = 0;
+  for (Uint n=0; n<nodes.size(); ++n)
+  {
+    if (nodes.rank()[n] == part)
+      local_nb_nodes = std::max(local_nb_nodes, nodes.glb_idx()[n]+1);
+  }
+  layout.nb_nodes = global_max(local_nb_nodes);
+
+  std::vector<Uint> node_begin(nb_parts+1);
+  for (Uint p=0; p<=nb_parts; ++p)
+    node_begin[p] = Layout::chunk_begin(layout.nb_nodes, p, nb_parts);
+
+  // Each owned node is sent as its global index and rank, followed by one row of values
+  std::vector< std::vector<Uint> > send_nodes(nb_parts);
+  std::vector< std::vector<Real> > send_values(nb_parts);
+  for (Uint n=0; n<nodes.size(); ++n)
+  {
+    if (nodes.rank()[n] != part)
+      continue;
+    const Uint glb_idx = nodes.glb_idx()[n];
+    const Uint p = std::upper_bound(node_begin.begin(), node_begin.end(), glb_idx) - node_begin.begin() - 1;
+    send_nodes[p].push_back(glb_idx);
+    send_nodes[p].push_back(nodes.rank()[n]);
+    boost_foreach(const Handle<Field const>& field, node_fields)
+    {
+      const Field::ConstRow row = (*field)[n];
+      send_values[p].insert(send_values[p].end(), row.begin(), row.end());
+    }
+  }
+
+  std::vector< std::vector<Uint> > recv_nodes;
+  std::vector< std::vector<Real> > recv_values;
+  if (parallel)
+  {
+    comm.all_to_all(send_nodes, recv_nodes);
+    comm.all_to_all(send_values, recv_values);
+  }
+  else
+  {
+    recv_nodes.swap(send_nodes);
+    recv_values.swap(send_values);
+  }
+
+  const Uint first_node = node_begin[part];
+  const Uint nb_chunk_nodes = node_begin[part+1] - first_node;
+  std::vector<boost::uint64_t> node_ranks(nb_chunk_nodes, Layout::no_rank);
+  std::vector< std::vector<double> > node_values(node_fields.size());
+  for (Uint f=0; f<node_fields.size(); ++f)
+    node_values[f].resize(nb_chunk_nodes * node_fields[f]->row_size(), 0.);
+
+  Uint nb_duplicates = 0;
+  for (Uint p=0; p<recv_nodes.size(); ++p)
+  {
+    const Real* values = recv_values[p].empty() ? 0 : &recv_values[p][0];
+    for (Uint i=0; i<recv_nodes[p].size(); i+=2)
+    {
+      const Uint row = recv_nodes[p][i] - first_node;
+      if (node_ranks[row] != Layout::no_rank)
+        ++nb_duplicates;
+      node_ranks[row] = recv_nodes[p][i+1];
+      for (Uint f=0; f<node_fields.size(); ++f)
+      {
+        const Uint row_size = node_fields[f]->row_size();
+        std::copy(values, values+row_size, node_values[f].begin() + row*row_size);
+        values += row_size;
+      }
+    }
+  }
+  if (global_max(nb_duplicates))
+    throw SetupError(FromHere(), "Global node indices of mesh " + mesh.uri().string() + " are not unique, they can be built with the GlobalNumbering action");
+
+  write_rows(file, layout.add_block("nodes/rank", false, layout.nb_nodes, 1u), first_node, node_ranks);
+  for (Uint f=0; f<node_fields.size(); ++f)
+  {
+    const std::string name = f == 0 ? "nodes/coordinates" : "nodes/" + node_fields[f]->name();
+    write_rows(file, layout.add_block(name, true, layout.nb_nodes, node_fields[f]->row_size()), first_node, node_values[f]);
+  }
+
+  // -------------------------------------------------------------------------
+  // Entities: the owned elements of all ranks one after the other, in the order of their path
+
+  boost_foreach(const Layout::EntitiesInfo& info, layout.entities)
+  {
+    const std::string& entities_path = info.path;
+    const Handle<Entities const> entities = entities_by_path.count(entities_path) ? entities_by_path[entities_path] : Handle<Entities const>();
+
+    std::vector<Uint> owned;
+    if (is_not_null(entities))
+    {
+      owned.reserve(entities->size());
+      for (Uint e=0; e<entities->size(); ++e)
+      {
+        if (!entities->is_ghost(e))
+          owned.push_back(e);
+      }
+    }
+    const std::vector<Uint> begin = rows_begin(owned.size());
+    const Uint first_row = begin[part];
+    const Uint nb_rows = begin.back();
+
+    std::vector<boost::uint64_t> glb_idx(owned.size());
+    std::vector<boost::uint64_t> rank(owned.size());
+    for (Uint i=0; i<owned.size(); ++i)
+    {
+      glb_idx[i] = entities->glb_idx()[owned[i]];
+      rank[i] = entities->rank()[owned[i]];
+    }
+    write_rows(file, layout.add_block(entities_path+"/glb_idx", false, nb_rows, 1u), first_row, glb_idx);
+    write_rows(file, layout.add_block(entities_path+"/rank", false, nb_rows, 1u), first_row, rank);
+
+    // Connectivity in global node indices
+    const Uint nb_elem_nodes = global_max(is_not_null(entities) ? entities->element_type().nb_nodes() : 0u);
+    std::vector<boost::uint64_t> nodes_glb_idx;
+    nodes_glb_idx.reserve(owned.size()*nb_elem_nodes);
+    boost_foreach(const Uint e, owned)
+    {
+      boost_foreach(const Uint node, entities->geometry_space().connectivity()[e])
+        nodes_glb_idx.push_back(nodes.glb_idx()[node]);
+    }
+    write_rows(file, layout.add_block(entities_path+"/connectivity", false, nb_rows, nb_elem_nodes), first_row, nodes_glb_idx);
+
+    // Fields of the other dictionaries, for every node of the space of each element
+    boost_foreach(const Layout::DictionaryInfo& dict_info, layout.dictionaries)
+    {
+      bool has_space_info = false;
+      boost_foreach(const Layout::SpaceInfo& space_info, dict_info.spaces)
+        has_space_info = has_space_info || space_info.entities == entities_path;
+      if (!has_space_info)
+        continue;
+
+      const Handle<Dictionary const> dict = dictionaries_by_name.count(dict_info.name) ? dictionaries_by_name[dict_info.name] : Handle<Dictionary const>();
+      const bool has_space = is_not_null(entities) && is_not_null(dict) && dict->defined_for_entities(entities);
+      if (global_max(!owned.empty() && !has_space))
+        throw SetupError(FromHere(), "Dictionary " + dict_info.name + " is not defined on the elements of " + entities_path + " on every rank that has some");
+
+      const Uint nb_space_nodes = has_space ? entities->space(*dict).shape_function().nb_nodes() : 0u;
+      boost_foreach(const Layout::FieldInfo& field_info, dict_info.fields)
+      {
+        const Handle<Field const> field = has_space ? Handle<Field const>(dict->get_child(field_info.name)) : Handle<Field const>();
+        const Uint row_size = global_max(has_space ? nb_space_nodes * field->row_size() : 0u);
+        std::vector<double> values;
+        values.reserve(owned.size()*row_size);
+        boost_foreach(const Uint e, owned)
+        {
+          boost_foreach(const Uint node, entities->space(*dict).connectivity()[e])
+          {
+            const Field::ConstRow row = (*field)[node];
+            values.insert(values.end(), row.begin(), row.end());
+          }
+        }
+        write_rows(file, layout.add_block(entities_path+"/"+dict_info.name+"/"+field_info.name, true, nb_rows, row_size), first_row, values);
+      }
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  // Table of contents after the data, and the header pointing to it
+
+  const std::string toc = layout.table_of_contents();
+  file.write_at_all(layout.end(), toc.data(), part == 0 ? toc.size() : 0u);
+
+  char header[Layout::header_size];
+  layout.write_header(header, toc.size());
+  file.write_at_all(0u, header, part == 0 ? Layout::header_size : 0u);
+
+  file.close();
+
+  CFinfo << "Wrote checkpoint " << path.string() << " (" << layout.end() + toc.size() << " bytes) in " << timer.elapsed() << " s" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
@@ -0,0 +1,56 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_checkpoint_Writer_hpp
+#define cf3_mesh_checkpoint_Writer_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshWriter.hpp"
+
+#include "mesh/checkpoint/LibCheckpoint.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace checkpoint {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Writes the complete mesh to one binary file shared by all ranks, for restarting.
+/// The connectivity, global indices and ranks of all entities, every dictionary
+/// and every field are written, regardless of the configured fields and regions.
+/// All ranks write their owned nodes and elements with collective MPI-IO.
+/// The global node indices must be unique, as built by the GlobalNumbering action.
+/// @see Layout for the file layout, and Reader to restart on any number of ranks
+class checkpoint_API Writer : public MeshWriter
+{
+public: // functions
+
+  /// constructor
+  Writer( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "Writer"; }
+
+  virtual void write();
+
+  virtual std::string get_format() { return "checkpoint"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+}; // end Writer
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // checkpoint
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_checkpoint_Writer_hpp
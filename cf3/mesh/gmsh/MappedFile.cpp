@@ -0,0 +1,361 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+
+#include "mesh/gmsh/MappedFile.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace gmsh {
+
+  using namespace common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+MappedFile::Cursor::Cursor(const char* position, const char* end, const bool binary) :
+  m_position(position),
+  m_end(end),
+  m_binary(binary)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MappedFile::Cursor::skip_blanks()
+{
+  while (m_position != m_end && (*m_position == ' ' || *m_position == '\t' || *m_position == '\r' || *m_position == '\n'))
+    ++m_position;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MappedFile::Cursor::check_remaining(const std::size_t nb_bytes) const
+{
+  if (static_cast<std::size_t>(m_end - m_position) < nb_bytes)
+    throw ParsingFailed(FromHere(), "Unexpected end of gmsh file");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Uint MappedFile::Cursor::get_uint()
+{
+  if (m_binary)
+    return static_cast<Uint>(get_int());
+
+  skip_blanks();
+  const char* start = m_position;
+  Uint value = 0;
+  while (m_position != m_end && *m_position >= '0' && *m_position <= '9')
+  {
+    value = 10*value + static_cast<Uint>(*m_position - '0');
+    ++m_position;
+  }
+  if (m_position == start)
+    throw ParsingFailed(FromHere(), "Expected an unsigned integer in gmsh file");
+  return value;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+int MappedFile::Cursor::get_int()
+{
+  if (m_binary)
+  {
+    int value;
+    check_remaining(sizeof(int));
+    std::memcpy(&value, m_position, sizeof(int));
+    m_position += sizeof(int);
+    return value;
+  }
+
+  skip_blanks();
+  bool negative = false;
+  if (m_position != m_end && (*m_position == '-' || *m_position == '+'))
+  {
+    negative = (*m_position == '-');
+    ++m_position;
+  }
+  const int value = static_cast<int>(get_uint());
+  return negative ? -value : value;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Real MappedFile::Cursor::get_real()
+{
+  if (m_binary)
+  {
+    double value;
+    check_remaining(sizeof(double));
+    std::memcpy(&value, m_position, sizeof(double));
+    m_position += sizeof(double);
+    return value;
+  }
+
+  skip_blanks();
+
+  // The mapped memory is not null-terminated, so the number is copied before conversion
+  char buffer[64];
+  std::size_t length = 0;
+  while (m_position+length != m_end && length < sizeof(buffer)-1 && std::strchr("0123456789+-.eE", m_position[length]) && m_position[length] != '\0')
+  {
+    buffer[length] = m_position[length];
+    ++length;
+  }
+  buffer[length] = '\0';
+
+  char* parsed_end;
+  const Real value = std::strtod(buffer, &parsed_end);
+  if (parsed_end == buffer)
+    throw ParsingFailed(FromHere(), "Expected a real number in gmsh file");
+  m_position += parsed_end - buffer;
+  return value;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MappedFile::Cursor::next_line()
+{
+  const void* newline = std::memchr(m_position, '\n', m_end - m_position);
+  m_position = newline ? static_cast<const char*>(newline) + 1 : m_end;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MappedFile::Cursor::skip_lines(const std::size_t nb_lines)
+{
+  for (std::size_t i=0; i<nb_lines; ++i)
+  {
+    if (m_position == m_end)
+      throw ParsingFailed(FromHere(), "Unexpected end of gmsh file");
+    next_line();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MappedFile::Cursor::skip_bytes(const std::size_t nb_bytes)
+{
+  check_remaining(nb_bytes);
+  m_position += nb_bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+MappedFile::MappedFile(const boost::filesystem::path& path, const Uint* nodes_in_elem_type, const Uint nb_elem_types) :
+  m_nodes_in_elem_type(nodes_in_elem_type),
+  m_nb_elem_types(nb_elem_types),
+  m_binary(false)
+{
+  m_file.open(path.string());
+  if (!m_file.is_open())
+    throw FileSystemError(FromHere(), "Could not map file " + path.string());
+
+  const char* data = m_file.data();
+  const std::size_t file_size = size();
+
+  std::size_t offset = (file_size != 0 && data[0] == '$') ? 0 : next_keyword(0);
+  while (offset < file_size)
+  {
+    const std::size_t data_offset = next_line(offset);
+    std::string keyword(data+offset, data+data_offset);
+    boost::algorithm::trim(keyword);
+    m_sections[keyword].push_back(offset);
+
+    std::size_t next_offset = data_offset;
+    if (keyword == "$MeshFormat")
+    {
+      Cursor format = cursor(data_offset, false);
+      const Real version = format.get_real();
+      const Uint file_type = format.get_uint();
+      const Uint data_size = format.get_uint();
+      if (version >= 3.)
+        throw NotSupported(FromHere(), "Gmsh file format version " + to_str(version) + " is not supported, only version 2 is");
+      m_binary = (file_type == 1);
+      format.next_line();
+      if (m_binary)
+      {
+        if (data_size != sizeof(double))
+          throw NotSupported(FromHere(), "Binary gmsh files must store reals in double precision");
+        format = cursor(this->offset(format), true);
+        if (format.get_int() != 1)
+          throw FileFormatError(FromHere(), "Binary gmsh file " + path.string() + " was written with a different byte order");
+      }
+      next_offset = this->offset(format);
+    }
+    else if (m_binary && (keyword == "$Nodes" || keyword == "$Elements" || keyword == "$NodeData" || keyword == "$ElementData" || keyword == "$ElementNodeData"))
+    {
+      // Binary data may contain '$', so it is skipped based on its size
+      next_offset = skip_binary_data(keyword, data_offset);
+    }
+
+    offset = next_keyword(next_offset);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+const std::vector<std::size_t>& MappedFile::sections(const std::string& keyword) const
+{
+  static const std::vector<std::size_t> no_sections;
+  std::map<std::string, std::vector<std::size_t> >::const_iterator it = m_sections.find(keyword);
+  return it == m_sections.end() ? no_sections : it->second;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t MappedFile::section_data(const std::size_t section_offset) const
+{
+  return next_line(section_offset);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+MappedFile::Cursor MappedFile::cursor(const std::size_t offset, const bool binary) const
+{
+  cf3_assert(offset <= size());
+  return Cursor(m_file.data() + offset, m_file.data() + size(), binary);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t MappedFile::line_start(const std::size_t offset) const
+{
+  if (offset == 0 || offset >= size() || m_file.data()[offset-1] == '\n')
+    return std::min(offset, size());
+  return next_line(offset);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t MappedFile::count_lines(const std::size_t begin, const std::size_t end) const
+{
+  cf3_assert(begin <= end && end <= size());
+  const char* data = m_file.data();
+  std::size_t nb_lines = 0;
+  std::size_t position = begin;
+  while (position < end)
+  {
+    const void* newline = std::memchr(data+position, '\n', end-position);
+    if (!newline)
+      return nb_lines + 1;
+    position = static_cast<const char*>(newline) - data + 1;
+    ++nb_lines;
+  }
+  return nb_lines;
+}
+
+std::size_t MappedFile::next_line(const std::size_t offset) const
+{
+  Cursor line = cursor(offset, false);
+  line.next_line();
+  return this->offset(line);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t MappedFile::next_keyword(const std::size_t offset) const
+{
+  const char* data = m_file.data();
+  const std::size_t file_size = size();
+  std::size_t position = offset;
+  while (position < file_size)
+  {
+    const void* found = std::memchr(data+position, '$', file_size-position);
+    if (!found)
+      return file_size;
+    position = static_cast<const char*>(found) - data;
+    if (position == 0 || data[position-1] == '\n')
+      return position;
+    ++position;
+  }
+  return file_size;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t MappedFile::skip_binary_data(const std::string& keyword, const std::size_t offset) const
+{
+  Cursor header = cursor(offset, false);
+
+  if (keyword == "$Nodes")
+  {
+    // node-number(int) x y z(double)
+    const Uint nb_nodes = header.get_uint();
+    header.next_line();
+    Cursor nodes = cursor(this->offset(header), true);
+    nodes.skip_bytes(static_cast<std::size_t>(nb_nodes) * (sizeof(int) + 3*sizeof(double)));
+    return this->offset(nodes);
+  }
+
+  if (keyword == "$Elements")
+  {
+    // blocks of: elm-type num-elm-follow num-tags, followed by num-elm-follow times elm-number tags node-list (all int)
+    const Uint nb_elems = header.get_uint();
+    header.next_line();
+    Cursor elems = cursor(this->offset(header), true);
+    Uint counted = 0;
+    while (counted < nb_elems)
+    {
+      const Uint elem_type = elems.get_uint();
+      const Uint nb_follow = elems.get_uint();
+      const Uint nb_tags = elems.get_uint();
+      if (elem_type >= m_nb_elem_types)
+        throw FileFormatError(FromHere(), "Unknown gmsh element type " + to_str(elem_type));
+      elems.skip_bytes(static_cast<std::size_t>(nb_follow) * (1 + nb_tags + m_nodes_in_elem_type[elem_type]) * sizeof(int));
+      counted += nb_follow;
+    }
+    return this->offset(elems);
+  }
+
+  // Data sections: an ASCII header with string, real and integer tags, followed by the binary values
+  const Uint nb_string_tags = header.get_uint();
+  header.next_line();
+  header.skip_lines(nb_string_tags);
+  const Uint nb_real_tags = header.get_uint();
+  header.next_line();
+  header.skip_lines(nb_real_tags);
+  const Uint nb_integer_tags = header.get_uint();
+  std::vector<Uint> integer_tags(nb_integer_tags);
+  for (Uint i=0; i<nb_integer_tags; ++i)
+    integer_tags[i] = header.get_uint();
+  header.next_line();
+  if (nb_integer_tags < 3)
+    throw FileFormatError(FromHere(), "Gmsh " + keyword + " section needs at least 3 integer tags");
+  const Uint nb_components = integer_tags[1];
+  const Uint nb_entries = integer_tags[2];
+
+  Cursor values = cursor(this->offset(header), true);
+  if (keyword == "$ElementNodeData")
+  {
+    for (Uint e=0; e<nb_entries; ++e)
+    {
+      values.get_int();
+      const Uint nb_elem_nodes = values.get_uint();
+      values.skip_bytes(static_cast<std::size_t>(nb_elem_nodes) * nb_components * sizeof(double));
+    }
+  }
+  else
+  {
+    values.skip_bytes(static_cast<std::size_t>(nb_entries) * (sizeof(int) + nb_components*sizeof(double)));
+  }
+  return this->offset(values);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // gmsh
+} // mesh
+} // cf3
@@ -0,0 +1,124 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_Gmsh_MappedFile_hpp
+#define cf3_mesh_Gmsh_MappedFile_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "mesh/gmsh/LibGmsh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace gmsh {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Read-only memory map of a gmsh file.
+/// On construction the file is scanned once for the positions of its sections,
+/// without parsing the node and element data. The data is then parsed
+/// directly from the mapped memory through a Cursor, in the ASCII
+/// as well as in the binary encoding of the version 2 format.
+class gmsh_API MappedFile
+{
+public:
+
+  /// Parses numbers from the mapped memory, starting at a given position
+  class gmsh_API Cursor
+  {
+  public:
+    Cursor(const char* position, const char* end, const bool binary);
+
+    /// Unsigned integer, a 4-byte int in binary mode
+    Uint get_uint();
+
+    /// Signed integer, a 4-byte int in binary mode
+    int get_int();
+
+    /// Real, an 8-byte double in binary mode
+    Real get_real();
+
+    /// Skip to the start of the next line (ASCII mode)
+    void next_line();
+
+    /// Skip the given number of lines (ASCII mode)
+    void skip_lines(const std::size_t nb_lines);
+
+    /// Skip the given number of bytes (binary mode)
+    void skip_bytes(const std::size_t nb_bytes);
+
+    const char* position() const { return m_position; }
+
+  private:
+    void skip_blanks();
+    void check_remaining(const std::size_t nb_bytes) const;
+
+    const char* m_position;
+    const char* m_end;
+    bool m_binary;
+  };
+
+  /// Map the file and locate its sections
+  /// @param nodes_in_elem_type Number of nodes for each gmsh element type, needed to skip binary element data
+  MappedFile(const boost::filesystem::path& path, const Uint* nodes_in_elem_type, const Uint nb_elem_types);
+
+  /// True if the data of the file is stored in binary
+  bool is_binary() const { return m_binary; }
+
+  /// Byte offsets of the lines holding the given section keyword (e.g. "$Nodes"), in file order
+  const std::vector<std::size_t>& sections(const std::string& keyword) const;
+
+  /// Byte offset of the first line after the keyword line of the given section
+  std::size_t section_data(const std::size_t section_offset) const;
+
+  /// Cursor at the given byte offset, in ASCII mode if binary is false
+  Cursor cursor(const std::size_t offset, const bool binary) const;
+
+  /// Byte offset of the current position of the given cursor
+  std::size_t offset(const Cursor& cursor) const { return cursor.position() - m_file.data(); }
+
+  /// Size of the mapped file in bytes
+  std::size_t size() const { return m_file.size(); }
+
+  /// Offset of the first line that starts at or after the given offset
+  std::size_t line_start(const std::size_t offset) const;
+
+  /// Number of lines starting in [begin,end), both at the start of a line
+  std::size_t count_lines(const std::size_t begin, const std::size_t end) const;
+
+private:
+  /// Offset of the start of the line following the given offset
+  std::size_t next_line(const std::size_t offset) const;
+
+  /// Offset of the next line that starts with '$', from the given offset
+  std::size_t next_keyword(const std::size_t offset) const;
+
+  /// Offset past the binary data of the section whose count line starts at the given offset
+  std::size_t skip_binary_data(const std::string& keyword, const std::size_t offset) const;
+
+  boost::iostreams::mapped_file_source m_file;
+  const Uint* m_nodes_in_elem_type;
+  Uint m_nb_elem_types;
+  bool m_binary;
+  std::map<std::string, std::vector<std::size_t> > m_sections;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // gmsh
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_Gmsh_MappedFile_hpp
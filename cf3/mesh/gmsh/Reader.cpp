@@ -4,6 +4,9 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/foreach.hpp>
 #include <boost/tokenizer.hpp>
 
@@ -19,6 +22,7 @@
 #include "common/List.hpp"
 #include "common/DynTable.hpp"
 
+#include "common/PE/Comm.hpp"
 #include "common/PE/debug.hpp"
 
 #include "mesh/Region.hpp"
@@ -33,6 +37,7 @@
 #include "mesh/Space.hpp"
 #include "mesh/Cells.hpp"
 
+#include "mesh/gmsh/MappedFile.hpp"
 #include "mesh/gmsh/Reader.hpp"
 
 
@@ -50,6 +55,58 @@ cf3::common::ComponentBuilder < gmsh::Reader, MeshReader, LibGmsh> aGmshReader_B
 
 //////////////////////////////////////////////////////////////////////////////
 
+/// Elements owned by this rank, as parsed from the mapped file
+struct Reader::MappedElements
+{
+  std::vector<Uint> number; // gmsh element number
+  std::vector<Uint> type;   // gmsh element type
+  std::vector<Uint> region; // index in the region list
+  std::vector<Uint> nodes;  // gmsh node numbers of all elements, in gmsh order
+};
+
+namespace {
+
+/// Contiguous range [first,second) of the objects owned by this rank
+std::pair<Uint,Uint> owned_range(const ParallelDistribution& hash)
+{
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_parts = hash.options().value<Uint>("nb_parts");
+  Uint begin = hash.options().value<Uint>("nb_obj");
+  Uint end = 0;
+  for (Uint part=0; part<nb_parts; ++part)
+  {
+    if (hash.proc_of_part(part) == rank)
+    {
+      begin = std::min(begin, hash.start_idx_in_part(part));
+      end = std::max(end, hash.end_idx_in_part(part));
+    }
+  }
+  return std::make_pair(std::min(begin,end), end);
+}
+
+/// Offset of the first given end keyword after the data offset, or the end of the file
+std::size_t section_end(const MappedFile& file, const std::string& keyword, const std::size_t data_offset)
+{
+  const std::vector<std::size_t>& ends = file.sections(keyword);
+  std::vector<std::size_t>::const_iterator it = std::lower_bound(ends.begin(), ends.end(), data_offset);
+  return it == ends.end() ? file.size() : *it;
+}
+
+/// True if the $MeshFormat line of the file declares binary data
+bool is_binary_file(const boost::filesystem::path& path)
+{
+  boost::filesystem::ifstream file(path);
+  std::string keyword;
+  Real version = 0.;
+  Uint file_type = 0;
+  file >> keyword >> version >> file_type;
+  return keyword == "$MeshFormat" && file_type == 1;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+
 Reader::Reader( const std::string& name )
 : MeshReader(name),
   Shared()
@@ -70,6 +127,11 @@ Reader::Reader( const std::string& name )
       .pretty_name("Read Fields")
       .mark_basic();
 
+  options().add("memory_map", false)
+      .description("Memory-map the file, and parse only the nodes and elements owned by this rank. "
+                   "When disabled, the file is read as a stream. Binary files are always memory-mapped.")
+      .pretty_name("Memory Map");
+
   // properties
 
   properties()["brief"] = std::string("Gmsh file reader component");
@@ -101,10 +163,16 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
 
   // if the file is present open it
   boost::filesystem::path fp (file.path());
+  bool memory_map = options().value<bool>("memory_map");
   if( boost::filesystem::exists(fp) )
   {
+    // The stream reader only handles ASCII files
+    memory_map = memory_map || is_binary_file(fp);
     CFinfo <<  "Opening file " <<  fp.string() << CFendl;
-    m_file.open(fp,std::ios_base::in); // exists so open it
+    if (memory_map)
+      m_mapped_file.reset(new MappedFile(fp, Shared::m_nodes_in_gmsh_elem, Shared::nb_gmsh_types));
+    else
+      m_file.open(fp,std::ios_base::in); // exists so open it
   }
   else // doesnt exist so throw exception
   {
@@ -120,22 +188,50 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
   // NOTE: since gmsh contains several 'physical entities' in one mesh, we create one region per physical entity
   m_region = Handle<Region>(m_mesh->topology().handle<Component>());
 
-  // Read file once and store positions
-  get_file_positions();
-  cf3_assert(m_hash);
+  if (memory_map)
+  {
+    // Scan the mapped file once for the sections, and parse only the owned entities
+    get_mapped_file_positions();
+    cf3_assert(m_hash);
+
+    m_mesh->initialize_nodes(0, m_mesh_dimension);
 
-  m_mesh->initialize_nodes(0, m_mesh_dimension);
+    MappedElements elements;
+    read_mapped_elements(elements);
+    read_mapped_coordinates(elements);
+    read_mapped_connectivity(elements);
+  }
+  else
+  {
+    // Read file once and store positions
+    get_file_positions();
+    cf3_assert(m_hash);
 
-  find_used_nodes();
-  read_coordinates();
-  read_connectivity();
+    m_mesh->initialize_nodes(0, m_mesh_dimension);
+
+    find_used_nodes();
+    read_coordinates();
+    read_connectivity();
+  }
 
   fix_negative_volumes(*m_mesh);
 
   if (options().value<bool>("read_fields"))
   {
-    read_element_node_data();
-    read_node_data();
+    const bool has_fields = m_element_node_data_positions.size() || m_node_data_positions.size();
+    if (memory_map && m_mapped_file->is_binary())
+    {
+      if (has_fields)
+        CFwarn << "Fields are not read from binary gmsh file " << fp.string() << CFendl;
+    }
+    else
+    {
+      // The field sections are read as a stream, at the positions found in the mapped file
+      if (memory_map && has_fields)
+        m_file.open(fp,std::ios_base::in);
+      read_element_node_data();
+      read_node_data();
+    }
   }
 
   m_node_idx_gmsh_to_cf.clear();
@@ -149,7 +245,9 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
     remove_component(*m_hash);
 
   // close the file
-  m_file.close();
+  m_mapped_file.reset();
+  if (m_file.is_open())
+    m_file.close();
 
   mesh.raise_mesh_loaded();
 }
@@ -169,11 +267,11 @@ void Reader::get_file_positions()
   m_node_data_positions.clear();
   m_element_node_data_positions.clear();
   m_elements_position=0;
-  int p;
+  std::size_t p;
   std::string line;
   while (!m_file.eof())
   {
-    p = m_file.tellg();
+    p = static_cast<std::size_t>(std::streamoff(m_file.tellg()));
     getline(m_file,line);
     if (line.find(region_names)!=std::string::npos) {
       m_region_names_position=p;
@@ -497,25 +595,16 @@ void Reader::read_coordinates()
 
 //////////////////////////////////////////////////////////////////////////////
 
-void Reader::read_connectivity()
+void Reader::create_elements(std::vector<std::map<Uint, Entities*> >& conn_table_idx)
 {
-
   Dictionary& nodes = m_mesh->geometry_fields();
 
-
-  Uint part = options().value<Uint>("part");
-
-  //Each entry of this vector holds a map (gmsh_type_idx, pointer to connectivity table of this gmsh type).
- //Each row corresponds to one region of the mesh
- std::vector<std::map<Uint, Entities* > > conn_table_idx;
  conn_table_idx.resize(m_nb_regions);
  for(Uint ir = 0; ir < m_nb_regions; ++ir)
  {
     conn_table_idx[ir].clear();
  }
 
- std::map<Uint, Entities*>::iterator elem_table_iter;
-
 // std::vector<std::map<std::string,Handle< Elements > > > elements(m_nb_regions);
 // std::vector<std::map<std::string,Handle< Connectivity::Buffer > > > buffer(m_nb_regions);
 
@@ -561,6 +650,20 @@ void Reader::read_connectivity()
      }
    }
  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_connectivity()
+{
+  Uint part = options().value<Uint>("part");
+
+  //Each entry of this vector holds a map (gmsh_type_idx, pointer to connectivity table of this gmsh type).
+ //Each row corresponds to one region of the mesh
+ std::vector<std::map<Uint, Entities* > > conn_table_idx;
+ create_elements(conn_table_idx);
+
+ std::map<Uint, Entities*>::iterator elem_table_iter;
 
    std::string etype_CF;
    std::set<Uint>::const_iterator it;
@@ -652,6 +755,437 @@ void Reader::read_connectivity()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Reader::get_mapped_file_positions()
+{
+  MappedFile& file = *m_mapped_file;
+
+  const std::vector<std::size_t>& region_names = file.sections("$PhysicalNames");
+  const std::vector<std::size_t>& nodes = file.sections("$Nodes");
+  const std::vector<std::size_t>& elements = file.sections("$Elements");
+  if (region_names.empty())
+    throw ParsingFailed(FromHere(),"File does not contain any physical names");
+  if (nodes.empty())
+    throw ParsingFailed(FromHere(),"File does not contain any nodes");
+  if (elements.empty())
+    throw ParsingFailed(FromHere(),"File does not contain any elements");
+
+  m_element_data_positions.assign(file.sections("$ElementData").begin(), file.sections("$ElementData").end());
+  m_node_data_positions.assign(file.sections("$NodeData").begin(), file.sections("$NodeData").end());
+  m_element_node_data_positions.assign(file.sections("$ElementNodeData").begin(), file.sections("$ElementNodeData").end());
+
+  // Physical groups, one region each
+  m_region_names_position = region_names.front();
+  MappedFile::Cursor cursor = file.cursor(file.section_data(m_region_names_position), false);
+  m_nb_regions = cursor.get_uint();
+  cursor.next_line();
+  m_region_list.clear();
+  m_region_list.resize(m_nb_regions);
+  m_nb_gmsh_elem_in_region.assign(m_nb_regions, std::vector<Uint>(Shared::nb_gmsh_types, 0));
+
+  m_mesh_dimension = options().value<Uint>("dimension");
+  for(Uint ir = 0; ir < m_nb_regions; ++ir)
+  {
+    const Uint phys_group_dimensionality = cursor.get_uint();
+    const Uint phys_group_index = cursor.get_uint();
+    const char* name_begin = cursor.position();
+    cursor.next_line();
+    std::string phys_group_name(name_begin, cursor.position());
+    boost::algorithm::trim(phys_group_name);
+    if (phys_group_index == 0 || phys_group_index > m_nb_regions)
+      throw ParsingFailed(FromHere(),"Physical group " + phys_group_name + " has invalid index " + to_str(phys_group_index));
+
+    RegionData& region_data = m_region_list[phys_group_index-1];
+    region_data.dim = phys_group_dimensionality;
+    region_data.index = phys_group_index;
+    //The original name of the region in the mesh file has quotes, we want to strip them off
+    region_data.name = phys_group_name.substr(1,phys_group_name.length()-2);
+    region_data.region = create_region(region_data.name);
+    m_mesh_dimension = std::max(region_data.dim,m_mesh_dimension);
+  }
+
+  m_coordinates_position = nodes.front();
+  cursor = file.cursor(file.section_data(m_coordinates_position), false);
+  m_total_nb_nodes = cursor.get_uint();
+  cursor.next_line();
+  m_mapped_nodes_data = file.offset(cursor);
+  m_mapped_nodes_end = section_end(file, "$EndNodes", m_mapped_nodes_data);
+  if (m_total_nb_nodes == 0) throw ParsingFailed(FromHere(),"File contains no nodes");
+
+  m_elements_position = elements.front();
+  cursor = file.cursor(file.section_data(m_elements_position), false);
+  m_total_nb_elements = cursor.get_uint();
+  cursor.next_line();
+  m_mapped_elements_data = file.offset(cursor);
+  m_mapped_elements_end = section_end(file, "$EndElements", m_mapped_elements_data);
+  if (m_total_nb_elements == 0) throw ParsingFailed(FromHere(),"File contains no elements");
+
+  //Create a hash
+  m_hash = create_component<MergedParallelDistribution>("hash");
+  std::vector<Uint> num_obj(2);
+  num_obj[0] = m_total_nb_nodes;
+  num_obj[1] = m_total_nb_elements;
+  m_hash->options().set("nb_parts",options().value<Uint>("nb_parts"));
+  m_hash->options().set("nb_obj",num_obj);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+MappedFile::Cursor Reader::mapped_line(const std::size_t data_begin, const std::size_t data_end, const Uint line) const
+{
+  const MappedFile& file = *m_mapped_file;
+  PE::Comm& comm = PE::Comm::instance();
+  const Uint nb_chunks = (comm.is_active() && comm.size() > 1) ? comm.size() : 1u;
+
+  MappedFile::Cursor cursor = file.cursor(data_begin, false);
+  if (nb_chunks == 1)
+  {
+    cursor.skip_lines(line);
+    return cursor;
+  }
+
+  // Every rank counts the lines in an equal share of the bytes, starting at the first full line of the share
+  std::vector<std::size_t> chunk_begin(nb_chunks+1, data_end);
+  const std::size_t nb_bytes = data_end - data_begin;
+  for (Uint c=0; c<nb_chunks; ++c)
+    chunk_begin[c] = std::min(file.line_start(data_begin + (nb_bytes*c)/nb_chunks), data_end);
+  const Uint rank = comm.rank();
+  const Uint nb_lines = file.count_lines(chunk_begin[rank], chunk_begin[rank+1]);
+  std::vector<Uint> chunk_lines;
+  comm.all_gather(nb_lines, chunk_lines);
+
+  // Only the share holding the line is scanned
+  Uint first_line = 0;
+  Uint chunk = 0;
+  while (chunk < nb_chunks && first_line + chunk_lines[chunk] <= line)
+    first_line += chunk_lines[chunk++];
+  cursor = file.cursor(chunk_begin[chunk], false);
+  cursor.skip_lines(line - first_line);
+  return cursor;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_mapped_elements(MappedElements& elements)
+{
+  MappedFile& file = *m_mapped_file;
+  const bool binary = file.is_binary();
+  const std::pair<Uint,Uint> range = owned_range(m_hash->subhash(ELEMS));
+
+  elements.number.reserve(range.second-range.first);
+  elements.type.reserve(range.second-range.first);
+  elements.region.reserve(range.second-range.first);
+
+  MappedFile::Cursor cursor = file.cursor(m_mapped_elements_data, binary);
+  Uint gmsh_element_type = 0;
+  Uint nb_tags = 0;
+  Uint nb_left_in_block = 0;
+
+  // Move to the first owned element
+  if (!binary)
+  {
+    cursor = mapped_line(m_mapped_elements_data, m_mapped_elements_end, range.first);
+  }
+  else if (range.first < range.second)
+  {
+    // Binary elements come in blocks with the same type and number of tags
+    Uint elem_idx = 0;
+    while (true)
+    {
+      gmsh_element_type = cursor.get_uint();
+      const Uint nb_in_block = cursor.get_uint();
+      nb_tags = cursor.get_uint();
+      const std::size_t element_size = (1 + nb_tags + Shared::m_nodes_in_gmsh_elem[gmsh_element_type]) * sizeof(int);
+      if (elem_idx + nb_in_block > range.first)
+      {
+        cursor.skip_bytes((range.first - elem_idx) * element_size);
+        nb_left_in_block = elem_idx + nb_in_block - range.first;
+        break;
+      }
+      cursor.skip_bytes(nb_in_block * element_size);
+      elem_idx += nb_in_block;
+    }
+  }
+
+  for (Uint i=range.first; i<range.second; ++i)
+  {
+    if (binary && nb_left_in_block == 0)
+    {
+      gmsh_element_type = cursor.get_uint();
+      nb_left_in_block = cursor.get_uint();
+      nb_tags = cursor.get_uint();
+    }
+
+    // element description
+    const Uint element_number = cursor.get_uint();
+    if (!binary)
+    {
+      gmsh_element_type = cursor.get_uint();
+      nb_tags = cursor.get_uint();
+    }
+    if (gmsh_element_type >= Shared::nb_gmsh_types || Shared::m_nodes_in_gmsh_elem[gmsh_element_type] == 0)
+      throw ParsingFailed(FromHere(),"Element " + to_str(element_number) + " has unsupported gmsh type " + to_str(gmsh_element_type));
+    if (nb_tags == 0)
+      throw ParsingFailed(FromHere(),"Element " + to_str(element_number) + " is not in a physical group");
+
+    // The first tag is the physical group, the others are skipped
+    const int phys_tag = cursor.get_int();
+    if (phys_tag < 1 || static_cast<Uint>(phys_tag) > m_nb_regions)
+      throw ParsingFailed(FromHere(),"Element " + to_str(element_number) + " is in unknown physical group " + to_str(phys_tag));
+    for(Uint itag = 1; itag < nb_tags; ++itag)
+      cursor.get_int();
+
+    elements.number.push_back(element_number);
+    elements.type.push_back(gmsh_element_type);
+    elements.region.push_back(phys_tag-1);
+    const Uint nb_element_nodes = Shared::m_nodes_in_gmsh_elem[gmsh_element_type];
+    for (Uint j=0; j<nb_element_nodes; ++j)
+      elements.nodes.push_back(cursor.get_uint());
+
+    (m_nb_gmsh_elem_in_region[phys_tag-1])[gmsh_element_type]++;
+
+    if (binary)
+      --nb_left_in_block;
+    else
+      cursor.next_line();
+  }
+
+  // Every rank creates the same element components, so the element types of each region are combined over the ranks
+  std::vector<Uint> local_types(m_nb_regions*Shared::nb_gmsh_types, 0u);
+  for(Uint ir = 0; ir < m_nb_regions; ++ir)
+    for(Uint etype = 0; etype < Shared::nb_gmsh_types; ++etype)
+      local_types[ir*Shared::nb_gmsh_types+etype] = (m_nb_gmsh_elem_in_region[ir])[etype] ? 1u : 0u;
+
+  std::vector<Uint> global_types(local_types);
+  if (PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1)
+    PE::Comm::instance().all_reduce(PE::max(), local_types, global_types);
+
+  for(Uint ir = 0; ir < m_nb_regions; ++ir)
+    for(Uint etype = 0; etype < Shared::nb_gmsh_types; ++etype)
+      if (global_types[ir*Shared::nb_gmsh_types+etype])
+        m_region_list[ir].element_types.insert(etype);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_mapped_coordinates(const MappedElements& elements)
+{
+  MappedFile& file = *m_mapped_file;
+  const bool binary = file.is_binary();
+  const ParallelDistribution& node_hash = m_hash->subhash(NODES);
+  const std::pair<Uint,Uint> range = owned_range(node_hash);
+  const Uint nb_owned = range.second - range.first;
+  const Uint part = options().value<Uint>("part");
+
+  // Owned nodes. Gmsh always stores 3 coordinates, even for 2D meshes
+  std::vector<Uint> owned_numbers(nb_owned);
+  std::vector<Real> owned_coordinates(nb_owned*m_mesh_dimension);
+  bool sorted = true;
+
+  MappedFile::Cursor cursor = file.cursor(m_mapped_nodes_data, binary);
+  if (binary)
+    cursor.skip_bytes(static_cast<std::size_t>(range.first) * (sizeof(int) + DIM_3D*sizeof(double)));
+  else
+    cursor = mapped_line(m_mapped_nodes_data, m_mapped_nodes_end, range.first);
+
+  m_node_idx_gmsh_to_cf.clear();
+  for (Uint i=0; i<nb_owned; ++i)
+  {
+    owned_numbers[i] = cursor.get_uint();
+    for (Uint dim=0; dim<DIM_3D; ++dim)
+    {
+      const Real coordinate = cursor.get_real();
+      if (dim < m_mesh_dimension)
+        owned_coordinates[i*m_mesh_dimension+dim] = coordinate;
+    }
+    if (!binary)
+      cursor.next_line();
+
+    sorted = sorted && (i == 0 || owned_numbers[i] > owned_numbers[i-1]);
+    m_node_idx_gmsh_to_cf.insert(m_node_idx_gmsh_to_cf.end(), std::make_pair(owned_numbers[i], i));
+  }
+
+  // Nodes used by the owned elements, but owned by another rank
+  std::vector<Uint> ghost_numbers;
+  {
+    std::vector<Uint> used_nodes(elements.nodes);
+    std::sort(used_nodes.begin(), used_nodes.end());
+    used_nodes.erase(std::unique(used_nodes.begin(), used_nodes.end()), used_nodes.end());
+    boost_foreach(const Uint gmsh_node_number, used_nodes)
+    {
+      if (m_node_idx_gmsh_to_cf.find(gmsh_node_number) == m_node_idx_gmsh_to_cf.end())
+        ghost_numbers.push_back(gmsh_node_number);
+    }
+  }
+  const Uint nb_ghosts = ghost_numbers.size();
+  std::vector<Real> ghost_coordinates(nb_ghosts*m_mesh_dimension);
+  std::vector<Uint> ghost_parts(nb_ghosts);
+
+  // When the node numbers increase over the ranks, the owner of each ghost node follows from the owned ranges
+  PE::Comm& comm = PE::Comm::instance();
+  bool query_owners = comm.is_active() && comm.size() > 1;
+  std::vector<Uint> ranges;
+  if (query_owners)
+  {
+    std::vector<Uint> local_range(4, 0u);
+    local_range[0] = nb_owned;
+    local_range[1] = sorted ? 1u : 0u;
+    if (nb_owned)
+    {
+      local_range[2] = owned_numbers.front();
+      local_range[3] = owned_numbers.back();
+    }
+    comm.all_gather(local_range, ranges);
+
+    bool first_range = true;
+    Uint previous_last = 0;
+    for (Uint p=0; p<comm.size(); ++p)
+    {
+      if (ranges[4*p] == 0)
+        continue;
+      if (!ranges[4*p+1] || (!first_range && ranges[4*p+2] <= previous_last))
+        query_owners = false;
+      previous_last = ranges[4*p+3];
+      first_range = false;
+    }
+  }
+
+  if (query_owners)
+  {
+    // Ask the owners for the ghost nodes
+    std::vector< std::vector<Uint> > send_queries(comm.size());
+    std::vector< std::vector<Uint> > recv_queries;
+    Uint owner = 0;
+    boost_foreach(const Uint gmsh_node_number, ghost_numbers)
+    {
+      while (owner < comm.size() && (ranges[4*owner] == 0 || ranges[4*owner+3] < gmsh_node_number))
+        ++owner;
+      if (owner == comm.size() || ranges[4*owner+2] > gmsh_node_number)
+        throw ParsingFailed(FromHere(),"Node " + to_str(gmsh_node_number) + " is used by an element, but is not in the file");
+      send_queries[owner].push_back(gmsh_node_number);
+    }
+    comm.all_to_all(send_queries, recv_queries);
+
+    // Answer with the part followed by the coordinates of each node, or a negative part if it is not found
+    const Uint answer_size = 1 + m_mesh_dimension;
+    std::vector< std::vector<Real> > send_answers(comm.size());
+    std::vector< std::vector<Real> > recv_answers;
+    for (Uint p=0; p<comm.size(); ++p)
+    {
+      send_answers[p].reserve(recv_queries[p].size()*answer_size);
+      boost_foreach(const Uint gmsh_node_number, recv_queries[p])
+      {
+        const Uint i = std::lower_bound(owned_numbers.begin(), owned_numbers.end(), gmsh_node_number) - owned_numbers.begin();
+        const bool found = i < nb_owned && owned_numbers[i] == gmsh_node_number;
+        send_answers[p].push_back(found ? static_cast<Real>(node_hash.part_of_obj(range.first+i)) : -1.);
+        for (Uint dim=0; dim<m_mesh_dimension; ++dim)
+          send_answers[p].push_back(found ? owned_coordinates[i*m_mesh_dimension+dim] : 0.);
+      }
+    }
+    comm.all_to_all(send_answers, recv_answers);
+
+    // The queries were sent in the order of the sorted ghost nodes
+    Uint ghost_idx = 0;
+    for (Uint p=0; p<comm.size(); ++p)
+    {
+      for (Uint q=0; q<send_queries[p].size(); ++q, ++ghost_idx)
+      {
+        const Real* answer = &recv_answers[p][q*answer_size];
+        if (answer[0] < 0.)
+          throw ParsingFailed(FromHere(),"Node " + to_str(ghost_numbers[ghost_idx]) + " is used by an element, but is not in the file");
+        ghost_parts[ghost_idx] = static_cast<Uint>(answer[0]);
+        for (Uint dim=0; dim<m_mesh_dimension; ++dim)
+          ghost_coordinates[ghost_idx*m_mesh_dimension+dim] = answer[1+dim];
+      }
+    }
+  }
+  else if (nb_ghosts)
+  {
+    // Look the ghost nodes up in the whole section
+    cursor = file.cursor(m_mapped_nodes_data, binary);
+    Uint nb_found = 0;
+    for (Uint node_idx=0; node_idx<m_total_nb_nodes && nb_found<nb_ghosts; ++node_idx)
+    {
+      const Uint gmsh_node_number = cursor.get_uint();
+      Real coordinates[DIM_3D];
+      for (Uint dim=0; dim<DIM_3D; ++dim)
+        coordinates[dim] = cursor.get_real();
+      if (!binary)
+        cursor.next_line();
+
+      if (node_idx >= range.first && node_idx < range.second)
+        continue;
+      std::vector<Uint>::const_iterator it = std::lower_bound(ghost_numbers.begin(), ghost_numbers.end(), gmsh_node_number);
+      if (it != ghost_numbers.end() && *it == gmsh_node_number)
+      {
+        const Uint ghost_idx = it - ghost_numbers.begin();
+        ghost_parts[ghost_idx] = node_hash.part_of_obj(node_idx);
+        for (Uint dim=0; dim<m_mesh_dimension; ++dim)
+          ghost_coordinates[ghost_idx*m_mesh_dimension+dim] = coordinates[dim];
+        ++nb_found;
+      }
+    }
+    if (nb_found != nb_ghosts)
+      throw ParsingFailed(FromHere(),"Some nodes used by the elements are not in the file");
+  }
+
+  // Store the owned nodes first, followed by the ghost nodes
+  Dictionary& nodes = m_mesh->geometry_fields();
+  nodes.resize(nb_owned+nb_ghosts);
+  common::Table<Real>& coordinates = nodes.coordinates();
+  for (Uint i=0; i<nb_owned; ++i)
+  {
+    for (Uint dim=0; dim<m_mesh_dimension; ++dim)
+      coordinates[i][dim] = owned_coordinates[i*m_mesh_dimension+dim];
+    nodes.rank()[i] = part;
+    nodes.glb_idx()[i] = owned_numbers[i]-1;
+  }
+  for (Uint ghost_idx=0; ghost_idx<nb_ghosts; ++ghost_idx)
+  {
+    const Uint coord_idx = nb_owned+ghost_idx;
+    m_node_idx_gmsh_to_cf[ghost_numbers[ghost_idx]] = coord_idx;
+    for (Uint dim=0; dim<m_mesh_dimension; ++dim)
+      coordinates[coord_idx][dim] = ghost_coordinates[ghost_idx*m_mesh_dimension+dim];
+    nodes.rank()[coord_idx] = ghost_parts[ghost_idx];
+    nodes.glb_idx()[coord_idx] = ghost_numbers[ghost_idx]-1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_mapped_connectivity(const MappedElements& elements)
+{
+  const Uint part = options().value<Uint>("part");
+
+  std::vector<std::map<Uint, Entities* > > conn_table_idx;
+  create_elements(conn_table_idx);
+
+  // The element counts are reused as row indices
+  for(Uint ir = 0; ir < m_nb_regions; ++ir)
+    std::fill(m_nb_gmsh_elem_in_region[ir].begin(), m_nb_gmsh_elem_in_region[ir].end(), 0u);
+
+  Uint nodes_begin = 0;
+  for (Uint e=0; e<elements.number.size(); ++e)
+  {
+    const Uint gmsh_element_type = elements.type[e];
+    const Uint ir = elements.region[e];
+    const Uint nb_element_nodes = Shared::m_nodes_in_gmsh_elem[gmsh_element_type];
+
+    Handle< Elements > elements_region = Handle<Elements>(conn_table_idx[ir][gmsh_element_type]->handle<Component>());
+    const Uint row_idx = (m_nb_gmsh_elem_in_region[ir])[gmsh_element_type]++;
+
+    Connectivity::Row element_nodes = elements_region->geometry_space().connectivity()[row_idx];
+    for (Uint j=0; j<nb_element_nodes; ++j)
+      element_nodes[Shared::m_nodes_gmsh_to_cf[gmsh_element_type][j]] = m_node_idx_gmsh_to_cf[elements.nodes[nodes_begin+j]];
+    nodes_begin += nb_element_nodes;
+
+    elements_region->rank()[row_idx] = part;
+    elements_region->glb_idx()[row_idx] = elements.number[e]-1;
+    m_elem_idx_gmsh_to_cf[elements.number[e]] = std::make_pair(elements_region, row_idx);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 void Reader::read_element_node_data()
 {
   /// Discontinuous fields section
@@ -673,7 +1207,7 @@ void Reader::read_element_node_data()
 
   std::map<std::string,Reader::Field> gmsh_fields;
 
-  boost_foreach(Uint element_node_data_position, m_element_node_data_positions)
+  boost_foreach(const std::size_t element_node_data_position, m_element_node_data_positions)
   {
     m_file.seekg(element_node_data_position,std::ios::beg);
     read_variable_header(gmsh_fields);
@@ -781,7 +1315,7 @@ void Reader::read_element_data()
 
   std::map<std::string,Reader::Field> fields;
 
-  boost_foreach(Uint element_data_position, m_element_data_positions)
+  boost_foreach(const std::size_t element_data_position, m_element_data_positions)
   {
     m_file.seekg(element_data_position,std::ios::beg);
     read_variable_header(fields);
@@ -862,7 +1396,7 @@ void Reader::read_node_data()
 
   std::map<std::string,Field> fields;
 
-  boost_foreach(Uint node_data_position, m_node_data_positions)
+  boost_foreach(const std::size_t node_data_position, m_node_data_positions)
   {
     m_file.seekg(node_data_position,std::ios::beg);
     read_variable_header(fields);
@@ -981,7 +1515,7 @@ void Reader::read_variable_header(std::map<std::string,Field>& fields)
   field.time=field_time;
   field.time_step=field_time_step;
   field.nb_entries=nb_entries;
-  field.file_data_positions.push_back(m_file.tellg());
+  field.file_data_positions.push_back(static_cast<std::size_t>(std::streamoff(m_file.tellg())));
 
   CFdebug << "    - found variable " << var_name << " from discontinuous field " << field_name << " at time " << field_time << CFendl;
 }
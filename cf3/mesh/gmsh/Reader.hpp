@@ -10,11 +10,13 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <set>
+#include <boost/shared_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
 
 #include "mesh/MeshReader.hpp"
 
 #include "mesh/gmsh/LibGmsh.hpp"
+#include "mesh/gmsh/MappedFile.hpp"
 #include "mesh/gmsh/Shared.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -23,6 +25,7 @@ namespace cf3 {
 namespace mesh {
 
 class Elements;
+class Entities;
 class Region;
 class MergedParallelDistribution;
 class Dictionary;
@@ -61,6 +64,26 @@ private: // functions
 
   void read_connectivity();
 
+  void create_elements(std::vector<std::map<Uint, Entities*> >& conn_table_idx);
+
+  /// @name Memory-mapped reading
+  /// Each rank only parses its own range of the $Nodes and $Elements sections,
+  /// and receives the coordinates of its ghost nodes from their owners.
+  //@{
+  struct MappedElements;
+
+  void get_mapped_file_positions();
+
+  void read_mapped_elements(MappedElements& elements);
+
+  void read_mapped_coordinates(const MappedElements& elements);
+
+  void read_mapped_connectivity(const MappedElements& elements);
+
+  /// Cursor at the given line of the ASCII data in [data_begin,data_end), collective
+  MappedFile::Cursor mapped_line(const std::size_t data_begin, const std::size_t data_end, const Uint line) const;
+  //@}
+
   void read_element_node_data();
 
   void read_element_data();
@@ -79,6 +102,7 @@ private: // data
   std::map<Uint, Uint> m_node_idx_gmsh_to_cf;
 
   boost::filesystem::fstream m_file;
+  boost::shared_ptr<MappedFile> m_mapped_file;
   Handle<Mesh> m_mesh;
   Handle<Region> m_region;
 
@@ -107,12 +131,16 @@ private: // data
   std::vector<std::set<Uint> > m_node_to_glb_elements;
 
   //Markers for important places in the file to be read
-  Uint m_region_names_position;
-  Uint m_coordinates_position;
-  Uint m_elements_position;
-  std::vector<Uint> m_element_data_positions;
-  std::vector<Uint> m_node_data_positions;
-  std::vector<Uint> m_element_node_data_positions;
+  std::size_t m_region_names_position;
+  std::size_t m_coordinates_position;
+  std::size_t m_elements_position;
+  std::vector<std::size_t> m_element_data_positions;
+  std::vector<std::size_t> m_node_data_positions;
+  std::vector<std::size_t> m_element_node_data_positions;
+  std::size_t m_mapped_nodes_data;    // first node, after the count line
+  std::size_t m_mapped_nodes_end;     // the $EndNodes line
+  std::size_t m_mapped_elements_data; // first element, after the count line
+  std::size_t m_mapped_elements_end;  // the $EndElements line
 
 
   std::vector<std::vector<Uint> > m_nb_gmsh_elem_in_region;
@@ -127,7 +155,7 @@ private: // data
     Uint time_step;
     std::vector<Uint> var_types;
     Uint nb_entries;
-    std::vector<Uint> file_data_positions;
+    std::vector<std::size_t> file_data_positions;
     std::string description() const
     {
       std::stringstream ss;
@@ -218,7 +218,7 @@ void Writer::write_coordinates(std::fstream& file)
   const Uint nb_dim = m_mesh->dimension();
   Uint node_number=0;
   const Dictionary& geometry = m_mesh->geometry_fields();
-  const common::Table<Real>& coordinates = geometry.coordinates();
+  const common::Table<Real>& coordinates = MeshWriter::coordinates();
   Uint gmsh_node = 1;
   boost_foreach( const Uint node, used_nodes.array())
   {
@@ -324,8 +324,8 @@ void Writer::write_elem_nodal_data(std::fstream& file)
     const Field& field = *field_h;
     if(field.discontinuous())
     {
-      const Real field_time = m_mesh->metadata().properties().value<Real>("time");
-      const Uint field_iter = m_mesh->metadata().properties().value<Uint>("iter");
+      const Real field_time = m_time;
+      const Uint field_iter = m_iter;
       const std::string field_name = field.name();
       Uint nb_elements = 0;
       boost_foreach(const Handle<Entities const>& elements_handle, m_filtered_entities )
@@ -490,8 +490,8 @@ void Writer::write_nodal_data(std::fstream& file)
     {
       cf3_assert(is_null(field_h) == false);
       const Field& field = *field_h;
-      const Real field_time = m_mesh->metadata().properties().value<Real>("time");
-      const Uint field_iter = m_mesh->metadata().properties().value<Uint>("iter");
+      const Real field_time = m_time;
+      const Uint field_iter = m_iter;
       const std::string field_name = field.name();
       Uint nb_elements = 0;
       std::vector< Handle<Entities const> > filtered_used_entities_by_field;
@@ -0,0 +1,74 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_hilbert_LibHilbert_hpp
+#define cf3_mesh_hilbert_LibHilbert_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Library.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Define the macro mesh_hilbert_API
+/// @note build system defines COOLFLUID_MESH_HILBERT_EXPORTS when compiling hilbert files
+#ifdef COOLFLUID_MESH_HILBERT_EXPORTS
+#   define mesh_hilbert_API      CF3_EXPORT_API
+#   define mesh_hilbert_TEMPLATE
+#else
+#   define mesh_hilbert_API      CF3_IMPORT_API
+#   define mesh_hilbert_TEMPLATE CF3_TEMPLATE_EXTERN
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+/// @brief Library for mesh partitioning along the Hilbert space-filling curve
+namespace hilbert {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Class defines a mesh partitioner that needs no external library
+class mesh_hilbert_API LibHilbert : public common::Library
+{
+public:
+
+  /// Constructor
+  LibHilbert ( const std::string& name) : common::Library(name) { }
+
+  /// @return string of the library namespace
+  static std::string library_namespace() { return "cf3.mesh.hilbert"; }
+
+  /// Static function that returns the module name.
+  /// Must be implemented for Library registration
+  /// @return name of the library
+  static std::string library_name() { return "hilbert"; }
+
+  /// Static function that returns the description of the module.
+  /// Must be implemented for Library registration
+  /// @return description of the library
+
+  static std::string library_description()
+  {
+    return "This library implements a mesh partitioner based on the Hilbert space-filling curve.";
+  }
+
+  /// Gets the Class name
+  static std::string type_name() { return "LibHilbert"; }
+
+}; // LibHilbert
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // hilbert
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_hilbert_LibHilbert_hpp
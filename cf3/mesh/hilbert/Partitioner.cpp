@@ -0,0 +1,236 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/Builder.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
+#include "common/Log.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/Hilbert.hpp"
+
+#include "mesh/hilbert/Partitioner.hpp"
+#include "mesh/BoundingBox.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Space.hpp"
+
+namespace cf3 {
+namespace mesh {
+namespace hilbert {
+
+  using namespace common;
+  using namespace common::PE;
+
+////////////////////////////////////////////////////////////////////////////////
+
+cf3::common::ComponentBuilder < Partitioner, MeshTransformer, LibHilbert > hilbert_partitioner_builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+Partitioner::Partitioner ( const std::string& name ) :
+  MeshPartitioner(name),
+  m_nb_samples(64),
+  m_imbalance_tolerance(0.01)
+{
+  options().add("nb_samples", m_nb_samples)
+      .description("Number of samples every process contributes to the first guess of the splitters")
+      .pretty_name("Number of Samples")
+      .link_to(&m_nb_samples);
+
+  options().add("imbalance_tolerance", m_imbalance_tolerance)
+      .description("Allowed deviation of the weight of a part from the mean, relative to the mean")
+      .pretty_name("Imbalance Tolerance")
+      .link_to(&m_imbalance_tolerance);
+
+  options().add("node_weights", true)
+      .description("Weight each element by its number of nodes. If false, all elements have the same weight")
+      .pretty_name("Node Weights");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Partitioner::partition_graph()
+{
+  Comm& comm = Comm::instance();
+  if (comm.is_active() == false)
+    return;
+
+  Mesh& mesh = *m_mesh;
+  const Uint nb_parts = options().value<Uint>("nb_parts");
+  const bool node_weights = options().value<bool>("node_weights");
+
+  boost::shared_ptr<BoundingBox> bounding_box = allocate_component<BoundingBox>("bounding_box");
+  bounding_box->build(mesh.geometry_fields().coordinates());
+  bounding_box->make_global();
+  math::Hilbert compute_hilbert_idx(*bounding_box, 20);  // functor
+
+  // Key and weight of every owned element, ordered as in mesh.elements()
+  std::vector<boost::uint64_t> elem_keys;
+  std::vector<Real> elem_weights;
+  const Uint nb_entities = mesh.elements().size();
+  for (Uint entities_idx=0; entities_idx<nb_entities; ++entities_idx)
+  {
+    const Entities& entities = *mesh.elements()[entities_idx];
+    const Space& space = entities.geometry_space();
+    const Real weight = node_weights ? static_cast<Real>(entities.element_type().nb_nodes()) : 1.;
+
+    RealMatrix centroids;
+    entities.element_type().compute_centroids(space.connectivity(), space.dict().coordinates(), 0, entities.size(), centroids);
+    RealVector centroid(entities.element_type().dimension());
+    for (Uint e=0; e<entities.size(); ++e)
+    {
+      if (entities.is_ghost(e))
+        continue;
+      centroid = centroids.row(e).transpose();
+      elem_keys.push_back(compute_hilbert_idx(centroid));
+      elem_weights.push_back(weight);
+    }
+  }
+
+  // Sort the keys locally, keeping the cumulative weight
+  std::vector< std::pair<boost::uint64_t,Uint> > sorted(elem_keys.size());
+  for (Uint i=0; i<elem_keys.size(); ++i)
+    sorted[i] = std::make_pair(elem_keys[i],i);
+  std::sort(sorted.begin(),sorted.end());
+
+  m_keys.resize(sorted.size());
+  m_weights_below.resize(sorted.size()+1);
+  m_weights_below[0] = 0.;
+  for (Uint i=0; i<sorted.size(); ++i)
+  {
+    m_keys[i] = sorted[i].first;
+    m_weights_below[i+1] = m_weights_below[i] + elem_weights[sorted[i].second];
+  }
+  const Real local_weight = m_weights_below.back();
+
+  Real total_weight;
+  comm.all_reduce(PE::plus(), &local_weight, 1, &total_weight);
+  const Real part_weight = total_weight / static_cast<Real>(nb_parts);
+
+  // Samples at equal intervals of local weight, each representing the same share of it
+  std::vector<boost::uint64_t> samples;
+  const Uint nb_samples = std::max(m_nb_samples, 1u);
+  if (m_keys.size())
+  {
+    samples.resize(nb_samples);
+    for (Uint s=0; s<nb_samples; ++s)
+    {
+      const Real target = (s+0.5) * local_weight / static_cast<Real>(nb_samples);
+      const Uint idx = std::upper_bound(m_weights_below.begin()+1, m_weights_below.end(), target) - (m_weights_below.begin()+1);
+      samples[s] = m_keys[std::min(idx, static_cast<Uint>(m_keys.size())-1)];
+    }
+  }
+  std::vector< std::vector<boost::uint64_t> > gathered_samples;
+  comm.all_gather(samples, gathered_samples);
+  std::vector<Real> local_weights;
+  comm.all_gather(local_weight, local_weights);
+
+  std::vector< std::pair<boost::uint64_t,Real> > weighted_samples;
+  for (Uint p=0; p<gathered_samples.size(); ++p)
+  {
+    boost_foreach (const boost::uint64_t sample, gathered_samples[p])
+      weighted_samples.push_back(std::make_pair(sample, local_weights[p] / static_cast<Real>(gathered_samples[p].size())));
+  }
+  std::sort(weighted_samples.begin(),weighted_samples.end());
+
+  // First guess of the splitters: part p holds the keys in [splitters[p-1], splitters[p])
+  const Uint nb_splitters = nb_parts-1;
+  std::vector<boost::uint64_t> splitters(nb_splitters, compute_hilbert_idx.max_key());
+  {
+    Real cumulative_weight = 0.;
+    Uint p = 0;
+    for (Uint s=0; s<weighted_samples.size() && p<nb_splitters; ++s)
+    {
+      cumulative_weight += weighted_samples[s].second;
+      while (p<nb_splitters && cumulative_weight >= (p+1)*part_weight)
+        splitters[p++] = weighted_samples[s].first;
+    }
+  }
+
+  // Refine the splitters by bisection on the exact weight below them.
+  // weight_below(lo[p]) <= target <= weight_below(hi[p]) is kept for every unconverged splitter.
+  std::vector<boost::uint64_t> lo(nb_splitters, 0u);
+  std::vector<boost::uint64_t> hi(nb_splitters, compute_hilbert_idx.max_key()+1u);
+  std::vector<bool> converged(nb_splitters, false);
+  std::vector<Real> weights_below(nb_splitters);
+  const Real tolerance = m_imbalance_tolerance * part_weight;
+  Uint nb_iterations = 0;
+  for (bool done = (nb_splitters == 0); !done; ++nb_iterations)
+  {
+    global_weights_below(splitters, weights_below);
+
+    done = true;
+    for (Uint p=0; p<nb_splitters; ++p)
+    {
+      if (converged[p])
+        continue;
+      const Real target = (p+1)*part_weight;
+      if (std::abs(weights_below[p] - target) <= tolerance)
+      {
+        converged[p] = true;
+        continue;
+      }
+      if (weights_below[p] < target)
+        lo[p] = splitters[p];
+      else
+        hi[p] = splitters[p];
+
+      // Keys can not be split any further
+      if (hi[p] - lo[p] <= 1u)
+      {
+        splitters[p] = hi[p];
+        converged[p] = true;
+        continue;
+      }
+      splitters[p] = lo[p] + (hi[p]-lo[p])/2u;
+      done = false;
+    }
+  }
+
+  // Parts must follow each other, also when splitters did not converge within the tolerance
+  for (Uint p=1; p<nb_splitters; ++p)
+    splitters[p] = std::max(splitters[p],splitters[p-1]);
+
+  CFdebug << "Hilbert partitioning: splitters refined in " << nb_iterations << " iterations" << CFendl;
+
+  // Export the elements whose key falls in another part.
+  // Nodes are not exported, they follow the elements during migration.
+  Uint elem_idx = 0;
+  for (Uint entities_idx=0; entities_idx<nb_entities; ++entities_idx)
+  {
+    const Entities& entities = *mesh.elements()[entities_idx];
+    for (Uint e=0; e<entities.size(); ++e)
+    {
+      if (entities.is_ghost(e))
+        continue;
+      const Uint part = std::upper_bound(splitters.begin(), splitters.end(), elem_keys[elem_idx++]) - splitters.begin();
+      if (part != comm.rank())
+        m_elements_to_export[part][entities_idx].push_back(e);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Partitioner::global_weights_below(const std::vector<boost::uint64_t>& splitters, std::vector<Real>& weights) const
+{
+  std::vector<Real> local_weights(splitters.size());
+  for (Uint p=0; p<splitters.size(); ++p)
+    local_weights[p] = m_weights_below[std::lower_bound(m_keys.begin(), m_keys.end(), splitters[p]) - m_keys.begin()];
+  weights.resize(splitters.size());
+  Comm::instance().all_reduce(PE::plus(), local_weights, weights);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // hilbert
+} // mesh
+} // cf3
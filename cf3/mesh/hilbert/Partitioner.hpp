@@ -0,0 +1,84 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_hilbert_Partitioner_hpp
+#define cf3_mesh_hilbert_Partitioner_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/cstdint.hpp>
+
+#include "mesh/MeshPartitioner.hpp"
+#include "mesh/hilbert/LibHilbert.hpp"
+
+namespace cf3 {
+namespace mesh {
+namespace hilbert {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Partition the elements along the Hilbert space-filling curve
+///
+/// Every owned element gets the Hilbert key of its centroid and a weight representing its cost.
+/// The key range is cut in nb_parts intervals of equal total weight, and each element is moved
+/// to the part whose interval contains its key:
+/// - keys are sorted locally, and every process contributes a fixed number of samples at equal
+///   local weight intervals (sample sort). The gathered samples give a first guess of the splitters.
+/// - the splitters are then refined by bisection on the exact global weight below each splitter,
+///   which costs a single all_reduce of nb_parts values per iteration, until every part is
+///   within the imbalance tolerance.
+///
+/// No graph is needed, so this partitioner works without Zoltan or PT-Scotch, and it is cheap
+/// enough to serve as a first distribution before a graph partitioner.
+class mesh_hilbert_API Partitioner : public MeshPartitioner {
+
+public: // functions
+
+  /// Contructor
+  /// @param name of the component
+  Partitioner ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~Partitioner() {}
+
+  /// Get the class name
+  static std::string type_name () { return "Partitioner"; }
+
+  /// Partitioning functions
+
+  virtual void build_graph() { /* Does nothing, as the elements are partitioned on their coordinates only */ }
+
+  virtual void partition_graph();
+
+private: // functions
+
+  /// Global weight of all elements with a key strictly below each of the given splitters
+  void global_weights_below(const std::vector<boost::uint64_t>& splitters, std::vector<Real>& weights) const;
+
+private: // data
+
+  /// Sorted Hilbert keys of the owned elements
+  std::vector<boost::uint64_t> m_keys;
+
+  /// m_weights_below[i] is the total weight of the elements m_keys[0] to m_keys[i-1]
+  std::vector<Real> m_weights_below;
+
+  /// Number of samples every process contributes to the first guess of the splitters
+  Uint m_nb_samples;
+
+  /// Allowed deviation of the weight of a part from the mean, relative to the mean
+  Real m_imbalance_tolerance;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // hilbert
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_hilbert_Partitioner_hpp
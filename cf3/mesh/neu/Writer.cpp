@@ -156,7 +156,7 @@ void Writer::write_coordinates(std::fstream& file, const Mesh& mesh)
   file << "   NODAL COORDINATES 2.3.16" << std::endl;
   file.setf(std::ios::fixed);
   Uint node_number = 0;
-  boost_foreach(common::Table<Real>::ConstRow row, mesh.geometry_fields().coordinates().array())
+  boost_foreach(common::Table<Real>::ConstRow row, coordinates().array())
   {
     ++node_number;
     file << std::setw(10) << node_number;
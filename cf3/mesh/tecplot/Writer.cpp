@@ -189,9 +189,9 @@ void Writer::write_file(std::fstream& file)
     // one zone per element type per cpu
     // therefore the title is dependent on those parameters
     file << "ZONE "
-         << "  T=\"ITER"<<m_mesh->metadata().properties().value<Uint>("iter") << ":" << zone_name << "\""
+         << "  T=\"ITER"<<m_iter << ":" << zone_name << "\""
          << ", STRANDID="<<zone_idx
-         << ", SOLUTIONTIME="<<m_mesh->metadata().properties().value<Real>("time")
+         << ", SOLUTIONTIME="<<m_time
          << ", N=" << used_nodes.size()
          << ", E=" << nb_elems
          << ", DATAPACKING=BLOCK"
@@ -215,7 +215,7 @@ void Writer::write_file(std::fstream& file)
     file.precision(12);
 
     // loop over coordinates
-    const common::Table<Real>& coordinates = m_mesh->geometry_fields().coordinates();
+    const common::Table<Real>& coordinates = MeshWriter::coordinates();
     for (Uint d = 0; d < dimension; ++d)
     {
       file << "\n### variable x" << d << "\n\n"; // var name in comment
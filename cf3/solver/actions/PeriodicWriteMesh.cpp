@@ -4,14 +4,27 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
 #include "common/Builder.hpp"
+#include "common/Log.hpp"
 #include "common/OptionT.hpp"
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
 #include "common/Foreach.hpp"
 #include "common/FindComponents.hpp"
+#include "common/Group.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
 
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/Dictionary.hpp"
 #include "mesh/WriteMesh.hpp"
+#include "mesh/MeshWriter.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Field.hpp"
 
@@ -31,8 +44,30 @@ common::ComponentBuilder < PeriodicWriteMesh, common::Action, LibActions > Perio
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/// Writers may communicate, so a background thread needs full MPI thread support in parallel
+bool asynchronous_output_supported()
+{
+  if (!PE::Comm::instance().is_active() || PE::Comm::instance().size() == 1)
+    return true;
+  int provided;
+  MPI_Query_thread(&provided);
+  return provided == MPI_THREAD_MULTIPLE;
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 PeriodicWriteMesh::PeriodicWriteMesh ( const std::string& name ) : solver::Action(name),
-  m_writer( *create_static_component<WriteMesh>("MeshWriter") )
+  m_writer( *create_static_component<WriteMesh>("MeshWriter") ),
+  m_snapshot_fields( create_static_component<Group>("snapshots") ),
+  m_stop(false),
+  m_io_time(0.),
+  m_stall_time(0.),
+  m_snapshot_time(0.),
+  m_nb_writes(0)
 {
   mark_basic();
 
@@ -48,8 +83,38 @@ PeriodicWriteMesh::PeriodicWriteMesh ( const std::string& name ) : solver::Actio
   options().add( "filepath", URI() )
       .pretty_name("File Path")
       .description("Path where to save the mesh");
+
+  options().add( "asynchronous", false )
+      .pretty_name("Asynchronous")
+      .description("Write a snapshot of the fields in a background thread, while the solver continues");
+
+  options().add( "nb_buffers", 2u )
+      .pretty_name("Number of Buffers")
+      .description("Number of field snapshots that can be queued for asynchronous output");
+
+  properties().add("io_time", Real(0.));
+  properties().add("stall_time", Real(0.));
+  properties().add("hidden_io_time", Real(0.));
+  properties().add("snapshot_time", Real(0.));
+  properties().add("nb_writes", Uint(0));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+PeriodicWriteMesh::~PeriodicWriteMesh()
+{
+  if (m_thread)
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread->join();
+  }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////
 
 void PeriodicWriteMesh::execute()
 {
@@ -67,18 +132,219 @@ void PeriodicWriteMesh::execute()
     URI filepath = options().value<URI>("filepath");
 
     /// @note writes all fields to the mesh
+    const std::vector< Handle<Field> > fields = fields_to_write();
+
+    if (options().value<bool>("asynchronous") && asynchronous_output_supported())
+    {
+      write_asynchronous(fields, filepath);
+      return;
+    }
+
+    if (options().value<bool>("asynchronous") && m_nb_writes == 0)
+      CFwarn << "MPI was not initialized with MPI_THREAD_MULTIPLE, " << uri().string() << " writes synchronously" << CFendl;
+
+    wait_for_output();
 
     std::vector<URI> state_fields;
-    boost_foreach(const Field& field, find_components_recursively<Field>( mesh() ) )
+    boost_foreach(const Handle<Field>& field, fields)
     {
-      state_fields.push_back(field.uri());
+      state_fields.push_back(field->uri());
     }
 
+    Timer timer;
     m_writer.write_mesh( mesh(), filepath, state_fields );
+    m_io_time += timer.elapsed();
+    m_stall_time += timer.elapsed();
+    ++m_nb_writes;
+    update_timing_properties();
+  }
 
+}
 
+////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector< Handle<Field> > PeriodicWriteMesh::fields_to_write()
+{
+  std::vector< Handle<Field> > fields;
+  boost_foreach(Field& field, find_components_recursively<Field>( mesh() ) )
+  {
+    fields.push_back(field.handle<Field>());
   }
+  return fields;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
 
+void PeriodicWriteMesh::allocate_snapshots(const Uint nb_buffers)
+{
+  cf3_assert(m_queue.empty());
+  m_snapshots.clear();
+  boost_foreach(Group& group, find_components<Group>(*m_snapshot_fields))
+  {
+    m_snapshot_fields->remove_component(group);
+  }
+  for (Uint s=0; s<nb_buffers; ++s)
+  {
+    m_snapshots.push_back(boost::shared_ptr<Snapshot>(new Snapshot()));
+    m_snapshots.back()->fields = m_snapshot_fields->create_component<Group>("snapshot"+to_str(s));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void PeriodicWriteMesh::write_asynchronous(const std::vector< Handle<Field> >& fields, const URI& filepath)
+{
+  const Uint nb_buffers = std::max(1u, options().value<Uint>("nb_buffers"));
+
+  // All snapshots are created before any of them is handed to the background thread
+  if (m_snapshots.size() != nb_buffers)
+  {
+    wait_for_output();
+    allocate_snapshots(nb_buffers);
+  }
+
+  // Snapshots are used in turn, so the output order is the order of the iterations
+  const Uint snapshot_idx = m_nb_writes % nb_buffers;
+  Snapshot& snapshot = *m_snapshots[snapshot_idx];
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if (!m_error.empty())
+    {
+      const std::string error = m_error;
+      m_error.clear();
+      throw FileSystemError(FromHere(), "Asynchronous output of " + uri().string() + " failed: " + error);
+    }
+
+    // Back-pressure: wait until the background thread releases the snapshot
+    Timer stall;
+    while (snapshot.busy)
+      m_condition.wait(lock);
+    m_stall_time += stall.elapsed();
+  }
+
+  // Only the solver thread touches a snapshot that is not busy.
+  // The copies refer to the dictionary of the original field, but are not part of it.
+  Timer copy;
+  std::vector<URI> field_uris(fields.size());
+  Handle<Field> coordinates;
+  for (Uint f=0; f<fields.size(); ++f)
+  {
+    const Field& field = *fields[f];
+    Dictionary& dict = field.dict();
+    Handle<Group> dict_group(snapshot.fields->get_child(dict.name()));
+    if (is_null(dict_group))
+      dict_group = snapshot.fields->create_component<Group>(dict.name());
+    Handle<Field> copy_field(dict_group->get_child(field.name()));
+    if (is_null(copy_field))
+    {
+      copy_field = dict_group->create_component<Field>(field.name());
+      copy_field->set_dict(dict);
+      copy_field->create_descriptor(field.descriptor().description(), mesh().dimension());
+    }
+    if (copy_field->size() != field.size())
+      copy_field->resize(field.size());
+    copy_field->array() = field.array();
+    field_uris[f] = copy_field->uri();
+    if (&field == &mesh().geometry_fields().coordinates())
+      coordinates = copy_field;
+  }
+  cf3_assert(is_not_null(coordinates));
+
+  // The path and the writer are resolved now, from the metadata of this iteration.
+  // Each snapshot has its own writer, as the previous snapshot may still be written.
+  const URI resolved_filepath = m_writer.file_path(mesh(), filepath);
+  const std::string writer_name = m_writer.writer_for(resolved_filepath).name();
+  if (is_null(snapshot.writer) || snapshot.writer->name() != writer_name)
+  {
+    if (is_not_null(snapshot.writer))
+      snapshot.fields->remove_component(*snapshot.writer);
+    snapshot.writer = Handle<MeshWriter>(snapshot.fields->create_component(writer_name, writer_name));
+  }
+  snapshot.writer->options().set("mesh", mesh().handle<Mesh>());
+  snapshot.writer->options().set("fields", field_uris);
+  snapshot.writer->options().set("coordinates", coordinates);
+  snapshot.writer->options().set("file", resolved_filepath);
+  snapshot.writer->prepare();
+  m_snapshot_time += copy.elapsed();
+
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    snapshot.busy = true;
+    m_queue.push_back(snapshot_idx);
+    ++m_nb_writes;
+  }
+  m_condition.notify_all();
+
+  if (!m_thread)
+    m_thread.reset(new boost::thread(boost::bind(&PeriodicWriteMesh::output_loop, this)));
+
+  update_timing_properties();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void PeriodicWriteMesh::output_loop()
+{
+  while (true)
+  {
+    Uint snapshot_idx;
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while (m_queue.empty() && !m_stop)
+        m_condition.wait(lock);
+      if (m_queue.empty())
+        return;
+      snapshot_idx = m_queue.front();
+    }
+
+    Snapshot& snapshot = *m_snapshots[snapshot_idx];
+    std::string error;
+    Timer timer;
+    try
+    {
+      snapshot.writer->write_prepared();
+    }
+    catch (std::exception& e)
+    {
+      error = e.what();
+    }
+
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_io_time += timer.elapsed();
+      if (!error.empty())
+        m_error = error;
+      m_queue.pop_front();
+      snapshot.busy = false;
+    }
+    m_condition.notify_all();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void PeriodicWriteMesh::wait_for_output()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    Timer stall;
+    while (!m_queue.empty())
+      m_condition.wait(lock);
+    m_stall_time += stall.elapsed();
+  }
+  update_timing_properties();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void PeriodicWriteMesh::update_timing_properties()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  properties()["io_time"] = m_io_time;
+  properties()["stall_time"] = m_stall_time;
+  properties()["hidden_io_time"] = std::max(0., m_io_time - m_stall_time);
+  properties()["snapshot_time"] = m_snapshot_time;
+  properties()["nb_writes"] = m_nb_writes;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -7,16 +7,40 @@
 #ifndef cf3_solver_actions_PeriodicWriteMesh_hpp
 #define cf3_solver_actions_PeriodicWriteMesh_hpp
 
+#include <deque>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common/URI.hpp"
+
 #include "solver/actions/LibActions.hpp"
 #include "solver/Action.hpp"
 
 /////////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
-namespace mesh   { class Field; class Mesh; class WriteMesh; }
+namespace common { class Group; }
+namespace mesh   { class Field; class Mesh; class MeshWriter; class WriteMesh; }
 namespace solver {
 namespace actions {
 
+/// Writes the mesh with all its fields every "saverate" iterations.
+///
+/// In asynchronous mode the fields, including the coordinates, are copied into snapshot fields,
+/// and the snapshot is written by a background thread while the solver continues.
+/// There are "nb_buffers" snapshots (2 gives double buffering), used in turn. When the next
+/// one is still queued for output, the solver waits for it to be written.
+/// The file path is resolved and the writer of each snapshot is configured on the solver thread,
+/// when the snapshot is taken, so the background thread only writes the data.
+/// The snapshot fields are children of this action, not of the mesh, so the mesh is left
+/// untouched while a snapshot is written. The connectivity is not copied, so wait_for_output()
+/// must be called before the topology of the mesh is changed or the mesh is removed.
+/// The properties "io_time", "stall_time" and "hidden_io_time" report the time spent
+/// writing in the background, the time the solver waited for output, and their difference.
 class solver_actions_API PeriodicWriteMesh : public solver::Action {
 
 public: // functions
@@ -24,8 +48,8 @@ public: // functions
   /// @param name of the component
   PeriodicWriteMesh ( const std::string& name );
 
-  /// Virtual destructor
-  virtual ~PeriodicWriteMesh() {}
+  /// Virtual destructor, finishes the queued output
+  virtual ~PeriodicWriteMesh();
 
   /// Get the class name
   static std::string type_name () { return "PeriodicWriteMesh"; }
@@ -33,12 +57,57 @@ public: // functions
   /// execute the action
   virtual void execute ();
 
+  /// Block until all queued snapshots are written
+  void wait_for_output();
+
+private: // functions
+
+  /// Fields to write
+  std::vector< Handle<mesh::Field> > fields_to_write();
+
+  /// Create "nb_buffers" empty snapshots, when no output is queued
+  void allocate_snapshots(const Uint nb_buffers);
+
+  /// Copy the fields into the next snapshot, configure its writer and queue it for the background thread
+  void write_asynchronous(const std::vector< Handle<mesh::Field> >& fields, const common::URI& filepath);
+
+  /// Body of the background thread
+  void output_loop();
+
+  /// Copy the timings of the background output to the properties
+  void update_timing_properties();
+
 private: // data
 
   Handle<Component> m_iterator;  ///< component that holds the iteration
 
   mesh::WriteMesh& m_writer; ///< mesh writer
 
+  /// Copy of the fields at one iteration
+  struct Snapshot
+  {
+    Snapshot() : busy(false) {}
+    Handle<common::Group> fields;  ///< copies of the fields, grouped per dictionary
+    Handle<mesh::MeshWriter> writer; ///< writer configured for the copies, only its output runs in the background
+    bool busy;                   ///< queued or being written
+  };
+
+  /// Snapshots, only reallocated when no output is queued
+  std::vector< boost::shared_ptr<Snapshot> > m_snapshots;
+  std::deque<Uint> m_queue;      ///< indices of the snapshots waiting for output
+  Handle<common::Group> m_snapshot_fields; ///< parent of the snapshot fields
+
+  boost::scoped_ptr<boost::thread> m_thread;
+  boost::mutex m_mutex;
+  boost::condition_variable m_condition;
+  bool m_stop;
+  std::string m_error;           ///< error of the background thread, rethrown by the solver thread
+
+  Real m_io_time;                ///< time spent writing snapshots
+  Real m_stall_time;             ///< time the solver waited for a free snapshot or the end of output
+  Real m_snapshot_time;          ///< time spent copying fields into snapshots and configuring their writers
+  Uint m_nb_writes;
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,7 @@
 #include <boost/mpl/assert.hpp>
 #include <boost/proto/core.hpp>
 #include <boost/proto/traits.hpp>
+#include <boost/thread/locks.hpp>
 
 
 #include "math/MatrixTypes.hpp"
@@ -125,6 +126,9 @@ struct BlockAssignmentOp<SystemMatrixTag, OpTagT>
         block_accumulator.mat(block_row, block_col) = rhs(row, col);
       }
     }
+    boost::unique_lock<boost::mutex> lock(lss.fill_mutex(), boost::defer_lock);
+    if(lss.needs_fill_lock(data.threaded_fill))
+      lock.lock();
     do_assign_op_matrix(OpTagT(), lss.matrix(), block_accumulator);
   }
 };
@@ -135,6 +139,9 @@ struct BlockAssignmentOp<SystemRHSTag, OpTagT>
   template<typename LSST, typename RhsT, typename DataT>
   void operator()(LSST& lss, const RhsT& rhs, const DataT& data) const
   {
+    if(lss.is_applying_operator())
+      return;
+
     // TODO: We take some shortcuts here that assume the same shape function for every variable. Storage order for the system is i.e. uvp, uvp, ...
     static const Uint mat_size = DataT::EMatrixSizeT::value;
     static const Uint nb_dofs = mat_size / DataT::SupportT::EtypeT::nb_nodes;
@@ -146,6 +153,9 @@ struct BlockAssignmentOp<SystemRHSTag, OpTagT>
       block_accumulator.rhs[block_idx] = rhs[i];
     }
 
+    boost::unique_lock<boost::mutex> lock(lss.fill_mutex(), boost::defer_lock);
+    if(lss.needs_fill_lock(data.threaded_fill))
+      lock.lock();
     do_assign_op_rhs(OpTagT(), lss.rhs(), block_accumulator);
   }
 };
@@ -195,6 +205,9 @@ boost::proto::transform< RHSAccumulator >
     template<typename LSST, typename RhsT>
     void assign_single_variable(LSST& lss_term, const RhsT& rhs, typename impl::data_param data, const Uint var_offset) const
     {
+      if(lss_term.is_applying_operator())
+        return;
+
       math::LSS::System& lss = lss_term.lss();
       // TODO: We take some shortcuts here that assume the same shape function for every variable. Storage order for the system is i.e. uvp, uvp, ...
       static const Uint mat_size = boost::remove_reference<DataT>::type::EMatrixSizeT::value;
@@ -219,6 +232,9 @@ boost::proto::transform< RHSAccumulator >
         const Uint block_idx = (i % SupportT::EtypeT::nb_nodes)*nb_dofs + i / SupportT::EtypeT::nb_nodes;
         block_accumulator.rhs[block_idx] = 0.;
       }
+      boost::unique_lock<boost::mutex> lock(lss_term.fill_mutex(), boost::defer_lock);
+      if(lss_term.needs_fill_lock(data.threaded_fill))
+        lock.lock();
       do_assign_op_rhs(boost::proto::tag::plus_assign(), *lss.rhs(), block_accumulator);
     }
 
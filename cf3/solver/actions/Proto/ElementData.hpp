@@ -813,6 +813,7 @@ public:
   typedef boost::fusion::filter_view< VariablesDataT, IsEquationData > EquationDataT;
 
   ElementData(VariablesT& variables, mesh::Elements& elements) :
+    threaded_fill(false),
     m_variables(variables),
     m_elements(elements),
     m_support(elements),
@@ -952,6 +953,9 @@ public:
   /// Stores a mutable block accululator, always up-to-date with index mapping and correct size
   mutable math::LSS::BlockAccumulator block_accumulator;
 
+  /// True if other threads of a coloured element loop fill the same system concurrently
+  bool threaded_fill;
+
 private:
   /// Variables used in the expression
   VariablesT& m_variables;
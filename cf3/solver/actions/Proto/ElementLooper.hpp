@@ -16,12 +16,22 @@
 #include <boost/mpl/for_each.hpp>
 #include <boost/mpl/filter_view.hpp>
 
+#include <boost/bind.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+
 #include "ElementData.hpp"
 #include "ElementExpressionWrapper.hpp"
 #include "ElementGrammar.hpp"
 
 #include "mesh/Mesh.hpp"
 #include "mesh/Space.hpp"
+#include "mesh/actions/ColourElements.hpp"
+#include "mesh/actions/ElementColouring.hpp"
 #include "mesh/ElementTypePredicates.hpp"
 
 namespace cf3 {
@@ -60,7 +70,7 @@ struct CheckSameEtype
 template<typename ElementTypesT, typename ExprT, typename SupportETYPE, typename VariablesT, typename VariablesEtypesT, typename NbVarsT, typename VarIdxT>
 struct ExpressionRunner
 {
-  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems) : variables(vars), expression(expr), elements(elems), m_nb_tests(0), m_found(false) {}
+  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems, const Uint nb_thr = 1) : variables(vars), expression(expr), elements(elems), nb_threads(nb_thr), m_nb_tests(0), m_found(false) {}
 
   typedef typename boost::remove_reference<typename boost::fusion::result_of::at<VariablesT, VarIdxT>::type>::type VarT;
 
@@ -89,7 +99,7 @@ struct ExpressionRunner
       NewVariablesEtypesT,
       NbVarsT,
       NextIdxT
-    >(variables, expression, elements).run();
+    >(variables, expression, elements, nb_threads).run();
   }
 
   // Chosen otherwise
@@ -141,12 +151,13 @@ struct ExpressionRunner
       NewVariablesEtypesT,
       NbVarsT,
       NextIdxT
-    >(variables, expression, elements).run();
+    >(variables, expression, elements, nb_threads).run();
   }
 
   VariablesT& variables;
   const ExprT& expression;
   mesh::Elements& elements;
+  const Uint nb_threads;
   // Number of times we tried a shape function
   mutable Uint m_nb_tests;
   mutable bool m_found;
@@ -165,6 +176,34 @@ struct ElementLooperImpl
     run(WrapExpression()(expr, mapped_coords, data), data, nb_elems);
   }
 
+  /// Threaded execution, using one thread for each entry in thread_data.
+  /// Colours are processed one after the other, and the elements of a colour are split evenly over the threads.
+  /// Since elements of the same colour share no node, the threads never write to the same field entry or matrix row.
+  /// The scatter into the system matrix and RHS is only serialized for LSS backends that can't fill disjoint rows
+  /// concurrently, see LSSWrapperImpl::needs_fill_lock().
+  template<typename ExprT>
+  void operator()(const ExprT& expr, boost::ptr_vector<DataT>& thread_data, const mesh::actions::ElementColouring& colouring) const
+  {
+    const Uint nb_threads = thread_data.size();
+    boost::barrier colour_barrier(nb_threads);
+    std::vector<std::string> errors(nb_threads);
+
+    boost::thread_group threads;
+    for(Uint thread_idx = 1; thread_idx < nb_threads; ++thread_idx)
+    {
+      threads.create_thread(boost::bind(&ElementLooperImpl::template run_thread<ExprT>, this, boost::cref(expr), boost::ref(thread_data[thread_idx]), boost::cref(colouring), thread_idx, nb_threads, boost::ref(colour_barrier), boost::ref(errors[thread_idx])));
+    }
+    // The calling thread takes the first chunk
+    run_thread(expr, thread_data[0], colouring, 0, nb_threads, colour_barrier, errors[0]);
+    threads.join_all();
+
+    for(Uint thread_idx = 0; thread_idx != nb_threads; ++thread_idx)
+    {
+      if(!errors[thread_idx].empty())
+        throw common::ParallelError(FromHere(), "Error in element loop thread " + common::to_str(thread_idx) + ": " + errors[thread_idx]);
+    }
+  }
+
 private:
   template<typename FilteredExprT>
   void run(const FilteredExprT& expr, DataT& data, const Uint nb_elems) const
@@ -178,13 +217,81 @@ private:
       grammar(expr, elem, data);
     }
   }
+
+  /// Work done by a single thread
+  template<typename ExprT>
+  void run_thread(const ExprT& expr, DataT& data, const mesh::actions::ElementColouring& colouring, const Uint thread_idx, const Uint nb_threads, boost::barrier& colour_barrier, std::string& error) const
+  {
+    // The wrapped expression holds temporary storage, so each thread needs its own copy
+    const typename DataT::SupportShapeFunction::MappedCoordsT mapped_coords;
+    run_colours(WrapExpression()(expr, mapped_coords, data), data, colouring, thread_idx, nb_threads, colour_barrier, error);
+  }
+
+  template<typename FilteredExprT>
+  void run_colours(const FilteredExprT& expr, DataT& data, const mesh::actions::ElementColouring& colouring, const Uint thread_idx, const Uint nb_threads, boost::barrier& colour_barrier, std::string& error) const
+  {
+    ElementGrammar grammar;
+    const Uint nb_colours = colouring.nb_colours();
+    for(Uint colour = 0; colour != nb_colours; ++colour)
+    {
+      const Uint colour_begin = colouring.colour_starts()[colour];
+      const Uint colour_size = colouring.colour_starts()[colour+1] - colour_begin;
+      const Uint chunk_begin = colour_begin + (colour_size * thread_idx) / nb_threads;
+      const Uint chunk_end = colour_begin + (colour_size * (thread_idx+1)) / nb_threads;
+
+      // Exceptions are caught here, so a failing thread keeps taking part in the barriers and the others can't deadlock
+      if(error.empty())
+      {
+        try
+        {
+          for(Uint i = chunk_begin; i != chunk_end; ++i)
+          {
+            const Uint elem = colouring.elements()[i];
+            data.set_element(elem);
+            grammar(expr, elem, data);
+          }
+        }
+        catch(std::exception& e)
+        {
+          error = e.what();
+        }
+      }
+
+      colour_barrier.wait();
+    }
+  }
 };
 
+/// Run the expression over the elements, using the given number of threads.
+/// With more than one thread, a copy of the element data is made for each thread, independent of the number of elements,
+/// so the collective operations done when destroying the element data match on all ranks.
+template<typename DataT, typename VariablesT, typename ExprT>
+void run_element_loop(VariablesT& variables, mesh::Elements& elements, const ExprT& expr, const Uint nb_threads)
+{
+  if(nb_threads < 2)
+  {
+    DataT data(variables, elements);
+    ElementLooperImpl<DataT>()(expr, data, elements.size());
+    return;
+  }
+
+  const mesh::actions::ElementColouring& colouring = mesh::actions::ColourElements::colouring(elements.geometry_space());
+
+  boost::ptr_vector<DataT> thread_data;
+  for(Uint i = 0; i != nb_threads; ++i)
+  {
+    thread_data.push_back(new DataT(variables, elements));
+    thread_data.back().threaded_fill = true;
+  }
+
+  ElementLooperImpl<DataT>()(expr, thread_data, colouring);
+}
+
 /// When we recursed to the last variable, actually run the expression
 template<typename ElementTypesT, typename ExprT, typename SupportETYPE, typename VariablesT, typename VariablesEtypesT, typename NbVarsT>
 struct ExpressionRunner<ElementTypesT, ExprT, SupportETYPE, VariablesT, VariablesEtypesT, NbVarsT, NbVarsT>
 {
-  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems) : variables(vars), expression(expr), elements(elems) {}
+  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems, const Uint nb_thr = 1) : variables(vars), expression(expr), elements(elems), nb_threads(nb_thr) {}
 
   typedef ElementData<VariablesT, VariablesEtypesT, SupportETYPE, typename EquationVariables<ExprT, NbVarsT>::type> DataT;
 
@@ -196,15 +303,14 @@ struct ExpressionRunner<ElementTypesT, ExprT, SupportETYPE, VariablesT, Variable
       INVALID_ELEMENT_EXPRESSION,
       (ElementGrammar));
 
-    DataT data(variables, elements);
-
-    ElementLooperImpl<DataT>()(expression, data, elements.size());
+    run_element_loop<DataT>(variables, elements, expression, nb_threads);
   }
 
 private:
   VariablesT& variables;
   const ExprT& expression;
   mesh::Elements& elements;
+  const Uint nb_threads;
 };
 
 /// mpl::for_each compatible functor to loop over elements, using the correct shape function for the geometry
@@ -215,10 +321,13 @@ struct ElementLooper
   // Type of a fusion vector that can contain a copy of each variable that is used in the expression
   typedef typename ExpressionProperties<ExprT>::VariablesT VariablesT;
 
-  ElementLooper(mesh::Elements& elements, const ExprT& expr, VariablesT& variables) :
+  /// @param nb_threads Number of threads to use. With more than one thread, the expression must not accumulate in shared
+  /// variables (i.e. terminals other than fields, element matrices and linear systems), since these writes are not protected.
+  ElementLooper(mesh::Elements& elements, const ExprT& expr, VariablesT& variables, const Uint nb_threads = 1) :
     m_elements(elements),
     m_expr(expr),
-    m_variables(variables)
+    m_variables(variables),
+    m_nb_threads(nb_threads)
   {
   }
 
@@ -252,9 +361,7 @@ struct ElementLooper
     // Verify the types match, and throw an error if non-matching fields are found
     boost::fusion::for_each(m_variables, CheckSameEtype<ETYPE>(m_elements));
 
-    DataT data(m_variables, m_elements);
-
-    ElementLooperImpl<DataT>()(m_expr, data, m_elements.size());
+    run_element_loop<DataT>(m_variables, m_elements, m_expr, m_nb_threads);
   }
 
   /// Static dispatch in case different ETYPE are possible
@@ -275,17 +382,19 @@ struct ElementLooper
       boost::mpl::vector0<>, // Start with an empty vector for the per-variable element types
       NbVarsT, // number of variables
       boost::mpl::int_<0> // Start index, as MPL integral constant
-    >(m_variables, m_expr, m_elements).run();
+    >(m_variables, m_expr, m_elements, m_nb_threads).run();
   }
 
 private:
   mesh::Elements& m_elements;
   const ExprT& m_expr;
   VariablesT& m_variables;
+  const Uint m_nb_threads;
 };
 
+/// Evaluate the expression for each element under root_region, using nb_threads threads per Elements
 template<typename ElementTypesT, typename ExprT>
-void for_each_element(mesh::Region& root_region, const ExprT& expr)
+void for_each_element(mesh::Region& root_region, const ExprT& expr, const Uint nb_threads = 1)
 {
   // Store the variables
   typedef typename ExpressionProperties<ExprT>::VariablesT VariablesT;
@@ -297,7 +406,7 @@ void for_each_element(mesh::Region& root_region, const ExprT& expr)
   BOOST_FOREACH(mesh::Elements& elements, common::find_components_recursively<mesh::Elements>(root_region))
   {
     // We skip order 0 functions in the top-call, because first the support shape function is determined, and order 0 is not allowed there
-    boost::mpl::for_each< boost::mpl::filter_view< ElementTypesT, mesh::IsMinimalOrder<1> > >( ElementLooper<ElementTypesT, ExprT>(elements, expr, vars) );
+    boost::mpl::for_each< boost::mpl::filter_view< ElementTypesT, mesh::IsMinimalOrder<1> > >( ElementLooper<ElementTypesT, ExprT>(elements, expr, vars, nb_threads) );
   }
 };
 
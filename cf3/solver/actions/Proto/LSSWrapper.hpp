@@ -9,12 +9,16 @@
 #define cf3_solver_actions_Proto_LSSWrapper_hpp
 
 #include <boost/proto/core.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "common/List.hpp"
 #include "common/Log.hpp"
 #include "common/OptionComponent.hpp"
 
 #include "math/LSS/System.hpp"
+#include "math/LSS/BlockCrs/BlockCrsVector.hpp"
+#include "math/LSS/BlockCrs/MatrixFreeMatrix.hpp"
 #include "mesh/Tags.hpp"
 
 /// @file
@@ -39,14 +43,16 @@ public:
   /// Construction using references to the actual component (mainly useful in utests or other non-dynamic code)
   /// Using this constructor does not use dynamic configuration through options
   LSSWrapperImpl(math::LSS::System& component) :
-    m_component( new Handle<math::LSS::System>(component.handle<math::LSS::System>()) )
+    m_component( new Handle<math::LSS::System>(component.handle<math::LSS::System>()) ),
+    m_fill_mutex( new boost::mutex() )
   {
     trigger_component();
   }
 
   /// Construction using an option that will point to the actual component.
   LSSWrapperImpl(common::Option& component_option) :
-    m_component( new Handle<math::LSS::System>() )
+    m_component( new Handle<math::LSS::System>() ),
+    m_fill_mutex( new boost::mutex() )
   {
     component_option.link_to(m_component.get()).attach_trigger(boost::bind(&LSSWrapperImpl::trigger_component, this));
     trigger_component();
@@ -79,6 +85,13 @@ public:
     return *m_solution;
   }
   
+  /// True if the matrix is matrix-free and the assembly is executed to compute a matrix-vector product,
+  /// in which case the RHS must be left alone
+  bool is_applying_operator() const
+  {
+    return is_not_null(m_matrix_free) && m_matrix_free->is_applying();
+  }
+
   /// Convert the given indices, using the given mapping
   template<typename VectorT>
   void convert_to_lss(VectorT& indices)
@@ -91,6 +104,20 @@ public:
       indices[i] = (*m_used_node_map)[indices[i]];
   }
   
+  /// Mutex to hold while adding to or setting values in the matrix or RHS, if needs_fill_lock is true
+  boost::mutex& fill_mutex()
+  {
+    return *m_fill_mutex;
+  }
+
+  /// True if the fill must be serialized. Threads of a coloured element loop fill disjoint rows, which the BlockCrs
+  /// backend supports concurrently. The other backends keep scratch buffers and internal submit state, so they need the lock.
+  /// @param threaded_fill True if other threads fill the system at the same time
+  bool needs_fill_lock(const bool threaded_fill) const
+  {
+    return threaded_fill && !m_disjoint_rows_fill;
+  }
+
   Uint node_to_lss(const Uint node)
   {
     if(is_null(m_used_node_map))
@@ -107,7 +134,14 @@ private:
   math::LSS::Matrix* m_matrix;
   math::LSS::Vector* m_rhs;
   math::LSS::Vector* m_solution;
+  /// Set if m_matrix is a MatrixFreeMatrix
+  math::LSS::MatrixFreeMatrix* m_matrix_free;
   
+  /// Shared between copies, like m_component
+  boost::shared_ptr<boost::mutex> m_fill_mutex;
+  /// Set if the matrix and RHS can be filled concurrently for disjoint rows
+  bool m_disjoint_rows_fill;
+
   // Used in case there is no 1-to-1 mapping between the mesh nodes and the LSS indices
   common::List<Uint>* m_used_nodes;
   common::List<Uint>* m_used_node_map;
@@ -120,6 +154,8 @@ private:
       m_matrix = m_cached_component->matrix().get();
       m_rhs = m_cached_component->rhs().get();
       m_solution = m_cached_component->solution().get();
+      m_matrix_free = dynamic_cast<math::LSS::MatrixFreeMatrix*>(m_matrix);
+      m_disjoint_rows_fill = is_not_null(dynamic_cast<math::LSS::BlockCrsMatrix*>(m_matrix)) && is_not_null(dynamic_cast<math::LSS::BlockCrsVector*>(m_rhs));
       
       m_used_nodes = Handle< common::List<Uint> >(m_cached_component->get_child(mesh::Tags::nodes_used())).get();
       m_used_node_map = Handle< common::List<Uint> >(m_cached_component->get_child("used_node_map")).get();
@@ -129,6 +165,8 @@ private:
       m_matrix = nullptr;
       m_rhs = nullptr;
       m_solution = nullptr;
+      m_matrix_free = nullptr;
+      m_disjoint_rows_fill = false;
       m_used_node_map = nullptr;
       m_used_nodes = nullptr;
     }
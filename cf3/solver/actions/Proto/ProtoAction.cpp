@@ -59,6 +59,12 @@ struct ProtoAction::Implementation
     }
   }
 
+  void trigger_nb_threads()
+  {
+    if(m_expression)
+      m_expression->set_nb_threads(m_component.options().option("nb_threads").value<Uint>());
+  }
+
   boost::shared_ptr< Expression > m_expression;
   Component& m_component;
 
@@ -107,6 +113,10 @@ ProtoAction::ProtoAction(const std::string& name) :
   Action(name),
   m_implementation(new Implementation(*this, m_physical_model))
 {
+  options().add("nb_threads", 1u)
+    .pretty_name("Number of Threads")
+    .description("Number of threads to use for element loops. Elements are coloured so that threads never write to the same node.")
+    .attach_trigger(boost::bind(&Implementation::trigger_nb_threads, m_implementation.get()));
 }
 
 ProtoAction::~ProtoAction()
@@ -132,6 +142,7 @@ void ProtoAction::set_expression(const boost::shared_ptr< Expression >& expressi
   m_implementation->m_expression = expression;
   expression->add_options(options());
   m_implementation->trigger_physical_model();
+  m_implementation->trigger_nb_threads();
 }
 
 void ProtoAction::insert_field_info(std::map<std::string, std::string>& tags) const
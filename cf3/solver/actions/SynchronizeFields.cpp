@@ -64,12 +64,8 @@ void SynchronizeFields::config_fields()
 
 void SynchronizeFields::execute()
 {
-  boost_foreach(Handle<Field> ptr, m_fields)
-  {
-    if( is_null(ptr) ) continue; // skip if pointer invalid
-
-    ptr->synchronize();
-  }
+  // invalid pointers are skipped, fields sharing a comm pattern are exchanged together
+  synchronize_fields(m_fields);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
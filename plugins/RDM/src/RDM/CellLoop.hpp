@@ -50,6 +50,7 @@ CFinfo << "TERMT CREATION: " <<  uri().path() << " TYPE (name too): " << TermT::
       term->configure_option_recursively( Tags::solution(),   parent()->handle<CellTerm>()->solution()   );
       term->configure_option_recursively( Tags::residual(),   parent()->handle<CellTerm>()->residual()   );
       term->configure_option_recursively( Tags::wave_speed(), parent()->handle<CellTerm>()->wave_speed() );
+      term->options().set( "cache_geometry", parent()->handle<CellTerm>()->cache_geometry() );
     }
 
     return *term;
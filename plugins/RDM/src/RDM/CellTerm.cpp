@@ -4,9 +4,13 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <boost/bind.hpp>
+
 /// @todo remove this include
 #include "common/Log.hpp"
 
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
 #include "common/Link.hpp"
 #include "common/Signal.hpp"
 #include "common/OptionComponent.hpp"
@@ -29,7 +33,8 @@ namespace RDM {
 /////////////////////////////////////////////////////////////////////////////////////
 
 CellTerm::CellTerm ( const std::string& name ) :
-  cf3::solver::Action(name)
+  cf3::solver::Action(name),
+  m_cache_geometry(false)
 {
   mark_basic();
 
@@ -44,6 +49,14 @@ CellTerm::CellTerm ( const std::string& name ) :
   options().add(RDM::Tags::residual(), m_residual)
       .pretty_name("Residual Field")
       .link_to(&m_residual);
+
+  options().add("cache_geometry", m_cache_geometry)
+      .pretty_name("Cache Geometry")
+      .description("Compute the jacobians and shape function gradients of the elements once, "
+                   "instead of in every iteration. Only valid if the mesh does not move, "
+                   "the cache is rebuilt when the mesh changes.")
+      .link_to(&m_cache_geometry)
+      .attach_trigger ( boost::bind ( &CellTerm::config_cache_geometry, this ) );
 }
 
 CellTerm::~CellTerm() {}
@@ -69,6 +82,16 @@ void CellTerm::link_fields()
   }
 }
 
+void CellTerm::config_cache_geometry()
+{
+  // the terms already created by the element loop
+  boost_foreach( Component& term, find_components(*this) )
+  {
+    if( term.options().check("cache_geometry") )
+      term.options().set("cache_geometry", m_cache_geometry);
+  }
+}
+
 ElementLoop& CellTerm::access_element_loop( const std::string& type_name )
 {
   // ensure that the fields are present
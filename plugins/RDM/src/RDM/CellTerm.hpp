@@ -52,12 +52,17 @@ public: // functions
 
   Handle<mesh::Field> wave_speed()  { return m_wave_speed; }
 
+  bool cache_geometry() const       { return m_cache_geometry; }
+
   //@} END ACCESSORS
 
 protected: // function
 
   void link_fields();
 
+  /// passes the cache_geometry option to the terms that were already created
+  void config_cache_geometry();
+
 protected: // data
 
   Handle<mesh::Field> m_solution;     ///< access to the solution field
@@ -66,6 +71,8 @@ protected: // data
 
   Handle<mesh::Field> m_wave_speed;   ///< access to the wave_speed field
 
+  bool m_cache_geometry;              ///< passed to the terms
+
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -16,6 +16,7 @@
 #include "math/Checks.hpp"
 
 #include "mesh/Field.hpp"
+#include "mesh/FieldExpression.hpp"
 #include "mesh/Mesh.hpp"
 
 #include "RDM/RDSolver.hpp"
@@ -56,6 +57,10 @@ RK::RK ( const std::string& name ) :
       .pretty_name("RK Order")
       .description("Order of the Runge-Kutta step");
 
+  options().add( "nb_threads", 1u )
+      .pretty_name("Number of Threads")
+      .description("Number of threads used for the solution update");
+
 }
 
 void RK::execute()
@@ -97,11 +102,7 @@ void RK::execute()
 
   // implementation of the RungeKutta update step
 
-  const Uint nbdofs = solution_k.size();
-  const Uint nbvars = solution_k.row_size();
-  for ( Uint i=0; i< nbdofs; ++i )
-    for ( Uint j=0; j< nbvars; ++j )
-      solution_k[i][j] += - residual[i][j] / dual_area[i][0];
+  field_expression::assign( solution_k, solution_k - residual / dual_area, options().value<Uint>("nb_threads") );
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
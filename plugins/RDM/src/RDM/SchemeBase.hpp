@@ -8,6 +8,8 @@
 #define cf3_RDM_SchemeBase_hpp
 
 #include <functional>
+#include <map>
+#include <vector>
 
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
@@ -20,6 +22,7 @@
 #include "common/Log.hpp"
 
 #include "common/Core.hpp"
+#include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionComponent.hpp"
 #include "common/BasicExceptions.hpp"
@@ -32,6 +35,7 @@
 #include "mesh/ElementType.hpp"
 #include "mesh/Connectivity.hpp"
 #include "mesh/Space.hpp"
+#include "mesh/Tags.hpp"
 
 #include "physics/PhysModel.hpp"
 
@@ -70,6 +74,8 @@ public: // functions
   static std::string type_name () { return "SchemeBase<" + SF::type_name() + ">"; }
 
   /// interpolates the shape functions and gradient values
+  /// If the option cache_geometry is set, the geometric quantities (X_q, jacob, wj and dNdX)
+  /// are computed once for all elements of the current Elements and copied from the cache
   /// @post zeros the local residual matrix
   void interpolate ( const common::Table<Uint>::ConstRow& nodes_idx );
 
@@ -118,6 +124,16 @@ protected: // helper functions
     CFinfo << "PPPPPPPPPPPPPP5: " << wave_speed->uri().path() << CFendl;
   }
 
+  /// The cached geometry is no longer valid when the mesh changes
+  void on_mesh_changed_event( common::SignalArgs& args ) { m_geometry_cache.clear(); }
+
+  /// computes X_q, jacob, wj and dNdX from the node coordinates in X_n
+  void compute_geometry();
+
+  /// @return the cached geometry of the current element, computing it for all
+  ///         elements of the current Elements on first access
+  const Real* cached_geometry();
+
 protected: // typedefs
 
   typedef typename SF::NodesT                                               NodeMT;
@@ -216,6 +232,14 @@ protected:
   /// Inverse of the Jacobi matrix at each quadrature point
   JMT JMinv;
 
+  /// number of Reals stored per element in the geometry cache: X_q, jacob, wj and dNdX
+  static const Uint geometry_stride = QD::nb_points * ( PHYS::MODEL::_ndim + 2u + PHYS::MODEL::_ndim * SF::nb_nodes );
+
+  /// if true, the geometric quantities are computed once and reused in each iteration
+  bool m_cache_geometry;
+  /// geometric quantities of all elements, one array per Elements, valid until the mesh changes
+  std::map< const mesh::Entities*, std::vector<Real> > m_geometry_cache;
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -223,7 +247,8 @@ protected:
 template<typename SF, typename QD, typename PHYS>
 SchemeBase<SF,QD,PHYS>::SchemeBase ( const std::string& name ) :
   LoopOperation(name),
-  m_quadrature( QD::instance() )
+  m_quadrature( QD::instance() ),
+  m_cache_geometry( false )
 {
   regist_typeinfo(this); // template class so must force type registration @ construction
 
@@ -237,6 +262,13 @@ SchemeBase<SF,QD,PHYS>::SchemeBase ( const std::string& name ) :
   options()["elements"]
       .attach_trigger ( boost::bind ( &SchemeBase<SF,QD,PHYS>::change_elements, this ) );
 
+  options().add("cache_geometry", m_cache_geometry)
+      .pretty_name("Cache Geometry")
+      .description("Compute the jacobians and shape function gradients once, for meshes that do not move")
+      .link_to(&m_cache_geometry);
+
+  common::Core::instance().event_handler().connect_to_event( mesh::Tags::event_mesh_changed(), this, &SchemeBase<SF,QD,PHYS>::on_mesh_changed_event );
+
   // initializations
 
   for(Uint d = 0; d < PHYS::MODEL::_ndim; ++d)
@@ -293,14 +325,45 @@ void SchemeBase<SF, QD,PHYS>::interpolate( const common::Table<Uint>::ConstRow&
     for (Uint v=0; v < PHYS::MODEL::_neqs; ++v)
       U_n(n,v) = (*solution)[ nodes_idx[n] ][v];
 
-  // coordinates of quadrature points in physical space
-
-  X_q  = Ni * X_n;
-
   // solution at all quadrature points in physical space
 
   U_q = Ni * U_n;
 
+  // geometry, either from the cache or computed from the node coordinates
+
+  if( m_cache_geometry )
+  {
+    const Real* geometry = cached_geometry();
+    X_q   = QCoordMT::Map( geometry );
+    geometry += QD::nb_points * PHYS::MODEL::_ndim;
+    jacob = WeightVT::Map( geometry );
+    geometry += QD::nb_points;
+    wj    = WeightVT::Map( geometry );
+    geometry += QD::nb_points;
+    for(Uint dim = 0; dim < PHYS::MODEL::_ndim; ++dim, geometry += QD::nb_points * SF::nb_nodes)
+      dNdX[dim] = SFMatrixT::Map( geometry );
+  }
+  else
+    compute_geometry();
+
+  // solution derivatives in physical space at quadrature point
+
+  for(Uint dim = 0; dim < PHYS::MODEL::_ndim; ++dim)
+    dUdX[dim] = dNdX[dim] * U_n;
+
+  // zero element residuals
+
+  Phi_n.setZero();
+}
+
+
+template<typename SF,typename QD, typename PHYS>
+void SchemeBase<SF, QD,PHYS>::compute_geometry()
+{
+  // coordinates of quadrature points in physical space
+
+  X_q  = Ni * X_n;
+
   // Jacobian of transformation phys -> ref:
   //    |   dx/dksi    dx/deta    |
   //    |   dy/dksi    dy/deta    |
@@ -347,15 +410,40 @@ void SchemeBase<SF, QD,PHYS>::interpolate( const common::Table<Uint>::ConstRow&
 
   for(Uint q = 0; q < QD::nb_points; ++q)
     wj[q] = jacob[q] * m_quadrature.weights[q];
+}
 
-  // solution derivatives in physical space at quadrature point
 
-  for(Uint dim = 0; dim < PHYS::MODEL::_ndim; ++dim)
-    dUdX[dim] = dNdX[dim] * U_n;
+template<typename SF,typename QD, typename PHYS>
+const Real* SchemeBase<SF, QD,PHYS>::cached_geometry()
+{
+  std::vector<Real>& cache = m_geometry_cache[ &elements() ];
 
-  // zero element residuals
+  if( cache.empty() )
+  {
+    const Uint nb_elem = connectivity->size();
+    cache.resize( nb_elem * geometry_stride );
 
-  Phi_n.setZero();
+    for(Uint elem = 0; elem < nb_elem; ++elem)
+    {
+      mesh::fill(X_n, *coordinates, (*connectivity)[elem] );
+      compute_geometry();
+
+      Real* geometry = &cache[ elem * geometry_stride ];
+      QCoordMT::Map( geometry ) = X_q;
+      geometry += QD::nb_points * PHYS::MODEL::_ndim;
+      WeightVT::Map( geometry ) = jacob;
+      geometry += QD::nb_points;
+      WeightVT::Map( geometry ) = wj;
+      geometry += QD::nb_points;
+      for(Uint dim = 0; dim < PHYS::MODEL::_ndim; ++dim, geometry += QD::nb_points * SF::nb_nodes)
+        SFMatrixT::Map( geometry ) = dNdX[dim];
+    }
+
+    // restore the coordinates of the current element
+    mesh::fill(X_n, *coordinates, (*connectivity)[ idx() ] );
+  }
+
+  return &cache[ idx() * geometry_stride ];
 }
 
 
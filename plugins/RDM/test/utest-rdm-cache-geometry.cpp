@@ -0,0 +1,199 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the cached geometry of cf3::RDM::SchemeBase"
+
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Link.hpp"
+#include "common/OptionList.hpp"
+
+#include "math/Consts.hpp"
+
+#include "mesh/Domain.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshTransformer.hpp"
+
+#include "solver/Model.hpp"
+
+#include "RDM/CellTerm.hpp"
+#include "RDM/DomainDiscretization.hpp"
+#include "RDM/RDSolver.hpp"
+#include "RDM/SteadyExplicit.hpp"
+#include "RDM/Tags.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::math;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+
+/// @todo create a library for support of the utests
+/// @todo move this to a class that all utests global fixtures must inherit from
+struct CoreInit {
+
+  /// global initiate
+  CoreInit()
+  {
+    using namespace boost::unit_test::framework;
+    Core::instance().initiate( master_test_suite().argc, master_test_suite().argv);
+  }
+
+  /// global tear-down
+  ~CoreInit()
+  {
+    Core::instance().terminate();
+  }
+
+};
+
+/// Move the nodes of the mesh, keeping its boundary in place
+void distort(Mesh& mesh, const Real amplitude)
+{
+  Field& coordinates = mesh.geometry_fields().coordinates();
+  for (Uint n=0; n<coordinates.size(); ++n)
+  {
+    const Real x = coordinates[n][XX];
+    const Real y = coordinates[n][YY];
+    const Real bump = amplitude * std::sin(Consts::pi()*x/2.) * std::sin(Consts::pi()*y);
+    coordinates[n][XX] += bump;
+    coordinates[n][YY] += 0.5*bump;
+  }
+}
+
+/// Field of the solver, through the link in its fields group
+Field& solver_field(RDM::RDSolver& solver, const std::string& tag)
+{
+  return *follow_link( solver.fields().get_child(tag) )->handle<Field>();
+}
+
+/// The model created by the setup test case
+Model& model()
+{
+  return *Handle<Model>(Core::instance().root().get_child("Model"));
+}
+
+RDM::RDSolver& rd_solver()
+{
+  return *model().solver().handle<RDM::RDSolver>();
+}
+
+RDM::CellTerm& cell_term()
+{
+  return *Handle<RDM::CellTerm>(rd_solver().domain_discretization().get_child("CellTerms")->get_child("INTERNAL"));
+}
+
+/// Compute the residual of the LDA scheme once, for a smooth solution
+std::vector<Real> compute_residual(RDM::RDSolver& solver)
+{
+  Field& solution = solver_field(solver, RDM::Tags::solution());
+  for (Uint n=0; n<solution.size(); ++n)
+    solution[n][0] = std::sin(2.*solution.coordinates()[n][XX]) * std::cos(3.*solution.coordinates()[n][YY]);
+
+  Field& residual = solver_field(solver, RDM::Tags::residual());
+  residual = 0.;
+  solver_field(solver, RDM::Tags::wave_speed()) = 0.;
+
+  solver.domain_discretization().execute();
+
+  std::vector<Real> result(residual.size());
+  for (Uint n=0; n<residual.size(); ++n)
+    result[n] = residual[n][0];
+  return result;
+}
+
+/// Check that two residuals are equal, up to round-off
+void check_equal(const std::vector<Real>& cached, const std::vector<Real>& computed)
+{
+  BOOST_REQUIRE_EQUAL(cached.size(), computed.size());
+  Real max_residual = 0.;
+  for (Uint n=0; n<computed.size(); ++n)
+    max_residual = std::max(max_residual, std::abs(computed[n]));
+  BOOST_CHECK(max_residual > 1e-3);
+
+  for (Uint n=0; n<computed.size(); ++n)
+    BOOST_CHECK_SMALL(cached[n] - computed[n], 1e-12*max_residual);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_GLOBAL_FIXTURE( CoreInit )
+
+BOOST_AUTO_TEST_SUITE( cache_geometry_test_suite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( setup )
+{
+  boost::shared_ptr<RDM::SteadyExplicit> wizard = allocate_component<RDM::SteadyExplicit>("wizard");
+  Model& model = wizard->create_model("Model", "cf3.physics.Scalar.Scalar2D");
+  RDM::RDSolver& solver = *model.solver().handle<RDM::RDSolver>();
+  solver.options().set(RDM::Tags::update_vars(), std::string("LinearAdv2D"));
+
+  // Triangulated rectangle, with distorted elements so that they all have a different geometry
+  Mesh& mesh = *model.domain().create_component<Mesh>("mesh");
+  boost::shared_ptr< MeshGenerator > generate_mesh = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","meshgenerator");
+  generate_mesh->options().set("nb_cells",std::vector<Uint>(2,8));
+  std::vector<Real> lengths(2,1.);
+  lengths[XX] = 2.;
+  generate_mesh->options().set("lengths",lengths);
+  generate_mesh->options().set("mesh",mesh.uri());
+  generate_mesh->execute();
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.MeshTriangulator","triangulator")->transform(mesh);
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.LoadBalance","load_balancer")->transform(mesh);
+  distort(mesh, 0.05);
+
+  // configures the solver with the mesh
+  mesh.raise_mesh_changed();
+
+  solver.domain_discretization().create_cell_term("cf3.RDM.Schemes.LDA", "INTERNAL", std::vector<URI>(1, mesh.topology().uri()));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( same_residual )
+{
+  RDM::RDSolver& solver = rd_solver();
+  RDM::CellTerm& term = cell_term();
+
+  const std::vector<Real> computed = compute_residual(solver);
+
+  // the option is passed on to the scheme that was created by the first computation
+  term.options().set("cache_geometry", true);
+  check_equal(compute_residual(solver), computed);
+  // the second computation uses the geometry cached by the first one
+  check_equal(compute_residual(solver), computed);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( rebuilt_after_mesh_changed )
+{
+  RDM::RDSolver& solver = rd_solver();
+  RDM::CellTerm& term = cell_term();
+  Mesh& mesh = *Handle<Mesh>(model().domain().get_child("mesh"));
+
+  BOOST_CHECK(term.cache_geometry());
+  compute_residual(solver);
+
+  // without the event, the cache would still hold the geometry of the old node positions
+  distort(mesh, 0.05);
+  mesh.raise_mesh_changed();
+  const std::vector<Real> cached = compute_residual(solver);
+
+  term.options().set("cache_geometry", false);
+  check_equal(cached, compute_residual(solver));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
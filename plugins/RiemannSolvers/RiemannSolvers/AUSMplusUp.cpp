@@ -9,6 +9,7 @@
 #include "common/OptionList.hpp"
 
 #include "RiemannSolvers/AUSMplusUp.hpp"
+#include "RiemannSolvers/FaceBlockKernels.hpp"
 
 namespace cf3 {
 namespace RiemannSolvers {
@@ -33,23 +34,28 @@ AUSMplusUp::AUSMplusUp ( const std::string& name ) :
 
   options().add("Ku",m_CoeffKu)
     .description("Ku")
-    .link_to(&m_CoeffKu);
+    .link_to(&m_CoeffKu)
+    .attach_trigger( boost::bind( &AUSMplusUp::reset_face_block_kernel, this) );
 
   options().add("Kp",m_CoeffKp)
     .description("Kp")
-    .link_to(&m_CoeffKp);
+    .link_to(&m_CoeffKp)
+    .attach_trigger( boost::bind( &AUSMplusUp::reset_face_block_kernel, this) );
 
   options().add("sigma",m_Coeffsigma)
     .description("sigma")
-    .link_to(&m_Coeffsigma);
+    .link_to(&m_Coeffsigma)
+    .attach_trigger( boost::bind( &AUSMplusUp::reset_face_block_kernel, this) );
 
   options().add("machinf",m_Machinf)
     .description("machinf")
-    .link_to(&m_Machinf);
+    .link_to(&m_Machinf)
+    .attach_trigger( boost::bind( &AUSMplusUp::reset_face_block_kernel, this) );
 
   options().add("beta",m_Beta)
     .description("beta")
-    .link_to(&m_Beta);
+    .link_to(&m_Beta)
+    .attach_trigger( boost::bind( &AUSMplusUp::reset_face_block_kernel, this) );
 
 }
 
@@ -81,8 +87,8 @@ void AUSMplusUp::trigger_physical_model()
   f_right.resize(physical_model().neqs(),physical_model().ndim());
 
   eigenvalues.resize(physical_model().neqs());
-//  eigenvalues_left.resize(physical_model().neqs());
-//  eigenvalues_right.resize(physical_model().neqs());
+  eigenvalues_left.resize(physical_model().neqs());
+  eigenvalues_right.resize(physical_model().neqs());
   right_eigenvectors.resize(physical_model().neqs(),physical_model().neqs());
   left_eigenvectors.resize(physical_model().neqs(),physical_model().neqs());
   abs_jacobian.resize(physical_model().neqs(),physical_model().neqs());
@@ -239,6 +245,12 @@ void AUSMplusUp::compute_interface_flux(const RealVector& left, const RealVector
     tmp /= p_right->P * P12;
     flux += (tmp*normal);
 
+    sol_vars.flux_jacobian_eigen_values(*p_left, normal, eigenvalues_left);
+    sol_vars.flux_jacobian_eigen_values(*p_right, normal, eigenvalues_right);
+
+    eigenvalues = eigenvalues_left;
+    eigenvalues += eigenvalues_right;
+    eigenvalues *= 0.5;
 
 }
 
@@ -248,11 +260,26 @@ void AUSMplusUp::compute_interface_flux_and_wavespeeds(const RealVector& left, c
                                                       RealVector& flux, RealVector& wave_speeds)
 {
   compute_interface_flux(left,right,coords,normal,flux);
-  /// @todo compute eigenvalues
   wave_speeds = eigenvalues;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+boost::shared_ptr<FaceBlockKernel> AUSMplusUp::create_face_block_kernel()
+{
+  if (is_null(m_physical_model) || is_null(m_solution_vars))
+    return boost::shared_ptr<FaceBlockKernel>();
+
+  const std::string type = solution_vars().derived_type_name();
+  boost::shared_ptr<FaceBlockKernel> kernel;
+  if (type == "cf3.physics.NavierStokes.Cons2D")
+    kernel.reset( new AUSMplusUpKernel<NavierStokes::Cons2D>(physical_model(), m_CoeffKu, m_CoeffKp, m_Coeffsigma, m_Machinf, m_Beta) );
+  else if (type == "cf3.physics.NavierStokes.Prim2D")
+    kernel.reset( new AUSMplusUpKernel<NavierStokes::Prim2D>(physical_model(), m_CoeffKu, m_CoeffKp, m_Coeffsigma, m_Machinf, m_Beta) );
+  return kernel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // RiemannSolvers
 } // cf3
@@ -52,6 +52,10 @@ public:
 
   Real P5(Real Mach, Real alpha, char chsign);
 
+protected:
+
+  virtual boost::shared_ptr<FaceBlockKernel> create_face_block_kernel();
+
 private:
 
   void trigger_physical_model();
@@ -67,6 +71,8 @@ private:
   RealMatrix f_right;
 
   RealVector eigenvalues;
+  RealVector eigenvalues_left;
+  RealVector eigenvalues_right;
   RealMatrix left_eigenvectors;
   RealMatrix right_eigenvectors;
   RealMatrix abs_jacobian;
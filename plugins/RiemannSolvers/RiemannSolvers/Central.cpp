@@ -9,6 +9,7 @@
 #include "common/OptionComponent.hpp"
 
 #include "RiemannSolvers/Central.hpp"
+#include "RiemannSolvers/FaceBlockKernels.hpp"
 
 namespace cf3 {
 namespace RiemannSolvers {
@@ -104,5 +105,14 @@ void Central::compute_interface_flux_and_wavespeeds(const RealVector& left, cons
 
 ////////////////////////////////////////////////////////////////////////////////
 
+boost::shared_ptr<FaceBlockKernel> Central::create_face_block_kernel()
+{
+  if (is_null(m_physical_model) || is_null(m_solution_vars))
+    return boost::shared_ptr<FaceBlockKernel>();
+  return RiemannSolvers::create_face_block_kernel<CentralKernel>(physical_model(),solution_vars());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // RiemannSolvers
 } // cf3
@@ -45,6 +45,10 @@ public:
     virtual void compute_interface_flux(const RealVector& left, const RealVector& right, const RealVector& coords, const RealVector& normal,
                                         RealVector& flux);
 
+protected:
+
+    virtual boost::shared_ptr<FaceBlockKernel> create_face_block_kernel();
+
 private:
 
     void trigger_physical_model();
@@ -0,0 +1,406 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_RiemannSolvers_FaceBlockKernels_hpp
+#define cf3_RiemannSolvers_FaceBlockKernels_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/EigenAssertions.hpp"
+#include <Eigen/Dense>
+
+#include "math/MatrixTypes.hpp"
+
+#include "physics/PhysModel.hpp"
+#include "physics/Variables.hpp"
+
+#include "Physics/NavierStokes/Cons1D.hpp"
+#include "Physics/NavierStokes/Cons2D.hpp"
+#include "Physics/NavierStokes/Cons3D.hpp"
+#include "Physics/NavierStokes/Prim2D.hpp"
+#include "Physics/NavierStokes/Roe1D.hpp"
+#include "Physics/NavierStokes/Roe2D.hpp"
+#include "Physics/NavierStokes/Roe3D.hpp"
+#include "Physics/LinEuler/Cons2D.hpp"
+#include "Physics/LinEuler/Cons3D.hpp"
+
+namespace cf3 {
+namespace RiemannSolvers {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Computes the interface fluxes of a block of faces.
+/// All matrices have one row per face and one column per variable or per dimension.
+/// The kernels compute the faces one at a time with fixed-size vectors, so they save the
+/// virtual calls and the dynamic allocations of the per-face solvers, but are not vectorized
+/// across faces.
+class FaceBlockKernel
+{
+public:
+
+  virtual ~FaceBlockKernel() {}
+
+  /// Compute the faces in rows [begin,end) of the arrays
+  /// @param [in]  left, right   solution states, nb_faces x neqs
+  /// @param [in]  coords        face coordinates, nb_faces x ndim
+  /// @param [in]  normals       face normals, nb_faces x ndim
+  /// @param [out] fluxes        interface fluxes, nb_faces x neqs, sized by the caller
+  /// @param [out] wave_speeds   wave speeds, nb_faces x neqs, sized by the caller
+  virtual void compute(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                       const Uint begin, const Uint end,
+                       RealMatrix& fluxes, RealMatrix& wave_speeds) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Fixed-size storage shared by the kernels of the variables VARS.
+/// The properties are created by the physical model, so that they hold its constants.
+template < typename VARS >
+class FaceBlockKernelT : public FaceBlockKernel
+{
+public: // typedefs
+
+  typedef typename VARS::MODEL              MODEL;
+  typedef typename MODEL::Properties        PropT;
+  typedef typename MODEL::GeoV              GeoV;
+  typedef typename MODEL::SolV              SolV;
+  typedef typename MODEL::SolM              SolM;
+  typedef Eigen::Matrix<Real, MODEL::_neqs, MODEL::_neqs> JacM;
+
+public: // functions
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  FaceBlockKernelT(physics::PhysModel& model) :
+    m_left_props (model.create_properties()),
+    m_right_props(model.create_properties()),
+    m_avg_props  (model.create_properties()),
+    p_left (static_cast<PropT&>(*m_left_props)),
+    p_right(static_cast<PropT&>(*m_right_props)),
+    p_avg  (static_cast<PropT&>(*m_avg_props))
+  {
+    grads.setZero();
+  }
+
+protected: // functions
+
+  /// Copy the state of face f into the fixed-size vectors.
+  /// The rows of the column-major arrays are strided, so this is a gather of neqs values per array.
+  void load_face(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals, const Uint f)
+  {
+    sol_left  = left.row(f).transpose();
+    sol_right = right.row(f).transpose();
+    coord     = coords.row(f).transpose();
+    normal    = normals.row(f).transpose();
+  }
+
+private: // data
+
+  std::auto_ptr<physics::Properties> m_left_props;
+  std::auto_ptr<physics::Properties> m_right_props;
+  std::auto_ptr<physics::Properties> m_avg_props;
+
+protected: // data
+
+  PropT& p_left;
+  PropT& p_right;
+  PropT& p_avg;
+
+  GeoV coord;
+  GeoV normal;
+  SolM grads;
+  SolV sol_left;
+  SolV sol_right;
+  SolV f_left;
+  SolV f_right;
+  SolV eigenvalues;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Central flux, with the wave speeds of the averaged state
+template < typename VARS >
+class CentralKernel : public FaceBlockKernelT<VARS>
+{
+public:
+
+  typedef FaceBlockKernelT<VARS> B;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  CentralKernel(physics::PhysModel& model) : B(model) {}
+
+  virtual void compute(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                       const Uint begin, const Uint end,
+                       RealMatrix& fluxes, RealMatrix& wave_speeds)
+  {
+    for (Uint f=begin; f<end; ++f)
+    {
+      B::load_face(left,right,coords,normals,f);
+
+      VARS::compute_properties(B::coord, B::sol_left,  B::grads, B::p_left);
+      VARS::compute_properties(B::coord, B::sol_right, B::grads, B::p_right);
+      sol_avg.noalias() = 0.5*(B::sol_left+B::sol_right);
+      VARS::compute_properties(B::coord, sol_avg, B::grads, B::p_avg);
+      VARS::flux_jacobian_eigen_values(B::p_avg, B::normal, B::eigenvalues);
+
+      VARS::flux(B::p_left,  B::normal, B::f_left);
+      VARS::flux(B::p_right, B::normal, B::f_right);
+
+      fluxes.row(f) = 0.5*(B::f_left + B::f_right).transpose();
+      wave_speeds.row(f) = B::eigenvalues.transpose();
+    }
+  }
+
+private:
+
+  typename B::SolV sol_avg;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Lax-Friedrich flux, dissipation from the average of the left and right wave speeds
+template < typename VARS >
+class LaxFriedrichKernel : public FaceBlockKernelT<VARS>
+{
+public:
+
+  typedef FaceBlockKernelT<VARS> B;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  LaxFriedrichKernel(physics::PhysModel& model) : B(model) {}
+
+  virtual void compute(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                       const Uint begin, const Uint end,
+                       RealMatrix& fluxes, RealMatrix& wave_speeds)
+  {
+    for (Uint f=begin; f<end; ++f)
+    {
+      B::load_face(left,right,coords,normals,f);
+
+      VARS::compute_properties(B::coord, B::sol_left,  B::grads, B::p_left);
+      VARS::compute_properties(B::coord, B::sol_right, B::grads, B::p_right);
+
+      VARS::flux(B::p_left,  B::normal, B::f_left);
+      VARS::flux(B::p_right, B::normal, B::f_right);
+
+      VARS::flux_jacobian_eigen_values(B::p_left,  B::normal, eigenvalues_left);
+      VARS::flux_jacobian_eigen_values(B::p_right, B::normal, eigenvalues_right);
+
+      B::eigenvalues.noalias() = 0.5*(eigenvalues_left + eigenvalues_right);
+      abs_eigenvalues.noalias() = 0.5*(eigenvalues_left.cwiseAbs() + eigenvalues_right.cwiseAbs());
+
+      fluxes.row(f) = ( 0.5*(B::f_left + B::f_right) - abs_eigenvalues.cwiseProduct(B::sol_right - B::sol_left) ).transpose();
+      wave_speeds.row(f) = B::eigenvalues.transpose();
+    }
+  }
+
+private:
+
+  typename B::SolV eigenvalues_left;
+  typename B::SolV eigenvalues_right;
+  typename B::SolV abs_eigenvalues;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Roe flux, the Roe average is taken on the variables ROEVARS
+template < typename VARS, typename ROEVARS >
+class RoeKernel : public FaceBlockKernelT<VARS>
+{
+public:
+
+  typedef FaceBlockKernelT<VARS> B;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  RoeKernel(physics::PhysModel& model) : B(model) {}
+
+  virtual void compute(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                       const Uint begin, const Uint end,
+                       RealMatrix& fluxes, RealMatrix& wave_speeds)
+  {
+    for (Uint f=begin; f<end; ++f)
+    {
+      B::load_face(left,right,coords,normals,f);
+
+      VARS::compute_properties(B::coord, B::sol_left,  B::grads, B::p_left);
+      VARS::compute_properties(B::coord, B::sol_right, B::grads, B::p_right);
+
+      // Roe-average = standard average of the Roe-parameter vectors
+      ROEVARS::compute_variables(B::p_left,  roe_left );
+      ROEVARS::compute_variables(B::p_right, roe_right);
+      roe_avg.noalias() = 0.5*(roe_left+roe_right);
+      ROEVARS::compute_properties(B::coord, roe_avg, B::grads, B::p_avg);
+
+      // Absolute jacobian using Roe averaged properties
+      VARS::flux_jacobian_eigen_structure(B::p_avg, B::normal, right_eigenvectors, left_eigenvectors, B::eigenvalues);
+      abs_jacobian.noalias() = right_eigenvectors * B::eigenvalues.cwiseAbs().asDiagonal() * left_eigenvectors;
+
+      VARS::flux(B::p_left,  B::normal, B::f_left);
+      VARS::flux(B::p_right, B::normal, B::f_right);
+
+      // flux = central flux - upwind flux
+      upwind_flux.noalias() = abs_jacobian*(B::sol_right - B::sol_left);
+      fluxes.row(f) = 0.5*(B::f_left + B::f_right - upwind_flux).transpose();
+      wave_speeds.row(f) = B::eigenvalues.transpose();
+    }
+  }
+
+private:
+
+  typename B::SolV roe_left;
+  typename B::SolV roe_right;
+  typename B::SolV roe_avg;
+  typename B::SolV upwind_flux;
+  typename B::JacM right_eigenvectors;
+  typename B::JacM left_eigenvectors;
+  typename B::JacM abs_jacobian;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// AUSM+up flux of the 2D Navier-Stokes variables VARS, computed as in AUSMplusUp::compute_interface_flux().
+/// The wave speeds are the average of the left and right wave speeds.
+template < typename VARS >
+class AUSMplusUpKernel : public FaceBlockKernelT<VARS>
+{
+public:
+
+  typedef FaceBlockKernelT<VARS> B;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  AUSMplusUpKernel(physics::PhysModel& model, const Real Ku, const Real Kp, const Real sigma, const Real machinf, const Real beta) :
+    B(model),
+    m_Ku(Ku),
+    m_Kp(Kp),
+    m_sigma(sigma),
+    m_machinf(machinf),
+    m_beta(beta)
+  {
+    pressure.setZero();
+  }
+
+  virtual void compute(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                       const Uint begin, const Uint end,
+                       RealMatrix& fluxes, RealMatrix& wave_speeds)
+  {
+    for (Uint f=begin; f<end; ++f)
+    {
+      B::load_face(left,right,coords,normals,f);
+
+      VARS::compute_properties(B::coord, B::sol_left,  B::grads, B::p_left);
+      VARS::compute_properties(B::coord, B::sol_right, B::grads, B::p_right);
+
+      const Real un_left  = B::p_left.u *B::normal[XX] + B::p_left.v *B::normal[YY];
+      const Real un_right = B::p_right.u*B::normal[XX] + B::p_right.v*B::normal[YY];
+
+      const Real a12 = 0.5*(B::p_left.a + B::p_right.a);
+      const Real M_left  = un_left  / a12;
+      const Real M_right = un_right / a12;
+      const Real Mbar2 = (B::p_left.uuvv + B::p_right.uuvv)/(2.*a12*a12);
+
+      const Real M02 = std::min(1., std::max(Mbar2, m_machinf*m_machinf));
+      const Real fa = std::sqrt(M02)*(2.-std::sqrt(M02));
+      const Real alpha = 3./16.*(-4.+5.*fa*fa);
+
+      const Real rho12 = 0.5*(B::p_right.rho + B::p_left.rho);
+      const Real M12 = -m_Kp/fa*std::max(1.-m_sigma*Mbar2, 0.) * (B::p_right.P - B::p_left.P) / (rho12*a12*a12)
+                     + M4(M_left, 1.) + M4(M_right, -1.);
+
+      const Real P5_left  = P5(M_left,  alpha,  1.);
+      const Real P5_right = P5(M_right, alpha, -1.);
+      const Real P12 = P5_left*B::p_left.P + P5_right*B::p_right.P
+                     - m_Ku*P5_left*P5_right*(B::p_right.rho + B::p_left.rho)*(fa*a12)*(un_right - un_left);
+
+      const Real mdot12 = a12*M12*(M12 > 0 ? B::p_left.rho : B::p_right.rho);
+
+      // Convected part of the flux tensor of the upwind side
+      const typename B::PropT& p_upwind = mdot12 > 0 ? B::p_left : B::p_right;
+      VARS::flux(p_upwind, psi);
+      psi(1,XX) -= p_upwind.P;
+      psi(2,YY) -= p_upwind.P;
+      psi /= (p_upwind.rho * std::sqrt(p_upwind.uuvv));
+
+      // Same pressure term as the per-face solver
+      pressure(1,XX) = B::p_right.P / (B::p_right.P * P12);
+      pressure(2,YY) = pressure(1,XX);
+
+      fluxes.row(f) = (mdot12*(psi*B::normal) + pressure*B::normal).transpose();
+
+      VARS::flux_jacobian_eigen_values(B::p_left,  B::normal, eigenvalues_left);
+      VARS::flux_jacobian_eigen_values(B::p_right, B::normal, eigenvalues_right);
+      wave_speeds.row(f) = 0.5*(eigenvalues_left + eigenvalues_right).transpose();
+    }
+  }
+
+private:
+
+  Real M1(const Real M, const Real sign) const { return 0.5*(M + sign*std::abs(M)); }
+
+  Real M2(const Real M, const Real sign) const { return sign*0.25*(M + sign)*(M + sign); }
+
+  Real M4(const Real M, const Real sign) const
+  {
+    return std::abs(M) >= 1. ? M1(M,sign) : M2(M,sign)*(1.-sign*16.*m_beta*M2(M,-sign));
+  }
+
+  Real P5(const Real M, const Real alpha, const Real sign) const
+  {
+    return std::abs(M) >= 1. ? 1./M*M1(M,sign) : M2(M,sign)*((sign*2.-M)-sign*16.*alpha*M*M2(M,-sign));
+  }
+
+private:
+
+  Real m_Ku;
+  Real m_Kp;
+  Real m_sigma;
+  Real m_machinf;
+  Real m_beta;
+
+  typename B::SolM psi;
+  typename B::SolM pressure;
+  typename B::SolV eigenvalues_left;
+  typename B::SolV eigenvalues_right;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Create the kernel KERNEL for the Navier-Stokes and Linearized Euler conservative variables
+/// @return a null pointer if the variables have no fixed-size specialization
+template < template <typename> class KERNEL >
+boost::shared_ptr<FaceBlockKernel> create_face_block_kernel(physics::PhysModel& model, const physics::Variables& vars)
+{
+  const std::string type = vars.derived_type_name();
+  if (type == "cf3.physics.NavierStokes.Cons1D")
+    return boost::shared_ptr<FaceBlockKernel>( new KERNEL<physics::NavierStokes::Cons1D>(model) );
+  if (type == "cf3.physics.NavierStokes.Cons2D")
+    return boost::shared_ptr<FaceBlockKernel>( new KERNEL<physics::NavierStokes::Cons2D>(model) );
+  if (type == "cf3.physics.NavierStokes.Cons3D")
+    return boost::shared_ptr<FaceBlockKernel>( new KERNEL<physics::NavierStokes::Cons3D>(model) );
+  if (type == "cf3.physics.LinEuler.Cons2D")
+    return boost::shared_ptr<FaceBlockKernel>( new KERNEL<physics::LinEuler::Cons2D>(model) );
+  if (type == "cf3.physics.LinEuler.Cons3D")
+    return boost::shared_ptr<FaceBlockKernel>( new KERNEL<physics::LinEuler::Cons3D>(model) );
+  return boost::shared_ptr<FaceBlockKernel>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // RiemannSolvers
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_RiemannSolvers_FaceBlockKernels_hpp
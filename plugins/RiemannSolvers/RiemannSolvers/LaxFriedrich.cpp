@@ -8,6 +8,7 @@
 #include "common/OptionList.hpp"
 
 #include "RiemannSolvers/LaxFriedrich.hpp"
+#include "RiemannSolvers/FaceBlockKernels.hpp"
 
 
 namespace cf3 {
@@ -41,8 +42,8 @@ void LaxFriedrich::trigger_physical_model()
   p_right = physical_model().create_properties();
   p_avg   = physical_model().create_properties();
 
-  f_left.resize(physical_model().neqs(),physical_model().ndim());
-  f_right.resize(physical_model().neqs(),physical_model().ndim());
+  f_left.resize(physical_model().neqs());
+  f_right.resize(physical_model().neqs());
 
   eigenvalues.resize(physical_model().neqs());
   eigenvalues_left.resize(physical_model().neqs());
@@ -81,9 +82,9 @@ void LaxFriedrich::compute_interface_flux(const RealVector& left, const RealVect
   sol_vars.compute_properties(coord,left,grads,*p_left);
   sol_vars.compute_properties(coord,right,grads,*p_right);
 
-  // Compute left and right fluxes
-  sol_vars.flux(*p_left , f_left);
-  sol_vars.flux(*p_right, f_right);
+  // Compute left and right fluxes, projected on the normal
+  sol_vars.flux(*p_left , normal, f_left);
+  sol_vars.flux(*p_right, normal, f_right);
 
   // Compute flux at interface
   sol_vars.flux_jacobian_eigen_values(*p_left, normal, eigenvalues_left);
@@ -93,11 +94,7 @@ void LaxFriedrich::compute_interface_flux(const RealVector& left, const RealVect
   eigenvalues += eigenvalues_right;
   eigenvalues *= 0.5;
 
-  RealMatrix absA = eigenvalues_left.cwiseAbs().asDiagonal();
-  absA += eigenvalues_right.cwiseAbs().asDiagonal();
-  absA *= 0.5;
-
-  flux = 0.5*(f_left + f_right)-absA*(right-left);
+  flux = 0.5*(f_left + f_right) - 0.5*(eigenvalues_left.cwiseAbs() + eigenvalues_right.cwiseAbs()).cwiseProduct(right-left);
 
 }
 
@@ -112,5 +109,14 @@ void LaxFriedrich::compute_interface_flux_and_wavespeeds(const RealVector& left,
 
 ////////////////////////////////////////////////////////////////////////////////
 
+boost::shared_ptr<FaceBlockKernel> LaxFriedrich::create_face_block_kernel()
+{
+  if (is_null(m_physical_model) || is_null(m_solution_vars))
+    return boost::shared_ptr<FaceBlockKernel>();
+  return RiemannSolvers::create_face_block_kernel<LaxFriedrichKernel>(physical_model(),solution_vars());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // RiemannSolvers
 } // cf3
@@ -45,6 +45,10 @@ public:
   virtual void compute_interface_flux(const RealVector& left, const RealVector& right, const RealVector& coords, const RealVector& normal,
                                       RealVector& flux);
 
+protected:
+
+  virtual boost::shared_ptr<FaceBlockKernel> create_face_block_kernel();
+
 private:
 
   void trigger_physical_model();
@@ -56,8 +60,8 @@ private:
   std::auto_ptr<physics::Properties> p_avg;
   RealVector coord;
   RealMatrix grads;
-  RealMatrix f_left;
-  RealMatrix f_right;
+  RealVector f_left;
+  RealVector f_right;
   RealVector eigenvalues;
   RealVector eigenvalues_left;
   RealVector eigenvalues_right;
@@ -4,12 +4,15 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <boost/bind.hpp>
+
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
 
 #include "physics/Variables.hpp"
 
 #include "RiemannSolvers/RiemannSolver.hpp"
+#include "RiemannSolvers/FaceBlockKernels.hpp"
 
 namespace cf3 {
 namespace RiemannSolvers {
@@ -19,7 +22,8 @@ using namespace common;
 ////////////////////////////////////////////////////////////////////////////////
 
 RiemannSolver::RiemannSolver ( const std::string& name  )
-: Component(name)
+: Component(name),
+  m_face_block_kernel_created(false)
 {
   properties()["brief"] = std::string("Riemann Solver");
   properties()["description"] = std::string("Solves the Riemann problem");
@@ -32,7 +36,10 @@ RiemannSolver::RiemannSolver ( const std::string& name  )
   options().add("solution_vars",m_solution_vars)
       .description("The component describing the solution")
       .pretty_name("Solution Variables")
-      .link_to(&m_solution_vars);
+      .link_to(&m_solution_vars)
+      .attach_trigger( boost::bind( &RiemannSolver::reset_face_block_kernel, this) );
+
+  options().option("physical_model").attach_trigger( boost::bind( &RiemannSolver::reset_face_block_kernel, this) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,5 +50,82 @@ RiemannSolver::~RiemannSolver()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+boost::shared_ptr<FaceBlockKernel> RiemannSolver::create_face_block_kernel()
+{
+  return boost::shared_ptr<FaceBlockKernel>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RiemannSolver::reset_face_block_kernel()
+{
+  m_face_block_kernel.reset();
+  m_face_block_kernel_created = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RiemannSolver::compute_interface_fluxes_and_wavespeeds(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                                            const Uint begin, const Uint end,
+                                                            RealMatrix& fluxes, RealMatrix& wave_speeds)
+{
+  cf3_assert(begin <= end && end <= left.rows());
+  if (fluxes.rows() != left.rows() || fluxes.cols() != left.cols())
+    fluxes.resize(left.rows(), left.cols());
+  if (wave_speeds.rows() != left.rows() || wave_speeds.cols() != left.cols())
+    wave_speeds.resize(left.rows(), left.cols());
+
+  if (m_face_block_kernel_created == false)
+  {
+    m_face_block_kernel = create_face_block_kernel();
+    m_face_block_kernel_created = true;
+  }
+
+  if (m_face_block_kernel)
+  {
+    m_face_block_kernel->compute(left,right,coords,normals,begin,end,fluxes,wave_speeds);
+    return;
+  }
+
+  // No fixed-size kernel, compute the faces one by one
+  for (Uint f=begin; f<end; ++f)
+  {
+    m_face_left   = left.row(f).transpose();
+    m_face_right  = right.row(f).transpose();
+    m_face_coords = coords.row(f).transpose();
+    m_face_normal = normals.row(f).transpose();
+    compute_interface_flux_and_wavespeeds(m_face_left,m_face_right,m_face_coords,m_face_normal,m_face_flux,m_face_wave_speeds);
+    fluxes.row(f) = m_face_flux.transpose();
+    wave_speeds.row(f) = m_face_wave_speeds.transpose();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RiemannSolver::compute_interface_fluxes_and_wavespeeds(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                                            RealMatrix& fluxes, RealMatrix& wave_speeds)
+{
+  compute_interface_fluxes_and_wavespeeds(left,right,coords,normals,0,left.rows(),fluxes,wave_speeds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RiemannSolver::compute_interface_fluxes(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                             const Uint begin, const Uint end,
+                                             RealMatrix& fluxes)
+{
+  compute_interface_fluxes_and_wavespeeds(left,right,coords,normals,begin,end,fluxes,m_block_wave_speeds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RiemannSolver::compute_interface_fluxes(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                             RealMatrix& fluxes)
+{
+  compute_interface_fluxes_and_wavespeeds(left,right,coords,normals,0,left.rows(),fluxes,m_block_wave_speeds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // RiemannSolvers
 } // cf3
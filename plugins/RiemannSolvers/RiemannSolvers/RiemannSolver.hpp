@@ -17,6 +17,8 @@ namespace cf3 {
 namespace physics { class Variables; class PhysModel;}
 namespace RiemannSolvers {
 
+class FaceBlockKernel;
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /// @author Willem Deconinck
@@ -47,13 +49,61 @@ public: // functions
   virtual void compute_interface_flux(const RealVector& left, const RealVector& right, const RealVector& coords, const RealVector& normal,
                                       RealVector& flux) = 0;
 
+  /// Compute interface fluxes and wavespeeds of the block of faces in rows [begin,end)
+  /// The arguments have one row per face:
+  /// left, right, fluxes and wave_speeds are nb_faces x neqs, coords and normals are nb_faces x ndim.
+  /// Only rows [begin,end) of fluxes and wave_speeds are written, they are resized to the size of left
+  /// if they do not match it. Blocks are given as a range rather than as Eigen blocks, so they are not copied.
+  /// Uses the fixed-size kernel of the solution variables if there is one, and the
+  /// per-face compute_interface_flux_and_wavespeeds() otherwise.
+  void compute_interface_fluxes_and_wavespeeds(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                               const Uint begin, const Uint end,
+                                               RealMatrix& fluxes, RealMatrix& wave_speeds);
+
+  /// Compute interface fluxes and wavespeeds of all faces
+  /// @see compute_interface_fluxes_and_wavespeeds()
+  void compute_interface_fluxes_and_wavespeeds(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                               RealMatrix& fluxes, RealMatrix& wave_speeds);
+
+  /// Compute interface fluxes of the block of faces in rows [begin,end)
+  /// @see compute_interface_fluxes_and_wavespeeds()
+  void compute_interface_fluxes(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                const Uint begin, const Uint end,
+                                RealMatrix& fluxes);
+
+  /// Compute interface fluxes of all faces
+  /// @see compute_interface_fluxes_and_wavespeeds()
+  void compute_interface_fluxes(const RealMatrix& left, const RealMatrix& right, const RealMatrix& coords, const RealMatrix& normals,
+                                RealMatrix& fluxes);
+
 protected:
 
+  /// Create the fixed-size kernel computing a block of faces at once
+  /// @return a null pointer if this solver has no kernel for the configured variables
+  virtual boost::shared_ptr<FaceBlockKernel> create_face_block_kernel();
+
+  /// Recreate the kernel at the next block of faces, after the physics or the variables changed
+  void reset_face_block_kernel();
+
   physics::Variables& solution_vars() const { return *m_solution_vars; }
   physics::PhysModel& physical_model() const { return *m_physical_model; }
 
   Handle<physics::PhysModel> m_physical_model;
   Handle<physics::Variables> m_solution_vars;
+
+private:
+
+  boost::shared_ptr<FaceBlockKernel> m_face_block_kernel;
+  bool m_face_block_kernel_created;
+
+  /// per-face storage for the fallback of the block computation
+  RealVector m_face_left;
+  RealVector m_face_right;
+  RealVector m_face_coords;
+  RealVector m_face_normal;
+  RealVector m_face_flux;
+  RealVector m_face_wave_speeds;
+  RealMatrix m_block_wave_speeds;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
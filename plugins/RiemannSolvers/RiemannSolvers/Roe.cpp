@@ -14,6 +14,7 @@
 #include "common/PropertyList.hpp"
 
 #include "RiemannSolvers/Roe.hpp"
+#include "RiemannSolvers/FaceBlockKernels.hpp"
 
 namespace cf3 {
 namespace RiemannSolvers {
@@ -30,7 +31,8 @@ Roe::Roe ( const std::string& name ) : RiemannSolver(name)
   options().add("roe_vars",m_roe_vars)
       .description("The component describing the Roe variables")
       .pretty_name("Roe Variables")
-      .link_to(&m_roe_vars);
+      .link_to(&m_roe_vars)
+      .attach_trigger( boost::bind( &Roe::reset_face_block_kernel, this) );
 
   options().option("physical_model").attach_trigger( boost::bind( &Roe::trigger_physical_model, this) );
 }
@@ -146,5 +148,28 @@ void Roe::compute_interface_flux_and_wavespeeds(const RealVector& left, const Re
 
 ////////////////////////////////////////////////////////////////////////////////
 
+boost::shared_ptr<FaceBlockKernel> Roe::create_face_block_kernel()
+{
+  if (is_null(m_physical_model) || is_null(m_solution_vars) || is_null(m_roe_vars))
+    return boost::shared_ptr<FaceBlockKernel>();
+
+  const std::string sol_type = solution_vars().derived_type_name();
+  const std::string roe_type = roe_vars().derived_type_name();
+  boost::shared_ptr<FaceBlockKernel> kernel;
+  if (sol_type == "cf3.physics.NavierStokes.Cons1D" && roe_type == "cf3.physics.NavierStokes.Roe1D")
+    kernel.reset( new RoeKernel<NavierStokes::Cons1D,NavierStokes::Roe1D>(physical_model()) );
+  else if (sol_type == "cf3.physics.NavierStokes.Cons2D" && roe_type == "cf3.physics.NavierStokes.Roe2D")
+    kernel.reset( new RoeKernel<NavierStokes::Cons2D,NavierStokes::Roe2D>(physical_model()) );
+  else if (sol_type == "cf3.physics.NavierStokes.Cons3D" && roe_type == "cf3.physics.NavierStokes.Roe3D")
+    kernel.reset( new RoeKernel<NavierStokes::Cons3D,NavierStokes::Roe3D>(physical_model()) );
+  else if (sol_type == "cf3.physics.LinEuler.Cons2D" && roe_type == sol_type)
+    kernel.reset( new RoeKernel<LinEuler::Cons2D,LinEuler::Cons2D>(physical_model()) );
+  else if (sol_type == "cf3.physics.LinEuler.Cons3D" && roe_type == sol_type)
+    kernel.reset( new RoeKernel<LinEuler::Cons3D,LinEuler::Cons3D>(physical_model()) );
+  return kernel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // RiemannSolvers
 } // cf3
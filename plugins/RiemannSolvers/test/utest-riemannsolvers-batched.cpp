@@ -0,0 +1,212 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the batched Riemann solvers"
+
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+
+#include "physics/PhysModel.hpp"
+#include "physics/Variables.hpp"
+#include "RiemannSolvers/RiemannSolver.hpp"
+
+#include "math/Defs.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::RiemannSolvers;
+using namespace cf3::physics;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Number of faces given to the batched solver at once
+#define BLOCK_SIZE 256u
+
+/// Left and right states of a Navier-Stokes shock tube or of a Linearized Euler perturbation,
+/// perturbed per face, with rotating normals
+struct Faces
+{
+  Faces(const std::string& model, const Uint ndim, const Uint nb_faces) :
+    neqs(ndim+2), left(nb_faces,ndim+2), right(nb_faces,ndim+2), coords(nb_faces,ndim), normals(nb_faces,ndim)
+  {
+    const Real g = 1.4;
+    coords.setZero();
+    for (Uint f=0; f<nb_faces; ++f)
+    {
+      const Real angle = 0.001*f;
+      if (ndim == DIM_2D)
+      {
+        normals(f,XX) = std::cos(angle);
+        normals(f,YY) = std::sin(angle);
+      }
+      else
+      {
+        const Real elevation = 0.0007*f;
+        normals(f,XX) = std::cos(angle)*std::sin(elevation);
+        normals(f,YY) = std::sin(angle)*std::sin(elevation);
+        normals(f,ZZ) = std::cos(elevation);
+      }
+
+      RealVector u_L(ndim), u_R(ndim);
+      u_L[XX] = std::cos(0.02*f);  u_R[XX] = 0.;
+      u_L[YY] = std::sin(0.03*f);  u_R[YY] = 0.1;
+      if (ndim == DIM_3D)
+      {
+        u_L[ZZ] = std::cos(0.05*f);  u_R[ZZ] = -0.1;
+      }
+
+      if (model == "NavierStokes")
+      {
+        const Real r_L = 4.696  * (1.+0.1*std::sin(0.01*f));   const Real r_R = 1.408;
+        const Real p_L = 404400.;                              const Real p_R = 101100.;
+        u_L *= 10.;  u_R *= 10.;
+        left(f,0)  = r_L;  left.row(f).segment(1,ndim)  = r_L*u_L.transpose();  left(f,ndim+1)  = p_L/(g-1.) + 0.5*r_L*u_L.squaredNorm();
+        right(f,0) = r_R;  right.row(f).segment(1,ndim) = r_R*u_R.transpose();  right(f,ndim+1) = p_R/(g-1.) + 0.5*r_R*u_R.squaredNorm();
+      }
+      else // LinEuler: perturbations of density, momentum and pressure
+      {
+        u_L *= 0.01;  u_R *= 0.01;
+        left(f,0)  = 0.01*std::sin(0.01*f);  left.row(f).segment(1,ndim)  = u_L.transpose();  left(f,ndim+1)  = 0.02*std::cos(0.04*f);
+        right(f,0) = 0.005;                  right.row(f).segment(1,ndim) = u_R.transpose();  right(f,ndim+1) = 0.;
+      }
+    }
+  }
+
+  Uint neqs;
+  RealMatrix left;
+  RealMatrix right;
+  RealMatrix coords;
+  RealMatrix normals;
+};
+
+/// Create a Riemann solver of given type for model "NavierStokes" or "LinEuler" in ndim dimensions
+RiemannSolver& create_riemann_solver(const std::string& model_type, const Uint ndim, const std::string& type)
+{
+  const std::string dim = ndim == DIM_2D ? "2D" : "3D";
+  Handle<Component> model = Core::instance().root().get_child(model_type+dim);
+  if (is_null(model))
+  {
+    model = Core::instance().root().create_component<Component>(model_type+dim);
+    Handle<PhysModel> physics( model->create_component("physics","cf3.physics."+model_type+"."+model_type+dim) );
+    physics->create_variables("Cons"+dim,"solution");
+    if (model_type == "NavierStokes")
+      physics->create_variables("Roe"+dim,"roe");
+  }
+  Handle<PhysModel> physics( model->get_child("physics") );
+  Handle<RiemannSolver> riemann( model->get_child(type) );
+  if (is_null(riemann))
+  {
+    riemann = Handle<RiemannSolver>( model->create_component(type,"cf3.RiemannSolvers."+type) );
+    riemann->options().set("physical_model",physics);
+    riemann->options().set("solution_vars",physics->get_child("solution"));
+    if (type == "Roe")
+      riemann->options().set("roe_vars",physics->get_child(model_type == "NavierStokes" ? "roe" : "solution"));
+  }
+  return *riemann;
+}
+
+/// Compute all faces one at a time
+void compute_per_face(RiemannSolver& riemann, const Faces& faces, RealMatrix& fluxes, RealMatrix& wave_speeds)
+{
+  const Uint ndim = faces.coords.cols();
+  RealVector left(faces.neqs), right(faces.neqs), coords(ndim), normal(ndim), flux(faces.neqs), ws(faces.neqs);
+  const Uint nb_faces = faces.left.rows();
+  fluxes.resize(nb_faces,faces.neqs);
+  wave_speeds.resize(nb_faces,faces.neqs);
+  for (Uint f=0; f<nb_faces; ++f)
+  {
+    left   = faces.left.row(f).transpose();
+    right  = faces.right.row(f).transpose();
+    coords = faces.coords.row(f).transpose();
+    normal = faces.normals.row(f).transpose();
+    riemann.compute_interface_flux_and_wavespeeds(left,right,coords,normal,flux,ws);
+    fluxes.row(f) = flux.transpose();
+    wave_speeds.row(f) = ws.transpose();
+  }
+}
+
+/// Compute the faces in blocks of BLOCK_SIZE, the last block being incomplete
+void compute_batched(RiemannSolver& riemann, const Faces& faces, RealMatrix& fluxes, RealMatrix& wave_speeds)
+{
+  const Uint nb_faces = faces.left.rows();
+  for (Uint begin=0; begin<nb_faces; begin+=BLOCK_SIZE)
+  {
+    const Uint end = std::min(begin+BLOCK_SIZE, nb_faces);
+    riemann.compute_interface_fluxes_and_wavespeeds(faces.left, faces.right, faces.coords, faces.normals,
+                                                    begin, end, fluxes, wave_speeds);
+  }
+}
+
+/// Check that the batched solver gives the per-face results
+void check_batched_equals_per_face(RiemannSolver& riemann, const Faces& faces)
+{
+  RealMatrix fluxes, wave_speeds, batched_fluxes, batched_wave_speeds;
+  compute_per_face(riemann,faces,fluxes,wave_speeds);
+  compute_batched(riemann,faces,batched_fluxes,batched_wave_speeds);
+  BOOST_REQUIRE_EQUAL(batched_fluxes.rows(), faces.left.rows());
+  BOOST_REQUIRE_EQUAL(batched_wave_speeds.rows(), faces.left.rows());
+  for (Uint f=0; f<faces.left.rows(); ++f)
+  {
+    for (Uint v=0; v<faces.neqs; ++v)
+    {
+      BOOST_CHECK_SMALL(batched_fluxes(f,v) - fluxes(f,v), 1e-8*(1.+std::abs(fluxes(f,v))));
+      BOOST_CHECK_SMALL(batched_wave_speeds(f,v) - wave_speeds(f,v), 1e-8*(1.+std::abs(wave_speeds(f,v))));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( RiemannSolversBatched_Suite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( batched_equals_per_face )
+{
+  const char* models[] = { "NavierStokes", "LinEuler" };
+  const Uint dims[] = { DIM_2D, DIM_3D };
+  const char* types[] = { "Roe", "Central", "LaxFriedrich" };
+  for (Uint m=0; m<2; ++m)
+  {
+    for (Uint d=0; d<2; ++d)
+    {
+      const Faces faces(models[m],dims[d],1000);
+      for (Uint t=0; t<3; ++t)
+      {
+        BOOST_TEST_CHECKPOINT(types[t] << " for " << models[m] << " in " << dims[d] << "D");
+        check_batched_equals_per_face(create_riemann_solver(models[m],dims[d],types[t]),faces);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( ausmplusup_batched_equals_per_face )
+{
+  // AUSMplusUp only supports the 2D Navier-Stokes model
+  RiemannSolver& riemann = create_riemann_solver("NavierStokes",DIM_2D,"AUSMplusUp");
+  riemann.options().set("machinf", 0.5);
+  const Faces faces("NavierStokes",DIM_2D,1000);
+  check_batched_equals_per_face(riemann,faces);
+
+  // Changing a coefficient recreates the kernel
+  riemann.options().set("machinf", 0.1);
+  check_batched_equals_per_face(riemann,faces);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -8,6 +8,7 @@
 #define BOOST_TEST_MODULE "Test module for cf3::RiemannSolvers"
 
 #include <iostream>
+#include <cmath>
 #include <boost/test/unit_test.hpp>
 
 #include "common/Builder.hpp"
@@ -70,6 +71,72 @@ BOOST_AUTO_TEST_CASE( Scalar1D_LaxFriedrich )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( NavierStokes2D_LaxFriedrich )
+{
+  Component& model =  *Core::instance().root().create_component<Component>("model2D");
+
+  // Creation of physics + variables
+  Handle<PhysModel> physics( model.create_component("navierstokes","cf3.physics.NavierStokes.NavierStokes2D") );
+  Handle<Variables> sol_vars( physics->create_variables("Cons2D","solution") );
+
+  // Creation + configuration of riemann solver
+  Handle<RiemannSolver> riemann( model.create_component("riemann","cf3.RiemannSolvers.LaxFriedrich") );
+  riemann->options().set("physical_model",physics);
+  riemann->options().set("solution_vars",sol_vars);
+
+  Uint dim  = physics->ndim();
+  Uint neqs = physics->neqs();
+  RealVector normal(dim);
+  RealVector left(neqs), right(neqs);
+  RealVector flux(neqs), flux_reversed(neqs);
+  RealVector wave_speeds(neqs);
+  RealVector coords(dim); coords.setZero();
+
+  const Real g = 1.4;
+  const Real tol (0.000001);
+
+  // Uniform state: the interface flux is the physical flux projected on the normal
+  const Real r = 1.;  const Real u = 2.;  const Real v = 0.;  const Real p = 1.;
+  const Real c = std::sqrt(g*p/r);
+  left << r, r*u, r*v, p/(g-1.) + 0.5*r*(u*u+v*v);
+  right = left;
+
+  normal << 1., 0.;
+  riemann->compute_interface_flux_and_wavespeeds(left,right,coords,normal,flux,wave_speeds);
+  BOOST_CHECK_CLOSE(flux[0] , 2.  , tol);
+  BOOST_CHECK_CLOSE(flux[1] , 5.  , tol);
+  BOOST_CHECK_SMALL(flux[2] , tol);
+  BOOST_CHECK_CLOSE(flux[3] , 11. , tol);
+
+  BOOST_CHECK_CLOSE(wave_speeds[0], u   , tol);
+  BOOST_CHECK_CLOSE(wave_speeds[1], u   , tol);
+  BOOST_CHECK_CLOSE(wave_speeds[2], u+c , tol);
+  BOOST_CHECK_CLOSE(wave_speeds[3], u-c , tol);
+
+  normal << 0., 1.;
+  riemann->compute_interface_flux_and_wavespeeds(left,right,coords,normal,flux,wave_speeds);
+  BOOST_CHECK_SMALL(flux[0] , tol);
+  BOOST_CHECK_SMALL(flux[1] , tol);
+  BOOST_CHECK_CLOSE(flux[2] , 1.  , tol);
+  BOOST_CHECK_SMALL(flux[3] , tol);
+
+  // Shock tube: the flux is conservative, reversing the states and the normal reverses the flux
+  const Real r_L = 4.696;     const Real r_R = 1.408;
+  const Real u_L = 10.;       const Real u_R = 0.;
+  const Real v_L = 5.;        const Real v_R = 1.;
+  const Real p_L = 404400;    const Real p_R = 101100;
+  left <<  r_L, r_L*u_L, r_L*v_L, p_L/(g-1.) + 0.5*r_L*(u_L*u_L+v_L*v_L);
+  right << r_R, r_R*u_R, r_R*v_R, p_R/(g-1.) + 0.5*r_R*(u_R*u_R+v_R*v_R);
+
+  normal << 0.6, 0.8;
+  riemann->compute_interface_flux(left,right,coords,normal,flux);
+  riemann->compute_interface_flux(right,left,coords,-normal,flux_reversed);
+  for (Uint v=0; v<neqs; ++v)
+    BOOST_CHECK_CLOSE(flux_reversed[v], -flux[v], tol);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
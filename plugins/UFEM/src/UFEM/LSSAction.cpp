@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include "common/Core.hpp"
+#include "common/EventHandler.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/Signal.hpp"
@@ -62,6 +64,46 @@ struct LSSAction::Implementation
     CFdebug << "lss for " << m_component.uri().path() << " set to " << m_component.options().option("lss").value_str() << CFendl;
   }
 
+  /// Copy the sparsity of the LSS into the given lists, reusing the cached pattern if it was built for the same regions and dictionary
+  boost::shared_ptr< List<Uint> > sparsity(const std::vector< Handle<Region> >& regions, const Dictionary& dictionary, List<Uint>& gids, List<Uint>& ranks, List<Uint>& used_node_map)
+  {
+    if(is_null(m_used_nodes) || m_sparsity_regions != regions || m_sparsity_dictionary.get() != &dictionary)
+    {
+      m_used_nodes = build_sparsity(regions, dictionary, m_node_connectivity, m_starting_indices, gids, ranks, used_node_map);
+      m_sparsity_regions = regions;
+      m_sparsity_dictionary = dictionary.handle<Dictionary>();
+      m_gids.assign(gids.array().begin(), gids.array().end());
+      m_ranks.assign(ranks.array().begin(), ranks.array().end());
+      m_used_node_map.assign(used_node_map.array().begin(), used_node_map.array().end());
+      return m_used_nodes;
+    }
+
+    CFdebug << "Reusing sparsity of " << m_starting_indices.size()-1 << " nodes for " << m_component.uri().path() << CFendl;
+    copy_list(m_gids, gids);
+    copy_list(m_ranks, ranks);
+    copy_list(m_used_node_map, used_node_map);
+    return m_used_nodes;
+  }
+
+  void copy_list(const std::vector<Uint>& from, List<Uint>& to)
+  {
+    to.resize(from.size());
+    std::copy(from.begin(), from.end(), to.array().begin());
+  }
+
+  /// Forget the cached sparsity, so the next LSS is built from the current mesh
+  void clear_sparsity()
+  {
+    m_used_nodes.reset();
+    m_sparsity_regions.clear();
+    m_sparsity_dictionary = Handle<Dictionary const>();
+    std::vector<Uint>().swap(m_node_connectivity);
+    std::vector<Uint>().swap(m_starting_indices);
+    std::vector<Uint>().swap(m_gids);
+    std::vector<Uint>().swap(m_ranks);
+    std::vector<Uint>().swap(m_used_node_map);
+  }
+
   Component& m_component;
   SystemMatrix system_matrix;
   SystemRHS system_rhs;
@@ -71,6 +113,16 @@ struct LSSAction::Implementation
   Handle<LSS::System> m_lss;
 
   bool m_updating;
+
+  /// Cached sparsity pattern, valid for the regions and dictionary it was built for until the mesh changes
+  std::vector<Uint> m_node_connectivity;
+  std::vector<Uint> m_starting_indices;
+  std::vector<Uint> m_gids;
+  std::vector<Uint> m_ranks;
+  std::vector<Uint> m_used_node_map;
+  boost::shared_ptr< List<Uint> > m_used_nodes;
+  std::vector< Handle<Region> > m_sparsity_regions;
+  Handle<Dictionary const> m_sparsity_dictionary;
 };
 
 LSSAction::LSSAction(const std::string& name) :
@@ -103,6 +155,8 @@ LSSAction::LSSAction(const std::string& name) :
   options().add("blocked_system", false)
     .pretty_name("Blocked System")
     .description("Store the linear system internally as a set of blocks grouped per variable, rather than keeping the variables per node");
+
+  Core::instance().event_handler().connect_to_event("mesh_changed", this, &LSSAction::on_mesh_changed_event);
 }
 
 LSSAction::~LSSAction()
@@ -194,11 +248,15 @@ void LSSAction::on_regions_set()
     Handle< List<Uint> > ranks = m_implementation->m_lss->create_component< List<Uint> >("Ranks");
     Handle< List<Uint> > used_node_map = m_implementation->m_lss->create_component< List<Uint> >("used_node_map");
 
-    std::vector<Uint> node_connectivity, starting_indices;
-    boost::shared_ptr< List<Uint> > used_nodes = build_sparsity(m_loop_regions, *m_dictionary, node_connectivity, starting_indices, *gids, *ranks, *used_node_map);
-    if(is_not_null(get_child(used_nodes->name())))
-      remove_component(used_nodes->name());
-    add_component(used_nodes);
+    boost::shared_ptr< List<Uint> > used_nodes = m_implementation->sparsity(m_loop_regions, *m_dictionary, *gids, *ranks, *used_node_map);
+    if(get_child(used_nodes->name()).get() != used_nodes.get())
+    {
+      if(is_not_null(get_child(used_nodes->name())))
+        remove_component(used_nodes->name());
+      add_component(used_nodes);
+    }
+    std::vector<Uint>& node_connectivity = m_implementation->m_node_connectivity;
+    std::vector<Uint>& starting_indices = m_implementation->m_starting_indices;
 
     // This comm pattern is valid only over the used nodes for the supplied regions
     if(is_not_null(get_child("CommPattern")))
@@ -255,6 +313,12 @@ void LSSAction::trigger_dictionary()
   }
 }
 
+void LSSAction::on_mesh_changed_event(SignalArgs& args)
+{
+  // The node numbering may have changed, so the sparsity has to be rebuilt for the next LSS
+  m_implementation->clear_sparsity();
+}
+
 void LSSAction::trigger_initial_conditions()
 {
   if(is_null(m_initial_conditions))
@@ -78,6 +78,9 @@ private:
   /// Trigger for the initial conditions
   void trigger_initial_conditions();
 
+  /// Discard the cached sparsity when a mesh is changed
+  void on_mesh_changed_event(common::SignalArgs& args);
+
   /// The dictionary to use for field lookups
   Handle<mesh::Dictionary> m_dictionary;
 
@@ -4,9 +4,10 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
-#include <set>
+#include <algorithm>
 
 #include "common/FindComponents.hpp"
+#include "common/HashMap.hpp"
 #include "common/List.hpp"
 #include "common/PE/Comm.hpp"
 
@@ -30,8 +31,8 @@ using namespace mesh;
 
 boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region> >& regions, const Dictionary& dictionary, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, List<Uint>& gids, List<Uint>& ranks, List<Uint>& used_node_map)
 {
-  // Get some data from the dictionary
-  const Uint nb_global_nodes = dictionary.size();
+  // Get some data from the dictionary. It only holds the local and ghost nodes.
+  const Uint nb_dict_nodes = dictionary.size();
   const List<Uint>& dict_gid = dictionary.glb_idx();
   const List<Uint>& dict_rank = dictionary.rank();
 
@@ -54,7 +55,7 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
   const Uint nb_used_nodes = used_nodes.size();
   gids.resize(nb_used_nodes);
   ranks.resize(nb_used_nodes);
-  used_node_map.resize(nb_global_nodes);
+  used_node_map.resize(nb_dict_nodes);
   Uint nb_local_nodes = 0;
   for(Uint i = 0; i != nb_used_nodes; ++i)
   {
@@ -64,7 +65,7 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
     {
       ++nb_local_nodes;
     }
-    ranks[i] = dict_rank[i];
+    ranks[i] = dict_rank[node_idx];
   }
 
   // Get the layout of the new GIDs across CPUs
@@ -128,14 +129,16 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
     std::vector<int> recv_map; recv_map.reserve(recv_size);
     std::vector<int> send_map; send_map.reserve(send_size);
     
-    std::map<Uint, Uint> gids_reverse_map;
-    for(Uint i = 0; i != nb_global_nodes; ++i)
+    boost::shared_ptr< HashMap<Uint, Uint> > gids_reverse_map_ptr = allocate_component< HashMap<Uint, Uint> >("gids_reverse_map");
+    HashMap<Uint, Uint>& gids_reverse_map = *gids_reverse_map_ptr;
+    gids_reverse_map.reserve(nb_dict_nodes);
+    for(Uint i = 0; i != nb_dict_nodes; ++i)
       gids_reverse_map[dict_gid[i]] = i;
 
     for(Uint i = 0; i != nb_procs; ++i)
     {
       recv_map.insert(recv_map.end(), lids_to_receive[i].begin(), lids_to_receive[i].end());
-      const std::vector<Uint> send_gids_i = gids_to_send[i];
+      const std::vector<Uint>& send_gids_i = gids_to_send[i];
       const Uint len_send_gids_i = send_gids_i.size();
       for(Uint j = 0; j != len_send_gids_i; ++j)
         send_map.push_back(gids_reverse_map[send_gids_i[j]]);
@@ -153,38 +156,64 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
     }
   }
 
-  std::vector< std::set<Uint> > connectivity_sets(nb_used_nodes);
-  start_indices.assign(nb_used_nodes+1, 0);
-
-  // Determine the number of connected nodes for each element
-  BOOST_FOREACH(const Handle<Entities const>& elements, used_entities)
+  // Build the node to element connectivity in compressed row format. Elements are numbered consecutively
+  // over all used entities, starting at entities_starts[k] for the k-th entities.
+  const Uint nb_used_entities = used_entities.size();
+  std::vector<Uint> entities_starts(nb_used_entities+1, 0);
+  std::vector<Uint> node_elements_starts(nb_used_nodes+1, 0);
+  for(Uint k = 0; k != nb_used_entities; ++k)
   {
-    const Connectivity& connectivity = elements->geometry_space().connectivity();
-    const Uint nb_elems = connectivity.size();
-    const Uint nb_elem_nodes = connectivity.row_size();
-    for(Uint elem = 0; elem != nb_elems; ++elem)
+    const Connectivity& connectivity = used_entities[k]->geometry_space().connectivity();
+    entities_starts[k+1] = entities_starts[k] + connectivity.size();
+    BOOST_FOREACH(const Connectivity::ConstRow row, connectivity.array())
     {
-      BOOST_FOREACH(const Uint node_a, connectivity[elem])
+      BOOST_FOREACH(const Uint node, row)
       {
-        BOOST_FOREACH(const Uint node_b, connectivity[elem])
-        {
-          connectivity_sets[used_node_map[node_a]].insert(used_node_map[node_b]);
-        }
+        ++node_elements_starts[used_node_map[node]+1];
       }
     }
   }
+  for(Uint i = 1; i != nb_used_nodes+1; ++i)
+    node_elements_starts[i] += node_elements_starts[i-1];
 
-  // Sum the number of connected nodes to get the real start indices
-  const Uint start_indices_end = start_indices.size();
-  for(Uint i = 1; i != start_indices_end; ++i)
+  std::vector<Uint> node_elements(node_elements_starts.back());
   {
-    start_indices[i] = connectivity_sets[i-1].size() + start_indices[i-1];
+    std::vector<Uint> fill_positions(node_elements_starts.begin(), node_elements_starts.end()-1);
+    for(Uint k = 0; k != nb_used_entities; ++k)
+    {
+      const Connectivity& connectivity = used_entities[k]->geometry_space().connectivity();
+      const Uint nb_elems = connectivity.size();
+      for(Uint elem = 0; elem != nb_elems; ++elem)
+      {
+        BOOST_FOREACH(const Uint node, connectivity[elem])
+        {
+          node_elements[fill_positions[used_node_map[node]]++] = entities_starts[k] + elem;
+        }
+      }
+    }
   }
 
-  node_connectivity.reserve(start_indices.back());
+  // For each node, gather the nodes of the surrounding elements and sort them to remove duplicates.
+  // The result is appended directly to the flat node_connectivity array.
+  node_connectivity.clear();
+  node_connectivity.reserve(node_elements.size());
+  start_indices.assign(nb_used_nodes+1, 0);
+  std::vector<Uint> connected_nodes;
   for(Uint node = 0; node != nb_used_nodes; ++node)
   {
-    node_connectivity.insert(node_connectivity.begin() + start_indices[node], connectivity_sets[node].begin(), connectivity_sets[node].end());
+    connected_nodes.clear();
+    for(Uint i = node_elements_starts[node]; i != node_elements_starts[node+1]; ++i)
+    {
+      const Uint elem_idx = node_elements[i];
+      const Uint k = std::upper_bound(entities_starts.begin(), entities_starts.end(), elem_idx) - entities_starts.begin() - 1;
+      BOOST_FOREACH(const Uint connected_node, used_entities[k]->geometry_space().connectivity()[elem_idx - entities_starts[k]])
+      {
+        connected_nodes.push_back(used_node_map[connected_node]);
+      }
+    }
+    std::sort(connected_nodes.begin(), connected_nodes.end());
+    node_connectivity.insert(node_connectivity.end(), connected_nodes.begin(), std::unique(connected_nodes.begin(), connected_nodes.end()));
+    start_indices[node+1] = node_connectivity.size();
   }
 
   return used_nodes_ptr;
@@ -0,0 +1,93 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the UFEM sparsity builder on a large tetrahedral mesh"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/List.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+
+#include "Tools/Testing/TimedTestFixture.hpp"
+
+#include "UFEM/SparsityBuilder.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+struct UFEMBuildSparsityBenchmarkFixture : public Tools::Testing::TimedTestFixture
+{
+  UFEMBuildSparsityBenchmarkFixture() :
+    root( Core::instance().root() )
+  {
+  }
+
+  Component& root;
+};
+
+BOOST_FIXTURE_TEST_SUITE( UFEMBuildSparsityBenchmarkSuite, UFEMBuildSparsityBenchmarkFixture )
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  common::PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().size(), 1);
+}
+
+/// Cube of segments^3 hexahedra, split into 5 tetrahedra each. 215 segments give about 10M nodes.
+BOOST_AUTO_TEST_CASE( CreateMesh )
+{
+  int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+
+  cf3_assert(argc == 2);
+  const Uint segments = boost::lexical_cast<Uint>(argv[1]);
+
+  boost::shared_ptr<MeshGenerator> create_box = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","create_box");
+  create_box->options().set("mesh",root.uri()/"Mesh");
+  create_box->options().set("lengths",std::vector<Real>(DIM_3D, 1.));
+  create_box->options().set("nb_cells",std::vector<Uint>(DIM_3D, segments));
+  Mesh& mesh = create_box->generate();
+
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.MeshTriangulator","triangulator")->transform(mesh);
+
+  BOOST_CHECK_EQUAL(mesh.geometry_fields().size(), (segments+1)*(segments+1)*(segments+1));
+  CFinfo << "Created tetra mesh with " << mesh.geometry_fields().size() << " nodes" << CFendl;
+}
+
+BOOST_AUTO_TEST_CASE( BuildSparsity )
+{
+  Mesh& mesh = *Handle<Mesh>(root.get_child("Mesh"));
+  const Uint nb_nodes = mesh.geometry_fields().size();
+
+  std::vector<Uint> node_connectivity, start_indices;
+  boost::shared_ptr< List<Uint> > gids = allocate_component< List<Uint> >("GIDs");
+  boost::shared_ptr< List<Uint> > ranks = allocate_component< List<Uint> >("Ranks");
+  boost::shared_ptr< List<Uint> > used_node_map = allocate_component< List<Uint> >("used_node_map");
+
+  restart_timer();
+  UFEM::build_sparsity(std::vector< Handle<Region> >(1, mesh.topology().handle<Region>()), mesh.geometry_fields(), node_connectivity, start_indices, *gids, *ranks, *used_node_map);
+
+  BOOST_CHECK_EQUAL(start_indices.size(), nb_nodes+1);
+  BOOST_CHECK_EQUAL(start_indices.back(), node_connectivity.size());
+  CFinfo << "Sparsity has " << node_connectivity.size() << " non-zero blocks" << CFendl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,182 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for proto assembly with a matrix-free LSS"
+
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#define BOOST_PROTO_MAX_ARITY 10                        //explained in boost doc
+#ifdef BOOST_MPL_LIMIT_METAFUNCTION_ARITY
+ #undef BOOST_MPL_LIMIT_METAFUNCTION_ARITY
+ #define BOOST_MPL_LIMIT_METAFUNCTION_ARITY 10
+#endif
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+
+#include "math/LSS/System.hpp"
+#include "math/LSS/SolveLSS.hpp"
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/BlockCrs/BlockCrsMatrix.hpp"
+#include "math/LSS/BlockCrs/BlockCrsVector.hpp"
+#include "math/LSS/BlockCrs/MatrixFreeMatrix.hpp"
+
+#include "mesh/Domain.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/MeshGenerator.hpp"
+
+#include "mesh/LagrangeP1/Quad2D.hpp"
+#include "solver/Model.hpp"
+
+#include "solver/actions/Proto/ProtoAction.hpp"
+#include "solver/actions/Proto/Expression.hpp"
+
+#include "UFEM/BoundaryConditions.hpp"
+#include "UFEM/LSSAction.hpp"
+#include "UFEM/Solver.hpp"
+#include "UFEM/Tags.hpp"
+
+using namespace cf3;
+using namespace cf3::solver;
+using namespace cf3::solver::actions;
+using namespace cf3::solver::actions::Proto;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+struct ProtoMatrixFreeFixture
+{
+  ProtoMatrixFreeFixture() :
+    root( Core::instance().root() )
+  {
+  }
+
+  /// Create a BlockCrs LSS with the given matrix, solved by GMRES with a Jacobi preconditioner
+  math::LSS::System& create_lss(UFEM::LSSAction& lss_action, const std::string& matrix_builder)
+  {
+    math::LSS::System& lss = lss_action.create_lss(matrix_builder, "cf3.math.LSS.BlockCrsStrategy");
+    lss.solution_strategy()->options().set("preconditioner", std::string("Jacobi"));
+    lss.solution_strategy()->options().set("tolerance", 1e-12);
+    return lss;
+  }
+
+  Component& root;
+};
+
+BOOST_FIXTURE_TEST_SUITE( ProtoMatrixFreeSuite, ProtoMatrixFreeFixture )
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  common::PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().size(), 1);
+}
+
+/// Solves the same Poisson problem with the assembled BlockCrs matrix and with the matrix-free matrix
+BOOST_AUTO_TEST_CASE( PoissonAssembledVsMatrixFree )
+{
+  // Setup a model
+  Model& model = *root.create_component<Model>("Model");
+  Domain& domain = model.create_domain("Domain");
+  UFEM::Solver& solver = *model.create_component<UFEM::Solver>("Solver");
+
+  Handle<UFEM::LSSAction> lss_action(solver.add_direct_solver("cf3.UFEM.LSSAction"));
+
+  // Proto placeholders
+  FieldVariable<0, ScalarField> temperature("Temperature", UFEM::Tags::solution());
+
+  // Allowed elements (reducing this list improves compile times)
+  boost::mpl::vector1<mesh::LagrangeP1::Quad2D> allowed_elements;
+
+  // BCs
+  boost::shared_ptr<UFEM::BoundaryConditions> bc = allocate_component<UFEM::BoundaryConditions>("BoundaryConditions");
+
+  // The RHS depends on the current temperature, so it changes if it is not skipped during a matrix-vector product
+  *lss_action
+    << create_proto_action
+    (
+      "Assembly",
+      elements_expression
+      (
+        allowed_elements,
+        group
+        (
+          _A = _0,
+          element_quadrature( _A(temperature) += transpose(nabla(temperature)) * nabla(temperature) ),
+          lss_action->system_matrix += _A,
+          lss_action->system_rhs += -_A * _x
+        )
+      )
+    )
+    << bc
+    << allocate_component<math::LSS::SolveLSS>("SolveLSS")
+    << create_proto_action("Increment", nodes_expression(temperature += lss_action->solution(temperature)));
+
+  // Setup physics
+  model.create_physics("cf3.UFEM.NavierStokesPhysics");
+
+  // Setup mesh
+  boost::shared_ptr<MeshGenerator> create_rectangle = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","create_rectangle");
+  create_rectangle->options().set("mesh",domain.uri()/"Mesh");
+  create_rectangle->options().set("lengths",std::vector<Real>(DIM_2D, 1.));
+  create_rectangle->options().set("nb_cells",std::vector<Uint>(DIM_2D, 8u));
+  Mesh& mesh = create_rectangle->generate();
+
+  // The LSS is created before the regions are set, so it is built with the BlockCrs matrix
+  create_lss(*lss_action, "cf3.math.LSS.BlockCrsMatrix");
+  lss_action->options().set("regions", std::vector<URI>(1, mesh.topology().uri()));
+
+  // Set boundary conditions, the bottom is left free
+  bc->add_constant_bc("left", "Temperature", 10.);
+  bc->add_constant_bc("right", "Temperature", 35.);
+  bc->add_constant_bc("top", "Temperature", 20.);
+
+  // Assembled solution
+  model.simulate();
+  Field& temperature_field = find_component_recursively_with_tag<Field>(mesh, UFEM::Tags::solution());
+  const Uint nb_nodes = temperature_field.size();
+  std::vector<Real> assembled_solution(nb_nodes);
+  for(Uint i = 0; i != nb_nodes; ++i)
+    assembled_solution[i] = temperature_field[i][0];
+
+  // Product of the assembled matrix, including the boundary conditions
+  std::vector<Real> x(nb_nodes), assembled_y;
+  for(Uint i = 0; i != nb_nodes; ++i)
+    x[i] = std::sin(static_cast<Real>(i));
+  math::LSS::System& assembled_lss = *lss_action->options().value< Handle<math::LSS::System> >("lss");
+  dynamic_cast<math::LSS::BlockCrsMatrix&>(*assembled_lss.matrix()).apply(x, assembled_y);
+
+  // Matrix-free solution, starting again from zero
+  for(Uint i = 0; i != nb_nodes; ++i)
+    temperature_field[i][0] = 0.;
+  math::LSS::System& lss = create_lss(*lss_action, "cf3.math.LSS.MatrixFreeMatrix");
+  lss.matrix()->options().set("operator", Handle<common::Action>(lss_action->get_child("Assembly")));
+  model.simulate();
+
+  for(Uint i = 0; i != nb_nodes; ++i)
+    BOOST_CHECK_SMALL(temperature_field[i][0] - assembled_solution[i], 1e-8);
+
+  // Applying the operator re-runs the assembly, with the converged temperature in the RHS term.
+  // The RHS is left untouched, and the product matches the assembled one.
+  math::LSS::MatrixFreeMatrix& matrix = dynamic_cast<math::LSS::MatrixFreeMatrix&>(*lss.matrix());
+  const std::vector<Real> rhs_before = dynamic_cast<math::LSS::BlockCrsVector&>(*lss.rhs()).data();
+  std::vector<Real> matrix_free_y;
+  matrix.apply(x, matrix_free_y);
+  BOOST_CHECK(dynamic_cast<math::LSS::BlockCrsVector&>(*lss.rhs()).data() == rhs_before);
+  BOOST_CHECK(!matrix.is_applying());
+  BOOST_REQUIRE_EQUAL(matrix_free_y.size(), assembled_y.size());
+  for(Uint i = 0; i != nb_nodes; ++i)
+    BOOST_CHECK_SMALL(matrix_free_y[i] - assembled_y[i], 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -12,6 +12,7 @@
 
 #include "common/Core.hpp"
 #include "common/Environment.hpp"
+#include "common/List.hpp"
 
 #include "common/PE/CommPattern.hpp"
 
@@ -19,6 +20,8 @@
 
 #include "mesh/Domain.hpp"
 #include "mesh/LagrangeP1/Line1D.hpp"
+#include "mesh/LagrangeP1/Quad2D.hpp"
+#include "mesh/Tags.hpp"
 
 #include "solver/Model.hpp"
 
@@ -355,6 +358,69 @@ BOOST_AUTO_TEST_CASE( Heat1DComponent )
   lss.matrix()->print("utest-ufem-buildsparsity_heat_matrix_1DHeat.plt");
 }
 
+// The LSSAction keeps the sparsity of its regions until the mesh changes
+BOOST_AUTO_TEST_CASE( SparsityCache )
+{
+  // Setup a model
+  Model& model = *root.create_component<Model>("CacheModel");
+  Domain& domain = model.create_domain("Domain");
+  UFEM::Solver& solver = *model.create_component<UFEM::Solver>("Solver");
+
+  Handle<UFEM::LSSAction> lss_action(solver.add_direct_solver("cf3.UFEM.LSSAction"));
+
+  FieldVariable<0, ScalarField> temperature("Temperature", UFEM::Tags::solution());
+  boost::mpl::vector1<mesh::LagrangeP1::Quad2D> allowed_elements;
+
+  *lss_action
+    << create_proto_action
+    (
+      "Assembly",
+      elements_expression
+      (
+        allowed_elements,
+        group
+        (
+          _A = _0,
+          element_quadrature( _A(temperature) += transpose(nabla(temperature)) * nabla(temperature) ),
+          lss_action->system_matrix += _A
+        )
+      )
+    );
+
+  model.create_physics("cf3.physics.DynamicModel");
+
+  Mesh& mesh = *domain.create_component<Mesh>("Mesh");
+  Tools::MeshGeneration::create_rectangle(mesh, 1., 1., 5, 5);
+
+  lss_action->options().set("regions", std::vector<URI>(1, mesh.topology().uri()));
+
+  // The used nodes list is only replaced when the sparsity is rebuilt
+  LSS::System& first_lss = lss_action->create_lss("cf3.math.LSS.TrilinosFEVbrMatrix");
+  BOOST_CHECK(first_lss.is_created());
+  Handle<Component> first_used_nodes = lss_action->get_child(mesh::Tags::nodes_used());
+  BOOST_REQUIRE(is_not_null(first_used_nodes));
+  const List<Uint>& first_gids_list = *Handle< List<Uint> >(first_lss.get_child("GIDs"));
+  const std::vector<Uint> first_gids(first_gids_list.array().begin(), first_gids_list.array().end());
+  BOOST_CHECK_EQUAL(first_gids.size(), 36u);
+
+  // A new LSS on the same regions reuses the sparsity
+  LSS::System& reused_lss = lss_action->create_lss("cf3.math.LSS.TrilinosFEVbrMatrix");
+  BOOST_CHECK(reused_lss.is_created());
+  BOOST_CHECK(lss_action->get_child(mesh::Tags::nodes_used()) == first_used_nodes);
+  const List<Uint>& reused_gids = *Handle< List<Uint> >(reused_lss.get_child("GIDs"));
+  BOOST_CHECK_EQUAL_COLLECTIONS(reused_gids.array().begin(), reused_gids.array().end(), first_gids.begin(), first_gids.end());
+
+  // After a mesh change, the sparsity is built again
+  mesh.raise_mesh_changed();
+  LSS::System& rebuilt_lss = lss_action->create_lss("cf3.math.LSS.TrilinosFEVbrMatrix");
+  BOOST_CHECK(rebuilt_lss.is_created());
+  Handle<Component> rebuilt_used_nodes = lss_action->get_child(mesh::Tags::nodes_used());
+  BOOST_REQUIRE(is_not_null(rebuilt_used_nodes));
+  BOOST_CHECK(rebuilt_used_nodes != first_used_nodes);
+  const List<Uint>& rebuilt_gids = *Handle< List<Uint> >(rebuilt_lss.get_child("GIDs"));
+  BOOST_CHECK_EQUAL_COLLECTIONS(rebuilt_gids.array().begin(), rebuilt_gids.array().end(), first_gids.begin(), first_gids.end());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
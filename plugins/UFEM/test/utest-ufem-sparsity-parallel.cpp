@@ -0,0 +1,186 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the UFEM sparsity builder against a brute-force build"
+
+#include <map>
+#include <set>
+
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+
+#include "UFEM/SparsityBuilder.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+struct UFEMSparsityParallelFixture
+{
+  UFEMSparsityParallelFixture() :
+    root( Core::instance().root() )
+  {
+  }
+
+  /// Generate a square or a cube, distributed over all ranks
+  Mesh& generate(const std::string& name, const Uint dim, const Uint nb_cells)
+  {
+    boost::shared_ptr<MeshGenerator> generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator", "generate_" + name);
+    generator->options().set("mesh", root.uri()/name);
+    generator->options().set("lengths", std::vector<Real>(dim, 1.));
+    generator->options().set("nb_cells", std::vector<Uint>(dim, nb_cells));
+    return generator->generate();
+  }
+
+  /// Build the sparsity of the whole mesh and check it against the node pairs of each element
+  void check_sparsity(Mesh& mesh)
+  {
+    const Dictionary& dict = mesh.geometry_fields();
+    const Uint my_rank = PE::Comm::instance().rank();
+    const Uint nb_procs = PE::Comm::instance().size();
+
+    std::vector<Uint> node_connectivity, start_indices;
+    boost::shared_ptr< List<Uint> > gids = allocate_component< List<Uint> >("GIDs");
+    boost::shared_ptr< List<Uint> > ranks = allocate_component< List<Uint> >("Ranks");
+    boost::shared_ptr< List<Uint> > used_node_map = allocate_component< List<Uint> >("used_node_map");
+    boost::shared_ptr< List<Uint> > used_nodes = UFEM::build_sparsity(std::vector< Handle<Region> >(1, mesh.topology().handle<Region>()), dict, node_connectivity, start_indices, *gids, *ranks, *used_node_map);
+
+    // Brute force: every pair of nodes sharing an element, in the numbering of the dictionary
+    std::map< Uint, std::set<Uint> > brute_force;
+    BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    {
+      BOOST_FOREACH(const Connectivity::ConstRow row, elements.geometry_space().connectivity().array())
+      {
+        BOOST_FOREACH(const Uint a, row)
+        {
+          BOOST_FOREACH(const Uint b, row)
+          {
+            brute_force[a].insert(b);
+          }
+        }
+      }
+    }
+
+    const Uint nb_used_nodes = used_nodes->size();
+    BOOST_REQUIRE_EQUAL(nb_used_nodes, brute_force.size());
+    BOOST_REQUIRE_EQUAL(start_indices.size(), nb_used_nodes+1);
+    BOOST_CHECK_EQUAL(start_indices.front(), 0u);
+    BOOST_CHECK_EQUAL(start_indices.back(), node_connectivity.size());
+    BOOST_REQUIRE_EQUAL(gids->size(), nb_used_nodes);
+    BOOST_REQUIRE_EQUAL(ranks->size(), nb_used_nodes);
+
+    Uint nb_ghosts = 0;
+    std::vector<Uint> owned_gids; // pairs of (dictionary GID, new GID) for the nodes owned by this rank
+    Uint i = 0;
+    for(std::map< Uint, std::set<Uint> >::const_iterator it = brute_force.begin(); it != brute_force.end(); ++it, ++i)
+    {
+      // The used nodes are sorted, so they come in the same order as the map keys
+      BOOST_CHECK_EQUAL((*used_nodes)[i], it->first);
+      BOOST_CHECK_EQUAL((*used_node_map)[it->first], i);
+      BOOST_CHECK_EQUAL((*ranks)[i], dict.rank()[it->first]);
+
+      // Rows are sorted on the used node index, which sorts them on the dictionary index as well
+      std::vector<Uint> row;
+      for(Uint j = start_indices[i]; j != start_indices[i+1]; ++j)
+        row.push_back((*used_nodes)[node_connectivity[j]]);
+      BOOST_CHECK_EQUAL_COLLECTIONS(row.begin(), row.end(), it->second.begin(), it->second.end());
+
+      if((*ranks)[i] == my_rank)
+      {
+        owned_gids.push_back(dict.glb_idx()[it->first]);
+        owned_gids.push_back((*gids)[i]);
+      }
+      else
+      {
+        ++nb_ghosts;
+      }
+    }
+
+    if(nb_procs > 1)
+      BOOST_CHECK(nb_ghosts > 0);
+    else
+      BOOST_CHECK_EQUAL(nb_ghosts, 0u);
+
+    // The new GIDs of the owned nodes are contiguous, starting after the nodes of the lower ranks
+    std::vector< std::vector<Uint> > all_owned_gids;
+    PE::Comm::instance().all_gather(owned_gids, all_owned_gids);
+    BOOST_REQUIRE_EQUAL(all_owned_gids.size(), nb_procs);
+    Uint first_gid = 0;
+    for(Uint rank = 0; rank != my_rank; ++rank)
+      first_gid += all_owned_gids[rank].size() / 2;
+    for(Uint k = 0; k != owned_gids.size() / 2; ++k)
+      BOOST_CHECK_EQUAL(owned_gids[2*k+1], first_gid + k);
+
+    // Ghosts get the new GID given by their owner
+    std::map<Uint, Uint> new_gids;
+    BOOST_FOREACH(const std::vector<Uint>& rank_gids, all_owned_gids)
+    {
+      for(Uint k = 0; k != rank_gids.size() / 2; ++k)
+        new_gids[rank_gids[2*k]] = rank_gids[2*k+1];
+    }
+    for(i = 0; i != nb_used_nodes; ++i)
+    {
+      const Uint dict_gid = dict.glb_idx()[(*used_nodes)[i]];
+      BOOST_REQUIRE(new_gids.count(dict_gid));
+      BOOST_CHECK_EQUAL((*gids)[i], new_gids[dict_gid]);
+    }
+  }
+
+  Component& root;
+};
+
+BOOST_FIXTURE_TEST_SUITE( UFEMSparsityParallelSuite, UFEMSparsityParallelFixture )
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  common::PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK(common::PE::Comm::instance().size() <= 2);
+}
+
+BOOST_AUTO_TEST_CASE( Quads )
+{
+  check_sparsity(generate("quads", DIM_2D, 8));
+}
+
+BOOST_AUTO_TEST_CASE( Hexas )
+{
+  check_sparsity(generate("hexas", DIM_3D, 4));
+}
+
+BOOST_AUTO_TEST_CASE( Tetras )
+{
+  Mesh& mesh = generate("tetras", DIM_3D, 4);
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.MeshTriangulator", "triangulator")->transform(mesh);
+  check_sparsity(mesh);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  common::PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
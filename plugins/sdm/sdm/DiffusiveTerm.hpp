@@ -352,6 +352,9 @@ void DiffusiveTerm<PHYSDATA>::set_entities(const mesh::Entities& entities)
   Term::set_entities(entities);
 
   elem->cache(m_entities);
+  // the option is read when the cache is first configured for these entities
+  if (m_precompute_geometry)
+    flx_pt_plane_jacobian_normal->options().set("precompute",true);
   flx_pt_plane_jacobian_normal->cache(m_entities);
 
   sol_pt_wave_speed.resize(NDIM,std::vector< RealVector1 >(elem->get().sf->nb_sol_pts()));
@@ -9,12 +9,15 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "common/Core.hpp"
+#include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
 #include "common/StringConversion.hpp"
 
 #include "math/Consts.hpp"
 
 #include "mesh/Entities.hpp"
+#include "mesh/Tags.hpp"
 
 #include "sdm/ShapeFunction.hpp"
 
@@ -125,7 +128,9 @@ public:
   CacheT(const std::string& name) :
     Cache(name),
     m_cache(nullptr)
-  { }
+  {
+    common::Core::instance().event_handler().connect_to_event( mesh::Tags::event_mesh_changed(), this, &CacheT::on_mesh_changed_event );
+  }
   static std::string type_name() { return "Cache"; }
 
   void add_options()
@@ -207,6 +212,14 @@ public:
     return get();
   }
 
+  /// The element caches may hold data of entities that changed or no longer exist,
+  /// they are created again on their next access
+  void on_mesh_changed_event( common::SignalArgs& args )
+  {
+    m_element_caches.clear();
+    m_cache = nullptr;
+  }
+
   ElementCacheT& get()
   {
     cf3_assert(is_not_null(m_cache));
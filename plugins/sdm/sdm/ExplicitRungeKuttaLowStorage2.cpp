@@ -21,9 +21,8 @@
 #include "solver/Solver.hpp"
 
 #include "mesh/Field.hpp"
+#include "mesh/FieldExpression.hpp"
 #include "mesh/FieldManager.hpp"
-#include "mesh/Space.hpp"
-#include "mesh/Connectivity.hpp"
 
 #include "sdm/ExplicitRungeKuttaLowStorage2.hpp"
 #include "sdm/Tags.hpp"
@@ -235,22 +234,7 @@ void ExplicitRungeKuttaLowStorage2::execute()
     // - time.dt()
 
     const Real one_minus_alpha = 1. - alpha[stage];
-    boost_foreach(const Handle<Entities>& elements_handle, U.entities_range())
-    {
-      Entities& elements = *elements_handle;
-      const Connectivity& space_connectivity = U.space(elements).connectivity();
-
-      for (Uint e=0; e<elements.size(); ++e)
-      {
-        boost_foreach(const Uint state, space_connectivity[e])
-        {
-          for (Uint var=0; var<U.row_size(); ++var)
-          {
-            U[state][var] = one_minus_alpha*U0[state][var] + alpha[stage]*U[state][var] + beta[stage]*H[state][0]*R[state][var];
-          }
-        }
-      }
-    }
+    field_expression::assign(U, one_minus_alpha*U0 + alpha[stage]*U + beta[stage]*(H*R), m_nb_threads);
 
     // U has now been updated
 
@@ -45,7 +45,8 @@ namespace sdm {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 IterativeSolver::IterativeSolver ( const std::string& name ) :
-  solver::Action(name)
+  solver::Action(name),
+  m_nb_threads(1)
 {
   mark_basic();
 
@@ -79,6 +80,11 @@ IterativeSolver::IterativeSolver ( const std::string& name ) :
       .pretty_name("Time")
       .link_to(&m_time);
 
+  options().add("nb_threads", m_nb_threads)
+      .description("Number of threads used for the solution updates")
+      .pretty_name("Number of Threads")
+      .link_to(&m_nb_threads);
+
   ComputeLNorm& cnorm = *create_static_component<ComputeLNorm>( "ComputeNorm" );
   cnorm.options().set("order",2u);
   cnorm.options().set("scale",true);
@@ -56,6 +56,7 @@ protected: // data
   Handle<mesh::Field> m_residual;        //!< Residual field
   Handle<mesh::Field> m_update_coeff;    //!< Update coefficient field
   Handle<solver::Time> m_time;           //!< Time component
+  Uint m_nb_threads;                     //!< Number of threads used for the solution updates
 
   /// set of actions called every iteration before non-linear solve
   Handle<common::ActionDirector> m_pre_update;
@@ -115,6 +115,7 @@ struct FluxPointPlaneJacobianNormal : ElementCache
   static void add_options(Cache& cache)
   {
     cache.options().add("space",Handle<mesh::Dictionary>()).description("path to Dictionary");
+    cache.options().add("precompute",false).description("Compute the plane-jacobian normals of all elements once and store them (static meshes only)");
   }
 
 private:
@@ -127,9 +128,59 @@ private:
     plane_jacobian_normal.resize(sf->nb_flx_pts());
     plane_jacobian.resize(sf->nb_flx_pts());
     plane_unit_normal.resize(sf->nb_flx_pts());
+
+    stored_plane_jacobian_normal.clear();
+    stored_plane_jacobian.clear();
+    if (options().option("precompute").template value<bool>())
+      precompute();
   }
 
   virtual void compute_variable_data()
+  {
+    if (stored_plane_jacobian.empty())
+    {
+      compute_plane_jacobian_normals();
+      return;
+    }
+
+    // the entities were resized in place, without a mesh_changed event
+    const Uint nb_flx_pts = sf->nb_flx_pts();
+    if (stored_plane_jacobian.size() != entities->size()*nb_flx_pts)
+      precompute();
+
+    // copy from the precomputed storage
+    const Real* normal = &stored_plane_jacobian_normal[idx*nb_flx_pts*NDIM];
+    const Real* jacobian = &stored_plane_jacobian[idx*nb_flx_pts];
+    for (Uint f=0; f<nb_flx_pts; ++f)
+    {
+      for (Uint d=0; d<NDIM; ++d)
+        plane_jacobian_normal[f][d] = normal[f*NDIM+d];
+      plane_jacobian[f] = jacobian[f];
+      plane_unit_normal[f] = plane_jacobian_normal[f]/plane_jacobian[f];
+    }
+  }
+
+  /// Compute the plane-jacobian normals of all elements, and store them contiguously per element
+  void precompute()
+  {
+    const Uint nb_flx_pts = sf->nb_flx_pts();
+    stored_plane_jacobian_normal.resize(entities->size()*nb_flx_pts*NDIM);
+    stored_plane_jacobian.resize(entities->size()*nb_flx_pts);
+    const Uint current_idx = idx;
+    for (idx=0; idx<entities->size(); ++idx)
+    {
+      compute_plane_jacobian_normals();
+      for (Uint f=0; f<nb_flx_pts; ++f)
+      {
+        for (Uint d=0; d<NDIM; ++d)
+          stored_plane_jacobian_normal[(idx*nb_flx_pts+f)*NDIM+d] = plane_jacobian_normal[f][d];
+        stored_plane_jacobian[idx*nb_flx_pts+f] = plane_jacobian[f];
+      }
+    }
+    idx = current_idx;
+  }
+
+  void compute_plane_jacobian_normals()
   {
     geo.compute_element(idx); // computes geo.nodes, for use of plane_jacobian normals
 
@@ -162,6 +213,12 @@ public:
   std::vector<coord_t, Eigen::aligned_allocator<coord_t> >      plane_jacobian_normal;
   std::vector<Real>         plane_jacobian;
   std::vector<coord_t, Eigen::aligned_allocator<coord_t> >      plane_unit_normal;
+
+private:
+  // precomputed state, empty unless the "precompute" option is set.
+  // The CacheT owning this object drops it on the mesh_changed event, so it is rebuilt for the new mesh.
+  std::vector<Real> stored_plane_jacobian_normal;  ///< [elem][flx_pt][dim]
+  std::vector<Real> stored_plane_jacobian;         ///< [elem][flx_pt]
 };
 
 ////////////////////////////////////////////////////////////////////////////////
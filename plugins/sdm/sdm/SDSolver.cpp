@@ -155,8 +155,10 @@ void SDSolver::execute()
   // Start time stepping
   m_time_stepping->execute();
   Component& solution_space = *mesh().get_child("solution_space");
+  std::vector< Handle<Field> > fields;
   boost_foreach(mesh::Field& field,  find_components_recursively<Field>(solution_space))
-    field.synchronize();
+    fields.push_back(field.handle<Field>());
+  synchronize_fields(fields);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
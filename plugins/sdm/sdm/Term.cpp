@@ -41,7 +41,8 @@ namespace sdm {
 
 Term::Term ( const std::string& name ) :
   cf3::solver::Action(name),
-  m_compute_wave_speed(true)
+  m_compute_wave_speed(true),
+  m_precompute_geometry(false)
 {
   mark_basic();
 
@@ -65,6 +66,11 @@ Term::Term ( const std::string& name ) :
       .pretty_name("Share Caches")
       .link_to(&m_shared_caches);
 
+  options().add("precompute_geometry", m_precompute_geometry)
+      .pretty_name("Precompute Geometry")
+      .description("Store the flux-point plane-jacobian normals of all elements at initialization (static meshes only)")
+      .link_to(&m_precompute_geometry);
+
   options().option(sdm::Tags::physical_model()).attach_trigger( boost::bind ( &Term::trigger_physical_model, this ) );
 
 }
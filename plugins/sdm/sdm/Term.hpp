@@ -107,6 +107,10 @@ protected: // data
   ///        - less accurate (mostly for shocks)
   ///        - WARNING: Must be computed somewhere else!!!!!!!!!
   bool m_compute_wave_speed;
+
+  /// Store the flux-point geometry of all elements at initialization,
+  /// instead of recomputing it for every element visit (static meshes only)
+  bool m_precompute_geometry;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +18,7 @@
 #include "solver/Solver.hpp"
 
 #include "mesh/Field.hpp"
+#include "mesh/FieldExpression.hpp"
 #include "mesh/FieldManager.hpp"
 
 #include "sdm/SDSolver.hpp"
@@ -157,56 +158,25 @@ void ExplicitRungeKuttaBase::execute()
     // - H
     // - time.dt()
 
+    // R = sum( coeff_j * R_j ) and U = U0 + H*R, each in a single fused pass
+    field_expression::LinearCombination stage_residuals(R.size());
     if (stage != last_stage)  // update solution for next stage
     {
       Uint next_stage = stage+1;
       /// U(s+1) = U(n) + h * sum( asj * Rj )
       /// R = sum( asj * Rj )
-      U = U0;
-      R = 0;
-      Real r;
       for (Uint j=0; j<next_stage; ++j)
-      {
-        Real a = butcher.a(next_stage,j);
-        if (a != 0)
-        {
-          const Field& R_j = (*m_residuals[j]);  // R from previous stages
-          for (Uint pt=0; pt<U.size(); ++pt)
-          {
-            for (Uint v=0; v<U.row_size(); ++v)
-            {
-              r =  a * R_j[pt][v];
-              R[pt][v] += r;
-              U[pt][v] += H[pt][0] * r;
-            }
-          }
-        }
-      }
+        stage_residuals.add(butcher.a(next_stage,j), *m_residuals[j]);
     }
     else // weighted average of all stages forms final solution
     {
       /// U(n+1) = U(n) + h * sum( bj * Rj )
       /// R = sum( bj * Rj )
-      U = U0;
-      R = 0.;
-      Real r;
       for (Uint j=0; j<nb_stages; ++j)
-      {
-        if (butcher.b(j)!=0)
-        {
-          const Field& R_j = (*m_residuals[j]);  // R from previous stages
-          for (Uint pt=0; pt<U.size(); ++pt)
-          {
-            for (Uint v=0; v<U.row_size(); ++v)
-            {
-              r = butcher.b(j) * R_j[pt][v];
-              R[pt][v] += r;
-              U[pt][v] += H[pt][0] * r;
-            }
-          }
-        }
-      }
+        stage_residuals.add(butcher.b(j), *m_residuals[j]);
     }
+    field_expression::assign(R, stage_residuals, m_nb_threads);
+    field_expression::assign(U, U0 + H*R, m_nb_threads);
 
     // U has now been updated
 
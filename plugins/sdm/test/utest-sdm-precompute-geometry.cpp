@@ -0,0 +1,199 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the precomputed geometry of cf3::sdm"
+
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/assign/list_of.hpp>
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+#include "common/Link.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/Consts.hpp"
+
+#include "solver/Model.hpp"
+
+#include "mesh/Cells.hpp"
+#include "mesh/Domain.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/FieldManager.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/Region.hpp"
+
+#include "sdm/SDSolver.hpp"
+#include "sdm/Term.hpp"
+#include "sdm/Tags.hpp"
+#include "sdm/DomainDiscretization.hpp"
+#include "sdm/ElementCaching.hpp"
+#include "sdm/Operations.hpp"
+
+using namespace boost::assign;
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+using namespace cf3::sdm;
+
+/// Move the nodes of the mesh, keeping its boundary in place, so that no two elements have the same normals
+void distort(Mesh& mesh, const Real amplitude)
+{
+  Field& coordinates = mesh.geometry_fields().coordinates();
+  for (Uint n=0; n<coordinates.size(); ++n)
+  {
+    const Real x = coordinates[n][XX];
+    const Real y = coordinates[n][YY];
+    const Real bump = amplitude * std::sin(Consts::pi()*x/4.) * std::sin(Consts::pi()*y/4.);
+    coordinates[n][XX] += bump;
+    coordinates[n][YY] += 0.5*bump;
+  }
+}
+
+/// Set up a convection-diffusion problem on a distorted mesh, and compute its residual once
+SDSolver& compute_residual(const std::string& name, const bool precompute_geometry)
+{
+  Model& model   = *Core::instance().root().create_component<Model>(name);
+  model.setup("cf3.sdm.SDSolver","cf3.physics.Scalar.Scalar2D");
+  SDSolver& solver  = *model.solver().handle<SDSolver>();
+  Domain&   domain  = model.domain();
+
+  Mesh& mesh = *domain.create_component<Mesh>("mesh");
+  std::vector<Uint> nb_cells = list_of( 4 )( 4 );
+  std::vector<Real> lengths  = list_of( 4.)( 4.);
+  SimpleMeshGenerator& generate_mesh = *domain.create_component<SimpleMeshGenerator>("generate_mesh");
+  generate_mesh.options().set("mesh",mesh.uri());
+  generate_mesh.options().set("nb_cells",nb_cells);
+  generate_mesh.options().set("lengths",lengths);
+  generate_mesh.execute();
+  distort(mesh,0.3);
+
+  solver.options().set(sdm::Tags::mesh(),mesh.handle<Mesh>());
+  solver.options().set(sdm::Tags::solution_vars(),std::string("cf3.physics.Scalar.LinearAdv2D"));
+  solver.options().set(sdm::Tags::solution_order(),3u);
+  solver.prepare_mesh().execute();
+
+  solver::Action& init = solver.initial_conditions().create_initial_condition("init");
+  init.options().set("functions",std::vector<std::string>(1,"sin(x)*cos(y)"));
+  init.execute();
+
+  std::vector<Real> advection_speed = list_of( 1. )( 0.5 );
+  Term& convection = solver.domain_discretization().create_term("cf3.sdm.scalar.LinearAdvection2D","convection");
+  convection.options().set("advection_speed",advection_speed);
+  Term& diffusion = solver.domain_discretization().create_term("cf3.sdm.scalar.Diffusion2D","diffusion");
+  diffusion.options().set("mu",0.1);
+  if (precompute_geometry)
+  {
+    convection.options().set("precompute_geometry",true);
+    diffusion.options().set("precompute_geometry",true);
+  }
+
+  solver.domain_discretization().execute();
+  return solver;
+}
+
+/// Residual computed by the solver
+const Field& residual(SDSolver& solver)
+{
+  return *follow_link(solver.field_manager().get_child(sdm::Tags::residual()))->handle<Field>();
+}
+
+/// Check the plane-jacobian normals of a precomputed cache against freshly computed ones, for all cells of the mesh
+void check_normals(FluxPointPlaneJacobianNormal<2>::cache_type& precomputed, FluxPointPlaneJacobianNormal<2>::cache_type& computed, const Mesh& mesh)
+{
+  boost_foreach(const Cells& cells, find_components_recursively<Cells>(mesh.topology()))
+  {
+    const Handle<Entities const> entities(cells.handle<Entities>());
+    for (Uint e=0; e<cells.size(); ++e)
+    {
+      FluxPointPlaneJacobianNormal<2>& stored = precomputed.cache(entities,e);
+      FluxPointPlaneJacobianNormal<2>& fresh = computed.cache(entities,e);
+      for (Uint f=0; f<fresh.plane_jacobian.size(); ++f)
+      {
+        BOOST_CHECK_CLOSE(stored.plane_jacobian[f], fresh.plane_jacobian[f], 1e-10);
+        BOOST_CHECK_SMALL((stored.plane_jacobian_normal[f] - fresh.plane_jacobian_normal[f]).norm(), 1e-12);
+      }
+      stored.unlock();
+      fresh.unlock();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( sdm_precompute_geometry_TestSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc,boost::unit_test::framework::master_test_suite().argv);
+  Core::instance().environment().options().set("log_level", (Uint)INFO);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( same_residual )
+{
+  const Field& computed    = residual(compute_residual("computed",false));
+  const Field& precomputed = residual(compute_residual("precomputed",true));
+
+  BOOST_REQUIRE_EQUAL(precomputed.size(), computed.size());
+  Real max_residual = 0.;
+  for (Uint i=0; i<computed.size(); ++i)
+    max_residual = std::max(max_residual, std::abs(computed[i][0]));
+  BOOST_CHECK(max_residual > 1e-3);
+
+  for (Uint i=0; i<computed.size(); ++i)
+    BOOST_CHECK_SMALL(precomputed[i][0] - computed[i][0], 1e-12*max_residual);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( rebuilt_after_mesh_changed )
+{
+  Model& model = *Handle<Model>(Core::instance().root().get_child("precomputed"));
+  Mesh& mesh = *Handle<Mesh>(model.domain().get_child("mesh"));
+  const Handle<Dictionary> space = residual(*model.solver().handle<SDSolver>()).dict().handle<Dictionary>();
+
+  SharedCaches& caches = *Core::instance().root().create_component<SharedCaches>("caches");
+  FluxPointPlaneJacobianNormal<2>::cache_type& precomputed = *caches.get_cache< FluxPointPlaneJacobianNormal<2> >("precomputed");
+  FluxPointPlaneJacobianNormal<2>::cache_type& computed = *caches.get_cache< FluxPointPlaneJacobianNormal<2> >("computed");
+  precomputed.options().set("space",space);
+  precomputed.options().set("precompute",true);
+  computed.options().set("space",space);
+  check_normals(precomputed,computed,mesh);
+
+  // The solver does not support changing its mesh, only the caches are kept
+  model.remove_component("solver");
+
+  // Without the event the precomputed normals would still be those of the old node positions
+  distort(mesh,0.2);
+  mesh.raise_mesh_changed();
+  check_normals(precomputed,computed,mesh);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
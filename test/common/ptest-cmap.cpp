@@ -0,0 +1,107 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the sorted Map against the HashMap, as global to local index"
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/cstdint.hpp>
+
+#include "common/CF.hpp"
+#include "common/HashMap.hpp"
+#include "common/Map.hpp"
+
+#include "Tools/Testing/TimedTestFixture.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::Tools::Testing;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Global index of the local index i, in reverse order as if they were received from another process
+boost::uint64_t global_index(const Uint i, const Uint nb_keys)
+{
+  return 7*static_cast<boost::uint64_t>(nb_keys-i);
+}
+
+/// Sum of all local indices, which the lookups must give back
+boost::uint64_t expected_sum(const Uint nb_keys)
+{
+  return static_cast<boost::uint64_t>(nb_keys)*(nb_keys-1)/2;
+}
+
+/// Build the map in bulk, then look up every global index
+void build_and_lookup(Map<boost::uint64_t,Uint>& map, const Uint nb_keys)
+{
+  map.reserve(nb_keys);
+  for(Uint i = 0; i != nb_keys; ++i)
+    map.push_back(global_index(i,nb_keys), i);
+  map.sort_keys();
+
+  boost::uint64_t sum = 0;
+  for(Uint i = 0; i != nb_keys; ++i)
+    sum += map[global_index(i,nb_keys)];
+  BOOST_CHECK_EQUAL(sum, expected_sum(nb_keys));
+}
+
+/// Build the map in bulk, then look up every global index
+void build_and_lookup(HashMap<boost::uint64_t,Uint>& map, const Uint nb_keys)
+{
+  map.reserve(nb_keys);
+  for(Uint i = 0; i != nb_keys; ++i)
+    map.push_back(global_index(i,nb_keys), i);
+
+  boost::uint64_t sum = 0;
+  for(Uint i = 0; i != nb_keys; ++i)
+    sum += map[global_index(i,nb_keys)];
+  BOOST_CHECK_EQUAL(sum, expected_sum(nb_keys));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( MapBenchmarkSuite, TimedTestFixture )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Map_1M )
+{
+  boost::shared_ptr< Map<boost::uint64_t,Uint> > map = allocate_component< Map<boost::uint64_t,Uint> >("map");
+  restart_timer();
+  build_and_lookup(*map, 1000000);
+}
+
+BOOST_AUTO_TEST_CASE( HashMap_1M )
+{
+  boost::shared_ptr< HashMap<boost::uint64_t,Uint> > map = allocate_component< HashMap<boost::uint64_t,Uint> >("hash_map");
+  restart_timer();
+  build_and_lookup(*map, 1000000);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// The size of glb_to_loc in the large mesh redistributions
+
+BOOST_AUTO_TEST_CASE( Map_10M )
+{
+  boost::shared_ptr< Map<boost::uint64_t,Uint> > map = allocate_component< Map<boost::uint64_t,Uint> >("map");
+  restart_timer();
+  build_and_lookup(*map, 10000000);
+}
+
+BOOST_AUTO_TEST_CASE( HashMap_10M )
+{
+  boost::shared_ptr< HashMap<boost::uint64_t,Uint> > map = allocate_component< HashMap<boost::uint64_t,Uint> >("hash_map");
+  restart_timer();
+  build_and_lookup(*map, 10000000);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//////////////////////////////////////////////////////////////////////////////
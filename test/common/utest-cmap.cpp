@@ -9,7 +9,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <boost/cstdint.hpp>
+
 #include "common/CF.hpp"
+#include "common/HashMap.hpp"
 #include "common/Map.hpp"
 #include "common/Log.hpp"
 #include "common/Foreach.hpp"
@@ -155,6 +158,74 @@ BOOST_AUTO_TEST_CASE ( test_Map_copy_std_map )
   BOOST_CHECK_EQUAL(map["third"], 3);
 }
 
+BOOST_AUTO_TEST_CASE ( test_HashMap )
+{
+  boost::shared_ptr< HashMap<std::string,Uint> > map_ptr ( allocate_component< HashMap<std::string,Uint> > ("map"));
+  HashMap<std::string,Uint>& map = *map_ptr;
+
+  BOOST_CHECK_EQUAL(map.type_name() , "HashMap<string,unsigned>");
+
+  BOOST_CHECK(map.find("first") == map.end());
+
+  map.push_back(std::string("first"), (Uint) 1);
+  BOOST_CHECK_EQUAL(map.size() , 1u);
+  BOOST_CHECK_EQUAL(map["first"] , 1u);
+  map["second"] = 2;
+  BOOST_CHECK_EQUAL(map.size() , 2u);
+  BOOST_CHECK_EQUAL(map["second"] , 2u);
+
+  // lookups work without sorting, also in the const version
+  const HashMap<std::string,Uint>& const_map = *map_ptr;
+  BOOST_CHECK_EQUAL(const_map["first"] , 1u);
+  BOOST_CHECK(const_map.exists("second"));
+  BOOST_CHECK(!const_map.exists("third"));
+
+  std::pair<HashMap<std::string,Uint>::iterator,bool> ret;
+  ret = map.insert(std::make_pair("third",3u));
+  BOOST_CHECK_EQUAL(ret.second, true);
+  BOOST_CHECK_EQUAL(ret.first->second, 3u);
+  ret = map.insert(std::make_pair("third",1000u));
+  BOOST_CHECK_EQUAL(ret.second, false);
+  BOOST_CHECK_EQUAL(ret.first->second, 3u);
+
+  BOOST_CHECK(map.erase("first"));
+  BOOST_CHECK(!map.erase("first"));
+  BOOST_CHECK_EQUAL(map.size() , 2u);
+  BOOST_CHECK_EQUAL(map["second"] , 2u);
+  BOOST_CHECK_EQUAL(map["third"] , 3u);
+
+  std::map<std::string,Uint> stl_map;
+  stl_map["a"] = 1;
+  stl_map["b"] = 2;
+  map.copy_std_map(stl_map);
+  BOOST_CHECK_EQUAL(map.size(), 2u);
+  BOOST_CHECK_EQUAL(map["b"], 2u);
+  BOOST_CHECK(map.find("third") == map.end());
+}
+
+BOOST_AUTO_TEST_CASE ( test_HashMap_erase )
+{
+  boost::shared_ptr< HashMap<boost::uint64_t,Uint> > map_ptr ( allocate_component< HashMap<boost::uint64_t,Uint> > ("map"));
+  HashMap<boost::uint64_t,Uint>& map = *map_ptr;
+
+  const Uint nb_keys = 10000;
+  for(Uint i = 0; i != nb_keys; ++i)
+    map.push_back(3*i, i);
+
+  // erase every other key, which exercises the backward shifting of colliding keys
+  for(Uint i = 0; i < nb_keys; i += 2)
+    BOOST_CHECK(map.erase(3*i));
+
+  BOOST_CHECK_EQUAL(map.size(), nb_keys/2);
+  for(Uint i = 0; i != nb_keys; ++i)
+  {
+    if(i % 2)
+      BOOST_CHECK_EQUAL(map[3*i], i);
+    else
+      BOOST_CHECK(!map.exists(3*i));
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 
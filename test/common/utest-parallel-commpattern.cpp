@@ -26,6 +26,7 @@
 #include "common/PE/CommPattern.hpp"
 #include "common/PE/debug.hpp"
 #include "common/Group.hpp"
+#include "common/OptionList.hpp"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -212,6 +213,126 @@ BOOST_AUTO_TEST_CASE( commpattern_mainstream )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( commpattern_neighbour_exchange )
+{
+  // general constants in this routine
+  const int nproc=PE::Comm::instance().size();
+  const int irank=PE::Comm::instance().rank();
+
+  // one commpattern with all_to_all and one with the neighbour exchange
+  boost::shared_ptr<CommPattern> ref_ptr = allocate_component<CommPattern>("RefCommPattern");
+  boost::shared_ptr<CommPattern> pecp_ptr = allocate_component<CommPattern>("CommPattern");
+  CommPattern& ref = *ref_ptr;
+  CommPattern& pecp = *pecp_ptr;
+  ref.options().set("neighbour_exchange",false);
+  pecp.options().set("neighbour_exchange",true);
+
+  // setup gid & rank
+  std::vector<Uint> ref_gid, gid;
+  std::vector<Uint> ref_rank, rank;
+  setupGidAndRank(ref_gid,ref_rank);
+  setupGidAndRank(gid,rank);
+  ref.insert("gid",ref_gid,1,false);
+  pecp.insert("gid",gid,1,false);
+
+  // additional arrays for testing
+  std::vector<int> ref_v1, v1;
+  for(int i=0;i<6*nproc;i++) ref_v1.push_back(-((irank+1)*1000+i+1));
+  v1=ref_v1;
+  ref.insert("v1",ref_v1,1,true);
+  pecp.insert("v1",v1,1,true);
+  std::vector<double> ref_v2, v2;
+  for(int i=0;i<12*nproc;i++) ref_v2.push_back((double)((irank+1)*1000+i+1));
+  v2=ref_v2;
+  ref.insert("v2",ref_v2,2,true);
+  pecp.insert("v2",v2,2,true);
+
+  ref.setup(Handle<CommWrapper>(ref.get_child("gid")),ref_rank);
+  pecp.setup(Handle<CommWrapper>(pecp.get_child("gid")),rank);
+
+  // neighbours exclude the current rank
+  BOOST_FOREACH(const int nb, pecp.send_neighbours()) BOOST_CHECK_NE( nb, irank );
+  BOOST_FOREACH(const int nb, pecp.recv_neighbours()) BOOST_CHECK_NE( nb, irank );
+
+  // blocking synchronization gives the same result as all_to_all
+  ref.synchronize_all();
+  pecp.synchronize("v1");
+  BOOST_CHECK( v1 == ref_v1 );
+
+  // split synchronization, ghosts are only updated at finish
+  pecp.start_synchronize("v2");
+  BOOST_CHECK( pecp.is_synchronizing() );
+  BOOST_CHECK_THROW( pecp.start_synchronize("v1"), ShouldNotBeHere );
+  pecp.finish_synchronize();
+  BOOST_CHECK( !pecp.is_synchronizing() );
+  BOOST_CHECK( v2 == ref_v2 );
+
+  // finishing without a pending exchange is harmless
+  pecp.finish_synchronize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( commpattern_batched_synchronization )
+{
+  // general constants in this routine
+  const int nproc=PE::Comm::instance().size();
+  const int irank=PE::Comm::instance().rank();
+
+  boost::shared_ptr<CommPattern> ref_ptr = allocate_component<CommPattern>("RefCommPattern");
+  boost::shared_ptr<CommPattern> pecp_ptr = allocate_component<CommPattern>("CommPattern");
+  CommPattern& ref = *ref_ptr;
+  CommPattern& pecp = *pecp_ptr;
+  ref.options().set("neighbour_exchange",false);
+
+  // setup gid & rank
+  std::vector<Uint> ref_gid, gid;
+  std::vector<Uint> ref_rank, rank;
+  setupGidAndRank(ref_gid,ref_rank);
+  setupGidAndRank(gid,rank);
+  ref.insert("gid",ref_gid,1,false);
+  pecp.insert("gid",gid,1,false);
+
+  // arrays of different types and strides, packed together in one message
+  std::vector<int> ref_v1, v1;
+  for(int i=0;i<6*nproc;i++) ref_v1.push_back(-((irank+1)*1000+i+1));
+  v1=ref_v1;
+  ref.insert("v1",ref_v1,1,true);
+  pecp.insert("v1",v1,1,true);
+  std::vector<double> ref_v2, v2;
+  for(int i=0;i<12*nproc;i++) ref_v2.push_back((double)((irank+1)*1000+i+1));
+  v2=ref_v2;
+  ref.insert("v2",ref_v2,2,true);
+  pecp.insert("v2",v2,2,true);
+  std::vector<double> ref_v3, v3;
+  for(int i=0;i<18*nproc;i++) ref_v3.push_back((double)(-(irank+1)*100-i));
+  v3=ref_v3;
+  ref.insert("v3",ref_v3,3,true);
+  pecp.insert("v3",v3,3,true);
+
+  ref.setup(Handle<CommWrapper>(ref.get_child("gid")),ref_rank);
+  pecp.setup(Handle<CommWrapper>(pecp.get_child("gid")),rank);
+
+  ref.synchronize_all();
+
+  // named group, gid does not need update and is skipped
+  std::vector<std::string> names;
+  names.push_back("v3");
+  names.push_back("gid");
+  names.push_back("v1");
+  pecp.synchronize(names);
+  BOOST_CHECK( v1 == ref_v1 );
+  BOOST_CHECK( v3 == ref_v3 );
+
+  // all registered data in one exchange
+  pecp.synchronize_all();
+  BOOST_CHECK( v1 == ref_v1 );
+  BOOST_CHECK( v2 == ref_v2 );
+  BOOST_CHECK( v3 == ref_v3 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( commpattern_external_synchronization )
 {
 /*
@@ -0,0 +1,215 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the native block-CRS linear solver, distributed and threaded"
+
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "common/PE/CommWrapper.hpp"
+
+#include "math/MatrixTypes.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/System.hpp"
+#include "math/LSS/BlockCrs/BlockCrsMatrix.hpp"
+#include "math/LSS/BlockCrs/BlockCrsVector.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::common::PE;
+using namespace cf3::math;
+
+/// Two coupled equations per node
+const Uint neq = 2;
+
+/// Exact solution
+Real exact(const Uint node, const Uint eq)
+{
+  return eq == 0 ? std::sin(static_cast<Real>(node)) : std::cos(static_cast<Real>(node));
+}
+
+/// Symmetric positive definite element matrix [K -I; -I K], with coupled equations in K
+RealMatrix element_matrix()
+{
+  RealMatrix mat(2*neq, 2*neq);
+  mat.setZero();
+  mat(0,0) = mat(2,2) = 2.;
+  mat(1,1) = mat(3,3) = 1.5;
+  mat(0,1) = mat(1,0) = mat(2,3) = mat(3,2) = 0.5;
+  mat(0,2) = mat(2,0) = mat(1,3) = mat(3,1) = -1.;
+  return mat;
+}
+
+/// 1D chain of nodes, split in contiguous parts over the processes.
+/// Each process stores its own nodes and the neighbouring node of each adjacent process as a ghost,
+/// so all elements touching an owned node are available locally.
+struct DistributedChain
+{
+  DistributedChain(const std::string& name, const Uint nodes_per_rank)
+  {
+    const Uint rank = Comm::instance().rank();
+    const Uint nb_procs = Comm::instance().size();
+    nb_nodes = nodes_per_rank*nb_procs;
+
+    const Uint first = rank == 0 ? 0 : rank*nodes_per_rank - 1;
+    const Uint last = rank == nb_procs-1 ? nb_nodes : (rank+1)*nodes_per_rank + 1;
+    std::vector<Uint> rnk, conn, startidx;
+    startidx.push_back(0);
+    for(Uint i = first; i != last; ++i)
+    {
+      const Uint l = i - first;
+      gid.push_back(i);
+      rnk.push_back(i / nodes_per_rank);
+      if(i != first)
+        conn.push_back(l-1);
+      conn.push_back(l);
+      if(i != last-1)
+        conn.push_back(l+1);
+      startidx.push_back(conn.size());
+    }
+
+    Component& root = Core::instance().root();
+    lss = root.create_component<LSS::System>(name);
+    CommPattern& cp = *root.create_component<CommPattern>(name + "_commpattern");
+    cp.insert("gid",gid,1,false);
+    cp.setup(cp.get_child("gid")->handle<common::PE::CommWrapper>(),rnk);
+
+    lss->options().set("matrix_builder", std::string("cf3.math.LSS.BlockCrsMatrix"));
+    lss->options().set("solution_strategy", std::string("cf3.math.LSS.BlockCrsStrategy"));
+    lss->create(cp, neq, conn, startidx);
+
+    LSS::BlockAccumulator acc;
+    acc.resize(2, neq);
+    acc.mat = element_matrix();
+    for(Uint l = 0; l != gid.size()-1; ++l)
+    {
+      acc.indices[0] = l;
+      acc.indices[1] = l+1;
+      for(Uint j = 0; j != 2; ++j)
+        for(Uint eq = 0; eq != neq; ++eq)
+          acc.sol[j*neq+eq] = exact(gid[acc.indices[j]], eq);
+      acc.rhs = acc.mat * acc.sol;
+      lss->matrix()->add_values(acc);
+      lss->rhs()->add_rhs_values(acc);
+    }
+
+    matrix = Handle<LSS::BlockCrsMatrix>(lss->matrix());
+    BOOST_REQUIRE(is_not_null(matrix));
+  }
+
+  /// Product of the global matrix with the exact solution, at global node i
+  Real exact_product(const Uint i, const Uint eq) const
+  {
+    const RealMatrix mat = element_matrix();
+    Real result = 0.;
+    for(Uint e = (i == 0 ? 0 : i-1); e <= i && e+1 < nb_nodes; ++e)
+    {
+      const Uint row = (i == e ? 0 : neq) + eq;
+      for(Uint j = 0; j != 2; ++j)
+        for(Uint col = 0; col != neq; ++col)
+          result += mat(row, j*neq+col) * exact(e+j, col);
+    }
+    return result;
+  }
+
+  /// Check A x against the exact product, for x the exact solution with invalid ghost values
+  void check_apply()
+  {
+    std::vector<Real> x(gid.size()*neq), y;
+    for(Uint l = 0; l != gid.size(); ++l)
+      for(Uint eq = 0; eq != neq; ++eq)
+        x[l*neq+eq] = matrix->is_updatable(l) ? exact(gid[l], eq) : 1e10;
+    matrix->apply(x, y);
+    for(Uint l = 0; l != gid.size(); ++l)
+    {
+      if(!matrix->is_updatable(l))
+        continue;
+      for(Uint eq = 0; eq != neq; ++eq)
+        BOOST_CHECK_SMALL(y[l*neq+eq] - exact_product(gid[l], eq), 1e-10);
+    }
+  }
+
+  Handle<LSS::System> lss;
+  Handle<LSS::BlockCrsMatrix> matrix;
+  std::vector<Uint> gid;
+  Uint nb_nodes;
+};
+
+BOOST_AUTO_TEST_SUITE( BlockCrsParallelSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK(Comm::instance().size() > 1);
+}
+
+BOOST_AUTO_TEST_CASE( DistributedApply )
+{
+  DistributedChain chain("ApplyLSS", 20);
+  chain.check_apply();
+}
+
+BOOST_AUTO_TEST_CASE( DistributedSolve )
+{
+  DistributedChain chain("SolveLSS", 20);
+
+  Component& strategy = *chain.lss->solution_strategy();
+  strategy.options().set("tolerance", 1e-12);
+  strategy.options().set("solver", std::string("CG"));
+  strategy.options().set("preconditioner", std::string("BlockJacobi"));
+  chain.lss->solution()->reset(0.);
+  chain.lss->solve();
+
+  // The solve synchronizes the solution, so the ghost values are checked as well
+  for(Uint l = 0; l != chain.gid.size(); ++l)
+  {
+    for(Uint eq = 0; eq != neq; ++eq)
+    {
+      Real value;
+      chain.lss->solution()->get_value(l, eq, value);
+      BOOST_CHECK_SMALL(value - exact(chain.gid[l], eq), 1e-8);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ThreadedApply )
+{
+  // Enough rows on each process to split the product over 4 threads
+  DistributedChain chain("ThreadedLSS", 4*1024);
+  chain.matrix->options().set("nb_threads", 4u);
+  chain.check_apply();
+
+  // The threaded product equals the serial one exactly, each row is computed the same way
+  std::vector<Real> x(chain.gid.size()*neq), y_threaded, y_serial;
+  for(Uint i = 0; i != x.size(); ++i)
+    x[i] = std::cos(0.1*static_cast<Real>(chain.gid[i/neq]*neq + i%neq));
+  chain.matrix->apply(x, y_threaded);
+  chain.matrix->options().set("nb_threads", 1u);
+  chain.matrix->apply(x, y_serial);
+  BOOST_CHECK(y_threaded == y_serial);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
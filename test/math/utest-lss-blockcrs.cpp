@@ -0,0 +1,215 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the native block-CRS linear solver"
+
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+
+#include "common/PE/CommPattern.hpp"
+#include "common/PE/CommWrapper.hpp"
+
+#include "math/MatrixTypes.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/System.hpp"
+#include "math/LSS/Vector.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::common::PE;
+using namespace cf3::math;
+
+/// Number of nodes in the 1D chain
+const Uint nb_nodes = 40;
+
+/// Two coupled equations per node
+const Uint neq = 2;
+
+/// Exact solution
+Real exact(const Uint node, const Uint eq)
+{
+  return eq == 0 ? std::sin(static_cast<Real>(node)) : std::cos(static_cast<Real>(node));
+}
+
+BOOST_AUTO_TEST_SUITE( BlockCrsSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( SolveChain )
+{
+  Component& root = Core::instance().root();
+  Handle<LSS::System> lss = root.create_component<LSS::System>("LSS");
+  CommPattern& cp = *root.create_component<CommPattern>("commpattern");
+
+  std::vector<Uint> gid, rnk, conn, startidx;
+  startidx.push_back(0);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    gid.push_back(i);
+    rnk.push_back(0);
+    if(i != 0)
+      conn.push_back(i-1);
+    conn.push_back(i);
+    if(i != nb_nodes-1)
+      conn.push_back(i+1);
+    startidx.push_back(conn.size());
+  }
+  cp.insert("gid",gid,1,false);
+  cp.setup(cp.get_child("gid")->handle<common::PE::CommWrapper>(),rnk);
+
+  lss->options().set("matrix_builder", std::string("cf3.math.LSS.BlockCrsMatrix"));
+  lss->options().set("solution_strategy", std::string("cf3.math.LSS.BlockCrsStrategy"));
+  lss->create(cp, neq, conn, startidx);
+
+  // Symmetric positive definite element matrix [K -I; -I K], with coupled equations in K
+  LSS::BlockAccumulator acc;
+  acc.resize(2, neq);
+  acc.mat.setZero();
+  acc.mat(0,0) = acc.mat(2,2) = 2.;
+  acc.mat(1,1) = acc.mat(3,3) = 1.5;
+  acc.mat(0,1) = acc.mat(1,0) = acc.mat(2,3) = acc.mat(3,2) = 0.5;
+  acc.mat(0,2) = acc.mat(2,0) = acc.mat(1,3) = acc.mat(3,1) = -1.;
+
+  for(Uint i = 0; i != nb_nodes-1; ++i)
+  {
+    acc.indices[0] = i;
+    acc.indices[1] = i+1;
+    for(Uint j = 0; j != 2; ++j)
+      for(Uint eq = 0; eq != neq; ++eq)
+        acc.sol[j*neq+eq] = exact(acc.indices[j], eq);
+    acc.rhs = acc.mat * acc.sol;
+    lss->matrix()->add_values(acc);
+    lss->rhs()->add_rhs_values(acc);
+  }
+
+  std::vector<std::string> solvers;
+  solvers.push_back("CG");
+  solvers.push_back("BiCGStab");
+  solvers.push_back("GMRES");
+
+  std::vector<std::string> preconditioners;
+  preconditioners.push_back("None");
+  preconditioners.push_back("Jacobi");
+  preconditioners.push_back("BlockJacobi");
+  preconditioners.push_back("ILU0");
+
+  Component& strategy = *lss->solution_strategy();
+  strategy.options().set("tolerance", 1e-12);
+  strategy.options().set("restart", 10u);
+  for(Uint s = 0; s != solvers.size(); ++s)
+  {
+    for(Uint p = 0; p != preconditioners.size(); ++p)
+    {
+      BOOST_TEST_MESSAGE(solvers[s] << " with " << preconditioners[p]);
+      strategy.options().set("solver", solvers[s]);
+      strategy.options().set("preconditioner", preconditioners[p]);
+      lss->solution()->reset(0.);
+      lss->solve();
+
+      for(Uint i = 0; i != nb_nodes; ++i)
+      {
+        for(Uint eq = 0; eq != neq; ++eq)
+        {
+          Real value;
+          lss->solution()->get_value(i, eq, value);
+          BOOST_CHECK_SMALL(value - exact(i, eq), 1e-8);
+        }
+      }
+    }
+  }
+
+  // The block ILU(0) factorization of a block tridiagonal matrix is exact
+  strategy.options().set("solver", std::string("GMRES"));
+  strategy.options().set("preconditioner", std::string("ILU0"));
+  lss->solution()->reset(0.);
+  lss->solve();
+  BOOST_CHECK(strategy.properties().value<Uint>("iterations") <= 2u);
+  BOOST_CHECK_SMALL(lss->solution_strategy()->compute_residual(), 1e-10);
+
+  // Always: setting the policy invalidates the preconditioner, which is then kept
+  strategy.options().set("preconditioner_reuse", std::string("Always"));
+  const Uint first_iterations = strategy.properties().value<Uint>("iterations");
+  Uint setups = strategy.properties().value<Uint>("preconditioner_setups");
+  for(Uint i = 0; i != 3; ++i)
+  {
+    lss->solution()->reset(0.);
+    lss->solve();
+    BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("iterations"), first_iterations);
+    BOOST_CHECK_SMALL(lss->solution_strategy()->compute_residual(), 1e-10);
+  }
+  BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("preconditioner_setups"), setups + 1u);
+
+  // Steps: a setup every reuse_steps solves
+  strategy.options().set("reuse_steps", 2u);
+  strategy.options().set("preconditioner_reuse", std::string("Steps"));
+  setups = strategy.properties().value<Uint>("preconditioner_setups");
+  for(Uint i = 0; i != 4; ++i)
+  {
+    lss->solution()->reset(0.);
+    lss->solve();
+    BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("preconditioner_setups"), setups + 1u + i/2);
+  }
+
+  // IterationGrowth: no setup while the iteration count is stable
+  strategy.options().set("preconditioner_reuse", std::string("IterationGrowth"));
+  setups = strategy.properties().value<Uint>("preconditioner_setups");
+  for(Uint i = 0; i != 3; ++i)
+  {
+    lss->solution()->reset(0.);
+    lss->solve();
+  }
+  BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("preconditioner_setups"), setups + 1u);
+  const Uint reference_iterations = strategy.properties().value<Uint>("iterations");
+
+  // Changing the matrix makes the kept factorization inexact, so the iteration count grows
+  acc.mat.setIdentity();
+  for(Uint i = 0; i != nb_nodes-1; ++i)
+  {
+    acc.indices[0] = i;
+    acc.indices[1] = i+1;
+    lss->matrix()->add_values(acc);
+  }
+  lss->solution()->reset(0.);
+  lss->solve();
+  BOOST_CHECK(strategy.properties().value<Uint>("iterations") > reference_iterations + reference_iterations/2);
+  BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("preconditioner_setups"), setups + 1u);
+
+  // The next solve recomputes the factorization, which is exact again
+  lss->solution()->reset(0.);
+  lss->solve();
+  BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("preconditioner_setups"), setups + 2u);
+  BOOST_CHECK(strategy.properties().value<Uint>("iterations") <= 2u);
+  BOOST_CHECK_SMALL(lss->solution_strategy()->compute_residual(), 1e-10);
+
+  // Rows that are not connected to each other can not be tied together
+  BOOST_CHECK_THROW(lss->matrix()->tie_blockrow_pairs(1, 3), common::BadValue);
+  BOOST_CHECK_THROW(lss->matrix()->tie_blockrow_pairs(0, 2), common::BadValue);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
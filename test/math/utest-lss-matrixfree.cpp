@@ -0,0 +1,189 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the matrix-free LSS matrix"
+
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Action.hpp"
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "common/PE/CommWrapper.hpp"
+
+#include "math/MatrixTypes.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/System.hpp"
+#include "math/LSS/Vector.hpp"
+#include "math/LSS/BlockCrs/MatrixFreeMatrix.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::common::PE;
+using namespace cf3::math;
+
+/// Number of nodes of the 1D chain owned by each process
+const Uint nodes_per_rank = 20;
+
+/// Two coupled equations per node
+const Uint neq = 2;
+
+/// Exact solution
+Real exact(const Uint node, const Uint eq)
+{
+  return eq == 0 ? std::sin(static_cast<Real>(node)) : std::cos(static_cast<Real>(node));
+}
+
+/// Assembles the system for a chain of 2-node elements, leaving the RHS alone during matrix-vector products.
+/// The chain is split in contiguous parts over the processes, and each process also stores the neighbouring node
+/// of each adjacent process as a ghost, so the elements between processes are assembled on both sides.
+class ChainAssembly : public common::Action
+{
+public:
+  ChainAssembly(const std::string& name) : common::Action(name)
+  {
+  }
+
+  static std::string type_name() { return "ChainAssembly"; }
+
+  void execute()
+  {
+    LSS::MatrixFreeMatrix& matrix = dynamic_cast<LSS::MatrixFreeMatrix&>(*lss->matrix());
+    LSS::BlockAccumulator acc;
+    acc.resize(2, neq);
+    acc.mat.setZero();
+    acc.mat(0,0) = acc.mat(2,2) = 2.;
+    acc.mat(1,1) = acc.mat(3,3) = 1.5;
+    acc.mat(0,1) = acc.mat(1,0) = acc.mat(2,3) = acc.mat(3,2) = 0.5;
+    acc.mat(0,2) = acc.mat(2,0) = acc.mat(1,3) = acc.mat(3,1) = -1.;
+
+    for(Uint l = 0; l != gid.size()-1; ++l)
+    {
+      acc.indices[0] = l;
+      acc.indices[1] = l+1;
+      matrix.add_values(acc);
+      if(matrix.is_applying())
+        continue;
+
+      for(Uint j = 0; j != 2; ++j)
+        for(Uint eq = 0; eq != neq; ++eq)
+          acc.sol[j*neq+eq] = exact(gid[acc.indices[j]], eq);
+      acc.rhs = acc.mat * acc.sol;
+      lss->rhs()->add_rhs_values(acc);
+    }
+  }
+
+  Handle<LSS::System> lss;
+
+  /// Global index of each local node
+  std::vector<Uint> gid;
+};
+
+BOOST_AUTO_TEST_SUITE( MatrixFreeSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( SolveChain )
+{
+  Component& root = Core::instance().root();
+  Handle<LSS::System> lss = root.create_component<LSS::System>("LSS");
+  Handle<ChainAssembly> assembly = root.create_component<ChainAssembly>("Assembly");
+  assembly->lss = lss;
+  CommPattern& cp = *root.create_component<CommPattern>("commpattern");
+
+  const Uint rank = Comm::instance().rank();
+  const Uint nb_procs = Comm::instance().size();
+  const Uint first = rank == 0 ? 0 : rank*nodes_per_rank - 1;
+  const Uint last = rank == nb_procs-1 ? nodes_per_rank*nb_procs : (rank+1)*nodes_per_rank + 1;
+  std::vector<Uint>& gid = assembly->gid;
+  std::vector<Uint> rnk, conn, startidx;
+  startidx.push_back(0);
+  for(Uint i = first; i != last; ++i)
+  {
+    const Uint l = i - first;
+    gid.push_back(i);
+    rnk.push_back(i / nodes_per_rank);
+    if(i != first)
+      conn.push_back(l-1);
+    conn.push_back(l);
+    if(i != last-1)
+      conn.push_back(l+1);
+    startidx.push_back(conn.size());
+  }
+  cp.insert("gid",gid,1,false);
+  cp.setup(cp.get_child("gid")->handle<common::PE::CommWrapper>(),rnk);
+
+  lss->options().set("matrix_builder", std::string("cf3.math.LSS.MatrixFreeMatrix"));
+  lss->options().set("solution_strategy", std::string("cf3.math.LSS.BlockCrsStrategy"));
+  lss->create(cp, neq, conn, startidx);
+  lss->matrix()->options().set("operator", Handle<common::Action>(assembly));
+
+  Component& strategy = *lss->solution_strategy();
+  strategy.options().set("tolerance", 1e-12);
+
+  std::vector<std::string> preconditioners;
+  preconditioners.push_back("None");
+  preconditioners.push_back("Jacobi");
+  preconditioners.push_back("BlockJacobi");
+
+  for(Uint p = 0; p != preconditioners.size(); ++p)
+  {
+    BOOST_TEST_MESSAGE("GMRES with " << preconditioners[p]);
+    lss->reset();
+    assembly->execute();
+
+    // Symmetric dirichlet condition on the first node, its column moves to the RHS when solving.
+    // In parallel, only the first process has the node, but the correction is computed on all of them.
+    if(rank == 0)
+    {
+      for(Uint eq = 0; eq != neq; ++eq)
+        lss->dirichlet(0, eq, exact(0, eq), true);
+    }
+
+    strategy.options().set("preconditioner", preconditioners[p]);
+    lss->solution()->reset(0.);
+    lss->solve();
+
+    // The solve synchronizes the solution, so the ghost values are checked as well
+    for(Uint l = 0; l != gid.size(); ++l)
+    {
+      for(Uint eq = 0; eq != neq; ++eq)
+      {
+        Real value;
+        lss->solution()->get_value(l, eq, value);
+        BOOST_CHECK_SMALL(value - exact(gid[l], eq), 1e-8);
+      }
+    }
+  }
+
+  // Only the diagonal blocks of the owned nodes are stored
+  std::vector<Uint> rows, cols;
+  std::vector<Real> vals;
+  lss->matrix()->debug_data(rows, cols, vals);
+  BOOST_CHECK_EQUAL(vals.size(), nodes_per_rank*neq*neq);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,166 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Tests mesh::actions::ColourElements"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/assign/list_of.hpp>
+
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/OptionList.hpp"
+
+#include "mesh/actions/ColourElements.hpp"
+#include "mesh/actions/ElementColouring.hpp"
+
+#include "mesh/Cells.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshAdaptor.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Tags.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::mesh::actions;
+using namespace boost::assign;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ColourElements_Fixture
+{
+  ColourElements_Fixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Check that all elements are coloured once and that no two elements of a colour share a node
+  void check_colouring(const Space& space, const ElementColouring& colouring)
+  {
+    const Connectivity& connectivity = space.connectivity();
+    BOOST_CHECK_EQUAL(colouring.nb_elements(), connectivity.size());
+    BOOST_CHECK_EQUAL(colouring.colour_starts().back(), connectivity.size());
+
+    std::vector<bool> elem_found(connectivity.size(), false);
+    std::vector<int> node_colours(space.dict().size(), -1);
+    for(Uint colour = 0; colour != colouring.nb_colours(); ++colour)
+    {
+      for(Uint i = colouring.colour_starts()[colour]; i != colouring.colour_starts()[colour+1]; ++i)
+      {
+        const Uint elem = colouring.elements()[i];
+        BOOST_CHECK(!elem_found[elem]);
+        elem_found[elem] = true;
+        boost_foreach(const Uint node, connectivity[elem])
+        {
+          BOOST_CHECK_NE(node_colours[node], static_cast<int>(colour));
+          node_colours[node] = colour;
+        }
+      }
+    }
+  }
+
+  /// Number of cached connectivity data components in the mesh
+  Uint nb_caches(Mesh& mesh)
+  {
+    Uint result = 0;
+    boost_foreach(const Component& cache, find_components_recursively_with_tag(mesh, mesh::Tags::connectivity_cache()))
+      ++result;
+    return result;
+  }
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( ColourElements_TestSuite, ColourElements_Fixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().initiate(m_argc,m_argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_colour_quads )
+{
+  Handle<MeshGenerator> mesh_generator = Core::instance().root().create_component<SimpleMeshGenerator>("mesh_generator_quads");
+  mesh_generator->options().set("mesh",Core::instance().root().uri()/"quads");
+  mesh_generator->options().set("lengths",std::vector<Real>(2,10.));
+  std::vector<Uint> nb_cells = list_of(20)(10);
+  mesh_generator->options().set("nb_cells",nb_cells);
+  Mesh& mesh = mesh_generator->generate();
+
+  boost::shared_ptr<MeshTransformer> colour_elements = allocate_component<ColourElements>("colour_elements");
+  colour_elements->transform(mesh);
+
+  Cells& cells = find_component_recursively<Cells>(mesh.topology());
+  Space& space = cells.geometry_space();
+  const ElementColouring& colouring = ColourElements::colouring(space);
+  check_colouring(space, colouring);
+
+  // A structured quad mesh needs exactly 4 colours
+  BOOST_CHECK_EQUAL(colouring.nb_colours(), 4u);
+
+  // The colouring is cached
+  BOOST_CHECK_EQUAL(&ColourElements::colouring(space), &colouring);
+
+  // Balanced colouring
+  const ElementColouring& balanced = ColourElements::colouring(space, true);
+  check_colouring(space, balanced);
+  BOOST_CHECK(balanced.balanced());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_invalidate )
+{
+  Mesh& mesh = *Core::instance().root().get_child("quads")->handle<Mesh>();
+  Cells& cells = find_component_recursively<Cells>(mesh.topology());
+  const Uint nb_cells = cells.size();
+  ColourElements::colouring(cells.geometry_space());
+  BOOST_CHECK_EQUAL(nb_caches(mesh), 1u);
+
+  // Remove a cell
+  Uint cells_idx = 0;
+  while(mesh.elements()[cells_idx] != cells.handle<Entities>())
+    ++cells_idx;
+
+  MeshAdaptor mesh_adaptor(mesh);
+  mesh_adaptor.prepare();
+  mesh_adaptor.remove_element(cells_idx, 0);
+  mesh_adaptor.finish();
+
+  BOOST_CHECK_EQUAL(cells.size(), nb_cells-1);
+  BOOST_CHECK_EQUAL(nb_caches(mesh), 0u);
+
+  // Recomputed on demand
+  const ElementColouring& colouring = ColourElements::colouring(cells.geometry_space());
+  check_colouring(cells.geometry_space(), colouring);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
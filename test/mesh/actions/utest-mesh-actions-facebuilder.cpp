@@ -7,6 +7,8 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Tests mesh::actions::BuildFaces"
 
+#include <algorithm>
+
 #include <boost/test/unit_test.hpp>
 #include <boost/assign/list_of.hpp>
 
@@ -15,6 +17,7 @@
 #include "common/Core.hpp"
 #include "common/Environment.hpp"
 #include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
 
 #include "mesh/actions/BuildFaces.hpp"
 #include "mesh/actions/BuildFaceNormals.hpp"
@@ -28,6 +31,7 @@
 #include "mesh/Field.hpp"
 #include "mesh/FaceCellConnectivity.hpp"
 #include "mesh/Cells.hpp"
+#include "mesh/Connectivity.hpp"
 #include "mesh/CellFaces.hpp"
 #include "mesh/SimpleMeshGenerator.hpp"
 
@@ -392,6 +396,45 @@ BOOST_AUTO_TEST_CASE( build_faces_rectangle )
 
 //////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( build_faces_rectangle_threaded )
+{
+  boost::shared_ptr<SimpleMeshGenerator> mesh_gen = allocate_component<SimpleMeshGenerator>("mesh_gen");
+  std::vector<Real> lengths  = list_of(8.)(6.);
+  std::vector<Uint> nb_cells = list_of(8u)(6u);
+  mesh_gen->options().set("mesh",URI("//rectangle_mesh_threaded"));
+  mesh_gen->options().set("lengths",lengths);
+  mesh_gen->options().set("nb_cells",nb_cells);
+  Mesh& rmesh = mesh_gen->generate();
+
+  boost::shared_ptr<BuildFaces> facebuilder = allocate_component<BuildFaces>("facebuilder");
+  facebuilder->options().set("nb_threads",4u);
+  facebuilder->set_mesh(rmesh);
+  facebuilder->execute();
+
+  // 8 rows of 5 inner horizontal faces, 6 rows of 7 inner vertical faces
+  Region& inner_faces_region = find_component_recursively_with_name<Region>(rmesh.topology(),mesh::Tags::inner_faces());
+  Uint nb_inner_faces = 0;
+  boost_foreach(const CellFaces& inner_faces, find_components<CellFaces>(inner_faces_region))
+    nb_inner_faces += inner_faces.size();
+  BOOST_CHECK_EQUAL(nb_inner_faces, 82u);
+
+  // every boundary face must be matched to a cell
+  Region& left_region = find_component_recursively_with_name<Region>(rmesh.topology(),"left");
+  Faces& left_faces = find_component<Faces>(left_region);
+  FaceCellConnectivity& f2c = find_component<FaceCellConnectivity>(left_faces);
+  BOOST_CHECK_EQUAL(f2c.size(),6u);
+  for (Face2Cell face(f2c); face.idx<f2c.size(); ++face.idx)
+  {
+    BOOST_CHECK(face.is_bdry());
+    BOOST_CHECK(is_not_null(face.cells()[0].comp));
+    Connectivity::ConstRow cell_nodes = face.cells()[0].get_nodes();
+    boost_foreach(const Uint node, left_faces.geometry_space().connectivity()[face.idx])
+      BOOST_CHECK(std::find(cell_nodes.begin(),cell_nodes.end(),node) != cell_nodes.end());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -105,6 +105,29 @@ BOOST_AUTO_TEST_CASE( build )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( rendezvous_matches_broadcast )
+{
+  // The numbering built above used the rendezvous algorithm, which is the default
+  const common::List<Uint>::ListT rendezvous_nodes_glb_idx = mesh->geometry_fields().glb_idx().array();
+  const common::List<Uint>::ListT rendezvous_nodes_rank = mesh->geometry_fields().rank().array();
+  std::vector< common::List<Uint>::ListT > rendezvous_elems_glb_idx;
+  boost_foreach(const Entities& entities, mesh->topology().elements_range())
+    rendezvous_elems_glb_idx.push_back(entities.glb_idx().array());
+
+  boost::shared_ptr<GlobalNumbering> build_glb_numbering = allocate_component<GlobalNumbering>("build_glb_numbering");
+  build_glb_numbering->set_mesh(mesh);
+  build_glb_numbering->options().set("rendezvous",false);
+  build_glb_numbering->execute();
+
+  BOOST_CHECK(mesh->geometry_fields().glb_idx().array() == rendezvous_nodes_glb_idx);
+  BOOST_CHECK(mesh->geometry_fields().rank().array() == rendezvous_nodes_rank);
+  Uint i=0;
+  boost_foreach(const Entities& entities, mesh->topology().elements_range())
+    BOOST_CHECK(entities.glb_idx().array() == rendezvous_elems_glb_idx[i++]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( Terminate )
 {
   PE::Comm::instance().finalize();
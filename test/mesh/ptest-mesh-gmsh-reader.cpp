@@ -0,0 +1,129 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark for the stream and memory-mapped modes of the gmsh reader"
+
+#include <fstream>
+#include <iostream>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Timer.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshReader.hpp"
+
+#include "test/mesh/utest-mesh-gmsh-quad-grid.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct GmshReaderBenchmarkFixture
+{
+  GmshReaderBenchmarkFixture() :
+    nx(400),
+    ny(400)
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    if(argc >= 3)
+    {
+      nx = boost::lexical_cast<int>(argv[1]);
+      ny = boost::lexical_cast<int>(argv[2]);
+    }
+  }
+
+  /// Read the file into a new mesh, and report the time and the memory increase of each rank
+  void read(const std::string& filename, const bool memory_map)
+  {
+    PE::Comm& comm = PE::Comm::instance();
+
+    boost::shared_ptr< MeshReader > meshreader = build_component_abstract_type<MeshReader>("cf3.mesh.gmsh.Reader","meshreader");
+    meshreader->options().set("memory_map",memory_map);
+    Mesh& mesh = *Core::instance().root().create_component<Mesh>("mesh");
+
+    comm.barrier();
+    const Real memory_before = OSystem::instance().layer()->memory_usage();
+    Timer timer;
+    meshreader->read_mesh_into(filename,mesh);
+    const Real elapsed = timer.elapsed();
+    const Real memory = OSystem::instance().layer()->memory_usage() - memory_before;
+
+    for (Uint rank=0; rank<comm.size(); ++rank)
+    {
+      comm.barrier();
+      if (rank == comm.rank())
+        std::cout << "[" << rank << "] " << filename << (memory_map ? " mapped: " : " stream: ") << elapsed << " s, " << memory / 1048576. << " MB" << std::endl;
+    }
+
+    BOOST_CHECK_EQUAL(mesh.properties().value<Uint>("global_nb_cells"), static_cast<Uint>(nx*ny));
+    Core::instance().root().remove_component(mesh);
+  }
+
+  int nx;
+  int ny;
+};
+
+BOOST_FIXTURE_TEST_SUITE( GmshReaderBenchmarkSuite, GmshReaderBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  Core::instance().initiate(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( WriteFiles )
+{
+  if (PE::Comm::instance().rank() == 0)
+  {
+    write_quad_grid("gmsh-benchmark-ascii.msh", nx, ny, false);
+    write_quad_grid("gmsh-benchmark-binary.msh", nx, ny, true);
+  }
+  PE::Comm::instance().barrier();
+}
+
+BOOST_AUTO_TEST_CASE( StreamAscii )
+{
+  read("gmsh-benchmark-ascii.msh", false);
+}
+
+BOOST_AUTO_TEST_CASE( MappedAscii )
+{
+  read("gmsh-benchmark-ascii.msh", true);
+}
+
+BOOST_AUTO_TEST_CASE( MappedBinary )
+{
+  read("gmsh-benchmark-binary.msh", true);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,178 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the checkpoint mesh writer and reader"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/MeshWriter.hpp"
+#include "mesh/Region.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Value of the geometry field at a point
+Real temperature(const Field::ConstRow& coords)
+{
+  return coords[XX] + 10.*coords[YY];
+}
+
+/// Check the fields of the mesh against the functions they were initialized with
+void check_fields(const Mesh& mesh)
+{
+  const Dictionary& nodes = mesh.geometry_fields();
+  const Field& coordinates = nodes.coordinates();
+  const Field& T = *Handle<Field const>(nodes.get_child("T"));
+  for (Uint n=0; n<nodes.size(); ++n)
+    BOOST_CHECK_CLOSE(T[n][0], temperature(coordinates[n]), 1e-12);
+
+  const Dictionary& dg = *Handle<Dictionary const>(mesh.get_child("P1dg"));
+  const Field& dg_coordinates = dg.coordinates();
+  const Field& u = *Handle<Field const>(dg.get_child("u"));
+  BOOST_CHECK_EQUAL(u.size(), dg_coordinates.size());
+  for (Uint n=0; n<u.size(); ++n)
+  {
+    BOOST_CHECK_EQUAL(u[n][XX], dg_coordinates[n][XX]);
+    BOOST_CHECK_EQUAL(u[n][YY], dg_coordinates[n][YY]);
+  }
+}
+
+/// Checkpoint written by a run on nb_procs processes
+std::string checkpoint_file(const std::string& nb_procs)
+{
+  return "checkpoint-np" + nb_procs + ".cf3chk";
+}
+
+BOOST_AUTO_TEST_SUITE( CheckpointSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  Core::instance().initiate(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( write_checkpoint )
+{
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("mesh");
+  boost::shared_ptr< MeshGenerator > generate_mesh = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","meshgenerator");
+  generate_mesh->options().set("nb_cells",std::vector<Uint>(2,10));
+  generate_mesh->options().set("lengths",std::vector<Real>(2,10.));
+  generate_mesh->options().set("mesh",mesh->uri());
+  generate_mesh->execute();
+
+  Dictionary& nodes = mesh->geometry_fields();
+  Field& T = nodes.create_field("T","T[scalar]");
+  for (Uint n=0; n<nodes.size(); ++n)
+    T[n][0] = temperature(nodes.coordinates()[n]);
+
+  Dictionary& dg = mesh->create_discontinuous_space("P1dg","cf3.mesh.LagrangeP1");
+  Field& u = dg.create_field("u","u[vector]");
+  for (Uint n=0; n<dg.size(); ++n)
+  {
+    u[n][XX] = dg.coordinates()[n][XX];
+    u[n][YY] = dg.coordinates()[n][YY];
+  }
+
+  boost::shared_ptr< MeshWriter > writer = build_component_abstract_type<MeshWriter>("cf3.mesh.checkpoint.Writer","writer");
+  writer->write_from_to(*mesh,checkpoint_file(to_str(PE::Comm::instance().size())));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( read_checkpoint )
+{
+  const Mesh& original = *Handle<Mesh const>(Core::instance().root().get_child("mesh"));
+
+  // Restart from the checkpoint of a run on the number of processes given as argument,
+  // or from the one written above
+  const int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+  const std::string written_by = argc > 1 ? std::string(argv[argc-1]) : to_str(PE::Comm::instance().size());
+  CFinfo << "Restarting on " << PE::Comm::instance().size() << " processes from the checkpoint written on " << written_by << CFendl;
+
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("restart");
+  boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.checkpoint.Reader","reader");
+  reader->read_mesh_into(checkpoint_file(written_by),*mesh);
+
+  BOOST_CHECK_EQUAL(mesh->dimension(), 2u);
+  BOOST_CHECK_EQUAL(mesh->properties().value<Uint>("global_nb_cells"), original.properties().value<Uint>("global_nb_cells"));
+  check_fields(*mesh);
+
+  // Repartition the restarted mesh, which migrates all dictionaries and fields
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.LoadBalance","load_balance")->transform(*mesh);
+  BOOST_CHECK_EQUAL(mesh->properties().value<Uint>("global_nb_cells"), original.properties().value<Uint>("global_nb_cells"));
+  check_fields(*mesh);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( entities_on_some_ranks )
+{
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("uneven");
+  boost::shared_ptr< MeshGenerator > generate_mesh = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","meshgenerator");
+  generate_mesh->options().set("nb_cells",std::vector<Uint>(2,4));
+  generate_mesh->options().set("lengths",std::vector<Real>(2,4.));
+  generate_mesh->options().set("mesh",mesh->uri());
+  generate_mesh->execute();
+
+  // Elements that exist on the first rank only, the other ranks must still take part in writing them
+  if (PE::Comm::instance().rank() == 0)
+  {
+    mesh->topology().create_region("extra").create_elements("cf3.mesh.LagrangeP1.Triag2D", mesh->geometry_fields());
+    mesh->update_structures();
+  }
+
+  const std::string file = "uneven-np" + to_str(PE::Comm::instance().size()) + ".cf3chk";
+  build_component_abstract_type<MeshWriter>("cf3.mesh.checkpoint.Writer","writer")->write_from_to(*mesh,file);
+
+  Handle<Mesh> restart = Core::instance().root().create_component<Mesh>("uneven_restart");
+  build_component_abstract_type<MeshReader>("cf3.mesh.checkpoint.Reader","reader")->read_mesh_into(file,*restart);
+
+  BOOST_CHECK_EQUAL(restart->properties().value<Uint>("global_nb_cells"), mesh->properties().value<Uint>("global_nb_cells"));
+  Handle<Region const> extra_region(restart->topology().get_child("extra"));
+  BOOST_REQUIRE(is_not_null(extra_region));
+  Handle<Elements const> extra(extra_region->get_child("elements_cf3.mesh.LagrangeP1.Triag2D"));
+  BOOST_REQUIRE(is_not_null(extra));
+  BOOST_CHECK_EQUAL(extra->size(), 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
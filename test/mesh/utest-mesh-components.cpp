@@ -22,6 +22,7 @@
 #include "common/Table.hpp"
 #include "common/List.hpp"
 #include "common/Table.hpp"
+#include "common/CompressedTable.hpp"
 #include "common/DynTable.hpp"
 #include "mesh/ElementType.hpp"
 #include "mesh/Dictionary.hpp"
@@ -701,6 +702,62 @@ BOOST_AUTO_TEST_CASE ( DynTable_test_hard )
 }
 
 
+BOOST_AUTO_TEST_CASE ( CompressedTable_test )
+{
+  CompressedTable<Uint>& table = *root.create_component< CompressedTable<Uint> >("compressed_table");
+  BOOST_CHECK_EQUAL(table.size(), 0u);
+
+  // Append rows
+  std::vector<Uint> row;
+  row = list_of(0)(1)(2);
+  BOOST_CHECK_EQUAL(table.add_row(row), 0u);
+  row.resize(0);
+  BOOST_CHECK_EQUAL(table.add_row(row), 1u);
+  BOOST_CHECK_EQUAL(table.add_row(), 2u);
+  table.push_back(5);
+  table.push_back(6);
+  table.compact();
+
+  BOOST_CHECK_EQUAL(table.size(), 3u);
+  BOOST_CHECK_EQUAL(table.nb_values(), 5u);
+  BOOST_CHECK_EQUAL(table.row_size(0), 3u);
+  BOOST_CHECK_EQUAL(table.row_size(1), 0u);
+  BOOST_CHECK_EQUAL(table.row_size(2), 2u);
+  BOOST_CHECK_EQUAL(table[0][2], 2u);
+  BOOST_CHECK_EQUAL(table[2][1], 6u);
+
+  Uint sum = 0;
+  boost_foreach(const Uint i, table[2])
+    sum += i;
+  BOOST_CHECK_EQUAL(sum, 11u);
+
+  // Allocate rows and fill them afterwards
+  std::vector<Uint> row_sizes = list_of(2)(0)(1);
+  table.allocate(row_sizes);
+  table[0][0] = 3;
+  table[0][1] = 4;
+  table[2][0] = 7;
+  BOOST_CHECK_EQUAL(table.size(), 3u);
+  BOOST_CHECK_EQUAL(table.row_size(1), 0u);
+  BOOST_CHECK_EQUAL(table[0][1], 4u);
+  BOOST_CHECK_EQUAL(table[2][0], 7u);
+
+  // Copy from a DynTable
+  DynTable<Uint>& dyn_table = *root.create_component< DynTable<Uint> >("dyn_table");
+  dyn_table.resize(2);
+  row = list_of(8);
+  dyn_table.set_row(0, row);
+  row = list_of(9)(10);
+  dyn_table.set_row(1, row);
+  table.assign(dyn_table.array());
+  BOOST_CHECK_EQUAL(table.size(), 2u);
+  BOOST_CHECK_EQUAL(table[0][0], 8u);
+  BOOST_CHECK_EQUAL(table[1][1], 10u);
+
+  table.clear();
+  BOOST_CHECK_EQUAL(table.size(), 0u);
+}
+
 BOOST_AUTO_TEST_CASE ( Mesh_test )
 {
   boost::shared_ptr<Component> root = boost::static_pointer_cast<Component>(allocate_component<Group>("root"));
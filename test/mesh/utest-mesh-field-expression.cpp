@@ -0,0 +1,127 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::field_expression"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Core.hpp"
+
+#include "mesh/Field.hpp"
+#include "mesh/FieldExpression.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Enough rows to split the evaluation over 4 threads
+static const Uint nb_rows = 4*field_expression::min_rows_per_thread + 7;
+
+/// Field with nb_vars variables, filled with f(i,j)
+Handle<Field> create_field(const std::string& name, const Uint nb_vars, const Real a, const Real b)
+{
+  Handle<Field> field = Core::instance().root().create_component<Field>(name);
+  field->set_row_size(nb_vars);
+  field->resize(nb_rows);
+  for (Uint i=0; i<nb_rows; ++i)
+    for (Uint j=0; j<nb_vars; ++j)
+      (*field)[i][j] = a*i + b*j + 1.;
+  return field;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( FieldExpressionSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( linear_combination )
+{
+  Field& U  = *create_field("U",  3, 0., 0.);
+  Field& U0 = *create_field("U0", 3, 0.5, 1.);
+  Field& R0 = *create_field("R0", 3, 1., -2.);
+  Field& R1 = *create_field("R1", 3, -0.25, 3.);
+  Field& R  = *create_field("R",  3, 0., 0.);
+  Field& H  = *create_field("H",  1, 0.01, 0.);
+
+  field_expression::LinearCombination residuals(nb_rows);
+  residuals.add(0.5, R0);
+  residuals.add(0., U);   // skipped
+  residuals.add(0.25, R1);
+
+  for (Uint nb_threads=1; nb_threads<=4; nb_threads+=3)
+  {
+    field_expression::assign(R, residuals, nb_threads);
+    field_expression::assign(U, U0 + H*R, nb_threads);
+    for (Uint i=0; i<nb_rows; ++i)
+    {
+      for (Uint j=0; j<3; ++j)
+      {
+        const Real r = 0.5*R0[i][j] + 0.25*R1[i][j];
+        BOOST_CHECK_CLOSE(R[i][j], r, 1e-12);
+        BOOST_CHECK_CLOSE(U[i][j], U0[i][j] + H[i][0]*r, 1e-12);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( operators )
+{
+  Field& U  = *create_field("V",  2, 0.5, 1.);
+  Field& R  = *create_field("S",  2, 1., -2.);
+  Field& A  = *create_field("A",  1, 0.01, 0.);
+
+  // The assigned field may appear in the expression
+  U = 2.*U - R / A + 0.5*(A*U);
+  for (Uint i=0; i<nb_rows; ++i)
+  {
+    for (Uint j=0; j<2; ++j)
+    {
+      const Real u = 0.5*i + 1.*j + 1.;
+      BOOST_CHECK_CLOSE(U[i][j], 2.*u - R[i][j]/A[i][0] + 0.5*A[i][0]*u, 1e-12);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( mismatched_operands )
+{
+  Field& W  = *create_field("W",  3, 0., 0.);
+  Field& X  = *create_field("X",  2, 0.5, 1.);
+  Field& Y  = *create_field("Y",  3, 1., -2.);
+  Field& B  = *create_field("B",  1, 0.01, 0.);
+
+  // Only scalar fields are broadcast, other row sizes must match the assigned field
+  BOOST_CHECK_THROW(W = Y + X, BadValue);
+  BOOST_CHECK_THROW(W = 2.*(B*X), BadValue);
+  field_expression::LinearCombination combination(nb_rows);
+  combination.add(1., Y);
+  combination.add(1., X);
+  BOOST_CHECK_THROW(field_expression::assign(W, combination), BadValue);
+
+  Handle<Field> short_field = Core::instance().root().create_component<Field>("short");
+  short_field->set_row_size(3);
+  short_field->resize(nb_rows-1);
+  BOOST_CHECK_THROW(W = Y - *short_field, BadValue);
+
+  // nothing was written
+  for (Uint i=0; i<nb_rows; ++i)
+    for (Uint j=0; j<3; ++j)
+      BOOST_CHECK_EQUAL(W[i][j], 1.);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -33,6 +33,8 @@
 
 #include "mesh/actions/LoadBalance.hpp"
 
+#include "test/mesh/utest-mesh-gmsh-quad-grid.hpp"
+
 using namespace std;
 using namespace boost;
 using namespace cf3;
@@ -226,6 +228,32 @@ BOOST_AUTO_TEST_CASE( test )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( read_mapped_ascii )
+{
+  // Each rank locates its range in the ASCII sections from the line counts of its share of the bytes
+  if (PE::Comm::instance().rank() == 0)
+    write_quad_grid("quad-grid-parallel.msh", 9, 7, false);
+  PE::Comm::instance().barrier();
+
+  boost::shared_ptr< MeshReader > meshreader = build_component_abstract_type<MeshReader>("cf3.mesh.gmsh.Reader","meshreader");
+  meshreader->options().set("memory_map",false);
+  Handle<Mesh> stream = Core::instance().root().create_component<Mesh>("quad_grid_stream");
+  meshreader->read_mesh_into("quad-grid-parallel.msh",*stream);
+  meshreader->options().set("memory_map",true);
+  Handle<Mesh> mapped = Core::instance().root().create_component<Mesh>("quad_grid_mapped");
+  meshreader->read_mesh_into("quad-grid-parallel.msh",*mapped);
+
+  BOOST_CHECK_EQUAL(mapped->properties().value<Uint>("global_nb_cells"), 63u);
+  BOOST_CHECK_EQUAL(mapped->properties().value<Uint>("local_nb_cells"), stream->properties().value<Uint>("local_nb_cells"));
+  BOOST_CHECK_EQUAL(mapped->properties().value<Uint>("local_nb_nodes"), stream->properties().value<Uint>("local_nb_nodes"));
+  BOOST_CHECK(mapped->properties().value<Uint>("local_nb_cells") > 0u);
+
+  Core::instance().root().remove_component(*stream);
+  Core::instance().root().remove_component(*mapped);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( finalize_mpi )
 {
   PE::Comm::instance().finalize();
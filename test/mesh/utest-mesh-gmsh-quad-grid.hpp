@@ -0,0 +1,87 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_test_mesh_utest_mesh_gmsh_quad_grid_hpp
+#define cf3_test_mesh_utest_mesh_gmsh_quad_grid_hpp
+
+/// @file utest-mesh-gmsh-quad-grid.hpp Writes structured quad meshes in gmsh format, to test the gmsh reader
+
+#include <fstream>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Write a unit square of nx by ny quads in gmsh format 2.2, in ASCII or binary
+inline void write_quad_grid(const std::string& filename, const int nx, const int ny, const bool binary)
+{
+  std::ofstream file(filename.c_str(), binary ? std::ios::out | std::ios::binary : std::ios::out);
+  file.precision(16);
+  file << "$MeshFormat\n2.2 " << (binary ? 1 : 0) << " 8\n";
+  if (binary)
+  {
+    const int one = 1;
+    file.write(reinterpret_cast<const char*>(&one), sizeof(int));
+    file << "\n";
+  }
+  file << "$EndMeshFormat\n";
+  file << "$PhysicalNames\n1\n2 1 \"interior\"\n$EndPhysicalNames\n";
+
+  file << "$Nodes\n" << (nx+1)*(ny+1) << "\n";
+  for (int j=0; j<=ny; ++j)
+  {
+    for (int i=0; i<=nx; ++i)
+    {
+      const int number = j*(nx+1)+i+1;
+      const double xyz[3] = { static_cast<double>(i)/nx, static_cast<double>(j)/ny, 0. };
+      if (binary)
+      {
+        file.write(reinterpret_cast<const char*>(&number), sizeof(int));
+        file.write(reinterpret_cast<const char*>(xyz), 3*sizeof(double));
+      }
+      else
+      {
+        file << number << " " << xyz[0] << " " << xyz[1] << " " << xyz[2] << "\n";
+      }
+    }
+  }
+  if (binary)
+    file << "\n";
+  file << "$EndNodes\n";
+
+  // Quads (type 3) with the physical group and the elementary entity as tags
+  file << "$Elements\n" << nx*ny << "\n";
+  if (binary)
+  {
+    const int header[3] = { 3, nx*ny, 2 };
+    file.write(reinterpret_cast<const char*>(header), 3*sizeof(int));
+  }
+  for (int j=0; j<ny; ++j)
+  {
+    for (int i=0; i<nx; ++i)
+    {
+      const int first = j*(nx+1)+i+1;
+      const int element[7] = { j*nx+i+1, 1, 1, first, first+1, first+nx+2, first+nx+1 };
+      if (binary)
+      {
+        file.write(reinterpret_cast<const char*>(element), 7*sizeof(int));
+      }
+      else
+      {
+        file << element[0] << " 3 2";
+        for (int k=1; k<7; ++k)
+          file << " " << element[k];
+        file << "\n";
+      }
+    }
+  }
+  if (binary)
+    file << "\n";
+  file << "$EndElements\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_test_mesh_utest_mesh_gmsh_quad_grid_hpp
@@ -7,6 +7,8 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::mesh::gmsh::Reader"
 
+#include <fstream>
+
 #include <boost/test/unit_test.hpp>
 
 #include "common/Log.hpp"
@@ -15,6 +17,7 @@
 
 #include "common/Core.hpp"
 #include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
 
 #include "math/VariablesDescriptor.hpp"
 
@@ -30,6 +33,10 @@
 #include "common/List.hpp"
 #include "common/Table.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Cells.hpp"
+#include "mesh/Connectivity.hpp"
+
+#include "test/mesh/utest-mesh-gmsh-quad-grid.hpp"
 
 using namespace std;
 using namespace boost;
@@ -311,6 +318,52 @@ BOOST_AUTO_TEST_CASE( read_2d_mesh_mix_p1_out )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( read_binary_mesh )
+{
+  write_quad_grid("quad-grid-ascii.msh", 7, 5, false);
+  write_quad_grid("quad-grid-binary.msh", 7, 5, true);
+
+  boost::shared_ptr< MeshReader > meshreader = build_component_abstract_type<MeshReader>("cf3.mesh.gmsh.Reader","meshreader");
+
+  // Stream reading is the reference
+  meshreader->options().set("memory_map",false);
+  Mesh& reference = *Core::instance().root().create_component<Mesh>("quad_grid_stream");
+  meshreader->read_mesh_into("quad-grid-ascii.msh",reference);
+
+  meshreader->options().set("memory_map",true);
+  Mesh& ascii = *Core::instance().root().create_component<Mesh>("quad_grid_ascii");
+  meshreader->read_mesh_into("quad-grid-ascii.msh",ascii);
+  Mesh& binary = *Core::instance().root().create_component<Mesh>("quad_grid_binary");
+  meshreader->read_mesh_into("quad-grid-binary.msh",binary);
+
+  const Table<Real>& reference_coords = reference.geometry_fields().coordinates();
+  const Connectivity& reference_conn = find_component_recursively<Cells>(reference.topology()).geometry_space().connectivity();
+  BOOST_CHECK_EQUAL(reference_coords.size(), 48u);
+  BOOST_CHECK_EQUAL(reference_conn.size(), 35u);
+
+  std::vector<Mesh*> meshes;
+  meshes.push_back(&ascii);
+  meshes.push_back(&binary);
+  boost_foreach(Mesh* mesh, meshes)
+  {
+    const Table<Real>& coords = mesh->geometry_fields().coordinates();
+    const Connectivity& conn = find_component_recursively<Cells>(mesh->topology()).geometry_space().connectivity();
+    BOOST_CHECK_EQUAL(coords.size(), reference_coords.size());
+    BOOST_CHECK_EQUAL(conn.size(), reference_conn.size());
+    for (Uint n=0; n<coords.size(); ++n)
+    {
+      BOOST_CHECK_EQUAL(mesh->geometry_fields().glb_idx()[n], reference.geometry_fields().glb_idx()[n]);
+      for (Uint d=0; d<DIM_2D; ++d)
+        BOOST_CHECK_CLOSE(coords[n][d], reference_coords[n][d], 1e-10);
+    }
+    for (Uint e=0; e<conn.size(); ++e)
+      for (Uint n=0; n<conn.row_size(); ++n)
+        BOOST_CHECK_EQUAL(conn[e][n], reference_conn[e][n]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( finalize_mpi )
 {
   Core::instance().terminate();
@@ -0,0 +1,142 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::hilbert"
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/Hilbert.hpp"
+
+#include "mesh/BoundingBox.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Space.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Number of owned elements, and the range of their Hilbert keys
+struct OwnedElements
+{
+  OwnedElements(const Mesh& mesh) : nb_elems(0), weight(0.), min_key(0), max_key(0)
+  {
+    boost::shared_ptr<BoundingBox> bounding_box = allocate_component<BoundingBox>("bounding_box");
+    bounding_box->build(mesh.geometry_fields().coordinates());
+    bounding_box->make_global();
+    math::Hilbert compute_hilbert_idx(*bounding_box, 20);
+
+    min_key = compute_hilbert_idx.max_key();
+    boost_foreach(const Handle<Entities>& entities, mesh.elements())
+    {
+      RealVector centroid(entities->element_type().dimension());
+      RealMatrix element_coordinates;
+      entities->geometry_space().allocate_coordinates(element_coordinates);
+      for (Uint e=0; e<entities->size(); ++e)
+      {
+        if (entities->is_ghost(e))
+          continue;
+        entities->geometry_space().put_coordinates(element_coordinates,e);
+        entities->element_type().compute_centroid(element_coordinates,centroid);
+        const boost::uint64_t key = compute_hilbert_idx(centroid);
+        min_key = std::min(min_key, key);
+        max_key = std::max(max_key, key);
+        ++nb_elems;
+        weight += entities->element_type().nb_nodes();
+      }
+    }
+  }
+
+  Uint nb_elems;
+  Real weight;
+  boost::uint64_t min_key;
+  boost::uint64_t max_key;
+};
+
+BOOST_AUTO_TEST_SUITE( HilbertPartitionerSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  Core::instance().initiate(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( partition_rectangle )
+{
+  PE::Comm& comm = PE::Comm::instance();
+
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("mesh");
+  boost::shared_ptr< MeshGenerator > generate_mesh = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","meshgenerator");
+  generate_mesh->options().set("nb_cells",std::vector<Uint>(2,40));
+  generate_mesh->options().set("lengths",std::vector<Real>(2,10.));
+  generate_mesh->options().set("mesh",mesh->uri());
+  generate_mesh->execute();
+
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering","glb_numbering")->transform(*mesh);
+
+  const OwnedElements before(*mesh);
+  Uint global_nb_elems_before;
+  comm.all_reduce(PE::plus(), &before.nb_elems, 1, &global_nb_elems_before);
+
+  boost::shared_ptr< MeshTransformer > partitioner = build_component_abstract_type<MeshTransformer>("cf3.mesh.hilbert.Partitioner","partitioner");
+  partitioner->options().set("imbalance_tolerance", 0.01);
+  partitioner->transform(*mesh);
+
+  const OwnedElements after(*mesh);
+
+  // No elements are lost or duplicated
+  Uint global_nb_elems_after;
+  comm.all_reduce(PE::plus(), &after.nb_elems, 1, &global_nb_elems_after);
+  BOOST_CHECK_EQUAL(global_nb_elems_after, global_nb_elems_before);
+
+  // Every part has the mean weight, up to the tolerance and one element of the largest weight
+  Real total_weight;
+  comm.all_reduce(PE::plus(), &after.weight, 1, &total_weight);
+  const Real mean_weight = total_weight / static_cast<Real>(comm.size());
+  BOOST_CHECK_SMALL(after.weight - mean_weight, 0.01*mean_weight + 4.);
+
+  // Parts hold consecutive intervals of the Hilbert curve
+  std::vector<boost::uint64_t> min_keys;
+  std::vector<boost::uint64_t> max_keys;
+  comm.all_gather(after.min_key, min_keys);
+  comm.all_gather(after.max_key, max_keys);
+  for (Uint p=1; p<comm.size(); ++p)
+    BOOST_CHECK_LT(max_keys[p-1], min_keys[p]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
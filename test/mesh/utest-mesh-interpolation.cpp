@@ -7,6 +7,8 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Tests mesh interpolation"
 
+#include <cmath>
+
 #include <boost/test/unit_test.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/assign/std/vector.hpp>
@@ -22,6 +24,8 @@
 #include "common/FindComponents.hpp"
 #include "common/Link.hpp"
 
+#include "common/PE/Comm.hpp"
+
 #include "math/MatrixTypesConversion.hpp"
 
 #include "mesh/Mesh.hpp"
@@ -47,6 +51,15 @@ using namespace cf3::common;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Linear function, interpolated exactly by the shape functions of any element
+template <typename RowT>
+Real linear(const RowT& coords)
+{
+  return 1. + 2.*coords[XX] - 3.*coords[YY];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 struct MeshInterpolation_Fixture
 {
   /// common setup for each test case
@@ -264,12 +277,18 @@ BOOST_AUTO_TEST_CASE( test_new_interpolation )
   // second call: use stored values
   BOOST_CHECK_NO_THROW(interpolator->interpolate(source_mesh->geometry_fields().coordinates(),target_field));
   CFinfo << target_field << CFendl;
+  Table<Real>::ArrayT stored_values = target_field.array();
 
   // turn off storage, and compute again on the fly
   interpolator->options().set("store",false);
   BOOST_CHECK_NO_THROW(interpolator->interpolate(source_mesh->geometry_fields().coordinates(),target_field));
   CFinfo << target_field << CFendl;
 
+  // the stored interpolation operator gives the same values
+  for (Uint i=0; i<target_field.size(); ++i)
+    for (Uint j=0; j<target_field.row_size(); ++j)
+      BOOST_CHECK_SMALL(stored_values[i][j] - target_field[i][j], 1e-12);
+
 
   Handle<Mesh> source_mesh_2 = Core::instance().root().create_component<Mesh>("quadtriag_new");
   meshreader->read_mesh_into("../../resources/quadtriag.neu",*source_mesh_2);
@@ -301,6 +320,58 @@ BOOST_AUTO_TEST_CASE( test_new_interpolation )
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( threaded_parallel_interpolation )
+{
+  // Source mesh distributed over the processors
+  Mesh& source = *Core::instance().root().create_component<Mesh>("distributed_source");
+  boost::shared_ptr<MeshGenerator> mesh_gen = allocate_component<SimpleMeshGenerator>("meshgen");
+  std::vector<Real> lengths = list_of(2.)(1.);
+  mesh_gen->options().set("nb_cells",std::vector<Uint>(2,20));
+  mesh_gen->options().set("lengths",lengths);
+  mesh_gen->options().set("mesh",source.uri());
+  mesh_gen->execute();
+
+  Field& source_field = source.geometry_fields().create_field("linear","f[1]");
+  for (Uint n=0; n<source_field.size(); ++n)
+    source_field[n][0] = linear(source_field.coordinates()[n]);
+
+  // Target points spread over the whole domain. In parallel, the points outside the local part
+  // are interpolated by another processor, and sent back in the all_to_all exchange.
+  // Each processor interpolates enough rows to use 4 threads.
+  const Uint nb_points = 6000;
+  boost::shared_ptr< Table<Real> > target_coords = allocate_component< Table<Real> >("target_coords");
+  target_coords->set_row_size(DIM_2D);
+  target_coords->resize(nb_points);
+  for (Uint i=0; i<nb_points; ++i)
+  {
+    (*target_coords)[i][XX] = 2.*std::fmod(0.6180339887*(i+0.5) + 0.1*PE::Comm::instance().rank(), 1.);
+    (*target_coords)[i][YY] = std::fmod(0.4142135624*(i+0.5), 1.);
+  }
+
+  boost::shared_ptr< Table<Real> > threaded = allocate_component< Table<Real> >("threaded");
+  threaded->set_row_size(1);
+  threaded->resize(nb_points);
+  boost::shared_ptr< Table<Real> > serial = allocate_component< Table<Real> >("serial");
+  serial->set_row_size(1);
+  serial->resize(nb_points);
+
+  boost::shared_ptr< Interpolator > interpolator = allocate_component<Interpolator>("interpolator");
+  interpolator->get_child("point_interpolator")->options().set("function",std::string("cf3.mesh.ShapeFunctionInterpolation"));
+  interpolator->options().set("store",true);
+  interpolator->options().set("nb_threads",4u);
+  interpolator->interpolate(source_field,*target_coords,*threaded);
+
+  for (Uint i=0; i<nb_points; ++i)
+    BOOST_CHECK_SMALL((*threaded)[i][0] - linear((*target_coords)[i]), 1e-10);
+
+  // The stored operator is reused on a single thread, and gives exactly the same rows
+  interpolator->options().set("nb_threads",1u);
+  interpolator->interpolate(source_field,*target_coords,*serial);
+  BOOST_CHECK(threaded->array() == serial->array());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_CASE( finalize_mpi )
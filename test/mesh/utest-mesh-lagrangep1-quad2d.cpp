@@ -103,6 +103,51 @@ BOOST_AUTO_TEST_CASE( Element )
   BOOST_CHECK_EQUAL(ETYPE::volume(coord), 150.);
 }
 
+BOOST_AUTO_TEST_CASE( BatchedGeometry )
+{
+  boost::shared_ptr<Elements> comp = allocate_component<Elements>("comp");
+  boost::shared_ptr<Dictionary> dict = allocate_component<ContinuousDictionary>("nodes");
+  comp->initialize("cf3.mesh.LagrangeP1.Quad2D",*dict);
+
+  // Two elements sharing the fixture nodes, the second one translated
+  boost::shared_ptr< Table<Real> > coordinates = allocate_component< Table<Real> >("coordinates");
+  coordinates->set_row_size(ETYPE::dimension);
+  coordinates->resize(2*ETYPE::nb_nodes);
+  boost::shared_ptr< Table<Uint> > connectivity = allocate_component< Table<Uint> >("connectivity");
+  connectivity->set_row_size(ETYPE::nb_nodes);
+  connectivity->resize(3);
+  for (Uint n=0; n<ETYPE::nb_nodes; ++n)
+  {
+    (*coordinates)[n][XX] = nodes(n,XX);
+    (*coordinates)[n][YY] = nodes(n,YY);
+    (*coordinates)[ETYPE::nb_nodes+n][XX] = nodes(n,XX) + 3.;
+    (*coordinates)[ETYPE::nb_nodes+n][YY] = nodes(n,YY) - 1.;
+    (*connectivity)[1][n] = n;
+    (*connectivity)[2][n] = ETYPE::nb_nodes+n;
+  }
+
+  // Only the last two elements are computed
+  RealVector volumes;
+  comp->element_type().compute_volumes(*connectivity, *coordinates, 1, 3, volumes);
+  BOOST_CHECK_EQUAL(volumes.size(), 2);
+  BOOST_CHECK_CLOSE(volumes[0], ETYPE::volume(nodes), 1e-10);
+  BOOST_CHECK_CLOSE(volumes[1], ETYPE::volume(nodes), 1e-10);
+
+  RealMatrix centroids;
+  comp->element_type().compute_centroids(*connectivity, *coordinates, 1, 3, centroids);
+  ETYPE::CoordsT centroid;
+  ETYPE::compute_centroid(nodes, centroid);
+  BOOST_CHECK_CLOSE(centroids(0,XX), centroid[XX], 1e-10);
+  BOOST_CHECK_CLOSE(centroids(0,YY), centroid[YY], 1e-10);
+  BOOST_CHECK_CLOSE(centroids(1,XX), centroid[XX] + 3., 1e-10);
+  BOOST_CHECK_CLOSE(centroids(1,YY), centroid[YY] - 1., 1e-10);
+
+  RealVector determinants;
+  comp->element_type().compute_jacobian_determinants(mapped_coords, *connectivity, *coordinates, 1, 3, determinants);
+  BOOST_CHECK_CLOSE(determinants[0], ETYPE::jacobian_determinant(mapped_coords, nodes), 1e-10);
+  BOOST_CHECK_CLOSE(determinants[1], ETYPE::jacobian_determinant(mapped_coords, nodes), 1e-10);
+}
+
 BOOST_AUTO_TEST_CASE( computeShapeFunction )
 {
   const ETYPE::SF::ValueT reference_result(0.045, 0.055, 0.495, 0.405);
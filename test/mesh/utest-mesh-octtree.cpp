@@ -27,8 +27,11 @@
 #include "mesh/Space.hpp"
 #include "common/Table.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
 #include "mesh/MeshGenerator.hpp"
 #include "mesh/Octtree.hpp"
+#include "mesh/ElementTree.hpp"
+#include "mesh/ElementFinderOcttree.hpp"
 #include "mesh/StencilComputerOcttree.hpp"
 #include "mesh/MeshWriter.hpp"
 
@@ -147,6 +150,145 @@ BOOST_AUTO_TEST_CASE( Octtree_creation )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( ElementTree_creation )
+{
+  // Uses the 5x5 mesh of cells of size 2 generated in Octtree_creation
+  Mesh& mesh = *Handle<Mesh>(Core::instance().root().get_child("mesh"));
+  ElementTree& tree = *mesh.create_component<ElementTree>("element_tree");
+  tree.options().set("mesh", mesh.handle<Mesh>());
+  tree.options().set("max_elems_per_leaf", 2u);
+  tree.options().set("nb_threads", 2u);
+
+  Entity element;
+  RealVector coord(2);
+
+  coord << 1. , 1. ;
+  BOOST_CHECK(tree.find_element(coord,element));
+  BOOST_CHECK_EQUAL(element.idx,0u);
+
+  coord << 3. , 1. ;
+  BOOST_CHECK(tree.find_element(coord,element));
+  BOOST_CHECK_EQUAL(element.idx,1u);
+
+  coord << 1 , 3. ;
+  BOOST_CHECK(tree.find_element(coord,element));
+  BOOST_CHECK_EQUAL(element.idx,5u);
+
+  coord << 11. , 1. ;
+  BOOST_CHECK(tree.find_element(coord,element) == false);
+
+  // Batch of points in all cells, in reverse order of the cells, followed by a point outside the mesh.
+  // There are enough points to split the search over 4 threads, 256 points each at least.
+  const Uint nb_rounds = 48;
+  const Uint nb_points = 25*nb_rounds;
+  boost::shared_ptr< Table<Real> > coordinates = allocate_component< Table<Real> >("centers");
+  coordinates->set_row_size(2);
+  coordinates->resize(nb_points+1);
+  for (Uint p=0; p<nb_points; ++p)
+  {
+    const Uint idx = 24-p%25;
+    const Real offset = 0.9 * (static_cast<Real>(p/25)/nb_rounds - 0.5);
+    (*coordinates)[p][XX] = 2.*(idx%5) + 1. + offset;
+    (*coordinates)[p][YY] = 2.*(idx/5) + 1. - offset;
+  }
+  (*coordinates)[nb_points][XX] = -1.;
+  (*coordinates)[nb_points][YY] = 5.;
+
+  tree.options().set("nb_threads", 4u);
+  std::vector<Entity> elements;
+  BOOST_CHECK_EQUAL(tree.find_elements(*coordinates,elements), nb_points);
+  BOOST_CHECK_EQUAL(elements.size(), nb_points+1);
+  for (Uint p=0; p<nb_points; ++p)
+  {
+    BOOST_CHECK(is_not_null(elements[p].comp));
+    BOOST_CHECK_EQUAL(elements[p].idx, 24u-p%25);
+  }
+  BOOST_CHECK(is_null(elements[nb_points].comp));
+
+  // The threaded search finds the same elements as the serial one
+  tree.options().set("nb_threads", 1u);
+  std::vector<Entity> serial_elements;
+  BOOST_CHECK_EQUAL(tree.find_elements(*coordinates,serial_elements), nb_points);
+  for (Uint p=0; p<=nb_points; ++p)
+  {
+    BOOST_CHECK(elements[p].comp == serial_elements[p].comp);
+    BOOST_CHECK_EQUAL(elements[p].idx, serial_elements[p].idx);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( ElementTree_graded_mesh )
+{
+  // 16x16 mesh of the unit square with the nodes mapped as x^4, so the cells
+  // range from 1.5e-5 to 0.23 wide, which a uniform octtree grid resolves badly
+  Handle< MeshGenerator > mesh_generator(Core::instance().root().get_child("mesh_generator"));
+  mesh_generator->options().set("mesh",Core::instance().root().uri()/"graded_mesh");
+  mesh_generator->options().set("lengths",std::vector<Real>(2,1.));
+  mesh_generator->options().set("nb_cells",std::vector<Uint>(2,16));
+  mesh_generator->options().set("part",0u);
+  mesh_generator->options().set("nb_parts",1u);
+  Mesh& mesh = mesh_generator->generate();
+
+  Field& coordinates = mesh.geometry_fields().coordinates();
+  for (Uint n=0; n<coordinates.size(); ++n)
+  {
+    for (Uint d=0; d<coordinates.row_size(); ++d)
+      coordinates[n][d] = std::pow(coordinates[n][d],4);
+  }
+
+  Handle<ElementFinderOcttree> finder = Core::instance().root().create_component<ElementFinderOcttree>("graded_finder");
+  finder->options().set("dict", mesh.geometry_fields().handle<Dictionary>());
+  Handle<ElementTree> tree(mesh.get_child("element_tree"));
+  Handle<Octtree> octtree(mesh.get_child("octtree"));
+  BOOST_CHECK(is_not_null(tree));
+  BOOST_CHECK(is_not_null(octtree));
+
+  // The mapping is separable, so the cells remain rectangles and every point
+  // inside the bounding box of a cell lies inside that cell
+  Entities& elements = *mesh.elements()[0];
+  Space& space = elements.geometry_space();
+  RealMatrix nodes;
+  space.allocate_coordinates(nodes);
+  RealVector coord(2);
+  SpaceElem found;
+  Entity tree_found;
+  const Real weights[3] = {0.05, 0.5, 0.95};
+  for (Uint e=0; e<elements.size(); ++e)
+  {
+    space.put_coordinates(nodes,e);
+    const RealVector2 min = nodes.colwise().minCoeff();
+    const RealVector2 max = nodes.colwise().maxCoeff();
+    for (Uint i=0; i<3; ++i)
+    {
+      for (Uint j=0; j<3; ++j)
+      {
+        coord[XX] = min[XX] + weights[i]*(max[XX]-min[XX]);
+        coord[YY] = min[YY] + weights[j]*(max[YY]-min[YY]);
+
+        BOOST_CHECK(tree->find_element(coord,tree_found));
+        BOOST_CHECK(tree_found.comp == &elements);
+        BOOST_CHECK_EQUAL(tree_found.idx, e);
+
+        BOOST_CHECK(finder->find_element(coord,found));
+        BOOST_CHECK(found.comp == &space);
+        BOOST_CHECK_EQUAL(found.idx, e);
+      }
+    }
+  }
+
+  // Every point was found by the element tree, so the octtree was never built
+  BOOST_CHECK(tree->is_created());
+  BOOST_CHECK(octtree->is_created() == false);
+
+  // A point outside the mesh is missed by the tree and builds the octtree for the fallback search
+  coord << 1.5, 0.5;
+  finder->find_element(coord,found);
+  BOOST_CHECK(octtree->is_created());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( Octtree_parallel )
 {
   Handle< MeshGenerator > mesh_generator(Core::instance().root().get_child("mesh_generator"));
@@ -7,14 +7,28 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::mesh::tecplot::Writer"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/assign/list_of.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/Core.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionComponent.hpp"
 #include "common/OptionArray.hpp"
 #include "common/OptionURI.hpp"
+#include "common/StringConversion.hpp"
 #include "mesh/MeshWriter.hpp"
 
 #include "Tools/MeshGeneration/MeshGeneration.hpp"
@@ -30,6 +44,90 @@ using namespace cf3::common;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Written VTU file, split in the XML header and the appended data
+struct VTUFile
+{
+  VTUFile(const std::string& filename, const bool is_compressed) : compressed(is_compressed)
+  {
+    std::ifstream vtu_file(filename.c_str(), std::ios_base::binary);
+    BOOST_CHECK(vtu_file.is_open());
+    contents.assign((std::istreambuf_iterator<char>(vtu_file)), std::istreambuf_iterator<char>());
+
+    const std::string start_tag = "<AppendedData encoding=\"raw\">\n_";
+    const std::string::size_type begin = contents.find(start_tag);
+    const std::string::size_type end = contents.rfind("\n</AppendedData>");
+    BOOST_REQUIRE(begin != std::string::npos && end != std::string::npos);
+    data = contents.substr(begin + start_tag.size(), end - begin - start_tag.size());
+
+    // Offsets of the arrays, in the order of the XML header
+    const std::string header = contents.substr(0, begin);
+    const std::string offset_attr = "offset=\"";
+    for(std::string::size_type pos = header.find(offset_attr); pos != std::string::npos; pos = header.find(offset_attr, pos))
+    {
+      pos += offset_attr.size();
+      offsets.push_back(boost::lexical_cast<Uint>(header.substr(pos, header.find('"', pos) - pos)));
+    }
+  }
+
+  boost::uint32_t read_uint32(const Uint position) const
+  {
+    BOOST_REQUIRE(position + 4 <= data.size());
+    boost::uint32_t result;
+    std::memcpy(&result, &data[position], 4);
+    return result;
+  }
+
+  /// Size of the array at the given offset, including its header
+  Uint array_size(const Uint offset) const
+  {
+    if(!compressed)
+      return 4 + read_uint32(offset);
+
+    const Uint nb_blocks = read_uint32(offset);
+    BOOST_CHECK(nb_blocks > 0);
+    BOOST_CHECK_EQUAL(read_uint32(offset + 4), 32768u);
+    BOOST_CHECK(read_uint32(offset + 8) > 0 && read_uint32(offset + 8) <= 32768u);
+    Uint result = 12 + 4*nb_blocks;
+    for(Uint i = 0; i != nb_blocks; ++i)
+      result += read_uint32(offset + 12 + 4*i);
+    return result;
+  }
+
+  /// Uncompressed bytes of the array at the given offset
+  std::string decode(const Uint offset) const
+  {
+    if(!compressed)
+      return data.substr(offset + 4, read_uint32(offset));
+
+    const Uint nb_blocks = read_uint32(offset);
+    const Uint blocksize = read_uint32(offset + 4);
+    const Uint last_blocksize = read_uint32(offset + 8);
+    std::string result;
+    Uint block_begin = offset + 12 + 4*nb_blocks;
+    for(Uint i = 0; i != nb_blocks; ++i)
+    {
+      const Uint compressed_size = read_uint32(offset + 12 + 4*i);
+      std::string block;
+      boost::iostreams::filtering_ostream decompressed_stream;
+      decompressed_stream.push(boost::iostreams::zlib_decompressor());
+      decompressed_stream.push(boost::iostreams::back_inserter(block));
+      decompressed_stream.write(&data[block_begin], compressed_size);
+      decompressed_stream.reset();
+      BOOST_CHECK_EQUAL(block.size(), i+1 == nb_blocks ? last_blocksize : blocksize);
+      result += block;
+      block_begin += compressed_size;
+    }
+    return result;
+  }
+
+  const bool compressed;
+  std::string contents;
+  std::string data;
+  std::vector<Uint> offsets;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE( VTKXMLSuite )
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -54,6 +152,76 @@ BOOST_AUTO_TEST_CASE( WriteGrid )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( WriteGridCompressionModes )
+{
+  // 101x101 points, so the points array spans several 32 KiB blocks
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("big_mesh");
+  Tools::MeshGeneration::create_rectangle(*mesh, 1., 1., 100, 100);
+  const Field& coords = mesh->geometry_fields().coordinates();
+
+  const std::vector<std::string> compressions = boost::assign::list_of("zlib")("fast")("raw");
+  const std::vector<Uint> nb_threads = boost::assign::list_of(1)(4);
+  boost_foreach(const std::string& compression, compressions)
+  {
+    std::vector<std::string> thread_contents;
+    boost_foreach(const Uint threads, nb_threads)
+    {
+      const std::string basename = "grid-" + compression + "-" + to_str(threads);
+      boost::shared_ptr< MeshWriter > vtk_writer = build_component_abstract_type<MeshWriter>("cf3.mesh.VTKXML.Writer","meshwriter");
+
+      std::vector<URI> fields; fields.push_back(coords.uri());
+      vtk_writer->options().set("fields",fields);
+      vtk_writer->options().set("mesh",mesh);
+      vtk_writer->options().set("compression",compression);
+      vtk_writer->options().set("nb_threads",threads);
+      vtk_writer->options().set("file",URI(basename + ".vtu"));
+      vtk_writer->execute();
+
+      const VTUFile vtu(basename + "_P0.vtu", compression != "raw");
+      thread_contents.push_back(vtu.contents);
+
+      // The file ends with the closing tags written after the streamed data
+      BOOST_CHECK(boost::algorithm::ends_with(vtu.contents, "</AppendedData>\n</VTKFile>\n"));
+      BOOST_CHECK_EQUAL(vtu.contents.find("vtkZLibDataCompressor") != std::string::npos, compression != "raw");
+
+      // Points, connectivity, offsets, types and the coordinates field
+      BOOST_REQUIRE_EQUAL(vtu.offsets.size(), 5u);
+
+      // Each offset points at a valid array header, and the arrays follow each other up to the end of the data
+      std::vector<Uint> sorted_offsets = vtu.offsets;
+      std::sort(sorted_offsets.begin(), sorted_offsets.end());
+      BOOST_CHECK_EQUAL(sorted_offsets.front(), 0u);
+      for(Uint i = 0; i != sorted_offsets.size(); ++i)
+      {
+        const Uint next = i+1 == sorted_offsets.size() ? vtu.data.size() : sorted_offsets[i+1];
+        BOOST_CHECK_EQUAL(sorted_offsets[i] + vtu.array_size(sorted_offsets[i]), next);
+      }
+
+      // The points array holds the coordinates, padded with z = 0
+      const std::string points = vtu.decode(vtu.offsets[0]);
+      BOOST_REQUIRE_EQUAL(points.size(), 3*coords.size()*sizeof(Real));
+      if(compression != "raw")
+        BOOST_CHECK(vtu.read_uint32(vtu.offsets[0]) > 1u);
+      bool points_equal = true;
+      for(Uint i = 0; i != coords.size(); ++i)
+      {
+        Real point[3];
+        std::memcpy(point, &points[3*i*sizeof(Real)], 3*sizeof(Real));
+        points_equal = points_equal && point[XX] == coords[i][XX] && point[YY] == coords[i][YY] && point[ZZ] == 0.;
+      }
+      BOOST_CHECK(points_equal);
+
+      // The field array holds the same values as the points
+      BOOST_CHECK(vtu.decode(vtu.offsets[4]) == points);
+    }
+
+    // The threaded compression doesn't change the output
+    BOOST_CHECK(thread_contents[0] == thread_contents[1]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
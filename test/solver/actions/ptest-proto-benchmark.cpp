@@ -9,10 +9,13 @@
 
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include "common/Core.hpp"
 #include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/Timer.hpp"
 
 #include "math/MatrixTypes.hpp"
 
@@ -228,6 +231,28 @@ BOOST_AUTO_TEST_CASE( SimulateVolumeComputer )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Run the proto model using an increasing number of threads, leaving the result for CheckResult
+BOOST_AUTO_TEST_CASE( SimulateProtoThreaded )
+{
+  Handle<Model> model(root.get_child("Proto"));
+  Component& action = *model->solver().get_child("ComputeVolume");
+
+  const Uint max_threads = std::max(boost::thread::hardware_concurrency(), 2u);
+  Real single_thread_time = 0.;
+  for(Uint nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2)
+  {
+    action.options().set("nb_threads", nb_threads);
+    Timer timer;
+    model->simulate();
+    const Real elapsed = timer.elapsed();
+    if(nb_threads == 1)
+      single_thread_time = elapsed;
+    std::cout << "Proto volume computation with " << nb_threads << " threads: " << elapsed << " s, speedup " << single_thread_time / elapsed << std::endl;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // Check the volume results (uses proto)
 BOOST_AUTO_TEST_CASE( CheckResult )
 {
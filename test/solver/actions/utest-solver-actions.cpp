@@ -7,7 +7,11 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::actions"
 
+#include <algorithm>
+#include <fstream>
 #include <iomanip>
+#include <limits>
+#include <sstream>
 
 #include <boost/test/unit_test.hpp>
 
@@ -15,14 +19,19 @@
 
 #include "common/LibCommon.hpp"
 
+#include "common/BoostFilesystem.hpp"
+
 #include "common/Log.hpp"
 #include "common/Core.hpp"
 #include "common/Libraries.hpp"
 #include "common/Environment.hpp"
 #include "common/Group.hpp"
 #include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/FindComponents.hpp"
 
 #include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
 #include "mesh/MeshWriter.hpp"
 #include "mesh/MeshReader.hpp"
 #include "mesh/MeshTransformer.hpp"
@@ -41,6 +50,7 @@
 #include "solver/actions/LoopOperation.hpp"
 #include "solver/actions/ComputeVolume.hpp"
 #include "solver/actions/ComputeArea.hpp"
+#include "solver/actions/PeriodicWriteMesh.hpp"
 
 using namespace boost::assign;
 
@@ -264,6 +274,129 @@ BOOST_AUTO_TEST_CASE ( test_ForAllElementsT )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Iteration tag and values of the scalar nodal field field_name in a gmsh file
+bool read_gmsh_node_data(const std::string& filename, const std::string& field_name, Uint& iteration, std::vector<Real>& values)
+{
+  std::ifstream file(filename.c_str());
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line != "$NodeData")
+      continue;
+    std::string var_name, name;
+    Uint nb_string_tags, nb_real_tags, nb_int_tags, datasize, nb_nodes;
+    Real time;
+    file >> nb_string_tags >> var_name >> name >> nb_real_tags >> time >> nb_int_tags >> iteration >> datasize >> nb_nodes;
+    if (name != "\"" + field_name + "\"")
+      continue;
+    values.resize(nb_nodes);
+    for (Uint n=0; n<nb_nodes; ++n)
+    {
+      Uint node;
+      file >> node >> values[n];
+    }
+    return file.good();
+  }
+  return false;
+}
+
+/// Smallest x-coordinate of the nodes in a gmsh file
+Real read_gmsh_min_x(const std::string& filename)
+{
+  std::ifstream file(filename.c_str());
+  std::string line;
+  while (std::getline(file, line) && line != "$Nodes") {}
+  Uint nb_nodes = 0;
+  file >> nb_nodes;
+  Real min_x = std::numeric_limits<Real>::max();
+  for (Uint n=0; n<nb_nodes; ++n)
+  {
+    Uint node;
+    Real x, y, z;
+    file >> node >> x >> y >> z;
+    min_x = std::min(min_x, x);
+  }
+  return min_x;
+}
+
+BOOST_AUTO_TEST_CASE ( test_PeriodicWriteMesh_asynchronous )
+{
+  Component& root = Core::instance().root();
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh3");
+  Core::instance().tools().get_child("LoadMesh")->handle<LoadMesh>()->load_mesh_into("../../../resources/rotation-tg-p1.neu", *mesh);
+
+  Field& field = mesh->geometry_fields().create_field("iteration_field");
+  Field& coordinates = mesh->geometry_fields().coordinates();
+  const Uint nb_mesh_fields = find_components_recursively<Field>(*mesh).size();
+  Real min_x = std::numeric_limits<Real>::max();
+  for(Uint i = 0; i != coordinates.size(); ++i)
+    min_x = std::min(min_x, coordinates[i][XX]);
+
+  Handle<Group> iterator = root.create_component<Group>("iterator");
+  iterator->properties().add("iteration", Uint(0));
+
+  Handle<PeriodicWriteMesh> writer = root.create_component<PeriodicWriteMesh>("periodic_writer");
+  writer->options().set("mesh", mesh);
+  writer->options().set("iterator", iterator->handle<Component>());
+  writer->options().set("saverate", 2u);
+  writer->options().set("filepath", URI("test_utest-actions_PeriodicWriteMesh_${iter}.msh"));
+  writer->options().set("asynchronous", true);
+  writer->options().set("nb_buffers", 2u);
+
+  // The solver keeps changing the field, the coordinates and the iteration in the metadata
+  // while the snapshots are written
+  for(Uint iteration = 1; iteration <= 6; ++iteration)
+  {
+    iterator->properties()["iteration"] = iteration;
+    mesh->metadata()["iter"] = iteration;
+    for(Uint i = 0; i != field.size(); ++i)
+      field[i][0] = static_cast<Real>(iteration);
+    writer->execute();
+    for(Uint i = 0; i != coordinates.size(); ++i)
+      coordinates[i][XX] += 1.;
+  }
+  mesh->metadata()["iter"] = 0u;
+  writer->wait_for_output();
+
+  // Each file is named after its iteration and holds the data of that iteration
+  for(Uint iteration = 2; iteration <= 6; iteration += 2)
+  {
+    std::stringstream filename;
+    filename << "test_utest-actions_PeriodicWriteMesh_" << std::setw(4) << std::setfill('0') << iteration << "_P0.msh";
+    BOOST_CHECK(boost::filesystem::exists(filename.str()));
+
+    Uint file_iteration = 0;
+    std::vector<Real> values;
+    BOOST_CHECK(read_gmsh_node_data(filename.str(), "iteration_field", file_iteration, values));
+    BOOST_CHECK_EQUAL(file_iteration, iteration);
+    BOOST_CHECK_EQUAL(values.size(), field.size());
+    BOOST_CHECK(std::count(values.begin(), values.end(), static_cast<Real>(iteration)) == static_cast<long>(values.size()));
+    BOOST_CHECK_SMALL(read_gmsh_min_x(filename.str()) - (min_x + static_cast<Real>(iteration-1)), 1e-5);
+  }
+
+  BOOST_CHECK_EQUAL(writer->properties().value<Uint>("nb_writes"), 3u);
+  BOOST_CHECK(writer->properties().value<Real>("hidden_io_time") <= writer->properties().value<Real>("io_time"));
+
+  // The snapshots are used in turn: iterations 2 and 6 went to the first, iteration 4 to the second.
+  // They hold the values at the iterations they were taken, not the live values.
+  const std::string dict_name = mesh->geometry_fields().name();
+  Handle<Field> snapshot0(writer->access_component("snapshots/snapshot0/"+dict_name+"/iteration_field"));
+  Handle<Field> snapshot1(writer->access_component("snapshots/snapshot1/"+dict_name+"/iteration_field"));
+  BOOST_REQUIRE(is_not_null(snapshot0));
+  BOOST_REQUIRE(is_not_null(snapshot1));
+  BOOST_CHECK_EQUAL((*snapshot0)[0][0], 6.);
+  BOOST_CHECK_EQUAL((*snapshot1)[0][0], 4.);
+
+  // The mesh is left untouched
+  BOOST_CHECK_EQUAL(find_components_recursively<Field>(*mesh).size(), nb_mesh_fields);
+
+  root.remove_component(*writer);
+  root.remove_component(*iterator);
+  root.remove_component(*mesh);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////